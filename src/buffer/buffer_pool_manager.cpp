@@ -26,6 +26,8 @@ BufferPoolManager::~BufferPoolManager() {
  * TODO: Student Implement
  */
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+  // 索引迭代器的预读线程也会访问缓冲池
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -73,6 +75,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * TODO: Student Implement
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // if(pages_[1].page_id_==0){throw "ERROR!";}
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
@@ -107,6 +110,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
  * TODO: Student Implement
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
@@ -114,21 +118,27 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
   if(page_id==INVALID_PAGE_ID) return true;//已经删除过了
   auto it=page_table_.find(page_id);//1.
-  if(it==page_table_.end()) return true;//1. if P does not exist
-  frame_id_t frame_id=it->second;
-  Page* p=pages_+frame_id;
-  if(p->pin_count_!=0) return false;//2.
-  page_table_.erase(p->page_id_);//3.
-  p->ResetMemory();
-  p->page_id_=INVALID_PAGE_ID;//如果 Page 对象不包含物理页，那么 page_id_ =INVALID_PAGE_ID 
-  free_list_.push_back(frame_id);
-  return false;
+  if(it!=page_table_.end()){
+    frame_id_t frame_id=it->second;
+    Page* p=pages_+frame_id;
+    if(p->pin_count_!=0) return false;//2.
+    page_table_.erase(p->page_id_);//3.
+    replacer_->Pin(frame_id);//帧回到free list, 不能再被replacer选中
+    p->ResetMemory();
+    p->page_id_=INVALID_PAGE_ID;//如果 Page 对象不包含物理页，那么 page_id_ =INVALID_PAGE_ID 
+    p->is_dirty_=false;
+    free_list_.push_back(frame_id);
+  }
+  //不在缓冲池中(比如已经被换出)的页同样要在磁盘上释放
+  DeallocatePage(page_id);//0.
+  return true;
 }
 
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   auto it=page_table_.find(page_id);
   if(it==page_table_.end()) return false;
   frame_id_t frame_id=it->second;
@@ -136,7 +146,8 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
   if(p->pin_count_ == 0) return false;
   p->pin_count_--;
   if(p->pin_count_==0) replacer_->Unpin(frame_id);
-  p->is_dirty_=is_dirty;
+  // 只读的 unpin 不能抹掉其他人留下的脏标记
+  p->is_dirty_=p->is_dirty_||is_dirty;
   return true;
 }
 
@@ -144,6 +155,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * TODO: Student Implement
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   auto it=page_table_.find(page_id);
   if(it==page_table_.end()) return false;
   frame_id_t frame_id=it->second;
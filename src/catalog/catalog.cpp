@@ -112,10 +112,11 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   catalog_meta_->table_meta_pages_[table_id] = page_id;
 
   Schema *tmp_schema = Schema::DeepCopySchema(schema);
-  auto table_meta = TableMetadata::Create(table_id, table_name, page_id, tmp_schema);
+  auto table_heap = TableHeap::Create(buffer_pool_manager_, tmp_schema, txn, log_manager_, lock_manager_);
+  // 元数据记录的是堆表的第一页, 重新加载时从这里开始遍历
+  auto table_meta = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), tmp_schema);
   table_meta->SerializeTo(page->GetData());
   buffer_pool_manager_->UnpinPage(page_id, true);
-  auto table_heap = TableHeap::Create(buffer_pool_manager_, tmp_schema, txn, log_manager_, lock_manager_);
   table_info = TableInfo::Create();
   table_info->Init(table_meta, table_heap);
   tables_[table_id] = table_info;
@@ -153,9 +154,10 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
  */
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Txn *txn, IndexInfo *&index_info,
-                                    const string &index_type) {
+                                    const string &index_type, bool unique) {
   if(table_names_.find(table_name) == table_names_.end()) return DB_TABLE_NOT_EXIST;  
   if(index_names_.find(table_name) != index_names_.end() && index_names_[table_name].find(index_name) != index_names_[table_name].end()) return DB_INDEX_ALREADY_EXIST;
+  if(index_type != "bptree" && index_type != "hash" && index_type != "art") return DB_FAILED;
   
   table_id_t table_id = table_names_[table_name];
   auto table_info = tables_[table_id];
@@ -170,7 +172,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   index_id = catalog_meta_->GetNextIndexId();
   table_id = table_names_[table_name];
   page_id_t index_page_id;
-  auto index_meta = IndexMetadata::Create(index_id, index_name, table_id, key_map);
+  auto index_meta = IndexMetadata::Create(index_id, index_name, table_id, key_map, index_type, unique);
   auto index_meta_page = buffer_pool_manager_->NewPage(index_page_id);
   index_meta->SerializeTo(index_meta_page->GetData());
 
@@ -255,11 +257,46 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
   // return DB_FAILED;
 }
 
+dberr_t CatalogManager::UpdateTableStatistics(const std::string &table_name, TableStatistics *statistics) {
+  if (table_names_.find(table_name) == table_names_.end()) {
+    delete statistics;
+    return DB_TABLE_NOT_EXIST;
+  }
+  table_id_t table_id = table_names_[table_name];
+  auto table_info = tables_[table_id];
+  auto table_meta = table_info->GetTableMetadata();
+  page_id_t stats_page_id = table_meta->GetStatsPageId();
+  bool new_page = stats_page_id == INVALID_PAGE_ID;
+  auto stats_page = new_page ? buffer_pool_manager_->NewPage(stats_page_id)
+                             : buffer_pool_manager_->FetchPage(stats_page_id);
+  if (stats_page == nullptr) {
+    delete statistics;
+    return DB_FAILED;
+  }
+  statistics->SerializeTo(stats_page->GetData());
+  buffer_pool_manager_->UnpinPage(stats_page_id, true);
+  table_info->SetStatistics(statistics);
+  if (new_page) {
+    // 第一次 ANALYZE, 把统计信息页记到表的元数据中
+    table_meta->SetStatsPageId(stats_page_id);
+    page_id_t meta_page_id = catalog_meta_->table_meta_pages_[table_id];
+    auto meta_page = buffer_pool_manager_->FetchPage(meta_page_id);
+    if (meta_page == nullptr) return DB_FAILED;
+    table_meta->SerializeTo(meta_page->GetData());
+    buffer_pool_manager_->UnpinPage(meta_page_id, true);
+  }
+  return DB_SUCCESS;
+}
+
 /**
  * TODO: Student Implement
  */
 dberr_t CatalogManager::FlushCatalogMetaPage() const {
   // ASSERT(false, "Not Implemented yet");
+  // 索引的根变化只记在内存里, 在这里统一写回 index roots page
+  for (auto &it : indexes_) {
+    if (it.second->GetIndex() != nullptr) it.second->GetIndex()->Checkpoint();
+  }
   auto meta_page = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
   catalog_meta_->SerializeTo(meta_page->GetData());
   buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
@@ -276,8 +313,12 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   auto table_page = buffer_pool_manager_->FetchPage(page_id);
   if(table_page == nullptr) return DB_FAILED;
 
-  TableMetadata *table_meta;
+  TableMetadata *table_meta = nullptr;
   TableMetadata::DeserializeFrom(table_page->GetData(), table_meta);
+  if (table_meta == nullptr) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return DB_FAILED;
+  }
   table_names_[table_meta->GetTableName()] = table_id;
 
   auto table_info = TableInfo::Create();
@@ -285,6 +326,14 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   table_info->Init(table_meta, table_heap);
   tables_[table_id] = table_info;
   buffer_pool_manager_->UnpinPage(page_id, false);
+  if (table_meta->GetStatsPageId() != INVALID_PAGE_ID) {
+    auto stats_page = buffer_pool_manager_->FetchPage(table_meta->GetStatsPageId());
+    if (stats_page == nullptr) return DB_FAILED;
+    TableStatistics *statistics = nullptr;
+    TableStatistics::DeserializeFrom(stats_page->GetData(), table_meta->GetSchema(), statistics);
+    table_info->SetStatistics(statistics);
+    buffer_pool_manager_->UnpinPage(table_meta->GetStatsPageId(), false);
+  }
   return DB_SUCCESS;
   // return DB_FAILED;
 }
@@ -297,8 +346,12 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
   auto index_page = buffer_pool_manager_->FetchPage(page_id);
   if(index_page == nullptr) return DB_FAILED;
 
-  IndexMetadata *index_meta;
+  IndexMetadata *index_meta = nullptr;
   IndexMetadata::DeserializeFrom(index_page->GetData(), index_meta);
+  if (index_meta == nullptr) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return DB_FAILED;
+  }
   table_id_t table_id = index_meta->GetTableId();
   string table_name = tables_[table_id]->GetTableName();
   string index_name = index_meta->GetIndexName();
@@ -308,6 +361,17 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
   index_info->Init(index_meta, tables_[table_id], buffer_pool_manager_);
   indexes_[index_id] = index_info;
   buffer_pool_manager_->UnpinPage(page_id, false);
+  if (index_info->GetIndexType() == "art") {
+    // art 索引只在内存中, 从堆表重建
+    auto table_info = tables_[table_id];
+    auto heap = table_info->GetTableHeap();
+    Row key_row;
+    for (auto it = heap->Begin(nullptr); it != heap->End(); it++) {
+      Row row = *it;
+      row.GetKeyFromRow(table_info->GetSchema(), index_info->GetIndexKeySchema(), key_row);
+      index_info->GetIndex()->InsertEntry(key_row, row.GetRowId(), nullptr);
+    }
+  }
   return DB_SUCCESS;
   // return DB_FAILED;
 }
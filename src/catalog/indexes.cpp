@@ -1,12 +1,17 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, const std::string &index_type, bool unique)
+    : index_id_(index_id),
+      index_name_(index_name),
+      table_id_(table_id),
+      key_map_(key_map),
+      index_type_(index_type),
+      unique_(unique) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, const std::string &index_type, bool unique) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, index_type, unique);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -35,6 +40,14 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf, col_index);
     buf += 4;
   }
+  // index type
+  MACH_WRITE_UINT32(buf, index_type_.length());
+  buf += 4;
+  MACH_WRITE_STRING(buf, index_type_);
+  buf += index_type_.length();
+  // unique
+  MACH_WRITE_TO(bool, buf, unique_);
+  buf += sizeof(bool);
   ASSERT(buf - p == ofs, "Unexpected serialize size.");
   return ofs;
 }
@@ -44,7 +57,7 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
  */
 uint32_t IndexMetadata::GetSerializedSize() const {
   // return 0;
-  return sizeof(uint32_t)*3 + sizeof(index_id_t) + index_name_.length() + sizeof(table_id_t) + sizeof(uint32_t)*key_map_.size();
+  return sizeof(uint32_t)*4 + sizeof(index_id_t) + index_name_.length() + sizeof(table_id_t) + sizeof(uint32_t)*key_map_.size() + index_type_.length() + sizeof(bool);
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
@@ -55,7 +68,12 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
   // magic num
   uint32_t magic_num = MACH_READ_UINT32(buf);
   buf += 4;
-  ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM, "Failed to deserialize index info.");
+  if (magic_num != INDEX_METADATA_MAGIC_NUM) {
+    // 旧格式的索引页也按旧的 key 编码存放, 只能拒绝, 不能猜
+    LOG(ERROR) << "Failed to deserialize index info, unknown magic number " << magic_num << "." << std::endl;
+    index_meta = nullptr;
+    return 0;
+  }
   // index id
   index_id_t index_id = MACH_READ_FROM(index_id_t, buf);
   buf += 4;
@@ -77,34 +95,85 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     buf += 4;
     key_map.push_back(key_index);
   }
+  // index type
+  len = MACH_READ_UINT32(buf);
+  buf += 4;
+  std::string index_type(buf, len);
+  buf += len;
+  // unique
+  bool unique = MACH_READ_FROM(bool, buf);
+  buf += sizeof(bool);
   // allocate space for index meta data
-  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, index_type, unique);
   return buf - p;
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  for (auto col : key_schema_->GetColumns()) {
-    max_size += col->GetLength();
+  if (index_type != "bptree" && index_type != "hash" && index_type != "art") {
+    return nullptr;
+  }
+  // key 按最长编码长度分配, b+ 树页内只存去掉补零后的部分; 非唯一的 b+ 树/art 索引在 key 后追加 RowId,
+  // hash 索引的重复 key 各占一个 pair, 不需要追加
+  size_t max_size = KeyManager::GetMaxKeySize(key_schema_);
+  if (index_type != "hash" && !meta_data_->unique_) {
+    max_size += KeyManager::ROW_ID_KEY_SIZE;
+  }
+  if (index_type == "art") {
+    // 只在内存中, 不受页大小限制
+    return new ArtIndex(meta_data_->index_id_, key_schema_, max_size, meta_data_->unique_);
+  }
+  if (max_size > 256) {
+    LOG(ERROR) << "GenericKey size is too large";
+    return nullptr;
+  }
+  if (index_type == "hash") {
+    return new HashIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, meta_data_->unique_);
+  }
+  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, meta_data_->unique_);
+}
+
+void IndexInfo::BuildKeyFilter(TableInfo *table_info) {
+  key_filter_ = std::make_unique<BloomFilter>();
+  auto heap = table_info->GetTableHeap();
+  Row key_row;
+  for (auto it = heap->Begin(nullptr); it != heap->End(); it++) {
+    it->GetKeyFromRow(table_info->GetSchema(), key_schema_, key_row);
+    auto buf = EncodeFilterKey(key_row);
+    key_filter_->Add(buf.data(), buf.size());
   }
+}
 
-  if (index_type == "bptree") {
-    if (max_size <= 8)
-      max_size = 16;
-    else if (max_size <= 24)
-      max_size = 32;
-    else if (max_size <= 56)
-      max_size = 64;
-    else if (max_size <= 120)
-      max_size = 128;
-    else if (max_size <= 248)
-      max_size = 256;
-    else {
-      LOG(ERROR) << "GenericKey size is too large";
-      return nullptr;
+std::vector<char> IndexInfo::EncodeFilterKey(const Row &key) const {
+  size_t max_size = KeyManager::GetMaxKeySize(key_schema_);
+  std::vector<char> buf(max_size);
+  buf.resize(KeyManager(key_schema_, max_size).SerializePrefix(key, buf.data()));
+  return buf;
+}
+
+dberr_t IndexInfo::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
+  dberr_t ret = index_->InsertEntry(key, row_id, txn);
+  if (ret == DB_SUCCESS && key_filter_ != nullptr) {
+    auto buf = EncodeFilterKey(key);
+    key_filter_->Add(buf.data(), buf.size());
+  }
+  return ret;
+}
+
+bool IndexInfo::ContainsKey(const Row &key, Txn *txn) {
+  filter_stats_.probes_++;
+  if (key_filter_ != nullptr) {
+    auto buf = EncodeFilterKey(key);
+    if (!key_filter_->MayContain(buf.data(), buf.size())) {
+      filter_stats_.skipped_++;
+      return false;
     }
-  } else {
-    return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  std::vector<RowId> result;
+  if (index_->ScanKey(key, result, txn) == DB_SUCCESS) {
+    return true;
+  }
+  if (key_filter_ != nullptr) {
+    filter_stats_.false_positives_++;
+  }
+  return false;
 }
@@ -0,0 +1,263 @@
+#include "catalog/statistics.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+#include "catalog/indexes.h"
+#include "index/b_plus_tree_index.h"
+
+/** Numeric value of an int or float field, used to interpolate inside a histogram bucket. */
+static double ToDouble(const Field &field) {
+  char buf[sizeof(int32_t)];
+  field.SerializeTo(buf);
+  if (field.GetTypeId() == TypeId::kTypeInt) {
+    return MACH_READ_INT32(buf);
+  }
+  return MACH_READ_FROM(float, buf);
+}
+
+double ColumnStatistics::EqualSelectivity(const Field &val) const {
+  double non_null = 1 - null_fraction_;
+  if (val.IsNull() || distinct_count_ < 1) {
+    return 0;
+  }
+  if (bounds_.empty()) {
+    return non_null / distinct_count_;
+  }
+  if (val.CompareLessThan(bounds_.front()) == CmpBool::kTrue ||
+      val.CompareGreaterThan(bounds_.back()) == CmpBool::kTrue) {
+    return 0;
+  }
+  double selectivity = non_null / distinct_count_;
+  // 一个值占了多个桶边界, 说明它至少占了这些桶的行数
+  uint32_t repeats = std::count_if(bounds_.begin(), bounds_.end(), [&val](const Field &bound) {
+    return bound.CompareEquals(val) == CmpBool::kTrue;
+  });
+  if (repeats >= 2) {
+    selectivity = std::max(selectivity, non_null * (repeats - 1) / (bounds_.size() - 1));
+  }
+  return std::min(selectivity, non_null);
+}
+
+double ColumnStatistics::LessSelectivity(const Field &val) const {
+  double non_null = 1 - null_fraction_;
+  if (val.IsNull()) {
+    return 0;
+  }
+  if (bounds_.empty()) {
+    return non_null / 3;
+  }
+  if (val.CompareLessThanEquals(bounds_.front()) == CmpBool::kTrue) {
+    return 0;
+  }
+  if (val.CompareGreaterThan(bounds_.back()) == CmpBool::kTrue || bounds_.size() == 1) {
+    return non_null;
+  }
+  // val 落在桶 [bounds_[i], bounds_[i + 1]] 中, 且 bounds_[i] < val
+  size_t buckets = bounds_.size() - 1;
+  size_t i = 0;
+  while (i + 1 < buckets && bounds_[i + 1].CompareLessThan(val) == CmpBool::kTrue) {
+    i++;
+  }
+  double fraction = 0.5;
+  if (val.GetTypeId() != TypeId::kTypeChar) {
+    double low = ToDouble(bounds_[i]);
+    double high = ToDouble(bounds_[i + 1]);
+    fraction = high > low ? std::min(1.0, (ToDouble(val) - low) / (high - low)) : 1.0;
+  }
+  return non_null * (i + fraction) / buckets;
+}
+
+uint32_t TableStatistics::SerializeTo(char *buf) const {
+  char *p = buf;
+  uint32_t ofs = GetSerializedSize();
+  ASSERT(ofs <= PAGE_SIZE, "Failed to serialize table statistics.");
+  MACH_WRITE_UINT32(buf, TABLE_STATISTICS_MAGIC_NUM);
+  buf += 4;
+  MACH_WRITE_TO(double, buf, row_count_);
+  buf += sizeof(double);
+  MACH_WRITE_TO(double, buf, page_count_);
+  buf += sizeof(double);
+  MACH_WRITE_UINT32(buf, columns_.size());
+  buf += 4;
+  for (const auto &column : columns_) {
+    MACH_WRITE_TO(double, buf, column.distinct_count_);
+    buf += sizeof(double);
+    MACH_WRITE_TO(double, buf, column.null_fraction_);
+    buf += sizeof(double);
+    MACH_WRITE_UINT32(buf, column.bounds_.size());
+    buf += 4;
+    for (const auto &bound : column.bounds_) {
+      buf += bound.SerializeTo(buf);
+    }
+  }
+  ASSERT(buf - p == ofs, "Unexpected serialize size.");
+  return ofs;
+}
+
+uint32_t TableStatistics::GetSerializedSize() const {
+  uint32_t size = 4 + 2 * sizeof(double) + 4;
+  for (const auto &column : columns_) {
+    size += 2 * sizeof(double) + 4;
+    for (const auto &bound : column.bounds_) {
+      size += bound.GetSerializedSize();
+    }
+  }
+  return size;
+}
+
+uint32_t TableStatistics::DeserializeFrom(char *buf, const Schema *schema, TableStatistics *&stats) {
+  char *p = buf;
+  uint32_t magic_num = MACH_READ_UINT32(buf);
+  buf += 4;
+  ASSERT(magic_num == TABLE_STATISTICS_MAGIC_NUM, "Failed to deserialize table statistics.");
+  stats = new TableStatistics();
+  stats->row_count_ = MACH_READ_FROM(double, buf);
+  buf += sizeof(double);
+  stats->page_count_ = MACH_READ_FROM(double, buf);
+  buf += sizeof(double);
+  uint32_t column_count = MACH_READ_UINT32(buf);
+  buf += 4;
+  ASSERT(column_count == schema->GetColumnCount(), "Statistics do not match the table schema.");
+  stats->columns_.resize(column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto &column = stats->columns_[i];
+    column.distinct_count_ = MACH_READ_FROM(double, buf);
+    buf += sizeof(double);
+    column.null_fraction_ = MACH_READ_FROM(double, buf);
+    buf += sizeof(double);
+    uint32_t bound_count = MACH_READ_UINT32(buf);
+    buf += 4;
+    for (uint32_t k = 0; k < bound_count; k++) {
+      Field *bound = nullptr;
+      buf += Field::DeserializeFrom(buf, schema->GetColumn(i)->GetType(), &bound, false);
+      column.bounds_.emplace_back(*bound);
+      delete bound;
+    }
+  }
+  return buf - p;
+}
+
+/**
+ * Number of distinct non-null keys of a single-column b+ tree index, adjacent entries of one key value
+ * are compared while walking the leaves.
+ */
+static double CountDistinctKeys(BPlusTreeIndex *index, Txn *txn) {
+  auto scan = index->ScanRange(nullptr, true, nullptr, true, txn);
+  RowId rid;
+  Row key, last;
+  double distinct = 0;
+  bool has_last = false;
+  while (scan->Next(&rid, &key)) {
+    Field *field = key.GetField(0);
+    if (field->IsNull()) {
+      continue;
+    }
+    if (!has_last || field->CompareEquals(*last.GetField(0)) != CmpBool::kTrue) {
+      distinct++;
+      last = key;
+      has_last = true;
+    }
+  }
+  return distinct;
+}
+
+TableStatistics *TableStatistics::Collect(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, Txn *txn) {
+  auto stats = new TableStatistics();
+  auto schema = table_info->GetSchema();
+  auto heap = table_info->GetTableHeap();
+  // 水塘抽样, 固定种子使同一张表的统计信息可以复现
+  std::vector<std::unique_ptr<Row>> sample;
+  std::mt19937_64 rng;
+  std::unordered_set<page_id_t> pages;
+  uint64_t rows = 0;
+  for (auto it = heap->Begin(txn); it != heap->End(); it++) {
+    rows++;
+    pages.insert(it->GetRowId().GetPageId());
+    if (sample.size() < STATS_SAMPLE_ROWS) {
+      sample.emplace_back(new Row(*it));
+    } else {
+      uint64_t slot = std::uniform_int_distribution<uint64_t>(0, rows - 1)(rng);
+      if (slot < STATS_SAMPLE_ROWS) {
+        sample[slot].reset(new Row(*it));
+      }
+    }
+  }
+  stats->row_count_ = rows;
+  stats->page_count_ = std::max<size_t>(pages.size(), 1);
+  stats->columns_.resize(schema->GetColumnCount());
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    auto &column = stats->columns_[i];
+    std::vector<const Field *> values;
+    for (const auto &row : sample) {
+      if (!row->GetField(i)->IsNull()) {
+        values.push_back(row->GetField(i));
+      }
+    }
+    if (sample.empty()) {
+      continue;
+    }
+    column.null_fraction_ = 1 - static_cast<double>(values.size()) / sample.size();
+    std::sort(values.begin(), values.end(),
+              [](const Field *a, const Field *b) { return a->CompareLessThan(*b) == CmpBool::kTrue; });
+    // d: 样本中不同值的个数, f1: 只出现一次的值的个数
+    double d = 0, f1 = 0;
+    for (size_t k = 0; k < values.size();) {
+      size_t run = 1;
+      while (k + run < values.size() && values[k + run]->CompareEquals(*values[k]) == CmpBool::kTrue) {
+        run++;
+      }
+      d++;
+      f1 += (run == 1);
+      k += run;
+    }
+    // Haas-Stokes 的 Duj1 估计, 全表都在样本中时恰好等于 d
+    double n = values.size();
+    double total = rows * (1 - column.null_fraction_);
+    if (n > 0) {
+      column.distinct_count_ = std::min(std::max(n * d / (n - f1 + f1 * n / total), d), total);
+    }
+    size_t buckets = std::min<size_t>(STATS_HISTOGRAM_BUCKETS, values.size());
+    for (size_t b = 0; b < buckets + (buckets > 0); b++) {
+      column.bounds_.emplace_back(*values[b * (values.size() - 1) / std::max<size_t>(buckets, 1)]);
+    }
+  }
+  // 单列索引可以给出准确的不同值个数
+  for (auto index : indexes) {
+    auto key_schema = index->GetIndexKeySchema();
+    if (key_schema->GetColumnCount() != 1) {
+      continue;
+    }
+    auto &column = stats->columns_[key_schema->GetColumn(0)->GetTableInd()];
+    if (index->IsUnique()) {
+      column.distinct_count_ = rows * (1 - column.null_fraction_);
+    } else if (auto bptree = dynamic_cast<BPlusTreeIndex *>(index->GetIndex())) {
+      column.distinct_count_ = CountDistinctKeys(bptree, txn);
+    }
+  }
+  // 统计信息只占一页, 放不下时把每个直方图的桶合并一半
+  while (stats->GetSerializedSize() > PAGE_SIZE) {
+    bool shrunk = false;
+    for (auto &column : stats->columns_) {
+      if (column.bounds_.size() <= 2) {
+        continue;
+      }
+      std::vector<Field> bounds;
+      for (size_t k = 0; k < column.bounds_.size(); k += 2) {
+        bounds.emplace_back(column.bounds_[k]);
+      }
+      if (column.bounds_.size() % 2 == 0) {
+        bounds.emplace_back(column.bounds_.back());
+      }
+      column.bounds_.swap(bounds);
+      shrunk = true;
+    }
+    if (!shrunk) {
+      for (auto &column : stats->columns_) {
+        column.bounds_.clear();
+      }
+    }
+  }
+  return stats;
+}
@@ -20,6 +20,9 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   buf += 4;
   // table schema
   buf += schema_->SerializeTo(buf);
+  // statistics page id
+  MACH_WRITE_TO(page_id_t, buf, stats_page_id_);
+  buf += 4;
   ASSERT(buf - p == ofs, "Unexpected serialize size.");
   return ofs;
 }
@@ -28,7 +31,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
  * TODO: Student Implement
  */
 uint32_t TableMetadata::GetSerializedSize() const {
-  return 4 + 4 + MACH_STR_SERIALIZED_SIZE(table_name_) + 4 + schema_->GetSerializedSize();
+  return 4 + 4 + MACH_STR_SERIALIZED_SIZE(table_name_) + 4 + schema_->GetSerializedSize() + 4;
 }
 
 /**
@@ -43,7 +46,11 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
   // magic num
   uint32_t magic_num = MACH_READ_UINT32(buf);
   buf += 4;
-  ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM, "Failed to deserialize table info.");
+  if (magic_num != TABLE_METADATA_MAGIC_NUM && magic_num != TABLE_METADATA_MAGIC_NUM_V1) {
+    LOG(ERROR) << "Failed to deserialize table info, unknown magic number " << magic_num << "." << std::endl;
+    table_meta = nullptr;
+    return 0;
+  }
   // table id
   table_id_t table_id = MACH_READ_FROM(table_id_t, buf);
   buf += 4;
@@ -58,8 +65,15 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
   // table schema
   TableSchema *schema = nullptr;
   buf += TableSchema::DeserializeFrom(buf, schema);
+  // statistics page id, a table of the old layout has not been analyzed
+  page_id_t stats_page_id = INVALID_PAGE_ID;
+  if (magic_num == TABLE_METADATA_MAGIC_NUM) {
+    stats_page_id = MACH_READ_FROM(page_id_t, buf);
+    buf += 4;
+  }
   // allocate space for table metadata
   table_meta = new TableMetadata(table_id, table_name, root_page_id, schema);
+  table_meta->stats_page_id_ = stats_page_id;
   return buf - p;
 }
 
@@ -0,0 +1,169 @@
+#include "common/result_writer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+#include "record/row.h"
+
+ResultSink::ResultSink(std::ostream &stream, const Schema *schema, ResultFormat format, int fixed_width)
+    : stream_(stream), schema_(schema), format_(format), writer_(stream) {
+  if (fixed_width > 0) {
+    widths_.assign(schema_->GetColumnCount(), fixed_width);
+  }
+  // 表格要等到第一行才输出表头, 空结果只打印 Empty set; 其他格式总是带着表头
+  if (format_ != ResultFormat::kTable) {
+    WriteHeader();
+  }
+}
+
+void ResultSink::WriteHeader() {
+  header_written_ = true;
+  switch (format_) {
+    case ResultFormat::kTable: {
+      if (widths_.empty()) {
+        widths_.assign(schema_->GetColumnCount(), 0);
+        for (const auto &cells : sampled_) {
+          for (size_t i = 0; i < cells.size(); i++) {
+            widths_[i] = std::max(widths_[i], static_cast<int>(cells[i].size()));
+          }
+        }
+        for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+          widths_[i] = std::max(widths_[i], static_cast<int>(schema_->GetColumn(i)->GetName().size()));
+        }
+      }
+      writer_.Divider(widths_);
+      writer_.BeginRow();
+      for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+        writer_.WriteHeaderCell(schema_->GetColumn(i)->GetName(), widths_[i]);
+      }
+      writer_.EndRow();
+      writer_.Divider(widths_);
+      for (const auto &cells : sampled_) {
+        WriteTableRow(cells);
+      }
+      sampled_.clear();
+      break;
+    }
+    case ResultFormat::kCsv:
+    case ResultFormat::kTsv: {
+      std::vector<std::string> names;
+      for (auto column : schema_->GetColumns()) {
+        names.push_back(column->GetName());
+      }
+      WriteDelimitedRow(names, std::vector<bool>(names.size(), false));
+      break;
+    }
+    case ResultFormat::kBinary:
+      buf_.resize(schema_->GetSerializedSize());
+      schema_->SerializeTo(&buf_[0]);
+      stream_.write(buf_.data(), buf_.size());
+      break;
+  }
+}
+
+void ResultSink::WriteTableRow(const std::vector<std::string> &cells) {
+  writer_.BeginRow();
+  for (size_t i = 0; i < cells.size(); i++) {
+    writer_.WriteCell(cells[i], widths_[i]);
+  }
+  writer_.EndRow();
+}
+
+void ResultSink::WriteDelimitedRow(const std::vector<std::string> &cells, const std::vector<bool> &nulls) {
+  for (size_t i = 0; i < cells.size(); i++) {
+    if (i > 0) {
+      stream_ << (format_ == ResultFormat::kCsv ? ',' : '\t');
+    }
+    if (nulls[i]) {
+      if (format_ == ResultFormat::kTsv) {
+        stream_ << "\\N";
+      }
+      continue;
+    }
+    const std::string &cell = cells[i];
+    if (format_ == ResultFormat::kCsv) {
+      if (cell.find_first_of(",\"\r\n") == std::string::npos) {
+        stream_ << cell;
+        continue;
+      }
+      stream_ << '"';
+      for (char c : cell) {
+        if (c == '"') {
+          stream_ << '"';
+        }
+        stream_ << c;
+      }
+      stream_ << '"';
+    } else {
+      for (char c : cell) {
+        switch (c) {
+          case '\t':
+            stream_ << "\\t";
+            break;
+          case '\n':
+            stream_ << "\\n";
+            break;
+          case '\\':
+            stream_ << "\\\\";
+            break;
+          default:
+            stream_ << c;
+        }
+      }
+    }
+  }
+  stream_ << "\n";
+}
+
+void ResultSink::Write(const RowBatch &batch) {
+  uint32_t column_count = schema_->GetColumnCount();
+  if (format_ == ResultFormat::kBinary) {
+    auto schema = const_cast<Schema *>(schema_);
+    Row row;
+    for (auto i : batch.GetSelection()) {
+      batch.GetRow(i, &row);
+      uint32_t size = row.GetSerializedSize(schema);
+      buf_.resize(sizeof(uint32_t) + size);
+      MACH_WRITE_UINT32(&buf_[0], size);
+      row.SerializeTo(&buf_[sizeof(uint32_t)], schema);
+      stream_.write(buf_.data(), buf_.size());
+    }
+  } else {
+    std::vector<std::string> cells(column_count);
+    std::vector<bool> nulls(column_count);
+    for (auto i : batch.GetSelection()) {
+      for (uint32_t c = 0; c < column_count; c++) {
+        cells[c] = batch.GetColumn(c).GetField(i).toString();
+        nulls[c] = batch.GetColumn(c).IsNull(i);
+      }
+      if (format_ != ResultFormat::kTable) {
+        WriteDelimitedRow(cells, nulls);
+      } else if (header_written_) {
+        WriteTableRow(cells);
+      } else {
+        sampled_.push_back(cells);
+        if (!widths_.empty() || sampled_.size() >= static_cast<size_t>(RESULT_SAMPLE_ROWS)) {
+          WriteHeader();
+        }
+      }
+    }
+  }
+  row_count_ += batch.GetSelection().size();
+  // 每批写完就交给下游, 第一行不必等整个查询结束
+  stream_.flush();
+}
+
+void ResultSink::Finish() {
+  if (format_ == ResultFormat::kTable) {
+    if (!header_written_ && !sampled_.empty()) {
+      WriteHeader();
+    }
+    if (header_written_) {
+      writer_.Divider(widths_);
+    }
+  } else if (format_ == ResultFormat::kBinary) {
+    buf_.assign(sizeof(uint32_t), 0);
+    stream_.write(buf_.data(), buf_.size());
+  }
+  stream_.flush();
+}
@@ -0,0 +1,214 @@
+#include "common/rowid_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/macros.h"
+
+void RowIdBitmap::Add(const RowId &rid) { pages_[rid.GetPageId()].Add(rid.GetSlotNum()); }
+
+bool RowIdBitmap::Contains(const RowId &rid) const {
+  auto iter = pages_.find(rid.GetPageId());
+  return iter != pages_.end() && iter->second.Contains(rid.GetSlotNum());
+}
+
+size_t RowIdBitmap::Cardinality() const {
+  size_t count = 0;
+  for (const auto &page : pages_) {
+    count += page.second.Cardinality();
+  }
+  return count;
+}
+
+RowIdBitmap &RowIdBitmap::IntersectWith(const RowIdBitmap &other) {
+  for (auto iter = pages_.begin(); iter != pages_.end();) {
+    auto other_iter = other.pages_.find(iter->first);
+    if (other_iter == other.pages_.end()) {
+      iter = pages_.erase(iter);
+      continue;
+    }
+    iter->second = Container::And(iter->second, other_iter->second);
+    if (iter->second.Cardinality() == 0) {
+      iter = pages_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return *this;
+}
+
+RowIdBitmap &RowIdBitmap::UnionWith(const RowIdBitmap &other) {
+  for (const auto &page : other.pages_) {
+    auto iter = pages_.find(page.first);
+    if (iter == pages_.end()) {
+      pages_.emplace(page.first, page.second);
+    } else {
+      iter->second = Container::Or(iter->second, page.second);
+    }
+  }
+  return *this;
+}
+
+std::vector<RowId> RowIdBitmap::ToVector() const {
+  std::vector<RowId> result;
+  result.reserve(Cardinality());
+  for (const auto &page : pages_) {
+    page.second.AppendTo(page.first, result);
+  }
+  return result;
+}
+
+void RowIdBitmap::Container::Add(uint32_t slot) {
+  ASSERT(slot <= UINT16_MAX, "Slot number out of range.");
+  if (is_bitset_) {
+    size_t word = slot / 64;
+    if (word >= bits_.size()) {
+      bits_.resize(word + 1, 0);
+    }
+    uint64_t mask = 1ULL << (slot % 64);
+    if ((bits_[word] & mask) == 0) {
+      bits_[word] |= mask;
+      cardinality_++;
+    }
+    return;
+  }
+  auto pos = std::lower_bound(array_.begin(), array_.end(), slot);
+  if (pos != array_.end() && *pos == slot) {
+    return;
+  }
+  array_.insert(pos, static_cast<uint16_t>(slot));
+  cardinality_++;
+  Optimize();
+}
+
+bool RowIdBitmap::Container::Contains(uint32_t slot) const {
+  if (is_bitset_) {
+    size_t word = slot / 64;
+    return word < bits_.size() && (bits_[word] & (1ULL << (slot % 64))) != 0;
+  }
+  return std::binary_search(array_.begin(), array_.end(), slot);
+}
+
+void RowIdBitmap::Container::AppendTo(page_id_t page_id, std::vector<RowId> &result) const {
+  if (!is_bitset_) {
+    for (auto slot : array_) {
+      result.emplace_back(page_id, slot);
+    }
+    return;
+  }
+  for (size_t word = 0; word < bits_.size(); word++) {
+    uint64_t bits = bits_[word];
+    while (bits != 0) {
+      uint32_t bit = __builtin_ctzll(bits);
+      result.emplace_back(page_id, static_cast<uint32_t>(word * 64 + bit));
+      bits &= bits - 1;
+    }
+  }
+}
+
+RowIdBitmap::Container RowIdBitmap::Container::And(const Container &lhs, const Container &rhs) {
+  Container result;
+  if (lhs.is_bitset_ && rhs.is_bitset_) {
+    result.is_bitset_ = true;
+    result.bits_.resize(std::min(lhs.bits_.size(), rhs.bits_.size()));
+    for (size_t i = 0; i < result.bits_.size(); i++) {
+      result.bits_[i] = lhs.bits_[i] & rhs.bits_[i];
+      result.cardinality_ += __builtin_popcountll(result.bits_[i]);
+    }
+  } else if (!lhs.is_bitset_ && !rhs.is_bitset_) {
+    std::set_intersection(lhs.array_.begin(), lhs.array_.end(), rhs.array_.begin(), rhs.array_.end(),
+                          std::back_inserter(result.array_));
+    result.cardinality_ = result.array_.size();
+  } else {
+    // 交集不会比数组那一侧更大, 直接按数组过滤
+    const Container &array = lhs.is_bitset_ ? rhs : lhs;
+    const Container &bitset = lhs.is_bitset_ ? lhs : rhs;
+    for (auto slot : array.array_) {
+      if (bitset.Contains(slot)) {
+        result.array_.push_back(slot);
+      }
+    }
+    result.cardinality_ = result.array_.size();
+  }
+  result.Optimize();
+  return result;
+}
+
+RowIdBitmap::Container RowIdBitmap::Container::Or(const Container &lhs, const Container &rhs) {
+  Container result;
+  if (!lhs.is_bitset_ && !rhs.is_bitset_) {
+    std::set_union(lhs.array_.begin(), lhs.array_.end(), rhs.array_.begin(), rhs.array_.end(),
+                   std::back_inserter(result.array_));
+    result.cardinality_ = result.array_.size();
+  } else {
+    // 至少一侧是 bitset, 结果也按 bitset 合并
+    result = lhs.is_bitset_ ? lhs : rhs;
+    const Container &other = lhs.is_bitset_ ? rhs : lhs;
+    if (other.is_bitset_) {
+      if (other.bits_.size() > result.bits_.size()) {
+        result.bits_.resize(other.bits_.size(), 0);
+      }
+      result.cardinality_ = 0;
+      for (size_t i = 0; i < result.bits_.size(); i++) {
+        if (i < other.bits_.size()) {
+          result.bits_[i] |= other.bits_[i];
+        }
+        result.cardinality_ += __builtin_popcountll(result.bits_[i]);
+      }
+    } else {
+      for (auto slot : other.array_) {
+        result.Add(slot);
+      }
+    }
+  }
+  result.Optimize();
+  return result;
+}
+
+void RowIdBitmap::Container::Optimize() {
+  if (cardinality_ == 0) {
+    return;
+  }
+  // 数组每个 slot 占 2 字节, bitset 按最大 slot 占 max/8 字节
+  uint32_t max_slot = is_bitset_ ? 0 : array_.back();
+  if (is_bitset_) {
+    for (size_t word = bits_.size(); word > 0; word--) {
+      if (bits_[word - 1] != 0) {
+        max_slot = static_cast<uint32_t>((word - 1) * 64 + 63 - __builtin_clzll(bits_[word - 1]));
+        break;
+      }
+    }
+  }
+  size_t bitset_bytes = (max_slot / 64 + 1) * sizeof(uint64_t);
+  size_t array_bytes = cardinality_ * sizeof(uint16_t);
+  if (!is_bitset_ && array_bytes > bitset_bytes) {
+    ToBitset();
+  } else if (is_bitset_ && array_bytes < bitset_bytes) {
+    ToArray();
+  }
+}
+
+void RowIdBitmap::Container::ToBitset() {
+  bits_.assign(array_.back() / 64 + 1, 0);
+  for (auto slot : array_) {
+    bits_[slot / 64] |= 1ULL << (slot % 64);
+  }
+  array_.clear();
+  array_.shrink_to_fit();
+  is_bitset_ = true;
+}
+
+void RowIdBitmap::Container::ToArray() {
+  array_.clear();
+  array_.reserve(cardinality_);
+  for (size_t word = 0; word < bits_.size(); word++) {
+    uint64_t bits = bits_[word];
+    while (bits != 0) {
+      array_.push_back(static_cast<uint16_t>(word * 64 + __builtin_ctzll(bits)));
+      bits &= bits - 1;
+    }
+  }
+  bits_.clear();
+  bits_.shrink_to_fit();
+  is_bitset_ = false;
+}
@@ -0,0 +1,222 @@
+#include "executor/executors/aggregation_executor.h"
+
+#include <functional>
+#include <stdexcept>
+
+#include "index/generic_key.h"
+
+AggregationExecutor::AggregationExecutor(ExecuteContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void AggregationExecutor::MakeKey(const Row &row, std::string *key) const {
+  key->clear();
+  // 用索引键的编码, null 自成一组
+  for (const auto &expr : plan_->GetGroupBys()) {
+    KeyManager::AppendField(expr->Evaluate(&row), key);
+  }
+}
+
+AggregationExecutor::Group *AggregationExecutor::FindGroup(const std::string &key, size_t hash, const Row &row,
+                                                           bool insert) {
+  size_t mask = slots_.size() - 1;
+  size_t slot = hash & mask;
+  while (slots_[slot] != 0) {
+    Group &group = groups_[slots_[slot] - 1];
+    if (group.hash_ == hash && group.key_ == key) {
+      return &group;
+    }
+    slot = (slot + 1) & mask;
+  }
+  if (!insert) {
+    return nullptr;
+  }
+  groups_.emplace_back();
+  Group &group = groups_.back();
+  group.key_ = key;
+  group.hash_ = hash;
+  for (const auto &expr : plan_->GetGroupBys()) {
+    group.values_.GetFields().push_back(new Field(expr->Evaluate(&row)));
+  }
+  group.aggregates_.resize(plan_->GetAggregates().size());
+  group_bytes_ += sizeof(Group) + key.size() * 2 + group.aggregates_.size() * sizeof(AggregateValue);
+  slots_[slot] = groups_.size();
+  if (groups_.size() * 2 > slots_.size()) {
+    Grow();
+  }
+  return &group;
+}
+
+void AggregationExecutor::Grow() {
+  slots_.assign(slots_.size() * 2, 0);
+  size_t mask = slots_.size() - 1;
+  for (size_t i = 0; i < groups_.size(); i++) {
+    size_t slot = groups_[i].hash_ & mask;
+    while (slots_[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = i + 1;
+  }
+  group_bytes_ += slots_.size() / 2 * sizeof(uint32_t);
+}
+
+void AggregationExecutor::Clear() {
+  slots_.assign(64, 0);
+  groups_.clear();
+  group_bytes_ = slots_.size() * sizeof(uint32_t);
+  cursor_ = 0;
+}
+
+void AggregationExecutor::Accumulate(Group *group, const Row &row) const {
+  const auto &aggregates = plan_->GetAggregates();
+  const auto &types = plan_->GetAggregateTypes();
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    auto &value = group->aggregates_[i];
+    if (types[i] == AggregationType::CountStarAggregate) {
+      value.count_++;
+      continue;
+    }
+    Field field = aggregates[i]->Evaluate(&row);
+    if (field.IsNull()) {
+      continue;
+    }
+    value.is_null_ = false;
+    value.count_++;
+    switch (types[i]) {
+      case AggregationType::SumAggregate:
+      case AggregationType::AvgAggregate: {
+        char buf[sizeof(int32_t)];
+        field.SerializeTo(buf);
+        if (field.GetTypeId() == TypeId::kTypeInt) {
+          value.int_ += MACH_READ_INT32(buf);
+        } else {
+          value.float_ += MACH_READ_FROM(float, buf);
+        }
+        break;
+      }
+      case AggregationType::MinAggregate:
+        if (value.extreme_ == nullptr || field.CompareLessThan(*value.extreme_) == CmpBool::kTrue) {
+          value.extreme_.reset(new Field(field));
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (value.extreme_ == nullptr || field.CompareGreaterThan(*value.extreme_) == CmpBool::kTrue) {
+          value.extreme_.reset(new Field(field));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+Field AggregationExecutor::GetAggregate(const Group &group, size_t i) const {
+  const auto &value = group.aggregates_[i];
+  auto type = plan_->GetAggregateTypes()[i];
+  if (type == AggregationType::CountStarAggregate || type == AggregationType::CountAggregate) {
+    return Field(TypeId::kTypeInt, static_cast<int32_t>(value.count_));
+  }
+  auto arg_type = plan_->GetAggregates()[i]->GetReturnType();
+  if (value.is_null_) {
+    return Field(AggregationPlanNode::GetResultType(type, arg_type));
+  }
+  switch (type) {
+    case AggregationType::SumAggregate:
+      if (arg_type == TypeId::kTypeFloat) {
+        return Field(TypeId::kTypeFloat, static_cast<float>(value.float_));
+      }
+      if (value.int_ > INT32_MAX || value.int_ < INT32_MIN) {
+        throw std::logic_error("integer out of range in sum");
+      }
+      return Field(TypeId::kTypeInt, static_cast<int32_t>(value.int_));
+    case AggregationType::AvgAggregate: {
+      double sum = arg_type == TypeId::kTypeInt ? value.int_ : value.float_;
+      return Field(TypeId::kTypeFloat, static_cast<float>(sum / value.count_));
+    }
+    default:
+      return Field(*value.extreme_);
+  }
+}
+
+void AggregationExecutor::Init() {
+  child_executor_->Init();
+  Clear();
+  spilled_ = false;
+  partitions_.clear();
+  partition_ = 0;
+  auto child_schema = child_executor_->GetOutputSchema();
+  std::hash<std::string> hasher;
+  RowBatch batch;
+  Row row;
+  std::string key;
+  while (child_executor_->NextBatch(&batch)) {
+    for (auto i : batch.GetSelection()) {
+      batch.GetRow(i, &row);
+      MakeKey(row, &key);
+      size_t hash = hasher(key);
+      // 超出预算后不再加入新的组, 已有组的行照常聚合, 其余的行按哈希值写入分区
+      Group *group = FindGroup(key, hash, row, !spilled_);
+      if (group == nullptr) {
+        partitions_[PartitionOf(hash)]->Append(row);
+        continue;
+      }
+      Accumulate(group, row);
+      if (!spilled_ && group_bytes_ > plan_->memory_budget_) {
+        spilled_ = true;
+        for (int k = 0; k < HASH_AGG_PARTITIONS; k++) {
+          partitions_.emplace_back(new TempRowFile(exec_ctx_->GetBufferPoolManager(), child_schema));
+        }
+      }
+    }
+  }
+  if (plan_->GetGroupBys().empty() && groups_.empty()) {
+    // 没有 GROUP BY 时空输入也是一组, 例如 COUNT(*) 为 0
+    FindGroup(key, hasher(key), row, true);
+  }
+  for (auto &partition : partitions_) {
+    partition->Rewind();
+  }
+}
+
+bool AggregationExecutor::LoadPartition() {
+  std::hash<std::string> hasher;
+  Row row;
+  std::string key;
+  while (partition_ < partitions_.size()) {
+    auto file = std::move(partitions_[partition_++]);
+    if (file->GetRowCount() == 0) {
+      continue;
+    }
+    // 分区中的组不会再溢出, 整个分区在内存中聚合
+    Clear();
+    while (file->Next(&row)) {
+      MakeKey(row, &key);
+      Accumulate(FindGroup(key, hasher(key), row, true), row);
+    }
+    return true;
+  }
+  Clear();
+  return false;
+}
+
+bool AggregationExecutor::Next(Row *row, RowId *rid) {
+  while (cursor_ >= groups_.size()) {
+    if (!LoadPartition()) {
+      return false;
+    }
+  }
+  const Group &group = groups_[cursor_++];
+  size_t group_count = plan_->GetGroupBys().size();
+  std::vector<Field> fields;
+  for (auto column : GetOutputSchema()->GetColumns()) {
+    uint32_t i = column->GetTableInd();
+    if (i < group_count) {
+      fields.emplace_back(*group.values_.GetField(i));
+    } else {
+      fields.emplace_back(GetAggregate(group, i - group_count));
+    }
+  }
+  *row = Row(fields);
+  *rid = RowId();
+  return true;
+}
@@ -13,19 +13,68 @@ void DeleteExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
   txn_ = exec_ctx_->GetTransaction();
+  pending_removes_.assign(index_info_.size(), {});
+  done_ = false;
 }
 
 bool DeleteExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-  if (child_executor_->Next(row, rid)) {
-    if (!table_info_->GetTableHeap()->MarkDelete(*rid, txn_)) {
+  if (!done_ && child_executor_->Next(row, rid)) {
+    if (!DeleteRow(*row, *rid)) {
+      done_ = true;
+      FlushIndexes();
       return false;
     }
-    Row key_row;
-    for (auto info : index_info_) {  // 更新索引
-      row->GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-      info->GetIndex()->RemoveEntry(key_row, *rid, txn_);
-    }
     return true;
   }
+  FlushIndexes();
+  return false;
+}
+
+bool DeleteExecutor::NextBatch(RowBatch *batch) {
+  while (!done_ && child_executor_->NextBatch(batch)) {
+    auto &selection = batch->GetSelection();
+    std::vector<Field> key_fields;
+    for (size_t k = 0; k < selection.size(); k++) {
+      RowId rid = batch->GetRowId(selection[k]);
+      if (!table_info_->GetTableHeap()->MarkDelete(rid, txn_)) {
+        done_ = true;
+        selection.resize(k);
+        break;
+      }
+      for (size_t i = 0; i < index_info_.size(); i++) {
+        key_fields.clear();
+        for (auto column : index_info_[i]->GetIndexKeySchema()->GetColumns()) {
+          key_fields.emplace_back(batch->GetColumn(column->GetTableInd()).GetField(selection[k]));
+        }
+        pending_removes_[i].emplace_back(Row(key_fields), rid);
+      }
+    }
+    if (!selection.empty()) {
+      return true;
+    }
+  }
+  FlushIndexes();
   return false;
+}
+
+bool DeleteExecutor::DeleteRow(Row &row, const RowId &rid) {
+  if (!table_info_->GetTableHeap()->MarkDelete(rid, txn_)) {
+    return false;
+  }
+  // 索引项先攒起来, 语句结束时按 key 排序一次删完
+  Row key_row;
+  for (size_t i = 0; i < index_info_.size(); i++) {
+    row.GetKeyFromRow(table_info_->GetSchema(), index_info_[i]->GetIndexKeySchema(), key_row);
+    pending_removes_[i].emplace_back(key_row, rid);
+  }
+  return true;
+}
+
+void DeleteExecutor::FlushIndexes() {
+  for (size_t i = 0; i < index_info_.size(); i++) {
+    if (!pending_removes_[i].empty()) {
+      index_info_[i]->GetIndex()->RemoveEntries(pending_removes_[i], txn_);
+      pending_removes_[i].clear();
+    }
+  }
 }
\ No newline at end of file
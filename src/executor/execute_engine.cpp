@@ -4,13 +4,24 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <chrono>
 
 #include "common/result_writer.h"
+#include "executor/executors/aggregation_executor.h"
 #include "executor/executors/delete_executor.h"
+#include "executor/executors/hash_distinct_executor.h"
+#include "executor/executors/hash_join_executor.h"
+#include "executor/executors/index_nested_loop_join_executor.h"
+#include "executor/executors/index_only_scan_executor.h"
 #include "executor/executors/index_scan_executor.h"
 #include "executor/executors/insert_executor.h"
+#include "executor/executors/limit_executor.h"
+#include "executor/executors/nested_loop_join_executor.h"
 #include "executor/executors/seq_scan_executor.h"
+#include "executor/executors/sort_distinct_executor.h"
+#include "executor/executors/sort_executor.h"
+#include "executor/executors/top_n_executor.h"
 #include "executor/executors/update_executor.h"
 #include "executor/executors/values_executor.h"
 #include "glog/logging.h"
@@ -50,6 +61,11 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
     case PlanType::IndexScan: {
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
     }
+    // Create a new index-only scan executor
+    case PlanType::IndexOnlyScan: {
+      return std::make_unique<IndexOnlyScanExecutor>(exec_ctx,
+                                                     dynamic_cast<const IndexOnlyScanPlanNode *>(plan.get()));
+    }
     // Create a new update executor
     case PlanType::Update: {
       auto update_plan = dynamic_cast<const UpdatePlanNode *>(plan.get());
@@ -70,6 +86,53 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
     case PlanType::Values: {
       return std::make_unique<ValuesExecutor>(exec_ctx, dynamic_cast<const ValuesPlanNode *>(plan.get()));
     }
+    case PlanType::NestedLoopJoin: {
+      auto join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan.get());
+      auto left_executor = CreateExecutor(exec_ctx, join_plan->GetLeftPlan());
+      auto right_executor = CreateExecutor(exec_ctx, join_plan->GetRightPlan());
+      return std::make_unique<NestedLoopJoinExecutor>(exec_ctx, join_plan, std::move(left_executor),
+                                                      std::move(right_executor));
+    }
+    case PlanType::HashJoin: {
+      auto join_plan = dynamic_cast<const HashJoinPlanNode *>(plan.get());
+      auto left_executor = CreateExecutor(exec_ctx, join_plan->GetLeftPlan());
+      auto right_executor = CreateExecutor(exec_ctx, join_plan->GetRightPlan());
+      return std::make_unique<HashJoinExecutor>(exec_ctx, join_plan, std::move(left_executor),
+                                                std::move(right_executor));
+    }
+    case PlanType::IndexNestedLoopJoin: {
+      auto join_plan = dynamic_cast<const IndexNestedLoopJoinPlanNode *>(plan.get());
+      auto outer_executor = CreateExecutor(exec_ctx, join_plan->GetOuterPlan());
+      return std::make_unique<IndexNestedLoopJoinExecutor>(exec_ctx, join_plan, std::move(outer_executor));
+    }
+    case PlanType::Aggregation: {
+      auto aggregation_plan = dynamic_cast<const AggregationPlanNode *>(plan.get());
+      auto child_executor = CreateExecutor(exec_ctx, aggregation_plan->GetChildPlan());
+      return std::make_unique<AggregationExecutor>(exec_ctx, aggregation_plan, std::move(child_executor));
+    }
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan.get());
+      auto child_executor = CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+    case PlanType::Limit: {
+      auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan.get());
+      auto child_executor = CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
+      return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
+    }
+    case PlanType::TopN: {
+      auto top_n_plan = dynamic_cast<const TopNPlanNode *>(plan.get());
+      auto child_executor = CreateExecutor(exec_ctx, top_n_plan->GetChildPlan());
+      return std::make_unique<TopNExecutor>(exec_ctx, top_n_plan, std::move(child_executor));
+    }
+    case PlanType::Distinct: {
+      auto distinct_plan = dynamic_cast<const DistinctPlanNode *>(plan.get());
+      auto child_executor = CreateExecutor(exec_ctx, distinct_plan->GetChildPlan());
+      if (distinct_plan->IsInputOrdered()) {
+        return std::make_unique<SortDistinctExecutor>(exec_ctx, distinct_plan, std::move(child_executor));
+      }
+      return std::make_unique<HashDistinctExecutor>(exec_ctx, distinct_plan, std::move(child_executor));
+    }
     default:
       throw std::logic_error("Unsupported plan type.");
   }
@@ -77,23 +140,39 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
 
 dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<Row> *result_set, Txn *txn,
                                    ExecuteContext *exec_ctx) {
+  auto result = ExecutePlan(
+      plan,
+      [result_set](const RowBatch &batch) {
+        if (result_set != nullptr) {
+          for (auto i : batch.GetSelection()) {
+            result_set->emplace_back();
+            batch.GetRow(i, &result_set->back());
+          }
+        }
+      },
+      txn, exec_ctx);
+  if (result != DB_SUCCESS && result_set != nullptr) {
+    result_set->clear();
+  }
+  return result;
+}
+
+dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan,
+                                   const std::function<void(const RowBatch &)> &consumer, Txn *txn,
+                                   ExecuteContext *exec_ctx) {
   // Construct the executor for the abstract plan node
   auto executor = CreateExecutor(exec_ctx, plan);
 
   try {
     executor->Init();
-    RowId rid{};
-    Row row{};
-    while (executor->Next(&row, &rid)) {
-      if (result_set != nullptr) {
-        result_set->push_back(row);
-      }
+    RowBatch batch;
+    while (executor->NextBatch(&batch)) {
+      consumer(batch);
     }
   } catch (const exception &ex) {
-    std::cout << "Error Encountered in Executor Execution: " << ex.what() << std::endl;
-    if (result_set != nullptr) {
-      result_set->clear();
-    }
+    // 表格之外的格式下 stdout 是结果数据, 错误不能混进去
+    (result_format_ == ResultFormat::kTable ? std::cout : std::cerr)
+        << "Error Encountered in Executor Execution: " << ex.what() << std::endl;
     return DB_FAILED;
   }
   return DB_SUCCESS;
@@ -137,68 +216,49 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteExecfile(ast, context.get());
     case kNodeQuit:
       return ExecuteQuit(ast, context.get());
+    case kNodeAnalyze:
+      return ExecuteAnalyze(ast, context.get());
     default:
       break;
   }
   // Plan the query.
   Planner planner(context.get());
-  std::vector<Row> result_set{};
+  std::unique_ptr<ResultSink> sink;
+  size_t row_count = 0;
+  dberr_t result;
   try {
     planner.PlanQuery(ast);
-    // Execute the query.
-    ExecutePlan(planner.plan_, &result_set, nullptr, context.get());
+    // Execute the query, the rows of a select are written out batch by batch.
+    if (ast->type_ == kNodeSelect) {
+      sink = std::make_unique<ResultSink>(std::cout, planner.plan_->OutputSchema(), result_format_, fixed_width_);
+    }
+    result = ExecutePlan(
+        planner.plan_,
+        [&](const RowBatch &batch) {
+          if (sink != nullptr) {
+            sink->Write(batch);
+          }
+          row_count += batch.GetSelection().size();
+        },
+        nullptr, context.get());
   } catch (const exception &ex) {
-    std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
+    (result_format_ == ResultFormat::kTable ? std::cout : std::cerr)
+        << "Error Encountered in Planner: " << ex.what() << std::endl;
     return DB_FAILED;
   }
+  // 执行到一半失败时已经写出的行不完整, 不写结尾, 读结果的程序不会把它当成完整的结果
+  if (result != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  if (sink != nullptr) {
+    sink->Finish();
+  }
   auto stop_time = std::chrono::system_clock::now();
   double duration_time =
       double((std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time)).count());
-  // Return the result set as string.
-  std::stringstream ss;
-  ResultWriter writer(ss);
-
-  if (planner.plan_->GetType() == PlanType::SeqScan || planner.plan_->GetType() == PlanType::IndexScan) {
-    auto schema = planner.plan_->OutputSchema();
-    auto num_of_columns = schema->GetColumnCount();
-    if (!result_set.empty()) {
-      // find the max width for each column
-      vector<int> data_width(num_of_columns, 0);
-      for (const auto &row : result_set) {
-        for (uint32_t i = 0; i < num_of_columns; i++) {
-          data_width[i] = max(data_width[i], int(row.GetField(i)->toString().size()));
-        }
-      }
-      int k = 0;
-      for (const auto &column : schema->GetColumns()) {
-        data_width[k] = max(data_width[k], int(column->GetName().length()));
-        k++;
-      }
-      // Generate header for the result set.
-      writer.Divider(data_width);
-      k = 0;
-      writer.BeginRow();
-      for (const auto &column : schema->GetColumns()) {
-        writer.WriteHeaderCell(column->GetName(), data_width[k++]);
-      }
-      writer.EndRow();
-      writer.Divider(data_width);
-
-      // Transforming result set into strings.
-      for (const auto &row : result_set) {
-        writer.BeginRow();
-        for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
-          writer.WriteCell(row.GetField(i)->toString(), data_width[i]);
-        }
-        writer.EndRow();
-      }
-      writer.Divider(data_width);
-    }
-    writer.EndInformation(result_set.size(), duration_time, true);
-  } else {
-    writer.EndInformation(result_set.size(), duration_time, false);
-  }
-  std::cout << writer.stream_.rdbuf();
+  // 表格之外的格式多半要交给别的程序读, 统计信息写到 stderr
+  ResultWriter writer(sink == nullptr || result_format_ == ResultFormat::kTable ? std::cout : std::cerr);
+  writer.EndInformation(row_count, duration_time, sink != nullptr);
   return DB_SUCCESS;
 }
 
@@ -402,7 +462,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     for(auto s : unique_keys){
       IndexInfo *index_info;
       catalog->CreateIndex(table_name, "UNIQUE_"+s + "_"+"ON_" + table_name, 
-        unique_keys, context->GetTransaction(), index_info, "btree");
+        {s}, context->GetTransaction(), index_info, "bptree", true);
     }
   }
   if(primary_keys.size()){
@@ -410,7 +470,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     string s="";
     for(auto t : primary_keys) s+=t+"_";
     catalog->CreateIndex(table_name, "PK_"+s + "_"+"ON_" + table_name, 
-        primary_keys, context->GetTransaction(), index_info, "btree");//用primary key建index
+        primary_keys, context->GetTransaction(), index_info, "bptree", true);//用primary key建index
   }
   return DB_SUCCESS;
 }
@@ -485,15 +545,23 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
   string index_name=node->val_;
   node=node->next_;
   string table_name=node->val_;
-  node=node->next_->child_;//到columnlist
+  pSyntaxNode key_list=node->next_;
+  node=key_list->child_;//到columnlist
   vector<string>index_keys;
   while(node!= nullptr){
     index_keys.push_back(string(node->val_));
     node=node->next_;
     }
+  //USING 子句指定索引类型, 默认 b+ 树
+  string index_type="bptree";
+  if(key_list->next_!=nullptr && key_list->next_->type_==kNodeIndexType){
+    index_type=key_list->next_->child_->val_;
+    std::transform(index_type.begin(),index_type.end(),index_type.begin(),::tolower);
+    if(index_type=="btree") index_type="bptree";
+  }
   IndexInfo* index_info;
   TableInfo* table_info;
-  auto ret=catalog->CreateIndex(table_name,index_name,index_keys,context->GetTransaction(),index_info,"btree");
+  auto ret=catalog->CreateIndex(table_name,index_name,index_keys,context->GetTransaction(),index_info,index_type);
   if(ret!=DB_SUCCESS)return ret;
   //遍历堆表
   catalog->GetTable(table_name,table_info);//获取
@@ -504,7 +572,11 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     row=*it;
     //提取出row里面作为key的部分
     row.GetKeyFromRow(table_info->GetSchema(),index_info->GetIndexKeySchema(),key_row);
-    index_info->GetIndex()->InsertEntry(key_row,row.GetRowId(),context->GetTransaction());
+    if(index_info->GetIndex()->InsertEntry(key_row,row.GetRowId(),context->GetTransaction())!=DB_SUCCESS){
+      //建到一半失败, 不能留下缺行的索引
+      catalog->DropIndex(table_name,index_name);
+      return DB_FAILED;
+    }
     it++;
   }
   return DB_SUCCESS;
@@ -528,6 +600,56 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
   return res;
 }
 
+/**
+ * Collect the statistics of a table for the planner's cost model and print a summary of them.
+ */
+dberr_t ExecuteEngine::ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteAnalyze" << std::endl;
+#endif
+  if (current_db_.empty()) return DB_NOT_EXIST;
+  CatalogManager *catalog = context->GetCatalog();
+  string table_name = ast->child_->val_;
+  TableInfo *table_info = nullptr;
+  if (catalog->GetTable(table_name, table_info) != DB_SUCCESS) return DB_TABLE_NOT_EXIST;
+  vector<IndexInfo *> indexes;
+  catalog->GetTableIndexes(table_name, indexes);
+  auto statistics = TableStatistics::Collect(table_info, indexes, context->GetTransaction());
+  dberr_t res = catalog->UpdateTableStatistics(table_name, statistics);
+  if (res != DB_SUCCESS) return res;
+
+  auto schema = table_info->GetSchema();
+  std::stringstream ss;
+  ResultWriter writer(ss);
+  vector<int> width{6, 8, 13};
+  for (auto column : schema->GetColumns()) {
+    width[0] = max(width[0], (int)column->GetName().length());
+  }
+  writer.Divider(width);
+  writer.BeginRow();
+  writer.WriteHeaderCell("Column", width[0]);
+  writer.WriteHeaderCell("Distinct", width[1]);
+  writer.WriteHeaderCell("Null Fraction", width[2]);
+  writer.EndRow();
+  writer.Divider(width);
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const auto &column = statistics->GetColumn(i);
+    std::stringstream null_fraction;
+    null_fraction.precision(3);
+    null_fraction << column.GetNullFraction();
+    writer.BeginRow();
+    writer.WriteCell(schema->GetColumn(i)->GetName(), width[0]);
+    writer.WriteCell(std::to_string((uint64_t)column.GetDistinctCount()), width[1]);
+    writer.WriteCell(null_fraction.str(), width[2]);
+    writer.EndRow();
+  }
+  writer.Divider(width);
+  std::cout << writer.stream_.rdbuf();
+  std::cout << "Table " << table_name << ": " << (uint64_t)statistics->GetRowCount() << " rows in "
+            << (uint64_t)statistics->GetPageCount() << " pages." << std::endl;
+  return DB_SUCCESS;
+}
+
 dberr_t ExecuteEngine::ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteTrxBegin" << std::endl;
@@ -0,0 +1,79 @@
+#include "executor/executors/hash_distinct_executor.h"
+
+#include <functional>
+
+#include "index/generic_key.h"
+
+HashDistinctExecutor::HashDistinctExecutor(ExecuteContext *exec_ctx, const DistinctPlanNode *plan,
+                                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void HashDistinctExecutor::Init() {
+  child_executor_->Init();
+  seen_.clear();
+  seen_bytes_ = 0;
+  batch_.Reset(nullptr);
+  batch_pos_ = 0;
+  child_done_ = false;
+  spilled_ = false;
+  partitions_.clear();
+  partition_ = 0;
+}
+
+bool HashDistinctExecutor::NextInput(Row *row) {
+  if (!child_done_) {
+    while (batch_pos_ >= batch_.GetSelection().size()) {
+      if (!child_executor_->NextBatch(&batch_)) {
+        child_done_ = true;
+        break;
+      }
+      batch_pos_ = 0;
+    }
+    if (!child_done_) {
+      batch_.GetRow(batch_.GetSelection()[batch_pos_++], row);
+      return true;
+    }
+    // 分区中的键都还没有输出过, 每个分区单独去重
+    seen_.clear();
+    for (auto &partition : partitions_) {
+      partition->Rewind();
+    }
+  }
+  while (partition_ < partitions_.size()) {
+    if (partitions_[partition_]->Next(row)) {
+      return true;
+    }
+    partitions_[partition_++].reset();
+    seen_.clear();
+  }
+  return false;
+}
+
+bool HashDistinctExecutor::Next(Row *row, RowId *rid) {
+  std::hash<std::string> hasher;
+  std::string key;
+  while (NextInput(row)) {
+    key.clear();
+    for (auto field : row->GetFields()) {
+      KeyManager::AppendField(*field, &key);
+    }
+    if (seen_.count(key) != 0) {
+      continue;
+    }
+    if (spilled_ && !child_done_) {
+      partitions_[PartitionOf(hasher(key))]->Append(*row);
+      continue;
+    }
+    seen_bytes_ += key.size() + sizeof(std::string) + 2 * sizeof(void *);
+    seen_.insert(std::move(key));
+    if (!spilled_ && seen_bytes_ > plan_->memory_budget_) {
+      spilled_ = true;
+      for (int i = 0; i < DISTINCT_PARTITIONS; i++) {
+        partitions_.emplace_back(new TempRowFile(exec_ctx_->GetBufferPoolManager(), GetOutputSchema()));
+      }
+    }
+    *rid = row->GetRowId();
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,177 @@
+#include "executor/executors/hash_join_executor.h"
+
+#include "executor/executors/join_helper.h"
+
+HashJoinExecutor::HashJoinExecutor(ExecuteContext *exec_ctx, const HashJoinPlanNode *plan,
+                                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                                   std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {
+  if (plan_->build_left_) {
+    build_executor_ = left_executor_.get();
+    probe_executor_ = right_executor_.get();
+    build_keys_ = &plan_->left_keys_;
+    probe_keys_ = &plan_->right_keys_;
+  } else {
+    build_executor_ = right_executor_.get();
+    probe_executor_ = left_executor_.get();
+    build_keys_ = &plan_->right_keys_;
+    probe_keys_ = &plan_->left_keys_;
+  }
+}
+
+bool HashJoinExecutor::EncodeKey(const Row &row, const std::vector<AbstractExpressionRef> &keys, std::string *key) {
+  key->clear();
+  char buf[sizeof(int32_t)];
+  for (const auto &expr : keys) {
+    Field field = expr->Evaluate(&row);
+    if (field.IsNull()) {
+      return false;
+    }
+    if (field.GetTypeId() == TypeId::kTypeChar) {
+      // 带上长度, 否则 ("ab", "c") 和 ("a", "bc") 的编码相同
+      uint32_t len = field.GetLength();
+      key->append(reinterpret_cast<const char *>(&len), sizeof(len));
+      key->append(field.GetData(), len);
+      continue;
+    }
+    field.SerializeTo(buf);
+    if (field.GetTypeId() == TypeId::kTypeFloat && MACH_READ_FROM(float, buf) == 0) {
+      // -0.0 和 0.0 相等, 但字节不同
+      MACH_WRITE_TO(float, buf, 0.0f);
+    }
+    key->append(buf, sizeof(buf));
+  }
+  return true;
+}
+
+void HashJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  hash_table_.clear();
+  table_bytes_ = 0;
+  spilled_ = false;
+  build_partitions_.clear();
+  probe_partitions_.clear();
+  partition_ = 0;
+  matches_ = nullptr;
+  auto build_schema = const_cast<Schema *>(build_executor_->GetOutputSchema());
+  RowBatch batch;
+  Row row;
+  std::string key;
+  while (build_executor_->NextBatch(&batch)) {
+    for (auto i : batch.GetSelection()) {
+      batch.GetRow(i, &row);
+      if (!EncodeKey(row, *build_keys_, &key)) {
+        continue;
+      }
+      if (spilled_) {
+        build_partitions_[PartitionOf(key)]->Append(row);
+        continue;
+      }
+      table_bytes_ += key.size() + row.GetSerializedSize(build_schema);
+      hash_table_[key].emplace_back(row);
+      if (table_bytes_ > plan_->memory_budget_) {
+        Spill();
+      }
+    }
+  }
+  if (!spilled_) {
+    return;
+  }
+  while (probe_executor_->NextBatch(&batch)) {
+    for (auto i : batch.GetSelection()) {
+      batch.GetRow(i, &row);
+      if (EncodeKey(row, *probe_keys_, &key)) {
+        probe_partitions_[PartitionOf(key)]->Append(row);
+      }
+    }
+  }
+  for (auto &partition : probe_partitions_) {
+    partition->Rewind();
+  }
+  LoadPartition(0);
+}
+
+void HashJoinExecutor::Spill() {
+  auto bpm = exec_ctx_->GetBufferPoolManager();
+  for (int i = 0; i < HASH_JOIN_PARTITIONS; i++) {
+    build_partitions_.emplace_back(new TempRowFile(bpm, build_executor_->GetOutputSchema()));
+    probe_partitions_.emplace_back(new TempRowFile(bpm, probe_executor_->GetOutputSchema()));
+  }
+  for (const auto &entry : hash_table_) {
+    auto &partition = build_partitions_[PartitionOf(entry.first)];
+    for (const auto &row : entry.second) {
+      partition->Append(row);
+    }
+  }
+  hash_table_.clear();
+  table_bytes_ = 0;
+  spilled_ = true;
+}
+
+void HashJoinExecutor::LoadPartition(size_t partition) {
+  hash_table_.clear();
+  auto &file = build_partitions_[partition];
+  file->Rewind();
+  Row row;
+  std::string key;
+  while (file->Next(&row)) {
+    EncodeKey(row, *build_keys_, &key);
+    hash_table_[key].emplace_back(row);
+  }
+  // 分区读进内存后它的临时页就没用了
+  file.reset();
+}
+
+bool HashJoinExecutor::NextProbeRow(Row *row) {
+  if (!spilled_) {
+    RowId rid;
+    return probe_executor_->Next(row, &rid);
+  }
+  while (partition_ < probe_partitions_.size()) {
+    if (probe_partitions_[partition_]->Next(row)) {
+      return true;
+    }
+    probe_partitions_[partition_].reset();
+    if (++partition_ < probe_partitions_.size()) {
+      LoadPartition(partition_);
+    }
+  }
+  hash_table_.clear();
+  return false;
+}
+
+bool HashJoinExecutor::Next(Row *row, RowId *rid) {
+  auto predicate = plan_->GetPredicate();
+  std::string key;
+  while (true) {
+    while (matches_ != nullptr && match_cursor_ < matches_->size()) {
+      const Row &build_row = (*matches_)[match_cursor_++];
+      const Row &left = plan_->build_left_ ? build_row : probe_row_;
+      const Row &right = plan_->build_left_ ? probe_row_ : build_row;
+      if (predicate != nullptr &&
+          predicate->EvaluateJoin(&left, &right).CompareEquals(Field(kTypeInt, 1)) != CmpBool::kTrue) {
+        continue;
+      }
+      JoinRows(left, right, plan_->OutputSchema(), row);
+      *rid = RowId();
+      return true;
+    }
+    // 读下一个探测行可能会换入另一个分区, 先丢掉指向旧哈希表的 matches_
+    matches_ = nullptr;
+    if (!NextProbeRow(&probe_row_)) {
+      return false;
+    }
+    if (!EncodeKey(probe_row_, *probe_keys_, &key)) {
+      continue;
+    }
+    auto it = hash_table_.find(key);
+    if (it != hash_table_.end()) {
+      matches_ = &it->second;
+      match_cursor_ = 0;
+    }
+  }
+}
@@ -0,0 +1,115 @@
+#include "executor/executors/index_nested_loop_join_executor.h"
+
+#include <algorithm>
+
+#include "executor/executors/join_helper.h"
+
+IndexNestedLoopJoinExecutor::IndexNestedLoopJoinExecutor(ExecuteContext *exec_ctx,
+                                                         const IndexNestedLoopJoinPlanNode *plan,
+                                                         std::unique_ptr<AbstractExecutor> &&outer_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), outer_executor_(std::move(outer_executor)) {}
+
+void IndexNestedLoopJoinExecutor::Init() {
+  outer_executor_->Init();
+  exec_ctx_->GetCatalog()->GetTable(plan_->GetInnerTableName(), table_info_);
+  outer_rows_.clear();
+  keys_.clear();
+  order_.clear();
+  probe_ = 0;
+  has_last_probe_ = false;
+  matches_.clear();
+  match_cursor_ = 0;
+  probe_count_ = 0;
+}
+
+/** Three-way comparison of two keys of the same schema, field by field. */
+static int CompareKeys(const Row &lhs, const Row &rhs) {
+  for (uint32_t i = 0; i < lhs.GetFieldCount(); i++) {
+    if (lhs.GetField(i)->CompareLessThan(*rhs.GetField(i)) == CmpBool::kTrue) {
+      return -1;
+    }
+    if (lhs.GetField(i)->CompareGreaterThan(*rhs.GetField(i)) == CmpBool::kTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+bool IndexNestedLoopJoinExecutor::NextOuterBatch() {
+  RowBatch batch;
+  do {
+    if (!outer_executor_->NextBatch(&batch)) {
+      return false;
+    }
+    outer_rows_.clear();
+    keys_.clear();
+    order_.clear();
+    for (auto i : batch.GetSelection()) {
+      outer_rows_.emplace_back();
+      batch.GetRow(i, &outer_rows_.back());
+      std::vector<Field> fields;
+      bool has_null = false;
+      for (const auto &expr : plan_->outer_keys_) {
+        fields.emplace_back(expr->Evaluate(&outer_rows_.back()));
+        has_null = has_null || fields.back().IsNull();
+      }
+      keys_.emplace_back(fields);
+      // null 与任何值都不相等, 不必查索引
+      if (!has_null) {
+        order_.push_back(outer_rows_.size() - 1);
+      }
+    }
+  } while (order_.empty());
+  std::stable_sort(order_.begin(), order_.end(),
+                   [this](size_t a, size_t b) { return CompareKeys(keys_[a], keys_[b]) < 0; });
+  probe_ = 0;
+  has_last_probe_ = false;
+  return true;
+}
+
+void IndexNestedLoopJoinExecutor::ProbeInner(size_t i) {
+  match_cursor_ = 0;
+  if (has_last_probe_ && CompareKeys(keys_[last_probe_], keys_[i]) == 0) {
+    return;
+  }
+  has_last_probe_ = true;
+  last_probe_ = i;
+  probe_count_++;
+  matches_.clear();
+  std::vector<RowId> rids;
+  plan_->index_->GetIndex()->ScanKey(keys_[i], rids, exec_ctx_->GetTransaction());
+  std::sort(rids.begin(), rids.end(), [](const RowId &a, const RowId &b) { return a.Get() < b.Get(); });
+  table_info_->GetTableHeap()->GetTuples(rids, matches_, exec_ctx_->GetTransaction());
+  auto inner_predicate = plan_->inner_predicate_;
+  if (inner_predicate != nullptr) {
+    matches_.erase(std::remove_if(matches_.begin(), matches_.end(),
+                                  [&inner_predicate](const Row &row) {
+                                    return inner_predicate->Evaluate(&row).CompareEquals(Field(kTypeInt, 1)) !=
+                                           CmpBool::kTrue;
+                                  }),
+                   matches_.end());
+  }
+}
+
+bool IndexNestedLoopJoinExecutor::Next(Row *row, RowId *rid) {
+  auto predicate = plan_->GetPredicate();
+  while (true) {
+    while (match_cursor_ < matches_.size()) {
+      const Row &inner = matches_[match_cursor_++];
+      const Row &outer = outer_rows_[current_];
+      if (predicate != nullptr &&
+          predicate->EvaluateJoin(&outer, &inner).CompareEquals(Field(kTypeInt, 1)) != CmpBool::kTrue) {
+        continue;
+      }
+      JoinRows(outer, inner, plan_->OutputSchema(), row);
+      *rid = RowId();
+      return true;
+    }
+    if (probe_ == order_.size() && !NextOuterBatch()) {
+      matches_.clear();
+      return false;
+    }
+    current_ = order_[probe_++];
+    ProbeInner(current_);
+  }
+}
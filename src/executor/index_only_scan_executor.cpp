@@ -0,0 +1,51 @@
+#include "executor/executors/index_only_scan_executor.h"
+
+#include "executor/executors/index_scan_executor.h"
+
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecuteContext *exec_ctx, const IndexOnlyScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexOnlyScanExecutor::Init() {
+  exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
+  auto key_schema = plan_->key_range_.index_->GetIndexKeySchema();
+  key_pos_.assign(table_info_->GetSchema()->GetColumnCount(), -1);
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    key_pos_[key_schema->GetColumn(i)->GetTableInd()] = static_cast<int>(i);
+  }
+  scan_ = IndexScanExecutor::OpenKeyRange(plan_->key_range_, exec_ctx_->GetTransaction());
+}
+
+bool IndexOnlyScanExecutor::Next(Row *row, RowId *rid) {
+  auto table_schema = table_info_->GetSchema();
+  RowId next_rid;
+  Row key;
+  while (scan_->Next(&next_rid, &key)) {
+    if (plan_->need_filter_) {
+      // 按表的列位置摊开 key, 谓词只引用 key 中的列, 其余列置空即可
+      std::vector<Field> fields;
+      fields.reserve(key_pos_.size());
+      for (uint32_t i = 0; i < key_pos_.size(); i++) {
+        if (key_pos_[i] >= 0) {
+          fields.emplace_back(*key.GetField(key_pos_[i]));
+        } else {
+          fields.emplace_back(table_schema->GetColumn(i)->GetType());
+        }
+      }
+      Row tuple(fields);
+      if (!plan_->GetCompiledPredicate()->Evaluate(tuple)) {
+        continue;
+      }
+    }
+    const auto &output_columns = plan_->OutputSchema()->GetColumns();
+    std::vector<Field> dest_row;
+    dest_row.reserve(output_columns.size());
+    for (const auto column : output_columns) {
+      dest_row.emplace_back(*key.GetField(key_pos_[column->GetTableInd()]));
+    }
+    *row = Row(dest_row);
+    row->SetRowId(next_rid);
+    *rid = next_rid;
+    return true;
+  }
+  return false;
+}
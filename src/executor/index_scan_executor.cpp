@@ -1,20 +1,95 @@
 #include "executor/executors/index_scan_executor.h"
 
-class RowidCompare {
- public:
-  bool operator()(RowId rid1, RowId rid2) { return rid1.Get() < rid2.Get(); }
-};
-
 IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void IndexScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  result_ = IndexScan(plan_->GetPredicate());
+  scan_.reset();
+  result_.clear();
+  cursor_ = 0;
+  batch_.clear();
+  batch_cursor_ = 0;
+  if (plan_->bitmap_heap_scan_) {
+    // bitmap 按 (page, slot) 有序, 正好是回表的顺序
+    if (plan_->bitmap_condition_ != nullptr) {
+      result_ = BuildBitmap(*plan_->bitmap_condition_).ToVector();
+    } else {
+      IndexBitmapCondition leaf{true, LogicType::And, plan_->key_range_, {}};
+      result_ = BuildBitmap(leaf).ToVector();
+    }
+  } else if (IsKeyLookup(plan_->key_range_)) {
+    LookupKey(plan_->key_range_, result_);
+  } else {
+    scan_ = OpenKeyRange(plan_->key_range_, exec_ctx_->GetTransaction());
+    if (plan_->snapshot_rids_) {
+      while (scan_->NextBatch(result_)) {
+      }
+      scan_.reset();
+    }
+  }
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), plan_->OutputSchema());
 }
 
+RowIdBitmap IndexScanExecutor::BuildBitmap(const IndexBitmapCondition &condition) {
+  RowIdBitmap bitmap;
+  if (condition.is_leaf_ && IsKeyLookup(condition.key_range_)) {
+    std::vector<RowId> rids;
+    LookupKey(condition.key_range_, rids);
+    for (const auto &rid : rids) {
+      bitmap.Add(rid);
+    }
+    return bitmap;
+  }
+  if (condition.is_leaf_) {
+    auto scan = OpenKeyRange(condition.key_range_, exec_ctx_->GetTransaction());
+    std::vector<RowId> rids;
+    while (scan->NextBatch(rids)) {
+      for (const auto &rid : rids) {
+        bitmap.Add(rid);
+      }
+      rids.clear();
+    }
+    return bitmap;
+  }
+  bitmap = BuildBitmap(condition.children_[0]);
+  for (size_t i = 1; i < condition.children_.size(); i++) {
+    if (condition.logic_type_ == LogicType::And) {
+      if (bitmap.Empty()) {
+        break;
+      }
+      bitmap.IntersectWith(BuildBitmap(condition.children_[i]));
+    } else {
+      bitmap.UnionWith(BuildBitmap(condition.children_[i]));
+    }
+  }
+  return bitmap;
+}
+
+std::unique_ptr<IndexRangeScan> IndexScanExecutor::OpenKeyRange(const IndexKeyRange &range, Txn *txn) {
+  auto index = dynamic_cast<BPlusTreeIndex *>(range.index_->GetIndex());
+  if (index == nullptr) {
+    throw std::logic_error("index scan expects a b+ tree index");
+  }
+  std::vector<Field> lower_fields(range.lower_);
+  std::vector<Field> upper_fields(range.upper_);
+  Row lower(lower_fields);
+  Row upper(upper_fields);
+  return index->ScanRange(range.lower_.empty() ? nullptr : &lower, range.lower_inclusive_,
+                          range.upper_.empty() ? nullptr : &upper, range.upper_inclusive_, txn);
+}
+
+bool IndexScanExecutor::IsKeyLookup(const IndexKeyRange &range) {
+  // hash 与 art 索引都只能按完整 key 查找
+  return dynamic_cast<BPlusTreeIndex *>(range.index_->GetIndex()) == nullptr;
+}
+
+void IndexScanExecutor::LookupKey(const IndexKeyRange &range, std::vector<RowId> &result) {
+  // 规划器只会给 hash/art 索引完整 key 上的等值条件
+  std::vector<Field> key_fields(range.lower_);
+  range.index_->GetIndex()->ScanKey(Row(key_fields), result, exec_ctx_->GetTransaction(), "=");
+}
+
 bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
   auto table_columns = table_schema->GetColumns();
   auto output_columns = output_schema->GetColumns();
@@ -44,58 +119,92 @@ void IndexScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *
   *output_row = Row(dest_row);
 }
 
-vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
-  switch (predicate->GetType()) {
-    case ExpressionType::LogicExpression: {
-      vector<RowId> lhs = IndexScan(predicate->GetChildAt(0));
-      vector<RowId> rhs = IndexScan(predicate->GetChildAt(1));
-      if (lhs.empty()) return rhs;
-      if (rhs.empty()) return lhs;
-      sort(lhs.begin(), lhs.end(), RowidCompare());
-      sort(rhs.begin(), rhs.end(), RowidCompare());
-      vector<RowId> result;
-      set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), back_inserter(result), RowidCompare());
-      return result;
+bool IndexScanExecutor::NextRowId(RowId *rid) {
+  if (scan_ != nullptr && cursor_ == result_.size()) {
+    // 一次取出一整个叶子的 RowId, 回表时不再占着叶子页
+    result_.clear();
+    cursor_ = 0;
+    if (!scan_->NextBatch(result_)) {
+      scan_.reset();
     }
-    case ExpressionType::ComparisonExpression: {
-      std::vector<RowId> ret;
-      std::vector<Field> fields{predicate->GetChildAt(1)->Evaluate(nullptr)};
-      Row key(fields);
-      for (auto index : plan_->indexes_) {
-        uint32_t col_idx = dynamic_pointer_cast<ColumnValueExpression>(predicate->GetChildAt(0))->GetColIdx();
-        if (col_idx == index->GetIndexKeySchema()->GetColumn(0)->GetTableInd()) {
-          index->GetIndex()->ScanKey(key, ret, nullptr,
-                                     dynamic_pointer_cast<ComparisonExpression>(predicate)->GetComparisonType());
-          break;
-        }
+  }
+  if (cursor_ < result_.size()) {
+    *rid = result_[cursor_++];
+    return true;
+  }
+  return false;
+}
+
+bool IndexScanExecutor::NextTuple(Row *tuple) {
+  if (!plan_->bitmap_heap_scan_) {
+    RowId next_rid;
+    while (NextRowId(&next_rid)) {
+      *tuple = Row(next_rid);
+      if (table_info_->GetTableHeap()->GetTuple(tuple, exec_ctx_->GetTransaction())) {
+        return true;
       }
-      return ret;
     }
-    default:
-      break;
+    return false;
+  }
+  while (batch_cursor_ >= batch_.size()) {
+    if (cursor_ >= result_.size()) {
+      return false;
+    }
+    // 取出同一页上的全部 rid, 整页只读一次
+    size_t page_end = cursor_;
+    while (page_end < result_.size() && result_[page_end].GetPageId() == result_[cursor_].GetPageId()) {
+      page_end++;
+    }
+    std::vector<RowId> page_rids(result_.begin() + cursor_, result_.begin() + page_end);
+    cursor_ = page_end;
+    batch_.clear();
+    batch_cursor_ = 0;
+    table_info_->GetTableHeap()->GetTuples(page_rids, batch_, exec_ctx_->GetTransaction());
   }
+  *tuple = batch_[batch_cursor_++];
+  return true;
 }
 
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
-  auto predicate = plan_->GetPredicate();
+  const auto &predicate = plan_->GetCompiledPredicate();
   auto table_schema = table_info_->GetSchema();
-  while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
-    if (plan_->need_filter_) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        cursor_++;
-        continue;
-      }
+  Row tuple;
+  while (NextTuple(&tuple)) {
+    if (plan_->need_filter_ && !predicate->Evaluate(tuple)) {
+      continue;
     }
-    *rid = result_[cursor_];
+    *rid = tuple.GetRowId();
     if (!is_schema_same_) {
-      TupleTransfer(table_schema, plan_->OutputSchema(), p_row, row);
+      TupleTransfer(table_schema, plan_->OutputSchema(), &tuple, row);
     } else {
-      *row = *p_row;
+      *row = tuple;
     }
-    cursor_++;
     return true;
   }
   return false;
 }
+
+bool IndexScanExecutor::NextBatch(RowBatch *batch) {
+  const auto &predicate = plan_->GetCompiledPredicate();
+  auto table_schema = table_info_->GetSchema();
+  Row tuple;
+  do {
+    table_batch_.Reset(table_schema);
+    while (!table_batch_.Full() && NextTuple(&tuple)) {
+      table_batch_.Append(tuple, tuple.GetRowId());
+    }
+    if (table_batch_.Size() == 0) {
+      batch->Reset(plan_->OutputSchema());
+      return false;
+    }
+    if (plan_->need_filter_) {
+      predicate->FilterBatch(&table_batch_);
+    }
+  } while (table_batch_.GetSelection().empty());
+  if (is_schema_same_) {
+    std::swap(*batch, table_batch_);
+  } else {
+    table_batch_.Project(plan_->OutputSchema(), batch);
+  }
+  return true;
+}
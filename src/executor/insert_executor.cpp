@@ -13,30 +13,51 @@ void InsertExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   schema_ = table_info_->GetSchema();
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
+  done_ = false;
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-    Row insert_row;
-    RowId insert_rid;
-    if (child_executor_->Next(&insert_row, &insert_rid)) {
-        for (auto info: index_info_) {
-            Row key_row;
-            insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-            std::vector<RowId> result;
-            if (!key_row.GetFields().empty() &&
-                info->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS) {
-                std::cout << "key already exists" << std::endl;
-                return false;
-            }
-        }
-        if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
-            Row key_row;
-            for (auto info: index_info_) {  // 更新索引
-                insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
-                info->GetIndex()->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
-            }
-            return true;
-        }
+  Row insert_row;
+  RowId insert_rid;
+  return !done_ && child_executor_->Next(&insert_row, &insert_rid) && InsertRow(insert_row);
+}
+
+bool InsertExecutor::NextBatch(RowBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  Row insert_row;
+  while (!done_ && batch->Size() == 0 && child_executor_->NextBatch(&child_batch_)) {
+    for (auto i : child_batch_.GetSelection()) {
+      child_batch_.GetRow(i, &insert_row);
+      if (!InsertRow(insert_row)) {
+        done_ = true;
+        break;
+      }
+      batch->Append(insert_row, insert_row.GetRowId());
+    }
+  }
+  return batch->Size() > 0;
+}
+
+bool InsertExecutor::InsertRow(Row &insert_row) {
+  for (auto info : index_info_) {
+    if (!info->IsUnique()) {  // 非唯一索引允许重复 key
+      continue;
+    }
+    Row key_row;
+    insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
+    // 新 key 通常被 bloom filter 直接排除, 不用查索引
+    if (!key_row.GetFields().empty() && info->ContainsKey(key_row, exec_ctx_->GetTransaction())) {
+      std::cout << "key already exists" << std::endl;
+      return false;
+    }
+  }
+  if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
+    Row key_row;
+    for (auto info : index_info_) {  // 更新索引
+      insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
+      info->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
+    }
+    return true;
   }
   return false;
 }
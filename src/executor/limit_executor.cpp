@@ -0,0 +1,33 @@
+#include "executor/executors/limit_executor.h"
+
+LimitExecutor::LimitExecutor(ExecuteContext *exec_ctx, const LimitPlanNode *plan,
+                             std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void LimitExecutor::Init() {
+  child_executor_->Init();
+  remaining_ = plan_->GetLimit();
+}
+
+bool LimitExecutor::Next(Row *row, RowId *rid) {
+  if (remaining_ == 0 || !child_executor_->Next(row, rid)) {
+    return false;
+  }
+  remaining_--;
+  return true;
+}
+
+bool LimitExecutor::NextBatch(RowBatch *batch) {
+  if (remaining_ < static_cast<size_t>(ROW_BATCH_SIZE)) {
+    return AbstractExecutor::NextBatch(batch);
+  }
+  if (!child_executor_->NextBatch(batch)) {
+    return false;
+  }
+  auto &selection = batch->GetSelection();
+  if (selection.size() > remaining_) {
+    selection.resize(remaining_);
+  }
+  remaining_ -= selection.size();
+  return true;
+}
@@ -0,0 +1,51 @@
+#include "executor/executors/nested_loop_join_executor.h"
+
+#include "executor/executors/join_helper.h"
+
+NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecuteContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
+                                               std::unique_ptr<AbstractExecutor> &&left_executor,
+                                               std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {}
+
+void NestedLoopJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  right_rows_.clear();
+  RowBatch batch;
+  while (right_executor_->NextBatch(&batch)) {
+    for (auto i : batch.GetSelection()) {
+      right_rows_.emplace_back();
+      batch.GetRow(i, &right_rows_.back());
+    }
+  }
+  has_left_ = false;
+  right_cursor_ = 0;
+}
+
+bool NestedLoopJoinExecutor::Next(Row *row, RowId *rid) {
+  auto predicate = plan_->GetPredicate();
+  while (true) {
+    if (!has_left_) {
+      RowId left_rid;
+      if (!left_executor_->Next(&left_row_, &left_rid)) {
+        return false;
+      }
+      has_left_ = true;
+      right_cursor_ = 0;
+    }
+    while (right_cursor_ < right_rows_.size()) {
+      const Row &right_row = right_rows_[right_cursor_++];
+      if (predicate != nullptr &&
+          predicate->EvaluateJoin(&left_row_, &right_row).CompareEquals(Field(kTypeInt, 1)) != CmpBool::kTrue) {
+        continue;
+      }
+      JoinRows(left_row_, right_row, plan_->OutputSchema(), row);
+      *rid = RowId();
+      return true;
+    }
+    has_left_ = false;
+  }
+}
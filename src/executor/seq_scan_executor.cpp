@@ -4,10 +4,7 @@
 #include "executor/executors/seq_scan_executor.h"
 
 SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      iterator_(nullptr, RowId(INVALID_PAGE_ID, 0), nullptr),
-      is_schema_same_(false) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), is_schema_same_(false) {}
 
 bool SeqScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
   auto table_columns = table_schema->GetColumns();
@@ -40,31 +37,56 @@ void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *ou
 
 void SeqScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  // auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
+  next_page_id_ = table_info_->GetTableHeap()->GetFirstPageId();
+  page_rows_.clear();
+  cursor_ = 0;
   schema_ = plan_->OutputSchema();
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
 }
 
-bool SeqScanExecutor::Next(Row *row, RowId *rid) {
-  auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
-  while (iterator_ != table_info_->GetTableHeap()->End()) {
-    auto p_row = &(*iterator_);
-    if (predicate != nullptr) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        iterator_++;
-        continue;
-      }
-    }
-    *rid = iterator_->GetRowId();
-    if (!is_schema_same_) {
-      TupleTransfer(table_schema, schema_, p_row, row);
-    } else {
-      *row = *p_row;
+bool SeqScanExecutor::NextRow(Row **row) {
+  while (cursor_ >= page_rows_.size()) {
+    if (next_page_id_ == INVALID_PAGE_ID) {
+      return false;
     }
-    iterator_++;
-    return true;
+    // 谓词在页内的元组上直接求值, 只有通过的元组才反序列化
+    page_rows_.clear();
+    cursor_ = 0;
+    next_page_id_ = table_info_->GetTableHeap()->ScanPage(next_page_id_, plan_->GetCompiledPredicate().get(),
+                                                          page_rows_, exec_ctx_->GetTransaction());
+  }
+  *row = &page_rows_[cursor_++];
+  return true;
+}
+
+bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+  Row *p_row;
+  if (!NextRow(&p_row)) {
+    return false;
   }
-  return false;
+  *rid = p_row->GetRowId();
+  if (!is_schema_same_) {
+    TupleTransfer(table_info_->GetSchema(), schema_, p_row, row);
+  } else {
+    *row = *p_row;
+  }
+  return true;
+}
+
+bool SeqScanExecutor::NextBatch(RowBatch *batch) {
+  table_batch_.Reset(table_info_->GetSchema());
+  Row *p_row;
+  while (!table_batch_.Full() && NextRow(&p_row)) {
+    table_batch_.Append(*p_row, p_row->GetRowId());
+  }
+  if (table_batch_.Size() == 0) {
+    batch->Reset(schema_);
+    return false;
+  }
+  if (is_schema_same_) {
+    std::swap(*batch, table_batch_);
+  } else {
+    table_batch_.Project(schema_, batch);
+  }
+  return true;
 }
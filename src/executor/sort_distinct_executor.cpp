@@ -0,0 +1,29 @@
+#include "executor/executors/sort_distinct_executor.h"
+
+#include "index/generic_key.h"
+
+SortDistinctExecutor::SortDistinctExecutor(ExecuteContext *exec_ctx, const DistinctPlanNode *plan,
+                                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void SortDistinctExecutor::Init() {
+  child_executor_->Init();
+  last_key_.clear();
+  has_last_ = false;
+}
+
+bool SortDistinctExecutor::Next(Row *row, RowId *rid) {
+  std::string key;
+  while (child_executor_->Next(row, rid)) {
+    for (auto field : row->GetFields()) {
+      KeyManager::AppendField(*field, &key);
+    }
+    if (!has_last_ || key != last_key_) {
+      last_key_.swap(key);
+      has_last_ = true;
+      return true;
+    }
+    key.clear();
+  }
+  return false;
+}
@@ -0,0 +1,164 @@
+#include "executor/executors/sort_executor.h"
+
+#include <algorithm>
+
+#include "executor/executors/sort_helper.h"
+
+SortExecutor::SortExecutor(ExecuteContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void SortExecutor::WriteRun() {
+  std::stable_sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b) { return a.key_ < b.key_; });
+  runs_.emplace_back(new TempRowFile(exec_ctx_->GetBufferPoolManager(), child_executor_->GetOutputSchema()));
+  for (const auto &entry : entries_) {
+    runs_.back()->Append(*entry.row_);
+  }
+  runs_.back()->Rewind();
+  run_count_++;
+  entries_.clear();
+  entry_bytes_ = 0;
+}
+
+void SortExecutor::Init() {
+  child_executor_->Init();
+  entries_.clear();
+  entry_bytes_ = 0;
+  runs_.clear();
+  run_count_ = 0;
+  sources_.clear();
+  tree_.clear();
+  cursor_ = 0;
+  auto child_schema = const_cast<Schema *>(child_executor_->GetOutputSchema());
+  RowBatch batch;
+  while (child_executor_->NextBatch(&batch)) {
+    for (auto i : batch.GetSelection()) {
+      entries_.emplace_back();
+      auto &entry = entries_.back();
+      entry.row_.reset(new Row());
+      batch.GetRow(i, entry.row_.get());
+      MakeSortKey(plan_->GetOrderBy(), *entry.row_, &entry.key_);
+      entry_bytes_ += sizeof(Entry) + sizeof(Row) + entry.key_.size() + entry.row_->GetSerializedSize(child_schema);
+      if (entry_bytes_ > plan_->memory_budget_) {
+        WriteRun();
+      }
+    }
+  }
+  std::stable_sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b) { return a.key_ < b.key_; });
+  if (runs_.empty()) {
+    return;
+  }
+  // 最后一趟归并还要读内存中的行; 多出的 run 从前往后合并, 合并结果放回原处以保持稳定
+  size_t fan_in = std::max<size_t>(plan_->merge_fan_in_, 2);
+  while (runs_.size() + 1 > fan_in) {
+    std::vector<TempRowFile *> inputs;
+    for (size_t i = 0; i < fan_in; i++) {
+      inputs.push_back(runs_[i].get());
+    }
+    StartMerge(inputs, false);
+    auto merged = std::make_unique<TempRowFile>(exec_ctx_->GetBufferPoolManager(), child_schema);
+    Row row;
+    while (MergeNext(&row)) {
+      merged->Append(row);
+    }
+    merged->Rewind();
+    run_count_++;
+    sources_.clear();
+    runs_.erase(runs_.begin(), runs_.begin() + fan_in);
+    runs_.insert(runs_.begin(), std::move(merged));
+  }
+  std::vector<TempRowFile *> inputs;
+  for (auto &run : runs_) {
+    inputs.push_back(run.get());
+  }
+  StartMerge(inputs, true);
+}
+
+void SortExecutor::StartMerge(const std::vector<TempRowFile *> &runs, bool with_memory) {
+  size_t k = runs.size() + with_memory;
+  sources_.clear();
+  sources_.resize(k);
+  for (size_t i = 0; i < k; i++) {
+    sources_[i].file_ = i < runs.size() ? runs[i] : nullptr;
+    Advance(i);
+  }
+  // 所有内部结点先放哨兵, 依次从每个叶子调整一遍之后哨兵都被换到了树外
+  tree_.assign(k, k);
+  for (size_t i = k; i-- > 0;) {
+    Adjust(i);
+  }
+}
+
+void SortExecutor::Advance(size_t source) {
+  auto &src = sources_[source];
+  if (src.file_ != nullptr) {
+    src.done_ = !src.file_->Next(&src.row_);
+  } else {
+    src.done_ = cursor_ >= entries_.size();
+    if (!src.done_) {
+      src.row_.destroy();
+      src.row_.GetFields().swap(entries_[cursor_].row_->GetFields());
+      src.row_.SetRowId(entries_[cursor_].row_->GetRowId());
+      src.key_.swap(entries_[cursor_].key_);
+      cursor_++;
+      return;
+    }
+  }
+  if (!src.done_) {
+    MakeSortKey(plan_->GetOrderBy(), src.row_, &src.key_);
+  }
+}
+
+bool SortExecutor::Less(size_t a, size_t b) const {
+  size_t k = sources_.size();
+  if (a == k || b == k) {
+    return a == k;
+  }
+  if (sources_[a].done_ || sources_[b].done_) {
+    return !sources_[a].done_;
+  }
+  int cmp = sources_[a].key_.compare(sources_[b].key_);
+  // 相等的行按来源的先后输出, 越靠前的来源越早读入
+  return cmp < 0 || (cmp == 0 && a < b);
+}
+
+void SortExecutor::Adjust(size_t source) {
+  size_t k = sources_.size();
+  for (size_t t = (source + k) / 2; t > 0; t /= 2) {
+    if (Less(tree_[t], source)) {
+      std::swap(tree_[t], source);
+    }
+  }
+  tree_[0] = source;
+}
+
+bool SortExecutor::MergeNext(Row *row) {
+  size_t winner = tree_[0];
+  if (sources_[winner].done_) {
+    return false;
+  }
+  auto &src = sources_[winner];
+  row->destroy();
+  row->GetFields().swap(src.row_.GetFields());
+  row->SetRowId(src.row_.GetRowId());
+  Advance(winner);
+  Adjust(winner);
+  return true;
+}
+
+bool SortExecutor::Next(Row *row, RowId *rid) {
+  if (sources_.empty()) {
+    if (cursor_ >= entries_.size()) {
+      return false;
+    }
+    auto &entry = entries_[cursor_++];
+    child_row_.destroy();
+    child_row_.GetFields().swap(entry.row_->GetFields());
+    child_row_.SetRowId(entry.row_->GetRowId());
+  } else if (!MergeNext(&child_row_)) {
+    return false;
+  }
+  ProjectRow(child_row_, GetOutputSchema(), row);
+  *rid = row->GetRowId();
+  return true;
+}
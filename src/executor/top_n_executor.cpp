@@ -0,0 +1,56 @@
+#include "executor/executors/top_n_executor.h"
+
+#include <algorithm>
+
+#include "executor/executors/sort_helper.h"
+
+TopNExecutor::TopNExecutor(ExecuteContext *exec_ctx, const TopNPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void TopNExecutor::Init() {
+  child_executor_->Init();
+  heap_.clear();
+  cursor_ = 0;
+  size_t n = plan_->GetN();
+  if (n == 0) {
+    return;
+  }
+  heap_.reserve(n);
+  RowBatch batch;
+  Row row;
+  std::string key;
+  size_t seq = 0;
+  while (child_executor_->NextBatch(&batch)) {
+    for (auto i : batch.GetSelection()) {
+      batch.GetRow(i, &row);
+      MakeSortKey(plan_->GetOrderBy(), row, &key);
+      size_t row_seq = seq++;
+      if (heap_.size() < n) {
+        heap_.push_back({key, row_seq, std::make_unique<Row>(row)});
+        std::push_heap(heap_.begin(), heap_.end(), EntryLess);
+        continue;
+      }
+      // 后读到的行序号更大, 键相等时排在堆顶之后, 只有键更小才替换堆顶
+      if (key.compare(heap_.front().key_) >= 0) {
+        continue;
+      }
+      std::pop_heap(heap_.begin(), heap_.end(), EntryLess);
+      auto &last = heap_.back();
+      last.key_.swap(key);
+      last.seq_ = row_seq;
+      *last.row_ = row;
+      std::push_heap(heap_.begin(), heap_.end(), EntryLess);
+    }
+  }
+  std::sort_heap(heap_.begin(), heap_.end(), EntryLess);
+}
+
+bool TopNExecutor::Next(Row *row, RowId *rid) {
+  if (cursor_ >= heap_.size()) {
+    return false;
+  }
+  ProjectRow(*heap_[cursor_++].row_, GetOutputSchema(), row);
+  *rid = row->GetRowId();
+  return true;
+}
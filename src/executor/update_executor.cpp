@@ -4,6 +4,8 @@
 
 #include "executor/executors/update_executor.h"
 
+#include <algorithm>
+
 UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -11,31 +13,61 @@ UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *p
 void UpdateExecutor::Init() {
   child_executor_->Init();
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
+  std::vector<IndexInfo *> indexes;
+  exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), indexes);
+  // 只维护键列被 SET 修改过的索引
+  const auto &update_attrs = plan_->GetUpdateAttr();
+  index_info_.clear();
+  for (auto info : indexes) {
+    const auto &key_columns = info->GetIndexKeySchema()->GetColumns();
+    if (std::any_of(key_columns.begin(), key_columns.end(),
+                    [&](const Column *column) { return update_attrs.count(column->GetTableInd()) > 0; })) {
+      index_info_.push_back(info);
+    }
+  }
   txn_ = exec_ctx_->GetTransaction();
+  pending_removes_.assign(index_info_.size(), {});
+  pending_inserts_.assign(index_info_.size(), {});
 }
 
-bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
+bool UpdateExecutor::Next(Row *row, RowId *rid) {
   Row src_row;
   RowId src_rid;
   if (child_executor_->Next(&src_row, &src_rid)) {
     Row dest_row = GenerateUpdatedTuple(src_row);
     if (!table_info_->GetTableHeap()->UpdateTuple(dest_row, src_rid, txn_)) {
+      FlushIndexes();
       return false;
     }
     Row src_key_row;
     Row dest_key_row;
-    for (auto info : index_info_) {  // 更新索引
-      src_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), src_key_row);
-      dest_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), dest_key_row);
-      info->GetIndex()->RemoveEntry(src_key_row, src_rid, txn_);
-      info->GetIndex()->InsertEntry(dest_key_row, src_rid, txn_);
+    for (size_t i = 0; i < index_info_.size(); i++) {  // 更新索引, 语句结束时成批执行
+      src_row.GetKeyFromRow(table_info_->GetSchema(), index_info_[i]->GetIndexKeySchema(), src_key_row);
+      dest_row.GetKeyFromRow(table_info_->GetSchema(), index_info_[i]->GetIndexKeySchema(), dest_key_row);
+      pending_removes_[i].emplace_back(src_key_row, src_rid);
+      pending_inserts_[i].emplace_back(dest_key_row, src_rid);
     }
+    *row = dest_row;
+    *rid = src_rid;
     return true;
   }
+  FlushIndexes();
   return false;
 }
 
+void UpdateExecutor::FlushIndexes() {
+  for (size_t i = 0; i < index_info_.size(); i++) {
+    if (!pending_removes_[i].empty()) {
+      index_info_[i]->GetIndex()->RemoveEntries(pending_removes_[i], txn_);
+      pending_removes_[i].clear();
+    }
+    for (const auto &entry : pending_inserts_[i]) {
+      index_info_[i]->InsertEntry(entry.first, entry.second, txn_);
+    }
+    pending_inserts_[i].clear();
+  }
+}
+
 Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row) {
   const auto update_attrs = plan_->GetUpdateAttr();
   Schema *schema = table_info_->GetSchema();
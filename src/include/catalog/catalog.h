@@ -84,7 +84,7 @@ class CatalogManager {
 
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Txn *txn, IndexInfo *&index_info,
-                      const string &index_type);
+                      const string &index_type, bool unique = false);
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
@@ -94,6 +94,13 @@ class CatalogManager {
 
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  /**
+   * Replace the statistics of a table and write them to its statistics page, which is allocated and
+   * recorded in the table metadata the first time the table is analyzed.
+   * @param statistics owned by the table afterwards
+   */
+  dberr_t UpdateTableStatistics(const std::string &table_name, TableStatistics *statistics);
+
  private:
   dberr_t DropTable(table_id_t table_id);
 
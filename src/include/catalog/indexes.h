@@ -6,8 +6,11 @@
 #include "catalog/table.h"
 #include "common/macros.h"
 #include "common/rowid.h"
+#include "index/art_index.h"
 #include "index/b_plus_tree_index.h"
+#include "index/bloom_filter.h"
 #include "index/generic_key.h"
+#include "index/hash_index.h"
 #include "record/schema.h"
 
 class IndexMetadata {
@@ -15,7 +18,8 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, const std::string &index_type = "bptree",
+                               bool unique = false);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,22 +37,48 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  /** "bptree" or "hash" */
+  inline const std::string &GetIndexType() const { return index_type_; }
+
+  /** Whether a key may appear only once, as for primary keys and unique columns */
+  inline bool IsUnique() const { return unique_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, const std::string &index_type, bool unique);
 
  private:
-  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  // 344528 was the layout without the index type and the unique flag, from before the memcomparable b+ tree keys
+  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344529;
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  std::string index_type_;
+  bool unique_;
+};
+
+/** Counters of the key filter of a unique index, see IndexInfo::ContainsKey. */
+struct KeyFilterStats {
+  uint64_t probes_{0};           // uniqueness checks
+  uint64_t skipped_{0};          // checks the filter answered alone, the index was not searched
+  uint64_t false_positives_{0};  // checks the filter passed on to the index, which did not have the key
+
+  // fraction of the absent keys the filter failed to reject
+  double FalsePositiveRate() const {
+    uint64_t negatives = skipped_ + false_positives_;
+    return negatives == 0 ? 0 : static_cast<double>(false_positives_) / negatives;
+  }
 };
 
 /**
  * The IndexInfo class maintains metadata about a index.
+ *
+ * A unique index also gets a bloom filter of its keys, so that an insert of a new key does not have to
+ * search the index for a duplicate. The filter is built from the table heap in Init, and the entries
+ * added afterwards must go through InsertEntry to reach it.
  */
 class IndexInfo {
  public:
@@ -70,13 +100,31 @@ class IndexInfo {
     this->meta_data_=meta_data;
     // this->table_info_=table_info;
     key_schema_=Schema::ShallowCopySchema(table_info->GetSchema(),meta_data->key_map_);
-    index_ = CreateIndex(buffer_pool_manager,"bptree");
+    index_ = CreateIndex(buffer_pool_manager, meta_data->index_type_);
+    if (index_ != nullptr && meta_data->unique_) {
+      BuildKeyFilter(table_info);
+    }
   }
 
+  /** Add an entry to the index and its key to the key filter. */
+  dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn);
+
+  /**
+   * Whether the index has an entry with this key, asking the key filter before the index.
+   * Only meaningful for a unique index.
+   */
+  bool ContainsKey(const Row &key, Txn *txn);
+
+  const KeyFilterStats &GetKeyFilterStats() const { return filter_stats_; }
+
   inline Index *GetIndex() { return index_; }
 
   std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
+  const std::string &GetIndexType() const { return meta_data_->GetIndexType(); }
+
+  bool IsUnique() const { return meta_data_->IsUnique(); }
+
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
  private:
@@ -84,10 +132,18 @@ class IndexInfo {
 
   Index *CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type);
 
+  // add the key of every row of the table, a superset of the keys in the index
+  void BuildKeyFilter(TableInfo *table_info);
+
+  // the memcomparable encoding of the key columns, what the filter hashes
+  std::vector<char> EncodeFilterKey(const Row &key) const;
+
  private:
   IndexMetadata *meta_data_;
   Index *index_;
   IndexSchema *key_schema_;
+  std::unique_ptr<BloomFilter> key_filter_;
+  KeyFilterStats filter_stats_;
 };
 
 #endif  // MINISQL_INDEXES_H
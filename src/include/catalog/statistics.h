@@ -0,0 +1,80 @@
+#ifndef MINISQL_STATISTICS_H
+#define MINISQL_STATISTICS_H
+
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+class TableInfo;
+class IndexInfo;
+class Txn;
+
+/**
+ * Statistics of one column: the number of distinct values, the fraction of nulls and an equi-depth
+ * histogram of the non-null values. bounds_ holds B + 1 sorted boundaries and every bucket
+ * [bounds_[i], bounds_[i + 1]] holds about 1/B of the non-null rows, so a value repeated across several
+ * boundaries is a frequent one.
+ */
+class ColumnStatistics {
+  friend class TableStatistics;
+
+ public:
+  ColumnStatistics() = default;
+
+  inline double GetDistinctCount() const { return distinct_count_; }
+
+  inline double GetNullFraction() const { return null_fraction_; }
+
+  inline const std::vector<Field> &GetBounds() const { return bounds_; }
+
+  /** @return the fraction of rows whose value equals val */
+  double EqualSelectivity(const Field &val) const;
+
+  /** @return the fraction of rows whose value is less than val, nulls never match */
+  double LessSelectivity(const Field &val) const;
+
+ private:
+  double distinct_count_{0};
+  double null_fraction_{0};
+  std::vector<Field> bounds_;
+};
+
+/**
+ * Statistics of a table collected by ANALYZE, stored on a page of its own and referenced from the table
+ * metadata. Only the planner reads them, so they may be stale: estimates are clamped but never trusted
+ * to be exact.
+ */
+class TableStatistics {
+ public:
+  uint32_t SerializeTo(char *buf) const;
+
+  uint32_t GetSerializedSize() const;
+
+  static uint32_t DeserializeFrom(char *buf, const Schema *schema, TableStatistics *&stats);
+
+  /**
+   * Scan the table once, counting its rows and pages exactly and keeping a reservoir sample of
+   * STATS_SAMPLE_ROWS rows, from which the histograms and distinct counts are estimated. A single-column
+   * index gives an exact distinct count instead of the estimate.
+   */
+  static TableStatistics *Collect(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, Txn *txn);
+
+  inline double GetRowCount() const { return row_count_; }
+
+  inline double GetPageCount() const { return page_count_; }
+
+  inline const ColumnStatistics &GetColumn(uint32_t column_id) const { return columns_[column_id]; }
+
+  inline uint32_t GetColumnCount() const { return columns_.size(); }
+
+ private:
+  static constexpr uint32_t TABLE_STATISTICS_MAGIC_NUM = 202406;
+  double row_count_{0};
+  double page_count_{0};
+  std::vector<ColumnStatistics> columns_;
+};
+
+#endif  // MINISQL_STATISTICS_H
@@ -3,6 +3,7 @@
 
 #include <memory>
 
+#include "catalog/statistics.h"
 #include "glog/logging.h"
 #include "record/schema.h"
 #include "storage/table_heap.h"
@@ -33,17 +34,25 @@ class TableMetadata {
 
   inline Schema *GetSchema() const { return schema_; }
 
+  inline page_id_t GetStatsPageId() const { return stats_page_id_; }
+
+  inline void SetStatsPageId(page_id_t stats_page_id) { stats_page_id_ = stats_page_id; }
+
  private:
   TableMetadata() = delete;
 
   TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
 
  private:
-  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344530;
+  // the layout before the statistics page id, still read
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM_V1 = 344528;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
   Schema *schema_;
+  // ANALYZE 得到的统计信息所在的页, 没有统计信息时为 INVALID_PAGE_ID
+  page_id_t stats_page_id_{INVALID_PAGE_ID};
 };
 
 /**
@@ -73,12 +82,20 @@ class TableInfo {
 
   inline page_id_t GetRootPageId() const { return table_meta_->root_page_id_; }
 
+  inline TableMetadata *GetTableMetadata() const { return table_meta_; }
+
+  /** @return the statistics of the last ANALYZE, nullptr if the table was never analyzed */
+  inline const TableStatistics *GetStatistics() const { return statistics_.get(); }
+
+  inline void SetStatistics(TableStatistics *statistics) { statistics_.reset(statistics); }
+
  private:
   explicit TableInfo(){};
 
  private:
   TableMetadata *table_meta_;
   TableHeap *table_heap_;
+  std::unique_ptr<TableStatistics> statistics_;
 };
 
 #endif  // MINISQL_TABLE_H
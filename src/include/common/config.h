@@ -15,6 +15,23 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index
 
 static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_BTREE_CACHED_LEVELS = 2;   // b+ tree levels kept in memory (root + one level)
+static constexpr int LEAF_PREFETCH_DEPTH = 8;           // leaves a b+ tree range scan reads ahead of itself
+static constexpr int BLOOM_FILTER_BITS_PER_KEY = 10;    // ~1% false positives for a blocked bloom filter
+static constexpr int BLOOM_FILTER_INITIAL_KEYS = 1024;  // keys the first stage of a bloom filter is sized for
+static constexpr int STATS_SAMPLE_ROWS = 3000;          // rows sampled by ANALYZE for histograms and distinct counts
+static constexpr int STATS_HISTOGRAM_BUCKETS = 32;      // buckets of an equi-depth column histogram
+static constexpr int ROW_BATCH_SIZE = 1024;             // rows passed between executors per NextBatch call
+static constexpr int HASH_JOIN_MEMORY_BYTES = 4 << 20;  // build rows a hash join keeps in memory before spilling
+static constexpr int HASH_JOIN_PARTITIONS = 16;         // partitions a spilling hash join splits its inputs into
+static constexpr int HASH_AGG_MEMORY_BYTES = 4 << 20;   // groups a hash aggregation keeps in memory before spilling
+static constexpr int HASH_AGG_PARTITIONS = 16;          // partitions a spilling hash aggregation splits its input into
+static constexpr int SORT_MEMORY_BYTES = 4 << 20;       // rows a sort orders in memory before writing out a run
+static constexpr int SORT_MERGE_FAN_IN = 64;            // sorted runs merged at a time by an external sort
+static constexpr int DISTINCT_MEMORY_BYTES = 4 << 20;   // keys a hash distinct keeps in memory before spilling
+static constexpr int DISTINCT_PARTITIONS = 16;          // partitions a spilling hash distinct splits its input into
+static constexpr int TOP_N_MAX_ROWS = 65536;            // ORDER BY ... LIMIT n up to this n keeps n rows in a heap
+static constexpr int RESULT_SAMPLE_ROWS = 1024;         // rows a streamed result table sizes its columns from
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
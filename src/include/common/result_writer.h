@@ -8,8 +8,12 @@
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "record/field.h"
+#include "record/row_batch.h"
+#include "record/schema.h"
+
 class ResultWriter {
  public:
   explicit ResultWriter(std::ostream &stream, bool disable_header = false, const char *separator = "|")
@@ -22,7 +26,7 @@ class ResultWriter {
       stream_ << " " << std::setfill(' ') << std::setw(width) << std::left << cell << " " << separator_;
     }
   }
-  void Divider(vector<int> &data_width) {
+  void Divider(std::vector<int> &data_width) {
     stream_ << "+";
     for (auto width : data_width) {
       stream_ << std::setfill('-') << std::setw(width + 3) << std::right << "+";
@@ -30,7 +34,7 @@ class ResultWriter {
     stream_ << "\n";
   }
   void BeginRow() { stream_ << "|"; }
-  void EndRow() { stream_ << std::endl; }
+  void EndRow() { stream_ << "\n"; }
   void EndInformation(size_t result_size, double time, bool is_scan) {
     if (is_scan) {
       if (!result_size)
@@ -40,11 +44,58 @@ class ResultWriter {
     } else {
       stream_ << "Query OK, " << result_size << " row affected";
     }
-    stream_ << "(" << fixed << setprecision(4) << time / 1000 << " sec)." << std::endl;
+    stream_ << "(" << std::fixed << std::setprecision(4) << time / 1000 << " sec)." << std::endl;
   }
   bool disable_header_;
   std::ostream &stream_;
   std::string separator_;
 };
 
+enum class ResultFormat { kTable, kCsv, kTsv, kBinary };
+
+/**
+ * ResultSink writes the rows of a query to a stream batch by batch, as the executors produce them, so
+ * that neither the result nor its string form is ever held as a whole.
+ *
+ * kTable draws the usual box. Its column widths are either fixed, or taken from the header and the first
+ * RESULT_SAMPLE_ROWS rows, which are the only rows kept before the header goes out. Later rows that are
+ * wider than their column are written in full and simply push the border out.
+ *
+ * kCsv quotes fields as RFC 4180 does and writes null as an empty field. kTsv escapes tab, newline and
+ * backslash and writes null as \N.
+ *
+ * kBinary writes the output schema as Schema::SerializeTo does, then every row as a uint32_t length
+ * followed by Row::SerializeTo, and ends with a zero length.
+ */
+class ResultSink {
+ public:
+  /** @param fixed_width width of every table column, 0 samples the widths from the first rows */
+  ResultSink(std::ostream &stream, const Schema *schema, ResultFormat format, int fixed_width = 0);
+
+  /** Write the selected rows of a batch. */
+  void Write(const RowBatch &batch);
+
+  /** Write out the rows still held for sampling and close the result. */
+  void Finish();
+
+  inline size_t GetRowCount() const { return row_count_; }
+
+ private:
+  void WriteHeader();
+
+  void WriteTableRow(const std::vector<std::string> &cells);
+
+  void WriteDelimitedRow(const std::vector<std::string> &cells, const std::vector<bool> &nulls);
+
+  std::ostream &stream_;
+  const Schema *schema_;
+  ResultFormat format_;
+  ResultWriter writer_;
+  std::vector<int> widths_;
+  bool header_written_{false};
+  std::vector<std::vector<std::string>> sampled_;
+  std::string buf_;
+  size_t row_count_{0};
+};
+
 #endif  // MINISQL_RESULTWRITER_H
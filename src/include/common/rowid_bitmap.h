@@ -0,0 +1,73 @@
+#ifndef MINISQL_ROWID_BITMAP_H
+#define MINISQL_ROWID_BITMAP_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * RowIdBitmap is a compressed set of row ids in the spirit of roaring bitmaps.
+ *
+ * Row ids are bucketed by page id. Each page keeps its slot numbers in a sorted array while it is sparse and
+ * switches to a plain bitset once the bitset becomes the smaller of the two. Iteration yields row ids in
+ * (page, slot) order, which is the order a heap fetch wants them in.
+ */
+class RowIdBitmap {
+ public:
+  RowIdBitmap() = default;
+
+  void Add(const RowId &rid);
+
+  bool Contains(const RowId &rid) const;
+
+  size_t Cardinality() const;
+
+  bool Empty() const { return pages_.empty(); }
+
+  /** this = this AND other */
+  RowIdBitmap &IntersectWith(const RowIdBitmap &other);
+
+  /** this = this OR other */
+  RowIdBitmap &UnionWith(const RowIdBitmap &other);
+
+  /** @return all row ids, sorted by page and then by slot */
+  std::vector<RowId> ToVector() const;
+
+ private:
+  /** The slots of a single page. */
+  class Container {
+   public:
+    void Add(uint32_t slot);
+
+    bool Contains(uint32_t slot) const;
+
+    uint32_t Cardinality() const { return cardinality_; }
+
+    void AppendTo(page_id_t page_id, std::vector<RowId> &result) const;
+
+    static Container And(const Container &lhs, const Container &rhs);
+
+    static Container Or(const Container &lhs, const Container &rhs);
+
+   private:
+    /** Switch to whichever representation takes less memory. */
+    void Optimize();
+
+    void ToBitset();
+
+    void ToArray();
+
+    bool is_bitset_{false};
+    /** sorted slot numbers, used while the page is sparse */
+    std::vector<uint16_t> array_;
+    /** one bit per slot, used once the page is dense */
+    std::vector<uint64_t> bits_;
+    uint32_t cardinality_{0};
+  };
+
+  std::map<page_id_t, Container> pages_;
+};
+
+#endif  // MINISQL_ROWID_BITMAP_H
@@ -1,12 +1,14 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
 #include "common/dberr.h"
 #include "common/instance.h"
+#include "common/result_writer.h"
 #include "concurrency/txn.h"
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
@@ -38,6 +40,21 @@ class ExecuteEngine {
   dberr_t ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<Row> *result_set, Txn *txn,
                       ExecuteContext *exec_ctx);
 
+  /**
+   * Run the plan and hand every batch to consumer as soon as the root executor produces it.
+   */
+  dberr_t ExecutePlan(const AbstractPlanNodeRef &plan, const std::function<void(const RowBatch &)> &consumer,
+                      Txn *txn, ExecuteContext *exec_ctx);
+
+  /**
+   * How the rows of a SELECT are written to std::cout.
+   * @param fixed_width width of every table column, 0 sizes the columns from the first rows
+   */
+  void SetResultFormat(ResultFormat format, int fixed_width = 0) {
+    result_format_ = format;
+    fixed_width_ = fixed_width;
+  }
+
   void ExecuteInformation(dberr_t result);
 
  private:
@@ -73,9 +90,13 @@ class ExecuteEngine {
 
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context);
+
  private:
   std::unordered_map<std::string, DBStorageEngine *> dbs_; /** all opened databases */
   std::string current_db_;                                 /** current database */
+  ResultFormat result_format_{ResultFormat::kTable};       /** output format of a select */
+  int fixed_width_{0};                                     /** fixed table column width, 0 for sampled */
 };
 
 #endif  // MINISQL_EXECUTE_ENGINE_H
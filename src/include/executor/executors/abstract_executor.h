@@ -2,8 +2,11 @@
 #define MINISQL_ABSTRACT_EXECUTOR_H
 
 #include "executor/execute_context.h"
+#include "record/row_batch.h"
+
 /**
- * The AbstractExecutor implements the Volcano row-at-a-time iterator model.
+ * The AbstractExecutor implements the Volcano row-at-a-time iterator model, plus a batch-at-a-time
+ * NextBatch() that scans and DML executors implement natively.
  * This is the base class from which all executors in the execution engine
  * inherit, and defines the minimal interface that all executors support.
  */
@@ -32,6 +35,22 @@ class AbstractExecutor {
    */
   virtual bool Next(Row *row, RowId *rid) = 0;
 
+  /**
+   * Yield the next batch of at most ROW_BATCH_SIZE rows, laid out by GetOutputSchema(). The default adapter
+   * fills the batch from Next() one row at a time.
+   * @param[out] batch The rows produced by this executor, only the selected ones are part of the result
+   * @return `true` if at least one row was selected, `false` if there are no more rows
+   */
+  virtual bool NextBatch(RowBatch *batch) {
+    batch->Reset(GetOutputSchema());
+    Row row;
+    RowId rid;
+    while (!batch->Full() && Next(&row, &rid)) {
+      batch->Append(row, rid);
+    }
+    return batch->Size() > 0;
+  }
+
   /** @return The schema of the rows that this executor produces */
   virtual const Schema *GetOutputSchema() const = 0;
 
@@ -0,0 +1,107 @@
+#ifndef MINISQL_AGGREGATION_EXECUTOR_H
+#define MINISQL_AGGREGATION_EXECUTOR_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/aggregation_plan.h"
+#include "storage/temp_row_file.h"
+
+/**
+ * The AggregationExecutor is a hash aggregation. Groups live in an open addressing table keyed by the
+ * memcomparable encoding of their group-by values, and every input row is folded into the running values
+ * of its group as it arrives.
+ *
+ * Once the groups outgrow the memory budget of the plan no new group is added: rows of the groups already
+ * in the table are still folded in, the rows of any other group are split by hash into HASH_AGG_PARTITIONS
+ * temporary files. After the groups in memory have been emitted, the partitions are aggregated one by one.
+ */
+class AggregationExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new AggregationExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The aggregation plan to be executed
+   * @param child_executor The child executor producing the rows to aggregate
+   */
+  AggregationExecutor(ExecuteContext *exec_ctx, const AggregationPlanNode *plan,
+                      std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /** Initialize the aggregation, the child is read to the end */
+  void Init() override;
+
+  /**
+   * Yield the row of the next group.
+   * @param[out] row The next group, laid out by the output schema
+   * @param[out] rid Unused, a group has no RowId
+   * @return `true` if a row was produced, `false` if there are no more groups
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the aggregation */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+  /** @return Whether some groups did not fit in the memory budget */
+  inline bool IsSpilled() const { return spilled_; }
+
+ private:
+  /** Running value of one aggregate, sums of ints and floats are kept wider than their columns */
+  struct AggregateValue {
+    bool is_null_{true};
+    int64_t count_{0};
+    int64_t int_{0};
+    double float_{0};
+    /** The least or greatest value so far, for MIN and MAX */
+    std::unique_ptr<Field> extreme_;
+  };
+
+  struct Group {
+    std::string key_;
+    size_t hash_;
+    Row values_;
+    std::vector<AggregateValue> aggregates_;
+  };
+
+  /** Encode the group-by values of row into key. */
+  void MakeKey(const Row &row, std::string *key) const;
+
+  /**
+   * Find the group of a key, a missing group is added if insert is set.
+   * @return nullptr if the group is missing and insert is not set
+   */
+  Group *FindGroup(const std::string &key, size_t hash, const Row &row, bool insert);
+
+  /** Double the slots of the table and put every group back. */
+  void Grow();
+
+  /** Drop every group. */
+  void Clear();
+
+  /** Fold a row into the aggregates of its group. */
+  void Accumulate(Group *group, const Row &row) const;
+
+  /** @return The final value of the i-th aggregate of a group */
+  Field GetAggregate(const Group &group, size_t i) const;
+
+  /** Aggregate the rows of the next partition that holds any. @return `false` if there is none */
+  bool LoadPartition();
+
+  inline size_t PartitionOf(size_t hash) const { return (hash >> 32) % HASH_AGG_PARTITIONS; }
+
+  const AggregationPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Open addressing with linear probing, a slot holds 1 + the position of its group or 0 when empty */
+  std::vector<uint32_t> slots_;
+  std::deque<Group> groups_;
+  size_t group_bytes_{0};
+  bool spilled_{false};
+  std::vector<std::unique_ptr<TempRowFile>> partitions_;
+  size_t partition_{0};
+  size_t cursor_{0};
+};
+
+#endif  // MINISQL_AGGREGATION_EXECUTOR_H
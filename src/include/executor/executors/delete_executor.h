@@ -40,17 +40,33 @@ class DeleteExecutor : public AbstractExecutor {
    */
   bool Next(Row *row, RowId *rid) override;
 
+  /**
+   * Delete every selected row of the next child batch, the deleted rows are yielded back. Index keys are
+   * read straight from the columns of the batch.
+   */
+  bool NextBatch(RowBatch *batch) override;
+
   /** @return The output schema for the delete */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  /** Mark the row deleted and buffer its index keys, `false` if it could not be deleted. */
+  bool DeleteRow(Row &row, const RowId &rid);
+
+  /** Remove the buffered keys from every index, once the child has produced every row to delete */
+  void FlushIndexes();
+
   /** The delete plan node to be executed */
   const DeletePlanNode *plan_;
   TableInfo *table_info_{};
   Txn *txn_;
   std::vector<IndexInfo *> index_info_;
+  /** Keys to remove from index_info_[i], applied in one batch per index at the end of the statement */
+  std::vector<std::vector<std::pair<Row, RowId>>> pending_removes_;
   /** The child executor from which RIDs for deleted rows are pulled */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Set once a row failed to delete, nothing after it is deleted */
+  bool done_{false};
 };
 
 #endif  // MINISQL_DELETE_EXECUTOR_H
@@ -0,0 +1,54 @@
+#ifndef MINISQL_HASH_DISTINCT_EXECUTOR_H
+#define MINISQL_HASH_DISTINCT_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/distinct_plan.h"
+#include "storage/temp_row_file.h"
+
+/**
+ * The HashDistinctExecutor remembers the memcomparable key of every row it has yielded and passes on a row
+ * as soon as its key is new, so the first rows come out before the child is exhausted.
+ *
+ * Once the keys outgrow the memory budget of the plan no key is added: rows with a known key are still
+ * dropped, the rows of any other key are split by hash into DISTINCT_PARTITIONS temporary files. After the
+ * child is exhausted every partition is deduplicated on its own, none of its keys has been yielded yet.
+ */
+class HashDistinctExecutor : public AbstractExecutor {
+ public:
+  HashDistinctExecutor(ExecuteContext *exec_ctx, const DistinctPlanNode *plan,
+                       std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  void Init() override;
+
+  bool Next(Row *row, RowId *rid) override;
+
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+  /** @return Whether some keys did not fit in the memory budget */
+  inline bool IsSpilled() const { return spilled_; }
+
+ private:
+  /** Read the next row of the child, then of the partitions one by one. */
+  bool NextInput(Row *row);
+
+  inline size_t PartitionOf(size_t hash) const { return (hash >> 32) % DISTINCT_PARTITIONS; }
+
+  const DistinctPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  std::unordered_set<std::string> seen_;
+  size_t seen_bytes_{0};
+  RowBatch batch_;
+  size_t batch_pos_{0};
+  bool child_done_{false};
+  bool spilled_{false};
+  std::vector<std::unique_ptr<TempRowFile>> partitions_;
+  size_t partition_{0};
+};
+
+#endif  // MINISQL_HASH_DISTINCT_EXECUTOR_H
@@ -0,0 +1,91 @@
+#ifndef MINISQL_HASH_JOIN_EXECUTOR_H
+#define MINISQL_HASH_JOIN_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/hash_join_plan.h"
+#include "storage/temp_row_file.h"
+
+/**
+ * The HashJoinExecutor puts the rows of the build child in a hash table keyed by their join keys and looks
+ * up every row of the probe child in it. Rows with a null key never match and are dropped on both sides.
+ *
+ * Once the build rows outgrow the memory budget of the plan the join turns into a grace hash join: the rows
+ * of both children are split by the hash of their key into HASH_JOIN_PARTITIONS temporary files and the
+ * partitions are joined one pair at a time, so only one build partition is in memory at once.
+ */
+class HashJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new HashJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The hash join plan to be executed
+   * @param left_executor The child executor producing the left rows
+   * @param right_executor The child executor producing the right rows
+   */
+  HashJoinExecutor(ExecuteContext *exec_ctx, const HashJoinPlanNode *plan,
+                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                   std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  /** Initialize the join, the build child is read to the end and the probe child is partitioned if needed */
+  void Init() override;
+
+  /**
+   * Yield the next joined row.
+   * @param[out] row The next joined row, laid out by the output schema
+   * @param[out] rid Unused, a joined row has no RowId
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the join */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+  /** @return Whether the build rows did not fit in the memory budget */
+  inline bool IsSpilled() const { return spilled_; }
+
+ private:
+  /**
+   * Encode the values of the key expressions on row into a byte string that is equal for equal keys.
+   * @return `false` if one of the values is null
+   */
+  static bool EncodeKey(const Row &row, const std::vector<AbstractExpressionRef> &keys, std::string *key);
+
+  /** Move the hash table into the build partitions and send the rest of the rows there. */
+  void Spill();
+
+  /** Put the rows of a build partition in the hash table. */
+  void LoadPartition(size_t partition);
+
+  /** Read the next probe row, from the probe child or from the probe partitions once spilled. */
+  bool NextProbeRow(Row *row);
+
+  inline size_t PartitionOf(const std::string &key) const {
+    return std::hash<std::string>()(key) % HASH_JOIN_PARTITIONS;
+  }
+
+  const HashJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  AbstractExecutor *build_executor_;
+  AbstractExecutor *probe_executor_;
+  const std::vector<AbstractExpressionRef> *build_keys_;
+  const std::vector<AbstractExpressionRef> *probe_keys_;
+  std::unordered_map<std::string, std::vector<Row>> hash_table_;
+  size_t table_bytes_{0};
+  bool spilled_{false};
+  std::vector<std::unique_ptr<TempRowFile>> build_partitions_;
+  std::vector<std::unique_ptr<TempRowFile>> probe_partitions_;
+  size_t partition_{0};
+  /** The probe row being joined and the build rows with its key */
+  Row probe_row_;
+  const std::vector<Row> *matches_{nullptr};
+  size_t match_cursor_{0};
+};
+
+#endif  // MINISQL_HASH_JOIN_EXECUTOR_H
@@ -0,0 +1,71 @@
+#ifndef MINISQL_INDEX_NESTED_LOOP_JOIN_EXECUTOR_H
+#define MINISQL_INDEX_NESTED_LOOP_JOIN_EXECUTOR_H
+
+#include <memory>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/index_nested_loop_join_plan.h"
+
+/**
+ * The IndexNestedLoopJoinExecutor looks up the inner table through an index for every outer row. The outer
+ * rows are read ROW_BATCH_SIZE at a time and probed in key order, so that consecutive lookups walk the
+ * index leaves forward and equal keys are looked up once. The RowIds of a key are sorted before the heap
+ * is read, which fetches each heap page once per key.
+ */
+class IndexNestedLoopJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new IndexNestedLoopJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The index nested loop join plan to be executed
+   * @param outer_executor The child executor producing the outer rows
+   */
+  IndexNestedLoopJoinExecutor(ExecuteContext *exec_ctx, const IndexNestedLoopJoinPlanNode *plan,
+                              std::unique_ptr<AbstractExecutor> &&outer_executor);
+
+  /** Initialize the join */
+  void Init() override;
+
+  /**
+   * Yield the next joined row.
+   * @param[out] row The next joined row, laid out by the output schema
+   * @param[out] rid Unused, a joined row has no RowId
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the join */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+  /** @return The number of index lookups so far */
+  inline size_t GetProbeCount() const { return probe_count_; }
+
+ private:
+  /**
+   * Read the next batch of outer rows and order the ones with a non-null key by key.
+   * @return `false` once the outer side is exhausted
+   */
+  bool NextOuterBatch();
+
+  /** Find the inner rows matching the key of the i-th outer row, the previous probe is reused for an equal key. */
+  void ProbeInner(size_t i);
+
+  const IndexNestedLoopJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> outer_executor_;
+  TableInfo *table_info_{nullptr};
+  std::vector<Row> outer_rows_;
+  std::vector<Row> keys_;
+  /** Positions of the outer rows to probe, in key order */
+  std::vector<size_t> order_;
+  size_t probe_{0};
+  size_t current_{0};
+  bool has_last_probe_{false};
+  size_t last_probe_{0};
+  std::vector<Row> matches_;
+  size_t match_cursor_{0};
+  size_t probe_count_{0};
+};
+
+#endif  // MINISQL_INDEX_NESTED_LOOP_JOIN_EXECUTOR_H
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/index_only_scan_plan.h"
+#include "index/b_plus_tree_index.h"
+
+/**
+ * The IndexOnlyScanExecutor produces rows straight from the keys of a covering index.
+ */
+class IndexOnlyScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new IndexOnlyScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The index-only scan plan to be executed
+   */
+  IndexOnlyScanExecutor(ExecuteContext *exec_ctx, const IndexOnlyScanPlanNode *plan);
+
+  /** Initialize the index-only scan */
+  void Init() override;
+
+  /**
+   * Yield the next row from the index-only scan.
+   * @param[out] row The next row produced by the scan
+   * @param[out] rid The next row RID produced by the scan
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the index-only scan */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  /** The index-only scan plan node to be executed */
+  const IndexOnlyScanPlanNode *plan_;
+  TableInfo *table_info_{};
+  /** The streaming cursor over the key range */
+  std::unique_ptr<IndexRangeScan> scan_;
+  /** Position of each table column inside the index key, -1 if the column is not in the key */
+  std::vector<int> key_pos_;
+};
@@ -4,7 +4,10 @@
 
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
+#include "common/rowid_bitmap.h"
 #include "executor/plans/index_scan_plan.h"
+#include "index/b_plus_tree_index.h"
+#include "index/hash_index.h"
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 
@@ -31,6 +34,12 @@ class IndexScanExecutor : public AbstractExecutor {
    */
   bool Next(Row *row, RowId *rid) override;
 
+  /**
+   * Yield the next batch of rows: up to ROW_BATCH_SIZE tuples are read, the predicate is evaluated on the
+   * whole batch and the output columns are picked from the survivors.
+   */
+  bool NextBatch(RowBatch *batch) override;
+
   /** @return The output schema for the sequential scan */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
@@ -38,13 +47,37 @@ class IndexScanExecutor : public AbstractExecutor {
 
   void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
 
+  /** Open a streaming scan over the key range of a b+ tree index. */
+  static std::unique_ptr<IndexRangeScan> OpenKeyRange(const IndexKeyRange &range, Txn *txn);
+
  private:
-  vector<RowId> IndexScan(AbstractExpressionRef predicate);
+  /** Whether the range is a point lookup on an index that cannot scan a key range (hash or art). */
+  static bool IsKeyLookup(const IndexKeyRange &range);
+
+  /** Probe the index with the full key held in range.lower_. */
+  void LookupKey(const IndexKeyRange &range, std::vector<RowId> &result);
+
+  /** Evaluate a bitmap condition into the set of RowIds it selects. */
+  RowIdBitmap BuildBitmap(const IndexBitmapCondition &condition);
+
+  /** Pull the next RowId inside the key range, either from the live scan or from the snapshot. */
+  bool NextRowId(RowId *rid);
+
+  /** Pull the next tuple, in bitmap heap scan mode it comes from the batch of the current page. */
+  bool NextTuple(Row *tuple);
 
   /** The sequential scan plan node to be executed */
   const IndexScanPlanNode *plan_;
   TableInfo *table_info_{};
+  /** The streaming cursor over the key range */
+  std::unique_ptr<IndexRangeScan> scan_;
+  /** RowIds collected up front when plan_->snapshot_rids_ is set, otherwise the current leaf of scan_ */
   vector<RowId> result_;
   size_t cursor_ = 0;
+  /** Tuples read from the current heap page in bitmap heap scan mode */
+  vector<Row> batch_;
+  size_t batch_cursor_ = 0;
   bool is_schema_same_;
+  /** Tuples of the current batch with every column of the table, before the projection */
+  RowBatch table_batch_;
 };
\ No newline at end of file
@@ -38,16 +38,28 @@ class InsertExecutor : public AbstractExecutor {
    */
   bool Next([[maybe_unused]] Row *row, RowId *rid) override;
 
+  /** Insert every selected row of the next child batch, the output batch holds one RowId per inserted row. */
+  bool NextBatch(RowBatch *batch) override;
+
   /** @return The output schema for the insert */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  /**
+   * Insert a row into the table and its indexes.
+   * @return `false` if the row breaks a unique index or does not fit, the statement stops there
+   */
+  bool InsertRow(Row &insert_row);
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableInfo *table_info_{};
   const Schema *schema_{};
   std::vector<IndexInfo *> index_info_;
+  RowBatch child_batch_;
+  /** Set once a row failed to insert, nothing after it is inserted */
+  bool done_{false};
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -0,0 +1,24 @@
+#ifndef MINISQL_JOIN_HELPER_H
+#define MINISQL_JOIN_HELPER_H
+
+#include <vector>
+
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Build the output row of a join from a pair of matching rows. The joined row is the left row followed by
+ * the right row, output_schema picks its columns from it by GetTableInd().
+ */
+inline void JoinRows(const Row &left, const Row &right, const Schema *output_schema, Row *output_row) {
+  std::vector<Field> fields;
+  fields.reserve(output_schema->GetColumnCount());
+  uint32_t left_count = left.GetFieldCount();
+  for (auto column : output_schema->GetColumns()) {
+    uint32_t idx = column->GetTableInd();
+    fields.emplace_back(idx < left_count ? *left.GetField(idx) : *right.GetField(idx - left_count));
+  }
+  *output_row = Row(fields);
+}
+
+#endif  // MINISQL_JOIN_HELPER_H
@@ -0,0 +1,34 @@
+#ifndef MINISQL_LIMIT_EXECUTOR_H
+#define MINISQL_LIMIT_EXECUTOR_H
+
+#include <memory>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/limit_plan.h"
+
+/**
+ * The LimitExecutor passes on the first rows of its child and then stops pulling from it. Below
+ * ROW_BATCH_SIZE remaining rows it asks the child for one row at a time, so that a small limit does not
+ * make the child produce a whole batch.
+ */
+class LimitExecutor : public AbstractExecutor {
+ public:
+  LimitExecutor(ExecuteContext *exec_ctx, const LimitPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  void Init() override;
+
+  bool Next(Row *row, RowId *rid) override;
+
+  bool NextBatch(RowBatch *batch) override;
+
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  const LimitPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Rows still to be passed on */
+  size_t remaining_{0};
+};
+
+#endif  // MINISQL_LIMIT_EXECUTOR_H
@@ -0,0 +1,52 @@
+#ifndef MINISQL_NESTED_LOOP_JOIN_EXECUTOR_H
+#define MINISQL_NESTED_LOOP_JOIN_EXECUTOR_H
+
+#include <memory>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/nested_loop_join_plan.h"
+
+/**
+ * The NestedLoopJoinExecutor keeps the rows of the right child in memory and compares every row of the left
+ * child with all of them. It serves the joins without an equality between the two sides.
+ */
+class NestedLoopJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new NestedLoopJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The nested loop join plan to be executed
+   * @param left_executor The child executor producing the outer rows
+   * @param right_executor The child executor producing the inner rows
+   */
+  NestedLoopJoinExecutor(ExecuteContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
+                         std::unique_ptr<AbstractExecutor> &&left_executor,
+                         std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  /** Initialize the join, the right child is read to the end */
+  void Init() override;
+
+  /**
+   * Yield the next joined row.
+   * @param[out] row The next joined row, laid out by the output schema
+   * @param[out] rid Unused, a joined row has no RowId
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the join */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  const NestedLoopJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  std::vector<Row> right_rows_;
+  Row left_row_;
+  bool has_left_{false};
+  size_t right_cursor_{0};
+};
+
+#endif  // MINISQL_NESTED_LOOP_JOIN_EXECUTOR_H
@@ -34,6 +34,12 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   bool Next(Row *row, RowId *rid) override;
 
+  /**
+   * Yield the next batch of rows: up to ROW_BATCH_SIZE tuples that passed the predicate inside their page are
+   * collected and the output columns are picked from them.
+   */
+  bool NextBatch(RowBatch *batch) override;
+
   /** @return The output schema for the sequential scan */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
@@ -42,12 +48,21 @@ class SeqScanExecutor : public AbstractExecutor {
   void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
 
  private:
+  /** Point row at the next tuple that passed the predicate, scanning the next page when the current one is used up */
+  bool NextRow(Row **row);
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_{};
-  TableIterator iterator_;
+  /** The page ScanPage reads next */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** The tuples of the last scanned page that passed the predicate, and the next one to hand out */
+  std::vector<Row> page_rows_;
+  size_t cursor_{0};
   const Schema *schema_{};
   bool is_schema_same_;
+  /** Rows of the current batch with every column of the table, before the projection */
+  RowBatch table_batch_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
@@ -0,0 +1,34 @@
+#ifndef MINISQL_SORT_DISTINCT_EXECUTOR_H
+#define MINISQL_SORT_DISTINCT_EXECUTOR_H
+
+#include <memory>
+#include <string>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/distinct_plan.h"
+
+/**
+ * The SortDistinctExecutor deduplicates a child whose equal rows are next to each other, such as an index
+ * scan on the selected columns or a sort on all of them: a row is passed on unless its key is the key of the
+ * row before it, so only that one key is kept.
+ */
+class SortDistinctExecutor : public AbstractExecutor {
+ public:
+  SortDistinctExecutor(ExecuteContext *exec_ctx, const DistinctPlanNode *plan,
+                       std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  void Init() override;
+
+  bool Next(Row *row, RowId *rid) override;
+
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  const DistinctPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  std::string last_key_;
+  bool has_last_{false};
+};
+
+#endif  // MINISQL_SORT_DISTINCT_EXECUTOR_H
@@ -0,0 +1,92 @@
+#ifndef MINISQL_SORT_EXECUTOR_H
+#define MINISQL_SORT_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/sort_plan.h"
+#include "storage/temp_row_file.h"
+
+/**
+ * The SortExecutor is an external merge sort. Every row is given a normalized key, the memcomparable
+ * encoding of its ORDER BY values with the bytes of descending keys inverted, so rows are ordered with
+ * memcmp alone. Rows are sorted in memory up to the memory budget of the plan; past it the sorted rows are
+ * written out as a run to temporary pages. The runs, plus the rows still in memory, are merged with a loser
+ * tree, in several passes when there are more of them than the merge fan-in.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new SortExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The sort plan to be executed
+   * @param child_executor The child executor producing the rows to sort
+   */
+  SortExecutor(ExecuteContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /** Initialize the sort, the child is read to the end */
+  void Init() override;
+
+  /**
+   * Yield the next row in order.
+   * @param[out] row The next row, laid out by the output schema
+   * @param[out] rid The RowId of the row of the child
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the sort */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+  /** @return The number of runs written to temporary pages, merged runs included */
+  inline size_t GetRunCount() const { return run_count_; }
+
+ private:
+  struct Entry {
+    std::string key_;
+    std::unique_ptr<Row> row_;
+  };
+
+  /** A sorted sequence being merged, a run or, if file_ is null, the rows left in memory */
+  struct MergeSource {
+    TempRowFile *file_;
+    std::string key_;
+    Row row_;
+    bool done_{false};
+  };
+
+  /** Sort the rows in memory and write them out as a run. */
+  void WriteRun();
+
+  /** Start merging the given runs, followed by the rows in memory if with_memory is set. */
+  void StartMerge(const std::vector<TempRowFile *> &runs, bool with_memory);
+
+  /** Take the least row of the merge into row. @return `false` once every source is exhausted */
+  bool MergeNext(Row *row);
+
+  /** Read the next row of a source. */
+  void Advance(size_t source);
+
+  /** Replay the matches of a source from its leaf to the root of the loser tree. */
+  void Adjust(size_t source);
+
+  /** @return Whether source a comes before source b, the sentinel index sources_.size() comes first */
+  bool Less(size_t a, size_t b) const;
+
+  const SortPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  std::vector<Entry> entries_;
+  size_t entry_bytes_{0};
+  std::vector<std::unique_ptr<TempRowFile>> runs_;
+  size_t run_count_{0};
+  /** tree_[0] is the source of the least row, tree_[i] the loser of the match at internal node i */
+  std::vector<MergeSource> sources_;
+  std::vector<size_t> tree_;
+  size_t cursor_{0};
+  Row child_row_;
+};
+
+#endif  // MINISQL_SORT_EXECUTOR_H
@@ -0,0 +1,43 @@
+#ifndef MINISQL_SORT_HELPER_H
+#define MINISQL_SORT_HELPER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "executor/plans/sort_plan.h"
+#include "index/generic_key.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Encode the normalized ORDER BY key of a row: the memcmp-comparable encoding of the key values, with the
+ * bytes of descending keys inverted, so that rows are ordered by comparing their keys with memcmp.
+ */
+inline void MakeSortKey(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys, const Row &row,
+                        std::string *key) {
+  key->clear();
+  for (const auto &order_by : order_bys) {
+    size_t ofs = key->size();
+    KeyManager::AppendField(order_by.second->Evaluate(&row), key);
+    if (order_by.first == OrderByType::Desc) {
+      // 取反后字节序整体反转; 字符串的结尾 0 变成 0xff, 所以前缀排在更长的串之后
+      for (size_t i = ofs; i < key->size(); i++) {
+        (*key)[i] = static_cast<char>(~(*key)[i]);
+      }
+    }
+  }
+}
+
+/** Build the output row of a sort, output_schema picks its columns from the row by GetTableInd(). */
+inline void ProjectRow(const Row &row, const Schema *output_schema, Row *output_row) {
+  std::vector<Field> fields;
+  fields.reserve(output_schema->GetColumnCount());
+  for (auto column : output_schema->GetColumns()) {
+    fields.emplace_back(*row.GetField(column->GetTableInd()));
+  }
+  *output_row = Row(fields);
+  output_row->SetRowId(row.GetRowId());
+}
+
+#endif  // MINISQL_SORT_HELPER_H
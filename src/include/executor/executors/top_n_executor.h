@@ -0,0 +1,47 @@
+#ifndef MINISQL_TOP_N_EXECUTOR_H
+#define MINISQL_TOP_N_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/top_n_plan.h"
+
+/**
+ * The TopNExecutor keeps the first n rows of its child, by their normalized ORDER BY keys, in a max-heap
+ * of n entries: a row that does not come before the last of them is dropped right away, otherwise it
+ * replaces that last row. Rows with equal keys keep the order in which they were read.
+ */
+class TopNExecutor : public AbstractExecutor {
+ public:
+  TopNExecutor(ExecuteContext *exec_ctx, const TopNPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /** Initialize the executor, the child is read to the end */
+  void Init() override;
+
+  bool Next(Row *row, RowId *rid) override;
+
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  struct Entry {
+    std::string key_;
+    /** Position of the row in the input, it breaks ties between equal keys */
+    size_t seq_;
+    std::unique_ptr<Row> row_;
+  };
+
+  static bool EntryLess(const Entry &a, const Entry &b) {
+    int cmp = a.key_.compare(b.key_);
+    return cmp < 0 || (cmp == 0 && a.seq_ < b.seq_);
+  }
+
+  const TopNPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  std::vector<Entry> heap_;
+  size_t cursor_{0};
+};
+
+#endif  // MINISQL_TOP_N_EXECUTOR_H
@@ -35,10 +35,9 @@ class UpdateExecutor : public AbstractExecutor {
    * @param[out] rid The next row RID produced by the update
    * @return `true` if a row was produced, `false` if there are no more rows
    *
-   * NOTE: UpdateExecutor::Next() does not use the `row` out-parameter.
-   * NOTE: UpdateExecutor::Next() does not use the `rid` out-parameter.
+   * NOTE: UpdateExecutor::Next() yields the updated row and its RID.
    */
-  bool Next([[maybe_unused]] Row *row, RowId *rid) override;
+  bool Next(Row *row, RowId *rid) override;
 
   /** @return The output schema for the update */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
@@ -51,12 +50,22 @@ class UpdateExecutor : public AbstractExecutor {
    */
   Row GenerateUpdatedTuple(const Row &src_row);
 
+  /** Move the buffered entries of every index from the old keys to the new ones */
+  void FlushIndexes();
+
   /** The update plan node to be executed */
   const UpdatePlanNode *plan_;
   /** Metadata identifying the table that should be updated */
   TableInfo *table_info_;
   Txn *txn_;
+  /** Indexes with a key column assigned by the SET clause, the others never change */
   std::vector<IndexInfo *> index_info_;
+  /**
+   * Old and new keys of index_info_[i]. All old keys are removed before any new key is added, so a new
+   * key may reuse the old key of another updated row even in a unique index.
+   */
+  std::vector<std::vector<std::pair<Row, RowId>>> pending_removes_;
+  std::vector<std::vector<std::pair<Row, RowId>>> pending_inserts_;
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
 };
@@ -15,14 +15,19 @@
 enum class PlanType {
   SeqScan,
   IndexScan,
+  IndexOnlyScan,
   Insert,
   Update,
   Delete,
   Values,
   Aggregation,
+  Sort,
   Limit,
+  TopN,
   Distinct,
   NestedLoopJoin,
+  HashJoin,
+  IndexNestedLoopJoin,
 };
 
 class AbstractPlanNode;
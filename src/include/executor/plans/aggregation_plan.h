@@ -0,0 +1,72 @@
+#ifndef MINISQL_AGGREGATION_PLAN_H
+#define MINISQL_AGGREGATION_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/** The aggregate functions of SELECT. */
+enum class AggregationType {
+  CountStarAggregate,
+  CountAggregate,
+  SumAggregate,
+  MinAggregate,
+  MaxAggregate,
+  AvgAggregate
+};
+
+/**
+ * AggregationPlanNode groups the rows of its child by the group-by expressions and computes the aggregates
+ * of every group. A group yields its group-by values followed by its aggregate values, and the output
+ * schema picks its columns from them by GetTableInd(). Without group-by expressions the whole input is a
+ * single group, which yields a row even when the input is empty.
+ */
+class AggregationPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new AggregationPlanNode.
+   * @param group_bys The expressions rows are grouped by
+   * @param aggregates The argument of every aggregate, null for COUNT(*)
+   * @param agg_types The function of every aggregate
+   */
+  AggregationPlanNode(const Schema *output, AbstractPlanNodeRef child, std::vector<AbstractExpressionRef> group_bys,
+                      std::vector<AbstractExpressionRef> aggregates, std::vector<AggregationType> agg_types)
+      : AbstractPlanNode(output, {std::move(child)}),
+        group_bys_(std::move(group_bys)),
+        aggregates_(std::move(aggregates)),
+        agg_types_(std::move(agg_types)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Aggregation; }
+
+  AbstractPlanNodeRef GetChildPlan() const { return GetChildAt(0); }
+
+  const std::vector<AbstractExpressionRef> &GetGroupBys() const { return group_bys_; }
+
+  const std::vector<AbstractExpressionRef> &GetAggregates() const { return aggregates_; }
+
+  const std::vector<AggregationType> &GetAggregateTypes() const { return agg_types_; }
+
+  /** @return The type of the value an aggregate yields, arg_type is the type of its argument */
+  static TypeId GetResultType(AggregationType type, TypeId arg_type) {
+    switch (type) {
+      case AggregationType::CountStarAggregate:
+      case AggregationType::CountAggregate:
+        return TypeId::kTypeInt;
+      case AggregationType::AvgAggregate:
+        return TypeId::kTypeFloat;
+      default:
+        return arg_type;
+    }
+  }
+
+  std::vector<AbstractExpressionRef> group_bys_;
+  std::vector<AbstractExpressionRef> aggregates_;
+  std::vector<AggregationType> agg_types_;
+  /** Bytes of groups held in memory, past this the rows of new groups are spilled to temporary pages */
+  size_t memory_budget_{HASH_AGG_MEMORY_BYTES};
+};
+
+#endif  // MINISQL_AGGREGATION_PLAN_H
@@ -0,0 +1,34 @@
+#ifndef MINISQL_DISTINCT_PLAN_H
+#define MINISQL_DISTINCT_PLAN_H
+
+#include <utility>
+
+#include "abstract_plan.h"
+
+/**
+ * DistinctPlanNode drops the rows of its child that are equal, in every column, to a row it has already
+ * yielded. The rows are passed through as they are.
+ */
+class DistinctPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new DistinctPlanNode.
+   * @param input_ordered Whether equal rows of the child are next to each other, then only the previous row
+   * is remembered instead of every row in a hash table
+   */
+  DistinctPlanNode(const Schema *output, AbstractPlanNodeRef child, bool input_ordered)
+      : AbstractPlanNode(output, {std::move(child)}), input_ordered_(input_ordered) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Distinct; }
+
+  AbstractPlanNodeRef GetChildPlan() const { return GetChildAt(0); }
+
+  bool IsInputOrdered() const { return input_ordered_; }
+
+  bool input_ordered_;
+  /** Bytes of keys a hash distinct keeps in memory, past this the rows of new keys are spilled */
+  size_t memory_budget_{DISTINCT_MEMORY_BYTES};
+};
+
+#endif  // MINISQL_DISTINCT_PLAN_H
@@ -0,0 +1,51 @@
+#ifndef MINISQL_HASH_JOIN_PLAN_H
+#define MINISQL_HASH_JOIN_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/**
+ * HashJoinPlanNode joins the rows of its children whose join keys are all equal. The rows of one child are
+ * put in a hash table and the rows of the other probe it. A joined row is the left row followed by the
+ * right row, whichever side is built, and the output schema picks its columns by GetTableInd().
+ */
+class HashJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new HashJoinPlanNode.
+   * @param left_keys The key expressions evaluated on a left row
+   * @param right_keys The key expressions evaluated on a right row, in the same order as left_keys
+   * @param predicate The rest of the join condition, evaluated with EvaluateJoin() on matching pairs, may be null
+   * @param build_left Whether the hash table is built from the left child
+   */
+  HashJoinPlanNode(const Schema *output, AbstractPlanNodeRef left, AbstractPlanNodeRef right,
+                   std::vector<AbstractExpressionRef> left_keys, std::vector<AbstractExpressionRef> right_keys,
+                   AbstractExpressionRef predicate, bool build_left)
+      : AbstractPlanNode(output, {std::move(left), std::move(right)}),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)),
+        predicate_(std::move(predicate)),
+        build_left_(build_left) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::HashJoin; }
+
+  AbstractPlanNodeRef GetLeftPlan() const { return GetChildAt(0); }
+
+  AbstractPlanNodeRef GetRightPlan() const { return GetChildAt(1); }
+
+  AbstractExpressionRef GetPredicate() const { return predicate_; }
+
+  std::vector<AbstractExpressionRef> left_keys_;
+  std::vector<AbstractExpressionRef> right_keys_;
+  AbstractExpressionRef predicate_;
+  /** Build on the left child, which is estimated to be the smaller one */
+  bool build_left_;
+  /** Bytes of build rows held in memory, past this the join falls back to partitions on temporary pages */
+  size_t memory_budget_{HASH_JOIN_MEMORY_BYTES};
+};
+
+#endif  // MINISQL_HASH_JOIN_PLAN_H
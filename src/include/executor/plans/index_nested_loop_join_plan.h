@@ -0,0 +1,54 @@
+#ifndef MINISQL_INDEX_NESTED_LOOP_JOIN_PLAN_H
+#define MINISQL_INDEX_NESTED_LOOP_JOIN_PLAN_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "catalog/catalog.h"
+#include "planner/expressions/abstract_expression.h"
+
+/**
+ * IndexNestedLoopJoinPlanNode joins the rows of its only child, the outer side, with the rows of a table
+ * found through a b+ tree index on its join columns. The outer rows are the left side of the join and the
+ * rows of the inner table, with every column of the table, are the right side.
+ */
+class IndexNestedLoopJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new IndexNestedLoopJoinPlanNode.
+   * @param outer The plan producing the outer rows
+   * @param inner_table_name The table looked up for every outer row
+   * @param index An index of the inner table whose every key column is compared for equality with the outer side
+   * @param outer_keys Expressions on an outer row giving the values of the index key columns, in key order
+   * @param inner_predicate The conditions on the inner table alone, evaluated on the inner row, may be null
+   * @param predicate The rest of the join condition, evaluated with EvaluateJoin(), may be null
+   */
+  IndexNestedLoopJoinPlanNode(const Schema *output, AbstractPlanNodeRef outer, std::string inner_table_name,
+                              IndexInfo *index, std::vector<AbstractExpressionRef> outer_keys,
+                              AbstractExpressionRef inner_predicate, AbstractExpressionRef predicate)
+      : AbstractPlanNode(output, {std::move(outer)}),
+        inner_table_name_(std::move(inner_table_name)),
+        index_(index),
+        outer_keys_(std::move(outer_keys)),
+        inner_predicate_(std::move(inner_predicate)),
+        predicate_(std::move(predicate)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::IndexNestedLoopJoin; }
+
+  AbstractPlanNodeRef GetOuterPlan() const { return GetChildAt(0); }
+
+  std::string GetInnerTableName() const { return inner_table_name_; }
+
+  AbstractExpressionRef GetPredicate() const { return predicate_; }
+
+  std::string inner_table_name_;
+  IndexInfo *index_;
+  std::vector<AbstractExpressionRef> outer_keys_;
+  AbstractExpressionRef inner_predicate_;
+  AbstractExpressionRef predicate_;
+};
+
+#endif  // MINISQL_INDEX_NESTED_LOOP_JOIN_PLAN_H
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "executor/plans/index_scan_plan.h"
+
+/**
+ * IndexOnlyScanPlanNode reads a key range of an index whose key holds every column the query references,
+ * so the output rows are rebuilt from the index keys without visiting the table heap.
+ */
+class IndexOnlyScanPlanNode : public IndexScanPlanNode {
+ public:
+  using IndexScanPlanNode::IndexScanPlanNode;
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::IndexOnlyScan; }
+};
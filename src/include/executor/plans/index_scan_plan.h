@@ -6,6 +6,32 @@
 #include "abstract_plan.h"
 #include "catalog/catalog.h"
 #include "planner/expressions/abstract_expression.h"
+#include "planner/expressions/compiled_predicate.h"
+#include "planner/expressions/logic_expression.h"
+
+/**
+ * IndexKeyRange is the slice of one index that an index scan reads.
+ * A bound holds values for a leading prefix of the key columns: equality columns first, then at most one
+ * range column. An empty bound leaves that side of the range open.
+ */
+struct IndexKeyRange {
+  IndexInfo *index_{nullptr};
+  std::vector<Field> lower_;
+  bool lower_inclusive_{true};
+  std::vector<Field> upper_;
+  bool upper_inclusive_{true};
+};
+
+/**
+ * IndexBitmapCondition combines the RowId sets of several index ranges. A leaf reads key_range_, an inner node
+ * intersects (And) or unions (Or) the sets of its children.
+ */
+struct IndexBitmapCondition {
+  bool is_leaf_{true};
+  LogicType logic_type_{LogicType::And};
+  IndexKeyRange key_range_;
+  std::vector<IndexBitmapCondition> children_;
+};
 
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
@@ -16,14 +42,19 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_name The identifier of table to be scanned
+   * @param key_range The index and the key range the scan is driven by
    */
-  IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<IndexInfo *> indexes, bool need_filter,
+  IndexScanPlanNode(const Schema *output, std::string table_name, IndexKeyRange key_range, bool need_filter,
                     AbstractExpressionRef filter_predicate = nullptr)
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
-        indexes_(std::move(indexes)),
+        key_range_(std::move(key_range)),
         need_filter_(need_filter),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)) {
+    if (filter_predicate_ != nullptr) {
+      compiled_predicate_ = std::make_shared<CompiledPredicate>(filter_predicate_);
+    }
+  }
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::IndexScan; }
@@ -33,15 +64,36 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   AbstractExpressionRef GetPredicate() const { return filter_predicate_; }
 
+  /** @return The predicate compiled for the scan, null if there is no predicate */
+  const CompiledPredicateRef &GetCompiledPredicate() const { return compiled_predicate_; }
+
   /** The table name */
   std::string table_name_;
 
-  /** The indexes*/
-  std::vector<IndexInfo *> indexes_;
+  /** The key range to read, bounds are merged from the conjuncts on the index column */
+  IndexKeyRange key_range_;
 
-  /** Whether there are indexes on all columns in the predicate*/
+  /** Whether some conjuncts of the predicate are not covered by the key range */
   bool need_filter_ = true;
 
+  /**
+   * Whether to collect all RowIds before producing rows. Set for DELETE/UPDATE, which modify the index
+   * that is being scanned.
+   */
+  bool snapshot_rids_ = false;
+
+  /**
+   * Bitmap heap scan: collect the RowIds of the whole range, sort them by page and read every heap page
+   * once. Chosen by the planner when the range is expected to be large.
+   */
+  bool bitmap_heap_scan_ = false;
+
+  /** If set, the RowIds come from combining several index ranges instead of key_range_ alone */
+  std::shared_ptr<IndexBitmapCondition> bitmap_condition_;
+
   /** The predicate to filter in IndexScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** filter_predicate_ compiled once when the plan is built */
+  CompiledPredicateRef compiled_predicate_;
 };
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef MINISQL_LIMIT_PLAN_H
+#define MINISQL_LIMIT_PLAN_H
+
+#include <utility>
+
+#include "abstract_plan.h"
+
+/**
+ * LimitPlanNode yields the first rows of its child, at most limit of them, and stops pulling from the
+ * child as soon as it has them. The rows are passed through as they are.
+ */
+class LimitPlanNode : public AbstractPlanNode {
+ public:
+  LimitPlanNode(const Schema *output, AbstractPlanNodeRef child, size_t limit)
+      : AbstractPlanNode(output, {std::move(child)}), limit_(limit) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Limit; }
+
+  AbstractPlanNodeRef GetChildPlan() const { return GetChildAt(0); }
+
+  size_t GetLimit() const { return limit_; }
+
+ private:
+  size_t limit_;
+};
+
+#endif  // MINISQL_LIMIT_PLAN_H
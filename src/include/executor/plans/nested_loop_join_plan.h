@@ -0,0 +1,37 @@
+#ifndef MINISQL_NESTED_LOOP_JOIN_PLAN_H
+#define MINISQL_NESTED_LOOP_JOIN_PLAN_H
+
+#include <utility>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/**
+ * NestedLoopJoinPlanNode pairs every row of the left child with every row of the right child on which the
+ * predicate holds. A joined row is the left row followed by the right row, the output schema picks its
+ * columns by GetTableInd().
+ */
+class NestedLoopJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new NestedLoopJoinPlanNode.
+   * @param predicate The join condition, evaluated with EvaluateJoin(), null for a cross product
+   */
+  NestedLoopJoinPlanNode(const Schema *output, AbstractPlanNodeRef left, AbstractPlanNodeRef right,
+                         AbstractExpressionRef predicate)
+      : AbstractPlanNode(output, {std::move(left), std::move(right)}), predicate_(std::move(predicate)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::NestedLoopJoin; }
+
+  AbstractPlanNodeRef GetLeftPlan() const { return GetChildAt(0); }
+
+  AbstractPlanNodeRef GetRightPlan() const { return GetChildAt(1); }
+
+  AbstractExpressionRef GetPredicate() const { return predicate_; }
+
+  /** The join condition */
+  AbstractExpressionRef predicate_;
+};
+
+#endif  // MINISQL_NESTED_LOOP_JOIN_PLAN_H
@@ -0,0 +1,42 @@
+#ifndef MINISQL_SORT_PLAN_H
+#define MINISQL_SORT_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/** The direction of an ORDER BY key. */
+enum class OrderByType { Asc, Desc };
+
+/**
+ * SortPlanNode orders the rows of its child by the ORDER BY keys, evaluated on the rows of the child. An
+ * output row takes its columns from the child row by GetTableInd(), so the keys may read columns that are
+ * not in the output. NULL sorts before every other value in ascending order and after them in descending.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new SortPlanNode.
+   * @param order_bys The keys rows are ordered by, the first one is the most significant
+   */
+  SortPlanNode(const Schema *output, AbstractPlanNodeRef child,
+               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys)
+      : AbstractPlanNode(output, {std::move(child)}), order_bys_(std::move(order_bys)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Sort; }
+
+  AbstractPlanNodeRef GetChildPlan() const { return GetChildAt(0); }
+
+  const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &GetOrderBy() const { return order_bys_; }
+
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys_;
+  /** Bytes of rows sorted in memory at a time, past this the sorted rows are written out as a run */
+  size_t memory_budget_{SORT_MEMORY_BYTES};
+  /** Runs merged at a time, every run being read pins one page of the buffer pool */
+  size_t merge_fan_in_{SORT_MERGE_FAN_IN};
+};
+
+#endif  // MINISQL_SORT_PLAN_H
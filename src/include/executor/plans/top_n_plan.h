@@ -0,0 +1,34 @@
+#ifndef MINISQL_TOP_N_PLAN_H
+#define MINISQL_TOP_N_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "executor/plans/sort_plan.h"
+
+/**
+ * TopNPlanNode is ORDER BY followed by LIMIT: it yields the first n rows of its child in the order of the
+ * ORDER BY keys, as a SortPlanNode under a LimitPlanNode would, but only ever keeps n rows.
+ */
+class TopNPlanNode : public AbstractPlanNode {
+ public:
+  TopNPlanNode(const Schema *output, AbstractPlanNodeRef child,
+               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys, size_t n)
+      : AbstractPlanNode(output, {std::move(child)}), order_bys_(std::move(order_bys)), n_(n) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::TopN; }
+
+  AbstractPlanNodeRef GetChildPlan() const { return GetChildAt(0); }
+
+  const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &GetOrderBy() const { return order_bys_; }
+
+  size_t GetN() const { return n_; }
+
+ private:
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys_;
+  size_t n_;
+};
+
+#endif  // MINISQL_TOP_N_PLAN_H
@@ -0,0 +1,136 @@
+#ifndef MINISQL_ADAPTIVE_RADIX_TREE_H
+#define MINISQL_ADAPTIVE_RADIX_TREE_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * In-memory adaptive radix tree (Leis et al., ICDE 2013) over memcomparable keys.
+ *
+ * Every key is the full key_size bytes of a GenericKey, so no key is a prefix of
+ * another. Inner nodes branch on one key byte and grow from Node4 to Node16,
+ * Node48 and Node256 as children are added (and shrink back on removal). A run
+ * of bytes shared by all keys below a node is compressed into the node prefix;
+ * only the first MAX_PREFIX_LEN bytes are stored, the rest is checked against a
+ * leaf. Leaves hold the whole key and its RowId, so a lookup never touches the
+ * buffer pool and iterating the leaves from left to right yields key order.
+ */
+class AdaptiveRadixTree {
+ public:
+  explicit AdaptiveRadixTree(const KeyManager &KM);
+
+  ~AdaptiveRadixTree();
+
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+
+  AdaptiveRadixTree &operator=(const AdaptiveRadixTree &) = delete;
+
+  bool IsEmpty() const { return root_ == nullptr; }
+
+  size_t GetSize() const { return size_; }
+
+  // Insert a key-value pair, false if the key already exists
+  bool Insert(const GenericKey *key, const RowId &value);
+
+  // Remove a key, false if it is not in the tree
+  bool Remove(const GenericKey *key);
+
+  // Return the value associated with a given key
+  bool GetValue(const GenericKey *key, RowId &value) const;
+
+  /**
+   * Visit in key order the entries whose key starts with prefix.
+   * @param visitor return false to stop the scan
+   */
+  void ScanPrefix(const char *prefix, int prefix_len,
+                  const std::function<bool(const GenericKey *, const RowId &)> &visitor) const;
+
+  // Visit every entry in key order, see ScanPrefix
+  void Scan(const std::function<bool(const GenericKey *, const RowId &)> &visitor) const {
+    ScanPrefix(nullptr, 0, visitor);
+  }
+
+  // Free every node
+  void Clear();
+
+ private:
+  static constexpr int MAX_PREFIX_LEN = 10;
+
+  enum class NodeType : uint8_t { kLeaf, kNode4, kNode16, kNode48, kNode256 };
+
+  struct Node {
+    NodeType type_;
+  };
+
+  struct Leaf : Node {
+    RowId value_;
+    uint8_t key_[0];
+  };
+
+  struct InnerNode : Node {
+    uint16_t num_children_{0};
+    uint32_t prefix_len_{0};
+    uint8_t prefix_[MAX_PREFIX_LEN];
+  };
+
+  struct Node4 : InnerNode {
+    uint8_t keys_[4];
+    Node *children_[4];
+  };
+
+  struct Node16 : InnerNode {
+    uint8_t keys_[16];
+    Node *children_[16];
+  };
+
+  struct Node48 : InnerNode {
+    // slot + 1 of the child of each byte, 0 if there is none
+    uint8_t child_index_[256];
+    Node *children_[48];
+  };
+
+  struct Node256 : InnerNode {
+    Node *children_[256];
+  };
+
+  static const uint8_t *Bytes(const GenericKey *key) { return reinterpret_cast<const uint8_t *>(key); }
+
+  Leaf *NewLeaf(const uint8_t *key, const RowId &value) const;
+
+  template <typename N>
+  static N *NewNode(const InnerNode *header = nullptr);
+
+  static void FreeNode(Node *node);
+
+  bool LeafMatches(const Leaf *leaf, const uint8_t *key) const;
+
+  // the slot holding the child of byte c, nullptr if there is none
+  static Node **FindChild(InnerNode *node, uint8_t c);
+
+  static const Leaf *MinLeaf(const Node *node);
+
+  // bytes of the prefix of node that match key from depth, checked against a leaf past MAX_PREFIX_LEN
+  int PrefixMismatch(const InnerNode *node, const uint8_t *key, int depth) const;
+
+  // add child under byte c, growing the node into *ref when it is full
+  static void AddChild(InnerNode *node, Node **ref, uint8_t c, Node *child);
+
+  // drop the child in slot, shrinking the node in *ref when it gets sparse
+  static void RemoveChild(InnerNode *node, Node **ref, uint8_t c, Node **slot);
+
+  bool Insert(Node **ref, const uint8_t *key, int depth, const RowId &value);
+
+  bool Remove(Node **ref, const uint8_t *key, int depth);
+
+  static bool Visit(const Node *node, const std::function<bool(const GenericKey *, const RowId &)> &visitor);
+
+  int key_size_;
+  Node *root_{nullptr};
+  size_t size_{0};
+};
+
+#endif  // MINISQL_ADAPTIVE_RADIX_TREE_H
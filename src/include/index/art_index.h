@@ -0,0 +1,38 @@
+#ifndef MINISQL_ART_INDEX_H
+#define MINISQL_ART_INDEX_H
+
+#include "index/adaptive_radix_tree.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Index backed by an in-memory adaptive radix tree. Nothing is written to disk: the catalog rebuilds the
+ * tree from the table heap when the index is created or loaded, and a probe never touches the buffer pool.
+ * Like BPlusTreeIndex, a non-unique index appends the RowId to every key, so key_size must leave room for it.
+ */
+class ArtIndex : public Index {
+ public:
+  ArtIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  /** "=" descends the tree, the other operators walk every entry in key order. */
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, std::string compare_operator = "=") override;
+
+  dberr_t Destroy() override;
+
+  bool IsUnique() const { return unique_; }
+
+  AdaptiveRadixTree &GetContainer() { return container_; }
+
+ protected:
+  bool unique_;
+  // comparator for key
+  KeyManager processor_;
+  // container
+  AdaptiveRadixTree container_;
+};
+
+#endif  // MINISQL_ART_INDEX_H
@@ -1,8 +1,10 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <memory>
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "concurrency/txn.h"
@@ -11,15 +13,42 @@
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
 
+/** Shape of a b+ tree, see BPlusTree::GetStats */
+struct BPlusTreeStats {
+  uint32_t height_{0};
+  uint32_t leaf_pages_{0};
+  uint32_t internal_pages_{0};
+  // key & value pairs in the leaf pages
+  uint64_t entries_{0};
+  // child pointers in the internal pages
+  uint64_t children_{0};
+
+  double GetLeafFanout() const { return leaf_pages_ == 0 ? 0 : static_cast<double>(entries_) / leaf_pages_; }
+
+  double GetInternalFanout() const {
+    return internal_pages_ == 0 ? 0 : static_cast<double>(children_) / internal_pages_;
+  }
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key, a non-unique index appends the RowId to
+ *     its keys to keep them unique (see BPlusTreeIndex)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * Pages hold variable-length keys, so whether a page is full or underfull is
+ * decided by bytes rather than by the number of pairs. The optional max sizes
+ * only put an extra cap on the number of pairs per page.
+ *
+ * The internal pages of the top levels are copied into memory and descents
+ * route through the copies, only going to the buffer pool below them. The
+ * copies are stamped with the tree version, which every change of an internal
+ * page or of the root bumps. A changed root page id is written to the index
+ * roots page at the next checkpoint (FlushRootPageId) rather than right away.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -29,6 +58,8 @@ class BPlusTree {
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
+  ~BPlusTree();
+
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
@@ -38,6 +69,14 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const GenericKey *key, Txn *transaction = nullptr);
 
+  /**
+   * Remove keys sorted in ascending order in one left-to-right pass. The keys of one leaf are removed
+   * together and the pass moves on along the leaf chain, descending from the root again only when the
+   * next key lies beyond the next leaf. A leaf is merged or refilled only once it falls below its low
+   * water mark rather than as soon as it is less than half full.
+   */
+  void RemoveBatch(const std::vector<GenericKey *> &keys, Txn *transaction = nullptr);
+
   // return the value associated with a given key
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction = nullptr);
 
@@ -56,6 +95,15 @@ class BPlusTree {
   // destroy the b plus tree
   void Destroy(page_id_t current_page_id = INVALID_PAGE_ID);
 
+  // walk the whole tree and count its pages and pairs
+  BPlusTreeStats GetStats();
+
+  // write the root page id to the index roots page if it changed since the last checkpoint
+  void FlushRootPageId();
+
+  // keep the internal pages of the top levels in memory, 0 turns the cache off
+  void SetCachedLevels(int levels) { cached_levels_ = levels; }
+
   void PrintTree(std::ofstream &out, Schema *schema) {
     if (IsEmpty()) {
       return;
@@ -76,24 +124,32 @@ class BPlusTree {
 
   LeafPage *Split(LeafPage *node, Txn *transaction);
 
-  InternalPage *Split(InternalPage *node, Txn *transaction);
+  InternalPage *Split(InternalPage *node, GenericKey *middle_key, Txn *transaction);
+
+  // Write the shortest key that separates left from its right sibling into separator
+  void LeafSeparator(LeafPage *left, LeafPage *right, GenericKey *separator);
 
   template <typename N>
   bool CoalesceOrRedistribute(N *&node, Txn *transaction = nullptr);
 
-  bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
+  bool Coalesce(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
                 Txn *transaction = nullptr);
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  bool Coalesce(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index, Txn *transaction = nullptr);
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
-  void UpdateRootPageId(int insert_record = 0);
+  void UpdateRootPageId();
+
+  // the in-memory copy of an internal page of the top levels, nullptr if page_id is a leaf
+  const InternalPage *GetCachedPage(page_id_t page_id);
+
+  // the internal pages or the root changed, the cached copies are stale
+  void InvalidateUpperLevels() { version_++; }
 
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out, Schema *schema) const;
@@ -107,6 +163,13 @@ class BPlusTree {
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  // root page id not yet written to the index roots page
+  bool root_dirty_{false};
+  int cached_levels_{DEFAULT_BTREE_CACHED_LEVELS};
+  uint64_t version_{0};
+  // copies of the top internal pages taken at upper_levels_version_, a leaf maps to nullptr
+  std::unordered_map<page_id_t, std::unique_ptr<char[]>> upper_levels_;
+  uint64_t upper_levels_version_{0};
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
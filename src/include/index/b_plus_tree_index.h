@@ -5,25 +5,85 @@
 #include "index/generic_key.h"
 #include "index/index.h"
 
+/**
+ * IndexRangeScan streams the RowIds of the entries whose key lies inside a (possibly half-open)
+ * key range. It only keeps the current leaf pinned, so the caller can stop at any time.
+ */
+class IndexRangeScan {
+ public:
+  IndexRangeScan(IndexIterator &&iter, const Row *upper, bool upper_inclusive, const KeyManager &processor,
+                 IndexSchema *key_schema);
+
+  /**
+   * Produce the next RowId in key order.
+   * @param[out] key if not nullptr, receives the key columns of the entry
+   * @return `false` once the iterator runs past the upper bound or off the last leaf
+   */
+  bool Next(RowId *rid, Row *key = nullptr);
+
+  /**
+   * Append the RowIds of the rest of the current leaf. A leaf whose last key is within the upper bound is
+   * copied without comparing its keys one by one.
+   * @return `false` once the scan is over and nothing was appended
+   */
+  bool NextBatch(std::vector<RowId> &rids);
+
+ private:
+  IndexIterator iter_;
+  IndexIterator end_;
+  /** Encoded leading key columns to stop at, only meaningful when has_upper_ is set */
+  std::vector<char> upper_;
+  bool has_upper_;
+  bool upper_inclusive_;
+  const KeyManager &processor_;
+  IndexSchema *key_schema_;
+};
+
+/**
+ * A b+ tree index. A unique index stores the key columns only and rejects a duplicate key. A non-unique
+ * index appends the RowId to every key (see KeyManager::SerializeFromKey), so the tree keys stay distinct
+ * and the entries of one key value are adjacent in RowId order; key_size must leave room for the RowId.
+ */
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
 
   dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
 
+  /** Sort the keys and remove them in one pass over the leaves, see BPlusTree::RemoveBatch */
+  dberr_t RemoveEntries(const std::vector<std::pair<Row, RowId>> &entries, Txn *txn) override;
+
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
 
   dberr_t Destroy() override;
 
+  void Checkpoint() override;
+
+  /**
+   * Open a streaming scan over the keys between lower and upper. A bound may hold only the leading
+   * columns of the key, in which case just those columns are compared. When upper bounds one more column
+   * than lower, the keys with a null in that column are outside the range and are skipped, a scan with
+   * neither bound still returns them.
+   * @param lower lower bound key, nullptr for an open lower end
+   * @param upper upper bound key, nullptr for an open upper end
+   */
+  std::unique_ptr<IndexRangeScan> ScanRange(const Row *lower, bool lower_inclusive, const Row *upper,
+                                            bool upper_inclusive, Txn *txn = nullptr);
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
 
   IndexIterator GetEndIterator();
   BPlusTree& Debug();//for debug
+
+  bool IsUnique() const { return unique_; }
+
  protected:
+  bool unique_;
   // comparator for key
   KeyManager processor_;
   // container
@@ -0,0 +1,69 @@
+#ifndef MINISQL_BLOOM_FILTER_H
+#define MINISQL_BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * Blocked bloom filter (Putze et al., "Cache-, Hash- and Space-Efficient Bloom Filters"). The bits of a
+ * key all fall in one 64 byte block, so a probe costs a single cache miss. A filter cannot drop a key,
+ * removed keys simply stay as false positives.
+ *
+ * The number of keys is not known in advance, so the filter is a chain of stages: once a stage holds
+ * as many keys as it was sized for, a new stage twice as large takes the next keys, and a probe asks
+ * every stage. Each new stage also gets one more bit per key, so the false positive rates of the later
+ * stages shrink and their sum stays a small multiple of that of the first one.
+ */
+class BloomFilter {
+ public:
+  explicit BloomFilter(size_t expected_keys = BLOOM_FILTER_INITIAL_KEYS,
+                       int bits_per_key = BLOOM_FILTER_BITS_PER_KEY);
+
+  void Add(const char *data, size_t len);
+
+  // false if the key was never added, true if it probably was
+  bool MayContain(const char *data, size_t len) const;
+
+  // number of keys added, duplicates included
+  size_t GetSize() const { return size_; }
+
+  // bytes taken by the bit arrays
+  size_t GetMemoryUsage() const;
+
+  void Clear();
+
+ private:
+  static constexpr int BLOCK_WORDS = 8;  // 64 bytes
+  static constexpr int BLOCK_BITS = BLOCK_WORDS * 64;
+  static constexpr int NUM_PROBES = 6;   // bits set per key, the best for 10 bits per key
+
+  struct Block {
+    uint64_t words_[BLOCK_WORDS];
+  };
+
+  struct Stage {
+    std::vector<Block> blocks_;
+    size_t capacity_;
+    int bits_per_key_;
+    size_t size_{0};
+  };
+
+  static uint64_t Mix(uint64_t hash);
+
+  static uint64_t Hash(const char *data, size_t len);
+
+  // the bits the probes are taken from, they do not depend on the high 32 bits that pick the block
+  static uint64_t ProbeHash(uint64_t hash);
+
+  static bool StageMayContain(const Stage &stage, uint64_t hash);
+
+  void AddStage(size_t capacity, int bits_per_key);
+
+  std::vector<Stage> stages_;
+  size_t size_{0};
+};
+
+#endif  // MINISQL_BLOOM_FILTER_H
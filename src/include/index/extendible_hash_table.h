@@ -0,0 +1,74 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/txn.h"
+#include "index/generic_key.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+
+/**
+ * Disk-backed extendible hash table. A unique table holds at most one pair per
+ * key, a non-unique one any number of pairs per key with different values.
+ *
+ * The directory page id is kept in the index roots page, like the root of a
+ * b+ tree. A full bucket splits on the next hash bit, doubling the directory
+ * when needed; an emptied bucket merges back into its split image. Pairs that
+ * no split can separate, such as the duplicates of one key, go to overflow pages.
+ */
+class ExtendibleHashTable {
+  using DirectoryPage = HashTableDirectoryPage;
+  using BucketPage = HashTableBucketPage;
+
+ public:
+  explicit ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
+                               bool unique = true);
+
+  bool IsEmpty() const { return directory_page_id_ == INVALID_PAGE_ID; }
+
+  // Insert a key-value pair into this hash table, false if the key (the pair when not unique) already exists
+  bool Insert(const GenericKey *key, const RowId &value, Txn *transaction = nullptr);
+
+  // Remove a key and its value from this hash table, only the pair with value when not unique
+  void Remove(const GenericKey *key, const RowId &value, Txn *transaction = nullptr);
+
+  // Append the values associated with a given key to result
+  bool GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction = nullptr);
+
+  // Free the directory and every bucket page
+  void Destroy();
+
+  uint32_t GetGlobalDepth();
+
+ private:
+  uint32_t Hash(const GenericKey *key) const;
+
+  // Create the directory with a single empty bucket and register it in the index roots page
+  void InitDirectory();
+
+  DirectoryPage *FetchDirectory();
+
+  BucketPage *FetchBucket(page_id_t bucket_page_id);
+
+  // Whether a pair in the chain of head_page_id differs from hash in the bits the directory can use
+  bool CanSplit(page_id_t head_page_id, uint32_t hash);
+
+  // Put the pair on the first page of the chain with room, a new overflow page if there is none
+  void AppendToChain(page_id_t head_page_id, const GenericKey *key, const RowId &value);
+
+  // Split the bucket of bucket_idx and its overflow pages on its next hash bit
+  void SplitBucket(DirectoryPage *directory, uint32_t bucket_idx);
+
+  // Fold the empty bucket of bucket_idx into its split image while the depths allow it
+  void MergeBucket(DirectoryPage *directory, uint32_t bucket_idx);
+
+  index_id_t index_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  const KeyManager &processor_;
+  bool unique_;
+  page_id_t directory_page_id_{INVALID_PAGE_ID};
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
@@ -1,7 +1,10 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <algorithm>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "record/field.h"
 #include "record/row.h"
@@ -11,6 +14,16 @@ class GenericKey {
   char data[0];
 };
 
+/**
+ * Index keys are kept in a memcomparable encoding, so that two keys compare with a plain memcmp
+ * instead of being deserialized into rows. Every key column is written as a null flag byte
+ * (0 for null, 1 otherwise) followed, for a non-null value, by
+ *  - int:   4 bytes big-endian with the sign bit flipped
+ *  - float: 4 bytes big-endian, sign bit flipped for positive values and all bits flipped for negative ones
+ *  - char:  the characters followed by a 0 terminator
+ * The key is zero padded up to key_size. Trailing zeros never change the order of two keys, so
+ * b+ tree pages only store a key up to its last non-zero byte (see GetKeyLength).
+ */
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,46 +31,125 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
+    // initialize to 0
+    memset(key_buf->data, 0, key_size_);
+    [[maybe_unused]] uint32_t size = EncodeFields(key, key.GetFieldCount(), key_buf->data);
     ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  }
+
+  /**
+   * Serialize the key columns followed by the row id, so that the entries of a non-unique index still
+   * have distinct keys. Equal key columns are then ordered by row id, and a prefix scan on the key
+   * columns finds all of them.
+   */
+  inline void SerializeFromKey(GenericKey *key_buf, const Row &key, const RowId &rid, Schema *schema) const {
+    ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    uint32_t size = EncodeFields(key, key.GetFieldCount(), key_buf->data);
+    ASSERT(size + ROW_ID_KEY_SIZE <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    EncodeUint32(static_cast<uint32_t>(rid.GetPageId()) ^ 0x80000000u, key_buf->data + size);
+    EncodeUint32(rid.GetSlotNum(), key_buf->data + size + sizeof(uint32_t));
   }
 
   inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
+    ASSERT(key.GetFieldCount() == 0, "Non empty field in row.");
+    uint32_t ofs = 0;
+    for (auto column : schema->GetColumns()) {
+      ofs += DecodeField(key_buf->data + ofs, key_size_ - ofs, column->GetType(), key.GetFields());
+    }
     ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
   }
 
   // compare
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
+    return memcmp(lhs->data, rhs->data, key_size_);
+  }
 
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
-      }
+  /**
+   * Encode the leading columns of a key, used by prefix range scans.
+   * @param buf at least key_size bytes
+   * @return length of the encoded prefix
+   */
+  inline int SerializePrefix(const Row &prefix, char *buf) const {
+    ASSERT(prefix.GetFieldCount() <= key_schema_->GetColumnCount(), "prefix longer than key.");
+    memset(buf, 0, key_size_);
+    return EncodeFields(prefix, prefix.GetFieldCount(), buf);
+  }
+
+  // compare only the leading columns of a key with a prefix encoded by SerializePrefix
+  [[nodiscard]] inline int CompareKeyPrefix(const GenericKey *lhs, const char *prefix, int prefix_len) const {
+    return memcmp(lhs->data, prefix, prefix_len);
+  }
+
+  // compare only the leading columns of a key with a (possibly shorter) row, used by prefix range scans
+  [[nodiscard]] inline int CompareKeyPrefix(const GenericKey *lhs, const Row &prefix) const {
+    std::vector<char> buf(key_size_);
+    int prefix_len = SerializePrefix(prefix, buf.data());
+    return CompareKeyPrefix(lhs, buf.data(), prefix_len);
+  }
+
+  // length of the key without its zero padding
+  [[nodiscard]] inline int GetKeyLength(const GenericKey *key) const { return GetKeyLength(key, key_size_); }
+
+  [[nodiscard]] static inline int GetKeyLength(const GenericKey *key, int key_size) {
+    int len = key_size;
+    while (len > 0 && key->data[len - 1] == 0) {
+      len--;
     }
-    // equals
-    return 0;
+    return len;
+  }
+
+  /**
+   * Write the shortest key sep with lhs < sep <= rhs into separator, so that internal pages only keep
+   * as many bytes as they need to tell two neighbouring pages apart. The separator never ends with a
+   * zero byte, so it survives the zero padding of a GenericKey.
+   */
+  inline void FindShortestSeparator(const GenericKey *lhs, const GenericKey *rhs, GenericKey *separator) const {
+    int lhs_len = GetKeyLength(lhs);
+    int rhs_len = GetKeyLength(rhs);
+    int len = 0;
+    while (len < lhs_len && len < rhs_len && lhs->data[len] == rhs->data[len]) {
+      len++;
+    }
+    // rhs 在第一个不同的字节之后截断; lhs 是 rhs 的前缀时要延伸到下一个非零字节
+    while (len < rhs_len && rhs->data[len] == 0) {
+      len++;
+    }
+    len = std::min(len + 1, rhs_len);
+    memset(separator->data, 0, key_size_);
+    memcpy(separator->data, rhs->data, len);
   }
 
   inline int GetKeySize() const { return key_size_; }
 
+  /** Bytes a row id takes after the key columns, see SerializeFromKey */
+  static constexpr size_t ROW_ID_KEY_SIZE = 2 * sizeof(uint32_t);
+
+  /** Size of the longest key of schema in this encoding, what a KeyManager needs as key_size */
+  static inline size_t GetMaxKeySize(const Schema *schema) {
+    size_t size = 0;
+    for (auto column : schema->GetColumns()) {
+      size += 1 + (column->GetType() == TypeId::kTypeChar ? column->GetLength() + 1 : sizeof(uint32_t));
+    }
+    return size;
+  }
+
+  /**
+   * Append the encoding of one field to key, as it is laid out in an index key. Rows whose fields are
+   * appended one after the other get keys that are equal for equal rows and that memcmp in row order.
+   */
+  static inline void AppendField(const Field &field, std::string *key) {
+    // a null char field has FIELD_NULL_LEN as its length, only the null flag is written
+    if (field.IsNull()) {
+      key->push_back(0);
+      return;
+    }
+    size_t ofs = key->size();
+    key->resize(ofs + 2 + (field.GetTypeId() == TypeId::kTypeChar ? field.GetLength() : sizeof(uint32_t)));
+    key->resize(ofs + EncodeField(field, &(*key)[ofs]));
+  }
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
@@ -67,6 +159,96 @@ class KeyManager {
   KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
 
  private:
+  static inline void EncodeUint32(uint32_t v, char *buf) {
+    for (int i = 3; i >= 0; i--, v >>= 8) {
+      buf[i] = static_cast<char>(v & 0xff);
+    }
+  }
+
+  static inline uint32_t DecodeUint32(const char *buf) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+      v = (v << 8) | static_cast<uint8_t>(buf[i]);
+    }
+    return v;
+  }
+
+  static inline uint32_t EncodeFields(const Row &row, uint32_t count, char *buf) {
+    uint32_t ofs = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      ofs += EncodeField(*row.GetField(i), buf + ofs);
+    }
+    return ofs;
+  }
+
+  static inline uint32_t EncodeField(const Field &field, char *buf) {
+    if (field.IsNull()) {
+      buf[0] = 0;
+      return 1;
+    }
+    buf[0] = 1;
+    switch (field.GetTypeId()) {
+      case TypeId::kTypeInt: {
+        int32_t v;
+        field.SerializeTo(reinterpret_cast<char *>(&v));
+        EncodeUint32(static_cast<uint32_t>(v) ^ 0x80000000u, buf + 1);
+        return 1 + sizeof(uint32_t);
+      }
+      case TypeId::kTypeFloat: {
+        float f;
+        field.SerializeTo(reinterpret_cast<char *>(&f));
+        if (f == 0) {
+          f = 0;  // -0.0 == 0.0
+        }
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        EncodeUint32((bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u, buf + 1);
+        return 1 + sizeof(uint32_t);
+      }
+      case TypeId::kTypeChar: {
+        // 字符串以 0 结尾, 按字节序比较与 CompareStrings 一致
+        uint32_t len = strnlen(field.GetData(), field.GetLength());
+        memcpy(buf + 1, field.GetData(), len);
+        buf[1 + len] = 0;
+        return len + 2;
+      }
+      default:
+        ASSERT(false, "Unsupported key column type.");
+    }
+    return 0;
+  }
+
+  static inline uint32_t DecodeField(const char *buf, uint32_t avail, TypeId type, std::vector<Field *> &fields) {
+    // 截断的分隔键按补零处理, 读到末尾即停止
+    if (avail == 0 || buf[0] == 0) {
+      fields.push_back(new Field(type));
+      return std::min(avail, 1u);
+    }
+    switch (type) {
+      case TypeId::kTypeInt: {
+        uint32_t v = DecodeUint32(buf + 1) ^ 0x80000000u;
+        fields.push_back(new Field(type, static_cast<int32_t>(v)));
+        return 1 + sizeof(uint32_t);
+      }
+      case TypeId::kTypeFloat: {
+        uint32_t bits = DecodeUint32(buf + 1);
+        bits = (bits & 0x80000000u) ? bits ^ 0x80000000u : ~bits;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        fields.push_back(new Field(type, f));
+        return 1 + sizeof(uint32_t);
+      }
+      case TypeId::kTypeChar: {
+        uint32_t len = strnlen(buf + 1, avail - 1);
+        fields.push_back(new Field(type, const_cast<char *>(buf + 1), len, true));
+        return std::min(avail, len + 2);
+      }
+      default:
+        ASSERT(false, "Unsupported key column type.");
+    }
+    return 0;
+  }
+
   int key_size_;
   Schema *key_schema_;
 };
@@ -0,0 +1,41 @@
+#ifndef MINISQL_HASH_INDEX_H
+#define MINISQL_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Index backed by an extendible hash table. A probe touches the directory and
+ * one bucket page whatever the size of the table, but only equality can be
+ * answered; range scans need a b+ tree index. A unique index rejects a
+ * duplicate key, a non-unique one keeps a pair per row; the key is not
+ * extended with the RowId as in a b+ tree, all duplicates have to hash alike.
+ */
+class HashIndex : public Index {
+ public:
+  HashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+            bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  /** Only the "=" operator is supported, any other operator returns DB_FAILED. */
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
+
+  dberr_t Destroy() override;
+
+  ExtendibleHashTable &GetContainer() { return container_; }
+
+  bool IsUnique() const { return unique_; }
+
+ protected:
+  bool unique_;
+  // comparator for key
+  KeyManager processor_;
+  // container
+  ExtendibleHashTable container_;
+};
+
+#endif  // MINISQL_HASH_INDEX_H
@@ -2,6 +2,8 @@
 #define MINISQL_INDEX_H
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "common/dberr.h"
 #include "concurrency/txn.h"
@@ -17,10 +19,21 @@ class Index {
 
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) = 0;
 
-  virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") = 0;
+  // remove many entries at once, an index that can do better than one by one overrides this
+  virtual dberr_t RemoveEntries(const std::vector<std::pair<Row, RowId>> &entries, Txn *txn) {
+    for (const auto &entry : entries) {
+      RemoveEntry(entry.first, entry.second, txn);
+    }
+    return DB_SUCCESS;
+  }
+
+  virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, std::string compare_operator = "=") = 0;
 
   virtual dberr_t Destroy() = 0;
 
+  // write the state the index keeps in memory, such as a changed root page id, to its pages
+  virtual void Checkpoint() {}
+
  protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
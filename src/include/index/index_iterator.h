@@ -1,6 +1,9 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <future>
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 class IndexIterator {
@@ -12,14 +15,32 @@ class IndexIterator {
 
   explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
 
+  IndexIterator(IndexIterator &&other) noexcept;
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
   ~IndexIterator();
 
-  /** Return the key/value pair this iterator is currently pointing at. */
+  /**
+   * Return the key/value pair this iterator is currently pointing at. Leaf pages store keys
+   * prefix compressed, so the key is rebuilt in a buffer owned by the iterator and stays valid
+   * until the iterator moves.
+   */
   std::pair<GenericKey *, RowId> operator*();
 
   /** Move to the next key/value pair.*/
   IndexIterator &operator++();
 
+  /**
+   * Append the values from the current slot to the end of the current leaf and move on to the next leaf,
+   * so a whole leaf is handed out and unpinned at once.
+   * @return the number of values appended
+   */
+  size_t NextLeafBatch(std::vector<RowId> &values);
+
+  /** Return the last key of the current leaf, valid until the iterator moves */
+  GenericKey *LeafLastKey();
+
   /** Return whether two iterators are equal */
   bool operator==(const IndexIterator &itr) const;
 
@@ -27,10 +48,28 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
+  /** Skip over an exhausted leaf so that a live iterator always points at a valid slot. */
+  void SkipExhaustedPages();
+
+  /** Unpin the current leaf and pin the next one, the iterator becomes the end iterator past the last leaf */
+  void MoveToNextLeaf();
+
+  /**
+   * Keep the next leaves loading in the background. A scan that has left its first leaf is likely to read
+   * many more, so from then on a task walks the leaf chain through the buffer pool, reading the leaves
+   * that are not resident, and stays between LEAF_PREFETCH_DEPTH / 2 and LEAF_PREFETCH_DEPTH leaves ahead.
+   */
+  void Prefetch();
+
   page_id_t current_page_id{INVALID_PAGE_ID};
   LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
+  std::vector<char> key_buf_;
+  // 预读任务返回它停下的位置, 下一次预读从那里继续
+  std::future<page_id_t> prefetch_;
+  // 再进入多少个叶子后发起下一次预读
+  int leaves_until_prefetch_{1};
   // add your own private member variables here
 };
 
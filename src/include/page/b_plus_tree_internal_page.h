@@ -4,11 +4,13 @@
 #include <string.h>
 
 #include <queue>
+#include <string>
+#include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_HEADER_SIZE 32
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -17,20 +19,38 @@
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Keys are separators rather than copies of the child keys: a separator is cut
+ * right after the first byte that tells the two neighbouring children apart
+ * (see KeyManager::FindShortestSeparator), so the keys have variable length.
+ * The slots hold the child pointers in key order and point at the key bytes,
+ * which are packed from the end of the page towards the slots.
+ *
+ * Internal page format (slots are stored in increasing key order):
+ *  -------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | free | KEY(k) | ... | KEY(2) |
+ *  -------------------------------------------------------------------------
+ *  SLOT = Offset (2) + KeyLength (2) + PAGE_ID (4)
+ *  HEADER = the common b+ tree page header + HeapOffset (4)
  */
 class BPlusTreeInternalPage : public BPlusTreePage {
+  // a child outside of a page: the separator before it without zero padding and its page id
+  using Entry = std::pair<std::string, page_id_t>;
+
  public:
+  static constexpr int DATA_SIZE = PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE;
+  static constexpr int SLOT_SIZE = 2 * sizeof(uint16_t) + sizeof(page_id_t);
+
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
             int max_size = UNDEFINED_SIZE);
 
-  GenericKey *KeyAt(int index);
+  // Copy the key at index into key, which must hold key_size bytes
+  void KeyAt(int index, GenericKey *key) const;
 
-  void SetKeyAt(int index, GenericKey *key);
+  int GetKeyLength(int index) const { return SlotLength(index); }
+
+  // @return false if the page has no room for the new key
+  bool SetKeyAt(int index, const GenericKey *key, const KeyManager &KM);
 
   int ValueIndex(const page_id_t &value) const;
 
@@ -38,40 +58,71 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void SetValueAt(int index, page_id_t value);
 
-  void *PairPtrAt(int index);
+  page_id_t Lookup(const GenericKey *key, const KeyManager &KP) const;
+
+  // bytes taken by the slots and the keys
+  int GetUsedBytes() const { return GetSize() * SLOT_SIZE + (DATA_SIZE - heap_offset_); }
 
-  void PairCopy(void *dest, void *src, int pair_num = 1);
+  // less than half full, the page should be merged with or borrow from a sibling
+  bool IsUnderflow() const { return GetUsedBytes() < DATA_SIZE / 2; }
 
-  page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
+  // whether a key of key_len bytes and its child fit in the page
+  bool HasRoomFor(int key_len) const {
+    return GetSize() < GetMaxSize() && SLOT_SIZE + key_len <= DATA_SIZE - GetUsedBytes();
+  }
 
-  void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+  void PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value,
+                       const KeyManager &KM);
 
-  int InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+  // the caller makes sure the page has room, see HasRoomFor
+  int InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value,
+                      const KeyManager &KM);
 
   void Remove(int index);
 
   page_id_t RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
+  // @param[out] middle_key the key between the two halves, to be pushed up to the parent
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  // Append middle_key and every child to recipient, the left sibling of this page
+  // @return false and leave both pages untouched if they do not fit in one page
+  bool MoveAllTo(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
+                 BufferPoolManager *buffer_pool_manager);
 
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                        BufferPoolManager *buffer_pool_manager);
+  // Even out the bytes held by this page and its right sibling, middle_key is the parent key between them
+  // and receives the new one
+  // @return false and leave both pages untouched if they cannot be balanced
+  bool Redistribute(BPlusTreeInternalPage *right, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
 
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                         BufferPoolManager *buffer_pool_manager);
-  page_id_t LeftMostKeyFromCurr(BufferPoolManager *buffer_pool_manager);
  private:
-  void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
+  uint16_t SlotOffset(int index) const;
+
+  uint16_t SlotLength(int index) const;
+
+  void SetSlot(int index, uint16_t offset, uint16_t length);
+
+  // Release the key bytes of index and leave it with an empty key
+  void RemoveKeyBytes(int index);
+
+  void AppendEntries(std::vector<Entry> &entries) const;
+
+  // Rewrite this page with entries[begin, end), the key of entries[begin] is dropped
+  void Rebuild(const std::vector<Entry> &entries, int begin, int end);
+
+  // Make this page the parent of the children in entries[begin, end)
+  void Adopt(const std::vector<Entry> &entries, int begin, int end, BufferPoolManager *buffer_pool_manager);
+
+  // bytes that entries[begin, end) take in a page
+  static int GetRebuildSize(const std::vector<Entry> &entries, int begin, int end);
 
-  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+  // find the split point of entries that leaves about the same number of bytes on both sides
+  static int GetBalancedSplit(const std::vector<Entry> &entries, int max_size);
 
-  void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
+  int heap_offset_;
 
-  char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
-  
+  char data_[DATA_SIZE];
 };
 
 using InternalPage = BPlusTreeInternalPage;
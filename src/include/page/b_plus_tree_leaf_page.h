@@ -7,30 +7,44 @@
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
-
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ * Keys have variable length (the encoded key without its zero padding, see
+ * generic_key.h). The bytes shared by every key of the page are stored once as
+ * the page prefix, and each entry only keeps the rest of its key. A slot
+ * directory in key order points at the entries, which are packed from the end
+ * of the page towards the slots.
+ *
+ * Leaf page format (slots are stored in key order):
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | PREFIX | SLOT(1) | ... | SLOT(n) | free | ENTRY(k) | ... | ENTRY(1) |
+ *  ---------------------------------------------------------------------------------
+ *  SLOT = Offset (2) + SuffixLength (2), ENTRY = KeySuffix + RID
+ *
+ *  Header format (size in byte, 40 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrefixSize (4) | HeapOffset (4)
+ *  ------------------------------------------------------------------------------
  */
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_HEADER_SIZE 40
 
 class BPlusTreeLeafPage : public BPlusTreePage {
+  // an entry outside of a page: the key without its zero padding and the record id
+  using Entry = std::pair<std::string, RowId>;
+
  public:
+  static constexpr int DATA_SIZE = PAGE_SIZE - LEAF_PAGE_HEADER_SIZE;
+  static constexpr int SLOT_SIZE = 2 * sizeof(uint16_t);
+
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
@@ -41,48 +55,69 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   void SetNextPageId(page_id_t next_page_id);
 
-  GenericKey *KeyAt(int index);
+  int GetPrefixSize() const { return prefix_size_; }
 
-  void SetKeyAt(int index, GenericKey *key);
+  // Copy the key at index into key, which must hold key_size bytes
+  void KeyAt(int index, GenericKey *key) const;
 
   RowId ValueAt(int index) const;
 
-  void SetValueAt(int index, RowId value);
-
-  int KeyIndex(const GenericKey *key, const KeyManager &comparator);
+  int KeyIndex(const GenericKey *key, const KeyManager &comparator) const;
 
-  void *PairPtrAt(int index);
+  // bytes taken by the prefix, the slots and the entries
+  int GetUsedBytes() const { return prefix_size_ + GetSize() * SLOT_SIZE + (DATA_SIZE - heap_offset_); }
 
-  void PairCopy(void *dest, void *src, int pair_num = 1);
+  // less than half full, the page should be merged with or borrow from a sibling
+  bool IsUnderflow() const { return GetUsedBytes() < DATA_SIZE / 2; }
 
-  std::pair<GenericKey *, RowId> GetItem(int index);
+  // nearly empty, BPlusTree::RemoveBatch only merges a page below this mark
+  bool IsBelowLowWater() const { return GetUsedBytes() < DATA_SIZE / 8; }
 
   // insert and delete methods
-  int Insert(GenericKey *key, const RowId &value, const KeyManager &comparator);
+  // @return false if the page has no room for the pair, the caller splits the page and retries
+  bool Insert(const GenericKey *key, const RowId &value, const KeyManager &comparator);
 
-  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator);
+  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator) const;
 
   int RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &comparator);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
 
-  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  // Append every pair to recipient, the left sibling of this page
+  // @return false and leave both pages untouched if they do not fit in one page
+  bool MoveAllTo(BPlusTreeLeafPage *recipient);
 
-  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
-
-  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  // Even out the bytes held by this page and its right sibling
+  // @return false and leave both pages untouched if they cannot be balanced
+  bool Redistribute(BPlusTreeLeafPage *right);
 
  private:
-  void CopyNFrom(void *src, int size);
+  uint16_t SlotOffset(int index) const;
+
+  uint16_t SlotLength(int index) const;
+
+  void SetSlot(int index, uint16_t offset, uint16_t length);
+
+  // compare the suffix at index with the part of a key after the page prefix
+  int CompareSuffix(int index, const char *suffix, int suffix_len) const;
+
+  void AppendEntries(std::vector<Entry> &entries) const;
+
+  // Rewrite this page with entries[begin, end), using their common prefix
+  void Rebuild(const std::vector<Entry> &entries, int begin, int end);
 
-  void CopyLastFrom(GenericKey *key, const RowId value);
+  // bytes that entries[begin, end) take in a page
+  static int GetRebuildSize(const std::vector<Entry> &entries, int begin, int end);
 
-  void CopyFirstFrom(GenericKey *key, const RowId value);
+  // find the split point of entries that leaves about the same number of bytes on both sides
+  static int GetBalancedSplit(const std::vector<Entry> &entries, int max_size);
 
   page_id_t next_page_id_{INVALID_PAGE_ID};
+  int prefix_size_;
+  int heap_offset_;
 
-  char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
+  char data_[DATA_SIZE];
 };
 
 using LeafPage = BPlusTreeLeafPage;
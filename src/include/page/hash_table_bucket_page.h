@@ -0,0 +1,76 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+/**
+ * hash_table_bucket_page.h
+ *
+ * Bucket of an extendible hash index. Pairs are kept unsorted and compared by
+ * their serialized bytes, a bucket only ever answers equality lookups. Once a
+ * bucket reaches the maximum directory depth, or holds only keys that no split
+ * can tell apart (duplicates of a non-unique index), further pairs go to
+ * overflow pages chained through NextPageId.
+ *
+ * Bucket page format:
+ *  ----------------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  ----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 20 bytes in total):
+ *  ---------------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | KeySize (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------------------
+ */
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+#define HASH_BUCKET_PAGE_HEADER_SIZE 20
+
+class HashTableBucketPage {
+ public:
+  // After creating a new bucket page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, int key_size);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  int GetSize() const { return size_; }
+
+  int GetMaxSize() const { return max_size_; }
+
+  bool IsFull() const { return size_ >= max_size_; }
+
+  GenericKey *KeyAt(int index);
+
+  RowId ValueAt(int index) const;
+
+  // @return the first slot from start on holding key, -1 if there is none
+  int KeyIndex(const GenericKey *key, int start = 0) const;
+
+  // @return the slot holding the pair (key, value), -1 if it is not in this page
+  int PairIndex(const GenericKey *key, const RowId &value) const;
+
+  // Append the pair, the caller makes sure the page is not full
+  void Insert(const GenericKey *key, const RowId &value);
+
+  // Fill the hole with the last pair, the order of pairs does not matter
+  void RemoveAt(int index);
+
+ private:
+  char *PairPtrAt(int index) { return data_ + index * (key_size_ + sizeof(RowId)); }
+
+  const char *PairPtrAt(int index) const { return data_ + index * (key_size_ + sizeof(RowId)); }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int key_size_;
+  int size_;
+  int max_size_;
+  char data_[PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE];
+};
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
@@ -0,0 +1,66 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+/**
+ * hash_table_directory_page.h
+ *
+ * Directory of an extendible hash index. Slot i points to the bucket page that
+ * holds the keys whose lowest global_depth hash bits equal i; a bucket with
+ * local depth d is shared by 2^(global_depth - d) slots.
+ *
+ * Directory page format (size in byte):
+ *  ----------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | LocalDepths (512) | BucketPageIds (4 * 512) |
+ *  ----------------------------------------------------------------------------
+ */
+#include <cstdint>
+
+#include "common/config.h"
+
+class HashTableDirectoryPage {
+ public:
+  static constexpr uint32_t MAX_GLOBAL_DEPTH = 9;
+  static constexpr uint32_t DIRECTORY_ARRAY_SIZE = 1U << MAX_GLOBAL_DEPTH;
+
+  // A new directory has a single slot pointing to bucket_page_id
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  uint32_t GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+  uint32_t Size() const { return 1U << global_depth_; }
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  // The slot that shares all but the highest local depth bit with bucket_idx
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  bool CanGrow() const { return global_depth_ < MAX_GLOBAL_DEPTH; }
+
+  // Double the directory, the new upper half mirrors the lower half
+  void IncrGlobalDepth();
+
+  // The directory can halve once no bucket uses the full global depth
+  bool CanShrink() const;
+
+  void DecrGlobalDepth();
+
+ private:
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "hash directory does not fit in a page");
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
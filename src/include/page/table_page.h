@@ -27,6 +27,8 @@
 #include "record/row.h"
 #include "recovery/log_manager.h"
 
+class CompiledPredicate;
+
 class TablePage : public Page {
  public:
   void Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Txn *txn);
@@ -58,6 +60,13 @@ class TablePage : public Page {
 
   bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
 
+  /**
+   * Check predicate on every live tuple of this page where the tuple is stored, and deserialize only the
+   * tuples that pass. A null predicate keeps every tuple.
+   * @param[out] rows The tuples that pass are appended here in slot order, each with its RowId
+   */
+  void ScanTuples(const CompiledPredicate *predicate, Schema *schema, std::vector<Row> &rows);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
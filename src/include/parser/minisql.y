@@ -1,12 +1,19 @@
 %{
   #include <stdio.h>
+  #include <string.h>
   #include "parser/parser.h"
 
   extern char *yytext;
   extern int yylex(void);
   int yyerror(char* error);
+
+  /* keywords added after minisql.l, see MinisqlLex */
+  static int MinisqlLex(void);
+  #define yylex MinisqlLex
 %}
 
+%define api.header.include {"parser/minisql_yacc.h"}
+
 %union {
 	pSyntaxNode syntax_node;
 }
@@ -17,6 +24,9 @@
 %token <syntax_node> ON FROM WHERE INTO SET VALUES PRIMARY KEY UNIQUE
 %token <syntax_node> CHAR INT FLOAT AND OR NOT IS FLAGNULL
 %token <syntax_node> IDENTIFIER STRING NUMBER EQ NE LE GE
+%token <syntax_node> ANALYZE
+%token <syntax_node> GROUP BY COUNT SUM MIN MAX AVG
+%token <syntax_node> ORDER ASC DESC LIMIT DISTINCT
 
 %type <syntax_node> start sql
 %type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
@@ -25,9 +35,11 @@
 %type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
 %type <syntax_node> sql_select select_columns column_values column_value operator
-%type <syntax_node> connector where_conditions where_condition
+%type <syntax_node> select_list select_item aggregate where_clause group_by_clause
+%type <syntax_node> order_by_clause order_list order_item order_direction limit_clause distinct_option
+%type <syntax_node> connector where_conditions where_condition table_list
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_quit sql_exec_file sql_analyze
 
 %%
 
@@ -58,6 +70,7 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_analyze { $$ = $1; }
   ;
 
 sql_create_database:
@@ -196,18 +209,113 @@ sql_show_indexes:
   ;
 
 sql_select:
-  SELECT select_columns FROM IDENTIFIER {
+  SELECT distinct_option select_columns FROM table_list where_clause group_by_clause order_by_clause limit_clause {
     $$ = CreateSyntaxNode(kNodeSelect, NULL);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, $5);
+    if ($6 != NULL) {
+      SyntaxNodeAddChildren($$, $6);
+    }
+    if ($7 != NULL) {
+      SyntaxNodeAddChildren($$, $7);
+    }
+    if ($8 != NULL) {
+      SyntaxNodeAddChildren($$, $8);
+    }
+    if ($9 != NULL) {
+      SyntaxNodeAddChildren($$, $9);
+    }
+    if ($2 != NULL) {
+      SyntaxNodeAddChildren($$, $2);
+    }
+  }
+  ;
+
+distinct_option:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | DISTINCT {
+    $$ = CreateSyntaxNode(kNodeDistinct, NULL);
+  }
+  ;
+
+where_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | WHERE where_conditions {
+    $$ = CreateSyntaxNode(kNodeConditions, NULL);
     SyntaxNodeAddChildren($$, $2);
-    SyntaxNodeAddChildren($$, $4);
   }
-  | SELECT select_columns FROM IDENTIFIER WHERE where_conditions {
-    $$ = CreateSyntaxNode(kNodeSelect, NULL);
+  ;
+
+group_by_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | GROUP BY column_list {
+    $$ = CreateSyntaxNode(kNodeGroupBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+order_by_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | ORDER BY order_list {
+    $$ = CreateSyntaxNode(kNodeOrderBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+limit_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | LIMIT NUMBER {
+    $$ = CreateSyntaxNode(kNodeLimit, NULL);
     SyntaxNodeAddChildren($$, $2);
-    SyntaxNodeAddChildren($$, $4);
-    pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, $6);
-    SyntaxNodeAddChildren($$, condition_node);
+  }
+  ;
+
+order_list:
+  order_item ',' order_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | order_item {
+    $$ = $1;
+  }
+  ;
+
+order_item:
+  select_item order_direction {
+    $$ = $2;
+    SyntaxNodeAddChildren($$, $1);
+  }
+  ;
+
+order_direction:
+  /* empty */ {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "asc");
+  }
+  | ASC {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "asc");
+  }
+  | DESC {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "desc");
+  }
+  ;
+
+table_list:
+  IDENTIFIER ',' table_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | IDENTIFIER {
+    $$ = $1;
   }
   ;
 
@@ -215,12 +323,54 @@ select_columns:
   '*' {
     $$ = CreateSyntaxNode(kNodeAllColumns, NULL);
   }
-  | column_list {
+  | select_list {
     $$ = CreateSyntaxNode(kNodeColumnList, "select columns");
     SyntaxNodeAddChildren($$, $1);
   }
   ;
 
+select_list:
+  select_item ',' select_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | select_item {
+    $$ = $1;
+  }
+  ;
+
+select_item:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | aggregate '(' IDENTIFIER ')' {
+    $$ = $1;
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | aggregate '(' '*' ')' {
+    $$ = $1;
+    SyntaxNodeAddChildren($$, CreateSyntaxNode(kNodeAllColumns, NULL));
+  }
+  ;
+
+aggregate:
+  COUNT {
+    $$ = CreateSyntaxNode(kNodeAggregate, "count");
+  }
+  | SUM {
+    $$ = CreateSyntaxNode(kNodeAggregate, "sum");
+  }
+  | MIN {
+    $$ = CreateSyntaxNode(kNodeAggregate, "min");
+  }
+  | MAX {
+    $$ = CreateSyntaxNode(kNodeAggregate, "max");
+  }
+  | AVG {
+    $$ = CreateSyntaxNode(kNodeAggregate, "avg");
+  }
+  ;
+
 where_conditions:
   where_conditions connector where_condition  {
     $$ = $2;
@@ -247,6 +397,11 @@ where_condition:
     SyntaxNodeAddChildren($$, $1);
     SyntaxNodeAddChildren($$, $3);
   }
+  | IDENTIFIER operator IDENTIFIER {
+    $$ = $2;
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
   ;
 
 column_value:
@@ -393,7 +548,50 @@ sql_exec_file:
   }
   ;
 
+sql_analyze:
+  ANALYZE IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeAnalyze, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
 %%
+#undef yylex
+
+/**
+ * The keywords below are not in minisql.l, they are scanned as identifiers and
+ * turned into keyword tokens here.
+ */
+static int MinisqlLex(void) {
+  static const struct {
+    const char *word;
+    int token;
+  } keywords[] = {
+      {"analyze", ANALYZE},
+      {"group", GROUP},
+      {"by", BY},
+      {"count", COUNT},
+      {"sum", SUM},
+      {"min", MIN},
+      {"max", MAX},
+      {"avg", AVG},
+      {"order", ORDER},
+      {"asc", ASC},
+      {"desc", DESC},
+      {"limit", LIMIT},
+      {"distinct", DISTINCT},
+  };
+  int token = yylex();
+  if (token == IDENTIFIER) {
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+      if (strcmp(yytext, keywords[i].word) == 0) {
+        return keywords[i].token;
+      }
+    }
+  }
+  return token;
+}
+
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
 	return 0;
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,59 +31,94 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_MINISQL_YACC_H_INCLUDED
+# define YY_YY_MINISQL_YACC_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
-#define YYTOKENTYPE
-/* Put the tokens into the symbol table, so that GDB and other debuggers
-   know about them.  */
-enum yytokentype {
-  CREATE = 258,
-  DROP = 259,
-  SELECT = 260,
-  INSERT = 261,
-  DELETE = 262,
-  UPDATE = 263,
-  TRXBEGIN = 264,
-  TRXCOMMIT = 265,
-  TRXROLLBACK = 266,
-  QUIT = 267,
-  EXECFILE = 268,
-  SHOW = 269,
-  USE = 270,
-  USING = 271,
-  DATABASE = 272,
-  DATABASES = 273,
-  TABLE = 274,
-  TABLES = 275,
-  INDEX = 276,
-  INDEXES = 277,
-  ON = 278,
-  FROM = 279,
-  WHERE = 280,
-  INTO = 281,
-  SET = 282,
-  VALUES = 283,
-  PRIMARY = 284,
-  KEY = 285,
-  UNIQUE = 286,
-  CHAR = 287,
-  INT = 288,
-  FLOAT = 289,
-  AND = 290,
-  OR = 291,
-  NOT = 292,
-  IS = 293,
-  FLAGNULL = 294,
-  IDENTIFIER = 295,
-  STRING = 296,
-  NUMBER = 297,
-  EQ = 298,
-  NE = 299,
-  LE = 300,
-  GE = 301
-};
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    CREATE = 258,                  /* CREATE  */
+    DROP = 259,                    /* DROP  */
+    SELECT = 260,                  /* SELECT  */
+    INSERT = 261,                  /* INSERT  */
+    DELETE = 262,                  /* DELETE  */
+    UPDATE = 263,                  /* UPDATE  */
+    TRXBEGIN = 264,                /* TRXBEGIN  */
+    TRXCOMMIT = 265,               /* TRXCOMMIT  */
+    TRXROLLBACK = 266,             /* TRXROLLBACK  */
+    QUIT = 267,                    /* QUIT  */
+    EXECFILE = 268,                /* EXECFILE  */
+    SHOW = 269,                    /* SHOW  */
+    USE = 270,                     /* USE  */
+    USING = 271,                   /* USING  */
+    DATABASE = 272,                /* DATABASE  */
+    DATABASES = 273,               /* DATABASES  */
+    TABLE = 274,                   /* TABLE  */
+    TABLES = 275,                  /* TABLES  */
+    INDEX = 276,                   /* INDEX  */
+    INDEXES = 277,                 /* INDEXES  */
+    ON = 278,                      /* ON  */
+    FROM = 279,                    /* FROM  */
+    WHERE = 280,                   /* WHERE  */
+    INTO = 281,                    /* INTO  */
+    SET = 282,                     /* SET  */
+    VALUES = 283,                  /* VALUES  */
+    PRIMARY = 284,                 /* PRIMARY  */
+    KEY = 285,                     /* KEY  */
+    UNIQUE = 286,                  /* UNIQUE  */
+    CHAR = 287,                    /* CHAR  */
+    INT = 288,                     /* INT  */
+    FLOAT = 289,                   /* FLOAT  */
+    AND = 290,                     /* AND  */
+    OR = 291,                      /* OR  */
+    NOT = 292,                     /* NOT  */
+    IS = 293,                      /* IS  */
+    FLAGNULL = 294,                /* FLAGNULL  */
+    IDENTIFIER = 295,              /* IDENTIFIER  */
+    STRING = 296,                  /* STRING  */
+    NUMBER = 297,                  /* NUMBER  */
+    EQ = 298,                      /* EQ  */
+    NE = 299,                      /* NE  */
+    LE = 300,                      /* LE  */
+    GE = 301,                      /* GE  */
+    ANALYZE = 302,                 /* ANALYZE  */
+    GROUP = 303,                   /* GROUP  */
+    BY = 304,                      /* BY  */
+    COUNT = 305,                   /* COUNT  */
+    SUM = 306,                     /* SUM  */
+    MIN = 307,                     /* MIN  */
+    MAX = 308,                     /* MAX  */
+    AVG = 309,                     /* AVG  */
+    ORDER = 310,                   /* ORDER  */
+    ASC = 311,                     /* ASC  */
+    DESC = 312,                    /* DESC  */
+    LIMIT = 313,                   /* LIMIT  */
+    DISTINCT = 314                 /* DISTINCT  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define CREATE 258
 #define DROP 259
 #define SELECT 260
@@ -130,19 +163,41 @@ enum yytokentype {
 #define NE 299
 #define LE 300
 #define GE 301
+#define ANALYZE 302
+#define GROUP 303
+#define BY 304
+#define COUNT 305
+#define SUM 306
+#define MIN 307
+#define MAX 308
+#define AVG 309
+#define ORDER 310
+#define ASC 311
+#define DESC 312
+#define LIMIT 313
+#define DISTINCT 314
 
-#if !defined YYSTYPE && !defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 10 "minisql.y"
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
 {
-  pSyntaxNode syntax_node;
-}
-/* Line 1529 of yacc.c.  */
-#line 145 "./minisql_yacc.h"
-YYSTYPE;
-#define yystype YYSTYPE /* obsolescent; will be withdrawn */
-#define YYSTYPE_IS_DECLARED 1
-#define YYSTYPE_IS_TRIVIAL 1
+#line 17 "minisql.y"
+
+	pSyntaxNode syntax_node;
+
+#line 189 "./minisql_yacc.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_MINISQL_YACC_H_INCLUDED  */
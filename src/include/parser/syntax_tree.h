@@ -43,7 +43,14 @@ typedef enum {
   kNodeIndexType,            /** type of index */
   kNodeTrxBegin,             /** begin recovery command */
   kNodeTrxCommit,            /** commit recovery command */
-  kNodeTrxRollback           /** rollback recovery command */
+  kNodeTrxRollback,          /** rollback recovery command */
+  kNodeAnalyze,              /** analyze table command */
+  kNodeAggregate,            /** aggregate function in select: count, sum, min, max, avg */
+  kNodeGroupBy,              /** group by columns, used in select */
+  kNodeOrderBy,              /** order by items, used in select */
+  kNodeOrderItem,            /** order by item: asc or desc, the sort key as its child */
+  kNodeLimit,                /** limit of select, the number of rows as its child */
+  kNodeDistinct              /** distinct of select */
 } SyntaxNodeType;
 
 /**
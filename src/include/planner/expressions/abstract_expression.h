@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "record/row.h"
+#include "record/row_batch.h"
 #include "record/schema.h"
 
 class AbstractExpression;
@@ -44,6 +45,34 @@ class AbstractExpression {
    */
   virtual Field EvaluateJoin(const Row *left_row, const Row *right_row) const = 0;
 
+  /**
+   * Evaluate the expression on the selected rows of a batch. out gets one value per row of the batch, or a
+   * single constant value, values of the rows outside the selection are unspecified.
+   * The default materializes every selected row and calls Evaluate().
+   */
+  virtual void EvaluateBatch(const RowBatch &batch, ColumnVector *out) const {
+    out->Reset(ret_type_);
+    out->Resize(batch.Size());
+    Row row;
+    for (auto i : batch.GetSelection()) {
+      batch.GetRow(i, &row);
+      out->Set(i, Evaluate(&row));
+    }
+  }
+
+  /** Shrink the selection of batch to the rows on which this predicate evaluates to true. */
+  void FilterBatch(RowBatch *batch) const {
+    ColumnVector result;
+    EvaluateBatch(*batch, &result);
+    auto &selection = batch->GetSelection();
+    size_t n = 0;
+    for (auto i : selection) {
+      selection[n] = i;
+      n += !result.IsNull(i) && result.Ints()[result.IsConstant() ? 0 : i] == CmpBool::kTrue;
+    }
+    selection.resize(n);
+  }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpressionRef &GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
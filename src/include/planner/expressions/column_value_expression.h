@@ -31,6 +31,8 @@ class ColumnValueExpression : public AbstractExpression {
     return row_idx_ == 0 ? Field(*left_row->GetField(col_idx_)) : Field(*right_row->GetField(col_idx_));
   }
 
+  void EvaluateBatch(const RowBatch &batch, ColumnVector *out) const override { *out = batch.GetColumn(col_idx_); }
+
   uint32_t GetRowIdx() const { return row_idx_; }
   uint32_t GetColIdx() const { return col_idx_; }
 
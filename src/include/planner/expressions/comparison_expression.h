@@ -5,9 +5,11 @@
 #ifndef MINISQL_COMPARISON_EXPRESSION_H
 #define MINISQL_COMPARISON_EXPRESSION_H
 
+#include <functional>
 #include <utility>
 
 #include "abstract_expression.h"
+#include "column_value_expression.h"
 #include "record/schema.h"
 
 /**
@@ -16,7 +18,7 @@
 class ComparisonExpression : public AbstractExpression {
  public:
   /** Creates a new comparison expression representing (left comp_type right). */
-  ComparisonExpression(AbstractExpressionRef left, AbstractExpressionRef right, string comp_type)
+  ComparisonExpression(AbstractExpressionRef left, AbstractExpressionRef right, std::string comp_type)
       : AbstractExpression({std::move(left), std::move(right)}, TypeId::kTypeInt, ExpressionType::ComparisonExpression),
         comp_type_{std::move(comp_type)} {}
 
@@ -33,9 +35,86 @@ class ComparisonExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComparison(lhs, rhs));
   }
 
+  /** Compare the two sides of the selected rows with one typed loop, a column is read in place. */
+  void EvaluateBatch(const RowBatch &batch, ColumnVector *out) const override {
+    ColumnVector lhs_buf;
+    ColumnVector rhs_buf;
+    const ColumnVector &lhs = EvaluateChildBatch(0, batch, &lhs_buf);
+    const ColumnVector &rhs = EvaluateChildBatch(1, batch, &rhs_buf);
+    if (comp_type_ != "is" && comp_type_ != "not" && lhs.GetType() != rhs.GetType()) {
+      AbstractExpression::EvaluateBatch(batch, out);
+      return;
+    }
+    out->Reset(TypeId::kTypeInt);
+    out->Resize(batch.Size(), false);
+    int32_t *result = out->MutableInts();
+    const auto &selection = batch.GetSelection();
+    if (comp_type_ == "is" || comp_type_ == "not") {
+      for (auto i : selection) {
+        result[i] = GetCmpBool(lhs.IsNull(i) == (comp_type_ == "is"));
+      }
+      return;
+    }
+    switch (lhs.GetType()) {
+      case TypeId::kTypeInt:
+        CompareBatch(lhs.Ints(), lhs.IsConstant(), rhs.Ints(), rhs.IsConstant(), selection, result);
+        break;
+      case TypeId::kTypeFloat:
+        CompareBatch(lhs.Floats(), lhs.IsConstant(), rhs.Floats(), rhs.IsConstant(), selection, result);
+        break;
+      case TypeId::kTypeChar:
+        CompareBatch(lhs.Chars(), lhs.IsConstant(), rhs.Chars(), rhs.IsConstant(), selection, result);
+        break;
+      default:
+        throw std::logic_error("Unsupported comparison type");
+    }
+    for (auto i : selection) {
+      if (lhs.IsNull(i) || rhs.IsNull(i)) {
+        result[i] = CmpBool::kNull;
+      }
+    }
+  }
+
   std::string GetComparisonType() { return comp_type_; }
 
  private:
+  /** A column child is returned straight from the batch, any other child is evaluated into buf. */
+  const ColumnVector &EvaluateChildBatch(uint32_t child_idx, const RowBatch &batch, ColumnVector *buf) const {
+    const auto &child = GetChildAt(child_idx);
+    if (child->GetType() == ExpressionType::ColumnExpression) {
+      return batch.GetColumn(std::static_pointer_cast<ColumnValueExpression>(child)->GetColIdx());
+    }
+    child->EvaluateBatch(batch, buf);
+    return *buf;
+  }
+
+  template <typename T>
+  void CompareBatch(const T *lhs, bool lhs_const, const T *rhs, bool rhs_const, const std::vector<uint32_t> &selection,
+                    int32_t *result) const {
+    if (comp_type_ == "=")
+      CompareLoop(lhs, lhs_const, rhs, rhs_const, selection, result, std::equal_to<T>());
+    else if (comp_type_ == "<>")
+      CompareLoop(lhs, lhs_const, rhs, rhs_const, selection, result, std::not_equal_to<T>());
+    else if (comp_type_ == "<")
+      CompareLoop(lhs, lhs_const, rhs, rhs_const, selection, result, std::less<T>());
+    else if (comp_type_ == "<=")
+      CompareLoop(lhs, lhs_const, rhs, rhs_const, selection, result, std::less_equal<T>());
+    else if (comp_type_ == ">")
+      CompareLoop(lhs, lhs_const, rhs, rhs_const, selection, result, std::greater<T>());
+    else if (comp_type_ == ">=")
+      CompareLoop(lhs, lhs_const, rhs, rhs_const, selection, result, std::greater_equal<T>());
+    else
+      throw std::logic_error("Unsupported comparison type");
+  }
+
+  template <typename T, typename Op>
+  static void CompareLoop(const T *lhs, bool lhs_const, const T *rhs, bool rhs_const,
+                          const std::vector<uint32_t> &selection, int32_t *result, Op op) {
+    for (auto i : selection) {
+      result[i] = op(lhs[lhs_const ? 0 : i], rhs[rhs_const ? 0 : i]) ? CmpBool::kTrue : CmpBool::kFalse;
+    }
+  }
+
   CmpBool PerformComparison(const Field &lhs, const Field &rhs) const {
     if (comp_type_ == "=")
       return lhs.CompareEquals(rhs);
@@ -0,0 +1,115 @@
+#ifndef MINISQL_COMPILED_PREDICATE_H
+#define MINISQL_COMPILED_PREDICATE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "planner/expressions/abstract_expression.h"
+#include "record/row.h"
+#include "record/row_batch.h"
+
+class CompiledPredicate;
+using CompiledPredicateRef = std::shared_ptr<const CompiledPredicate>;
+
+/**
+ * CompiledPredicate is a scan predicate flattened once at plan time into a postfix program. Comparisons carry
+ * an operator enum, the column index they read and the constant already in the column type, so a row or a
+ * batch is filtered by switching on the instruction instead of on the comparison string and the Type of every
+ * Field.
+ *
+ * The top level AND is split into conjuncts, each with its own program. A batch runs them one after another,
+ * every conjunct only over the rows that passed the previous ones. A sub-expression that does not fit an
+ * instruction is kept as is and run through the interpreter.
+ */
+class CompiledPredicate {
+ public:
+  enum class OpCode : uint8_t {
+    CompareConstant,  // column <op> constant
+    CompareColumn,    // column <op> column
+    IsNull,
+    IsNotNull,
+    And,
+    Or,
+    Expression,  // fall back to expr_
+  };
+
+  enum class CompareOp : uint8_t { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+  struct Instruction {
+    OpCode op_;
+    CompareOp cmp_{CompareOp::Equal};
+    TypeId type_{TypeId::kTypeInvalid};
+    uint32_t column_{0};
+    uint32_t rhs_column_{0};
+    /** The constant of CompareConstant in type_, a null constant makes the comparison null */
+    bool is_null_{false};
+    int32_t int_{0};
+    float float_{0};
+    std::string chars_;
+    AbstractExpressionRef expr_;
+  };
+
+  explicit CompiledPredicate(const AbstractExpressionRef &predicate);
+
+  /** @return whether the predicate is true on row, null counts as false */
+  bool Evaluate(const Row &row) const;
+
+  /**
+   * Evaluate the predicate on a tuple serialized by Row::SerializeTo, in place. The null bitmap and the
+   * lengths of the char columns are walked up to the last column the predicate reads, nothing is decoded
+   * into a Field. A predicate with an interpreted part deserializes the tuple first.
+   */
+  bool EvaluateTuple(const char *data, Schema *schema) const;
+
+  /** Shrink the selection of batch to the rows on which the predicate is true. */
+  void FilterBatch(RowBatch *batch) const;
+
+  /** @return the instructions of every conjunct, one after another */
+  const std::vector<Instruction> &GetProgram() const { return program_; }
+
+  size_t GetConjunctCount() const { return conjunct_ends_.size(); }
+
+ private:
+  void CompileConjuncts(const AbstractExpressionRef &expr);
+
+  void Compile(const AbstractExpressionRef &expr);
+
+  /** A column value of a row or of a serialized tuple, chars point into the Field or into the page */
+  struct Value {
+    bool is_null_{true};
+    int32_t int_{0};
+    float float_{0};
+    const char *chars_{nullptr};
+    uint32_t len_{0};
+  };
+
+  static Value GetValue(const Row &row, uint32_t column);
+
+  /** Run the program [begin, end), get(column) gives the Value of a column, row is only read by Expression. */
+  template <typename Getter>
+  CmpBool Run(size_t begin, size_t end, const Getter &get, const Row *row) const;
+
+  template <typename Getter>
+  CmpBool EvaluateValue(const Instruction &ins, const Getter &get, const Row *row) const;
+
+  /** Run the program [begin, end) over the selected rows, out gets a CmpBool for every row of the batch. */
+  void RunBatch(size_t begin, size_t end, const RowBatch &batch, std::vector<uint8_t> *out) const;
+
+  void EvaluateBatch(const Instruction &ins, const RowBatch &batch, std::vector<uint8_t> *out) const;
+
+  /** Shrink the selection by a single comparison with a constant, the common case, in one typed loop. */
+  void FilterConstant(const Instruction &ins, RowBatch *batch) const;
+
+  std::vector<Instruction> program_;
+  /** The end of each conjunct in program_, a conjunct starts where the previous one ends */
+  std::vector<size_t> conjunct_ends_;
+  /** The deepest the value stack of a conjunct gets */
+  size_t max_depth_{0};
+  /** The largest column index an instruction reads */
+  uint32_t max_column_{0};
+  /** Whether some instruction falls back to the interpreter */
+  bool has_expression_{false};
+};
+
+#endif  // MINISQL_COMPILED_PREDICATE_H
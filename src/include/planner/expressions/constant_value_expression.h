@@ -20,6 +20,8 @@ class ConstantValueExpression : public AbstractExpression {
 
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override { return Field(val_); }
 
+  void EvaluateBatch(const RowBatch & /*batch*/, ColumnVector *out) const override { out->SetConstant(val_); }
+
   const Field val_;
 };
 
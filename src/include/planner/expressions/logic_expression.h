@@ -37,6 +37,19 @@ class LogicExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComputation(lhs, rhs));
   }
 
+  void EvaluateBatch(const RowBatch &batch, ColumnVector *out) const override {
+    ColumnVector lhs;
+    ColumnVector rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    out->Reset(TypeId::kTypeInt);
+    out->Resize(batch.Size(), false);
+    int32_t *result = out->MutableInts();
+    for (auto i : batch.GetSelection()) {
+      result[i] = PerformComputation(GetValueAsCmpBool(lhs, i), GetValueAsCmpBool(rhs, i));
+    }
+  }
+
   static LogicType Char2Type(char *val) {
     if (!strcmp(val, "and"))
       return LogicType::And;
@@ -59,9 +72,18 @@ class LogicExpression : public AbstractExpression {
     return CmpBool::kFalse;
   }
 
+  static CmpBool GetValueAsCmpBool(const ColumnVector &vec, size_t i) {
+    if (vec.IsNull(i)) {
+      return CmpBool::kNull;
+    }
+    return vec.Ints()[vec.IsConstant() ? 0 : i] == 1 ? CmpBool::kTrue : CmpBool::kFalse;
+  }
+
   CmpBool PerformComputation(const Field &lhs, const Field &rhs) const {
-    auto l = GetFieldAsCmpBool(lhs);
-    auto r = GetFieldAsCmpBool(rhs);
+    return PerformComputation(GetFieldAsCmpBool(lhs), GetFieldAsCmpBool(rhs));
+  }
+
+  CmpBool PerformComputation(CmpBool l, CmpBool r) const {
     switch (logic_type_) {
       case LogicType::And:
         if (l == CmpBool::kFalse || r == CmpBool::kFalse) {
@@ -7,10 +7,19 @@
 
 #include "common/instance.h"
 #include "executor/plans/abstract_plan.h"
+#include "executor/plans/aggregation_plan.h"
 #include "executor/plans/delete_plan.h"
+#include "executor/plans/distinct_plan.h"
+#include "executor/plans/hash_join_plan.h"
+#include "executor/plans/index_nested_loop_join_plan.h"
+#include "executor/plans/index_only_scan_plan.h"
 #include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
+#include "executor/plans/limit_plan.h"
+#include "executor/plans/nested_loop_join_plan.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "executor/plans/sort_plan.h"
+#include "executor/plans/top_n_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "planner/statement/abstract_statement.h"
@@ -40,6 +49,73 @@ class Planner {
 
   AbstractPlanNodeRef PlanUpdate(std::shared_ptr<UpdateStatement> statement);
 
+  /**
+   * Whether the equal rows a plan yields are next to each other, so that DISTINCT only has to compare a row
+   * with the one before it: the plan is a sort, or a scan of a single b+ tree range, and every column it
+   * yields is among the leading columns it is ordered by, not counting the key columns fixed by equalities.
+   */
+  static bool IsGroupedByOutput(const AbstractPlanNodeRef &plan);
+
+  /**
+   * Put a LIMIT on top of a plan. A sort under a limit of at most TOP_N_MAX_ROWS rows becomes a top-n, which
+   * only keeps the rows it yields instead of sorting all of them.
+   */
+  AbstractPlanNodeRef PlanLimit(const AbstractPlanNodeRef &plan, size_t limit);
+
+  /**
+   * Plan the scan below SELECT/DELETE/UPDATE. Equalities on a leading prefix of an index key, plus the
+   * comparisons on the next key column, are merged into one key range; without any usable comparison
+   * this falls back to a sequential scan. When an index key holds every column the query reads, an
+   * index-only scan is planned instead. Once the table has been analyzed, an index or bitmap heap scan is
+   * only kept if its estimated cost is below that of a sequential scan.
+   * @param snapshot_rids set when the caller modifies the indexes the scan may read
+   */
+  AbstractPlanNodeRef PlanScan(const Schema *out_schema, const std::string &table_name,
+                               const AbstractExpressionRef &predicate, bool snapshot_rids = false);
+
+  /**
+   * Plan a SELECT over several tables as a left-deep tree of joins in the order of FROM. A condition on a
+   * single table is pushed down to its scan, the others are evaluated when the last table they read is
+   * joined. Equalities between the two sides become the keys of a hash join, built on the side with fewer
+   * estimated rows; without any, the tables are joined with nested loops. When a b+ tree index of the table
+   * joined in has its whole key among the equalities and probing it for every outer row is cheaper than
+   * reading the table, an index nested loop join is planned instead.
+   */
+  AbstractPlanNodeRef PlanJoin(std::shared_ptr<SelectStatement> statement, const Schema *out_schema);
+
+  /**
+   * Plan the scan or the joins of the tables of a SELECT so that they yield every column of every table,
+   * laid out as by MakeJoinedSchema, for the operators that read columns outside the SELECT list.
+   */
+  AbstractPlanNodeRef PlanTables(std::shared_ptr<SelectStatement> statement);
+
+  /**
+   * Plan a SELECT with aggregates or GROUP BY as a hash aggregation over PlanTables().
+   */
+  AbstractPlanNodeRef PlanAggregation(std::shared_ptr<SelectStatement> statement);
+
+  /**
+   * Make the schema of the rows joined from the first count tables, a column takes its position in the row
+   * made of the columns of every table as its table index.
+   * @param offsets the position of the first column of every table in that row
+   */
+  static Schema *MakeJoinedSchema(const std::vector<TableInfo *> &infos, const std::vector<uint32_t> &offsets,
+                                  size_t count);
+
+  /**
+   * Find the b+ tree index of a table with the most key columns, all of which are among inner_keys.
+   * @param[out] key_positions for every key column, the position of its expression in inner_keys
+   * @return nullptr if there is none
+   */
+  IndexInfo *FindJoinIndex(const std::string &table_name, const std::vector<AbstractExpressionRef> &inner_keys,
+                           std::vector<size_t> &key_positions);
+
+  /**
+   * Estimate whether an index range is large enough to be read as a bitmap heap scan, by counting its
+   * entries up to BITMAP_HEAP_SCAN_MIN_ROWS.
+   */
+  bool IsLargeRange(const IndexKeyRange &range);
+
   /** the root plan node of the plan tree */
   AbstractPlanNodeRef plan_;
 
@@ -52,6 +128,24 @@ class Planner {
 
   /** The maximum size allowed for VARCHAR columns */
   static constexpr const uint32_t MAX_VARCHAR_SIZE = 128;
+
+  /** Index ranges with at least this many entries are fetched page by page */
+  static constexpr const uint32_t BITMAP_HEAP_SCAN_MIN_ROWS = 64;
+
+  /** Cost of reading a page in order, the unit of the cost model */
+  static constexpr const double SEQ_PAGE_COST = 1.0;
+  /** Cost of reading a page at random */
+  static constexpr const double RANDOM_PAGE_COST = 4.0;
+  /** Cost of evaluating one row */
+  static constexpr const double CPU_TUPLE_COST = 0.01;
+  /** Cost of reading one index entry */
+  static constexpr const double CPU_INDEX_TUPLE_COST = 0.005;
+  /** Rows assumed for a table that has not been analyzed */
+  static constexpr const double DEFAULT_TABLE_ROWS = 1000;
+  /** Pages assumed for a table that has not been analyzed */
+  static constexpr const double DEFAULT_TABLE_PAGES = 10;
+  /** Rows assumed to share a key of a non-unique index of a table that has not been analyzed */
+  static constexpr const double DEFAULT_INDEX_MATCHES = 10;
 };
 
 #endif  // MINISQL_PLANNER_H
@@ -40,7 +40,7 @@ class AbstractStatement {
    * @param col The ptr to the SyntaxNode of the column
    * @return A owning pointer to the ColumnValueExpression
    */
-  AbstractExpressionRef MakeColumnValueExpression(const std::string &table_name, pSyntaxNode col) {
+  virtual AbstractExpressionRef MakeColumnValueExpression(const std::string &table_name, pSyntaxNode col) {
     TableInfo *info = nullptr;
     context_->GetCatalog()->GetTable(table_name, info);
     auto schema = info->GetSchema();
@@ -112,15 +112,29 @@ class AbstractStatement {
         pSyntaxNode col = ast->child_;
         pSyntaxNode value = ast->child_->next_;
         auto col_expr = MakeColumnValueExpression(table_name, col);
-        auto const_expr = MakeConstantValueExpression(col_expr->GetReturnType(), value);
+        AbstractExpressionRef value_expr;
+        if (value->type_ == kNodeIdentifier) {
+          // 两列之间的比较, 例如连接条件
+          value_expr = MakeColumnValueExpression(table_name, value);
+          if (value_expr->GetReturnType() != col_expr->GetReturnType()) {
+            throw std::logic_error("the columns compared are not of the same type");
+          }
+        } else {
+          value_expr = MakeConstantValueExpression(col_expr->GetReturnType(), value);
+        }
         if (column_in_condition) {
-          uint32_t index = dynamic_pointer_cast<ColumnValueExpression>(col_expr)->GetColIdx();
-          if (std::find(column_in_condition->begin(), column_in_condition->end(), index) ==
-              column_in_condition->end()) {
-            column_in_condition->emplace_back(index);
+          for (const auto &expr : {col_expr, value_expr}) {
+            if (expr->GetType() != ExpressionType::ColumnExpression) {
+              continue;
+            }
+            uint32_t index = dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx();
+            if (std::find(column_in_condition->begin(), column_in_condition->end(), index) ==
+                column_in_condition->end()) {
+              column_in_condition->emplace_back(index);
+            }
           }
         }
-        return MakeComparisonExpression(col_expr, const_expr, ast->val_);
+        return MakeComparisonExpression(col_expr, value_expr, ast->val_);
       }
       default:
         throw std::logic_error("The node kNodeConditions has a child node of the wrong type");
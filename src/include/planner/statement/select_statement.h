@@ -6,6 +6,8 @@
 #define MINISQL_SELECT_STATEMENT_H
 
 #include "abstract_statement.h"
+#include "executor/plans/aggregation_plan.h"
+#include "executor/plans/sort_plan.h"
 
 class SelectStatement : public AbstractStatement {
  public:
@@ -23,19 +25,50 @@ class SelectStatement : public AbstractStatement {
           error_info << "the table " << ast->val_ << " is not exist.";
           throw std::logic_error(error_info.str());
         }
-        table_name_ = ast->val_;
+        if (std::find(table_names_.begin(), table_names_.end(), ast->val_) != table_names_.end()) {
+          throw std::logic_error("the table " + std::string(ast->val_) + " appears twice in FROM");
+        }
+        if (table_names_.empty()) {
+          table_name_ = ast->val_;
+        }
+        table_names_.emplace_back(ast->val_);
         break;
       }
       case kNodeAllColumns:
       case kNodeColumnList: {
         SyntaxTree2Statement(ast->next_);
         MakeColumnList(ast->child_);
+        MakeOrderBy(order_by_ast_);
         return;
       }
       case kNodeConditions: {
         where_ = MakePredicate(ast->child_, table_name_, &column_in_condition_, &has_or);
         break;
       }
+      case kNodeOrderBy: {
+        // 要等 SELECT 列表绑定之后才能绑定
+        order_by_ast_ = ast->child_;
+        break;
+      }
+      case kNodeDistinct: {
+        distinct_ = true;
+        break;
+      }
+      case kNodeLimit: {
+        std::string number = ast->child_->val_;
+        if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos) {
+          throw std::logic_error("the LIMIT must be a non-negative integer");
+        }
+        limit_ = std::stoull(number);
+        has_limit_ = true;
+        break;
+      }
+      case kNodeGroupBy: {
+        for (auto col = ast->child_; col != nullptr; col = col->next_) {
+          group_by_.emplace_back(MakeColumnValueExpression(table_name_, col));
+        }
+        break;
+      }
       default:
         throw std::logic_error("the ast_type is not supported in planner yet");
     }
@@ -43,34 +76,213 @@ class SelectStatement : public AbstractStatement {
   };
 
   void MakeColumnList(pSyntaxNode ast) {
-    TableInfo *info = nullptr;
-    context_->GetCatalog()->GetTable(table_name_, info);
-    auto schema = info->GetSchema();
     if (!ast) {
-      auto columns = schema->GetColumns();
-      for (auto column : columns) {
-        auto expr = std::make_shared<ColumnValueExpression>(0, column->GetTableInd(), column->GetType());
-        column_list_.emplace_back(make_pair(column->GetName(), expr));
+      uint32_t offset = 0;
+      for (const auto &table_name : table_names_) {
+        TableInfo *info = nullptr;
+        context_->GetCatalog()->GetTable(table_name, info);
+        for (auto column : info->GetSchema()->GetColumns()) {
+          auto expr = std::make_shared<ColumnValueExpression>(0, offset + column->GetTableInd(), column->GetType());
+          column_list_.emplace_back(make_pair(column->GetName(), expr));
+        }
+        offset += info->GetSchema()->GetColumnCount();
       }
     } else {
       while (ast) {
-        uint32_t index;
-        if (schema->GetColumnIndex(ast->val_, index) != DB_SUCCESS) {
-          throw std::logic_error("the column does not exist in table");
+        if (ast->type_ == kNodeAggregate) {
+          MakeAggregate(ast);
+        } else {
+          column_list_.emplace_back(make_pair(ast->val_, MakeColumnValueExpression(table_name_, ast)));
         }
-        auto expr = std::make_shared<ColumnValueExpression>(0, index, schema->GetColumn(index)->GetType());
-        column_list_.emplace_back(make_pair(ast->val_, expr));
         ast = ast->next_;
       }
     }
+    if (aggregates_.empty() && group_by_.empty()) {
+      return;
+    }
+    // 分组之后每组只剩一行, 普通列只能是分组的列
+    for (size_t i = 0, j = 0; i < column_list_.size(); i++) {
+      if (j < aggregates_.size() && aggregates_[j].first == i) {
+        j++;
+        continue;
+      }
+      if (GetGroupByPosition(column_list_[i].second) == group_by_.size()) {
+        throw std::logic_error("the column " + column_list_[i].first +
+                               " must appear in GROUP BY or in an aggregate function");
+      }
+    }
+  }
+
+  /** Bind an aggregate of the SELECT list, its argument goes to column_list_ (null for COUNT(*)). */
+  void MakeAggregate(pSyntaxNode ast) {
+    std::string func = ast->val_;
+    pSyntaxNode arg = ast->child_;
+    if (arg->type_ == kNodeAllColumns) {
+      if (func != "count") {
+        throw std::logic_error(func + "(*) is not supported");
+      }
+      aggregates_.emplace_back(column_list_.size(), AggregationType::CountStarAggregate);
+      column_list_.emplace_back(make_pair(AggregateName(ast), nullptr));
+      return;
+    }
+    auto expr = MakeColumnValueExpression(table_name_, arg);
+    AggregationType type;
+    if (func == "count") {
+      type = AggregationType::CountAggregate;
+    } else if (func == "sum") {
+      type = AggregationType::SumAggregate;
+    } else if (func == "avg") {
+      type = AggregationType::AvgAggregate;
+    } else if (func == "min") {
+      type = AggregationType::MinAggregate;
+    } else {
+      type = AggregationType::MaxAggregate;
+    }
+    if ((type == AggregationType::SumAggregate || type == AggregationType::AvgAggregate) &&
+        expr->GetReturnType() == TypeId::kTypeChar) {
+      throw std::logic_error("the column of " + func + " must be a number");
+    }
+    aggregates_.emplace_back(column_list_.size(), type);
+    column_list_.emplace_back(make_pair(AggregateName(ast), expr));
+  }
+
+  /** @return The name of an aggregate in the SELECT list, such as count(*) */
+  static std::string AggregateName(pSyntaxNode ast) {
+    pSyntaxNode arg = ast->child_;
+    return std::string(ast->val_) + "(" + (arg->type_ == kNodeAllColumns ? "*" : arg->val_) + ")";
+  }
+
+  /**
+   * Bind ORDER BY. Without aggregates a key reads the row made of the columns of every table in FROM;
+   * with them the key has to be in the SELECT list, and reads the row of the aggregation.
+   */
+  void MakeOrderBy(pSyntaxNode ast) {
+    bool grouped = !aggregates_.empty() || !group_by_.empty();
+    for (; ast != nullptr; ast = ast->next_) {
+      auto type = strcmp(ast->val_, "desc") == 0 ? OrderByType::Desc : OrderByType::Asc;
+      pSyntaxNode key = ast->child_;
+      if (!grouped) {
+        if (key->type_ == kNodeAggregate) {
+          throw std::logic_error("aggregate functions in ORDER BY must also appear in the SELECT list");
+        }
+        order_by_.emplace_back(type, MakeColumnValueExpression(table_name_, key));
+        continue;
+      }
+      std::string name = key->type_ == kNodeAggregate ? AggregateName(key) : key->val_;
+      size_t i = 0;
+      while (i < column_list_.size() && column_list_[i].first != name) {
+        i++;
+      }
+      if (i == column_list_.size()) {
+        throw std::logic_error("the ORDER BY key " + name + " must appear in the SELECT list");
+      }
+      order_by_.emplace_back(type, std::make_shared<ColumnValueExpression>(0, i, GetColumnType(i)));
+    }
+    if (!distinct_ || order_by_.empty()) {
+      return;
+    }
+    // DISTINCT 之后再排序, 键必须在 SELECT 列表中; 其余的列也加进排序键, 相等的行就排在一起
+    auto select_key = [&](size_t i) -> AbstractExpressionRef {
+      return grouped ? std::make_shared<ColumnValueExpression>(0, i, GetColumnType(i)) : column_list_[i].second;
+    };
+    auto col_idx = [](const AbstractExpressionRef &expr) {
+      return dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx();
+    };
+    std::vector<uint32_t> keys, selected;
+    for (const auto &order_by : order_by_) {
+      keys.push_back(col_idx(order_by.second));
+    }
+    for (size_t i = 0; i < column_list_.size(); i++) {
+      selected.push_back(col_idx(select_key(i)));
+    }
+    for (auto key : keys) {
+      if (std::find(selected.begin(), selected.end(), key) == selected.end()) {
+        throw std::logic_error("for SELECT DISTINCT, the ORDER BY keys must appear in the SELECT list");
+      }
+    }
+    for (size_t i = 0; i < column_list_.size(); i++) {
+      if (std::find(keys.begin(), keys.end(), selected[i]) == keys.end()) {
+        order_by_.emplace_back(OrderByType::Asc, select_key(i));
+        keys.push_back(selected[i]);
+      }
+    }
+  }
+
+  /** @return The type of the i-th column of the SELECT list, the result type for an aggregate */
+  TypeId GetColumnType(size_t i) const {
+    const auto &expr = column_list_[i].second;
+    for (const auto &aggregate : aggregates_) {
+      if (aggregate.first == i) {
+        return AggregationPlanNode::GetResultType(aggregate.second,
+                                                  expr == nullptr ? TypeId::kTypeInt : expr->GetReturnType());
+      }
+    }
+    return expr->GetReturnType();
   }
 
-  /** Bound FROM clause. */
+  /** @return The position of a column in GROUP BY, group_by_.size() if it is not there */
+  size_t GetGroupByPosition(const AbstractExpressionRef &column) const {
+    auto col_idx = dynamic_pointer_cast<ColumnValueExpression>(column)->GetColIdx();
+    for (size_t i = 0; i < group_by_.size(); i++) {
+      if (dynamic_pointer_cast<ColumnValueExpression>(group_by_[i])->GetColIdx() == col_idx) {
+        return i;
+      }
+    }
+    return group_by_.size();
+  }
+
+  /**
+   * Resolve a column by name among all the tables in FROM. The column index is its position in the row
+   * made of the columns of every table, in the order of FROM; for a single table that is its table index.
+   */
+  AbstractExpressionRef MakeColumnValueExpression(const std::string &table_name, pSyntaxNode col) override {
+    uint32_t offset = 0;
+    AbstractExpressionRef expr = nullptr;
+    for (const auto &name : table_names_) {
+      TableInfo *info = nullptr;
+      context_->GetCatalog()->GetTable(name, info);
+      auto schema = info->GetSchema();
+      uint32_t index;
+      if (schema->GetColumnIndex(col->val_, index) == DB_SUCCESS) {
+        if (expr != nullptr) {
+          throw std::logic_error("the column " + std::string(col->val_) + " is ambiguous");
+        }
+        expr = std::make_shared<ColumnValueExpression>(0, offset + index, schema->GetColumn(index)->GetType());
+      }
+      offset += schema->GetColumnCount();
+    }
+    if (expr == nullptr) {
+      throw std::logic_error("the column does not exist in table");
+    }
+    return expr;
+  }
+
+  /** Bound FROM clause, table_name_ is the first of table_names_. */
   std::string table_name_;
+  std::vector<std::string> table_names_;
 
   /** Bound SELECT list. */
   std::vector<std::pair<std::string, AbstractExpressionRef>> column_list_;
 
+  /** Aggregates of the SELECT list: their position in column_list_ and their function. */
+  std::vector<std::pair<size_t, AggregationType>> aggregates_;
+
+  /** Bound GROUP BY clause. */
+  std::vector<AbstractExpressionRef> group_by_;
+
+  /** Bound ORDER BY clause. */
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_by_;
+
+  /** SELECT DISTINCT */
+  bool distinct_ = false;
+
+  /** Bound LIMIT clause. */
+  bool has_limit_ = false;
+  size_t limit_ = 0;
+
+  /** Items of ORDER BY, bound once the SELECT list is. */
+  pSyntaxNode order_by_ast_ = nullptr;
+
   /** Index of columns in condition. */
   std::vector<uint32_t> column_in_condition_;
 
@@ -0,0 +1,117 @@
+#ifndef MINISQL_ROW_BATCH_H
+#define MINISQL_ROW_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * The values of one column over the rows of a batch, kept in a typed array so that expressions can be
+ * evaluated with plain loops instead of a Field per value. A constant vector holds a single value that
+ * stands for every row.
+ */
+class ColumnVector {
+ public:
+  explicit ColumnVector(TypeId type = TypeId::kTypeInvalid) : type_(type) {}
+
+  /** Drop every value and switch to the given type. */
+  void Reset(TypeId type);
+
+  /** Resize to n values, new values are null unless is_null is false. */
+  void Resize(size_t n, bool is_null = true);
+
+  /** Make this a constant vector holding val. */
+  void SetConstant(const Field &val);
+
+  void Append(const Field &field);
+
+  /** Overwrite the i-th value, the vector must already hold it. */
+  void Set(size_t i, const Field &field);
+
+  inline void SetInt(size_t i, int32_t val) {
+    ints_[i] = val;
+    nulls_[i] = false;
+  }
+
+  inline TypeId GetType() const { return type_; }
+
+  inline size_t Size() const { return nulls_.size(); }
+
+  inline bool IsConstant() const { return is_constant_; }
+
+  inline bool IsNull(size_t i) const { return nulls_[is_constant_ ? 0 : i]; }
+
+  inline const int32_t *Ints() const { return ints_.data(); }
+
+  inline int32_t *MutableInts() { return ints_.data(); }
+
+  inline const float *Floats() const { return floats_.data(); }
+
+  inline const std::string *Chars() const { return chars_.data(); }
+
+  /** @return the i-th value as a field, char data is copied */
+  Field GetField(size_t i) const;
+
+ private:
+  TypeId type_;
+  bool is_constant_{false};
+  std::vector<uint8_t> nulls_;
+  std::vector<int32_t> ints_;
+  std::vector<float> floats_;
+  std::vector<std::string> chars_;
+};
+
+/**
+ * Up to ROW_BATCH_SIZE rows stored column by column, with the RowId of every row and a selection vector
+ * listing, in ascending order, the positions of the rows that are still alive. Filters only shrink the
+ * selection and never move values around.
+ */
+class RowBatch {
+ public:
+  RowBatch() = default;
+
+  /**
+   * Drop every row and take the column types of schema. Without a schema the batch takes the types of the
+   * first row appended, so the rows of a DML executor, which carry no fields, leave it with bare RowIds.
+   */
+  void Reset(const Schema *schema);
+
+  /** Append a row (its first GetColumnCount() fields) and select it. */
+  void Append(const Row &row, RowId rid);
+
+  inline size_t Size() const { return rids_.size(); }
+
+  inline bool Full() const { return rids_.size() >= static_cast<size_t>(ROW_BATCH_SIZE); }
+
+  inline uint32_t GetColumnCount() const { return columns_.size(); }
+
+  inline ColumnVector &GetColumn(uint32_t i) { return columns_[i]; }
+
+  inline const ColumnVector &GetColumn(uint32_t i) const { return columns_[i]; }
+
+  inline RowId GetRowId(size_t i) const { return rids_[i]; }
+
+  inline std::vector<uint32_t> &GetSelection() { return selection_; }
+
+  inline const std::vector<uint32_t> &GetSelection() const { return selection_; }
+
+  /** Materialize the i-th row, it carries its RowId. */
+  void GetRow(size_t i, Row *row) const;
+
+  /**
+   * Fill out with the columns of output_schema, taken by GetTableInd() from this batch, which holds the
+   * columns of the whole table. The selection is copied as is.
+   */
+  void Project(const Schema *output_schema, RowBatch *out) const;
+
+ private:
+  bool has_schema_{false};
+  std::vector<ColumnVector> columns_;
+  std::vector<RowId> rids_;
+  std::vector<uint32_t> selection_;
+};
+
+#endif  // MINISQL_ROW_BATCH_H
@@ -71,6 +71,26 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Txn *txn);
 
+  /**
+   * Read a batch of tuples, fetching each page once for every run of row ids on the same page.
+   * Callers sort the row ids by page to get the most out of it.
+   * @param[in] rids Row ids of the tuples to read
+   * @param[out] rows The tuples that exist are appended here, in the order of rids
+   * @param[in] txn recovery performing the read
+   */
+  void GetTuples(const std::vector<RowId> &rids, std::vector<Row> &rows, Txn *txn);
+
+  /**
+   * Read the tuples of one page that satisfy predicate. The predicate is checked on the serialized tuples
+   * inside the pinned page, a tuple that fails it is never deserialized.
+   * @param[in] page_id The page to scan
+   * @param[in] predicate The filter, null keeps every tuple
+   * @param[out] rows The tuples that pass are appended here in slot order
+   * @param[in] txn recovery performing the read
+   * @return the id of the page after page_id, INVALID_PAGE_ID after the last page
+   */
+  page_id_t ScanPage(page_id_t page_id, const CompiledPredicate *predicate, std::vector<Row> &rows, Txn *txn);
+
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
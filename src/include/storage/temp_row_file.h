@@ -0,0 +1,62 @@
+#ifndef MINISQL_TEMP_ROW_FILE_H
+#define MINISQL_TEMP_ROW_FILE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "record/row.h"
+
+/**
+ * Rows written once to temporary pages of the buffer pool and then read back in the order they were
+ * written, for operators whose input does not fit in memory. The pages are only written to disk if the
+ * buffer pool evicts them, and are deleted together with the file.
+ *
+ * Page format:
+ * ---------------------------------------------------------------
+ * | Row count (4) | RowId (8) | Row size (4) | Row | RowId ... |
+ * ---------------------------------------------------------------
+ */
+class TempRowFile {
+ public:
+  TempRowFile(BufferPoolManager *buffer_pool_manager, const Schema *schema);
+
+  ~TempRowFile();
+
+  DISALLOW_COPY_AND_MOVE(TempRowFile);
+
+  /** Append a row and its RowId, the row is laid out by the schema of the file. */
+  void Append(const Row &row);
+
+  /** Stop writing and go back to the first row. */
+  void Rewind();
+
+  /**
+   * Read the next row.
+   * @return `false` once every row has been read
+   */
+  bool Next(Row *row);
+
+  inline size_t GetRowCount() const { return row_count_; }
+
+  inline size_t GetPageCount() const { return pages_.size(); }
+
+ private:
+  /** Unpin the page being written or read, if any. */
+  void ReleasePage();
+
+  static constexpr uint32_t HEADER_SIZE = sizeof(uint32_t);
+  static constexpr uint32_t ENTRY_HEADER_SIZE = sizeof(int64_t) + sizeof(uint32_t);
+
+  BufferPoolManager *buffer_pool_manager_;
+  Schema *schema_;
+  std::vector<page_id_t> pages_;
+  size_t row_count_{0};
+  /** The pinned page being written or read and the cursor in it */
+  Page *page_{nullptr};
+  bool writing_{true};
+  uint32_t offset_{0};
+  uint32_t rows_left_{0};
+  size_t next_page_{0};
+};
+
+#endif  // MINISQL_TEMP_ROW_FILE_H
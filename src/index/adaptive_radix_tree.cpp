@@ -0,0 +1,493 @@
+#include "index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+AdaptiveRadixTree::AdaptiveRadixTree(const KeyManager &KM) : key_size_(KM.GetKeySize()) {}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() { Clear(); }
+
+void AdaptiveRadixTree::Clear() {
+  FreeNode(root_);
+  root_ = nullptr;
+  size_ = 0;
+}
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+AdaptiveRadixTree::Leaf *AdaptiveRadixTree::NewLeaf(const uint8_t *key, const RowId &value) const {
+  // key 紧跟在叶子后面, 一次分配
+  auto *leaf = static_cast<Leaf *>(malloc(sizeof(Leaf) + key_size_));
+  leaf->type_ = NodeType::kLeaf;
+  new (&leaf->value_) RowId(value);
+  memcpy(leaf->key_, key, key_size_);
+  return leaf;
+}
+
+template <typename N>
+N *AdaptiveRadixTree::NewNode(const InnerNode *header) {
+  auto *node = new N();
+  if (std::is_same<N, Node4>::value) node->type_ = NodeType::kNode4;
+  if (std::is_same<N, Node16>::value) node->type_ = NodeType::kNode16;
+  if (std::is_same<N, Node48>::value) node->type_ = NodeType::kNode48;
+  if (std::is_same<N, Node256>::value) node->type_ = NodeType::kNode256;
+  if (header != nullptr) {
+    node->num_children_ = header->num_children_;
+    node->prefix_len_ = header->prefix_len_;
+    memcpy(node->prefix_, header->prefix_, std::min<uint32_t>(header->prefix_len_, MAX_PREFIX_LEN));
+  }
+  return node;
+}
+
+void AdaptiveRadixTree::FreeNode(Node *node) {
+  if (node == nullptr) return;
+  switch (node->type_) {
+    case NodeType::kLeaf:
+      free(node);
+      return;
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->num_children_; i++) FreeNode(n->children_[i]);
+      delete n;
+      return;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<Node16 *>(node);
+      for (int i = 0; i < n->num_children_; i++) FreeNode(n->children_[i]);
+      delete n;
+      return;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      for (auto child : n->children_) FreeNode(child);
+      delete n;
+      return;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      for (auto child : n->children_) FreeNode(child);
+      delete n;
+      return;
+    }
+  }
+}
+
+bool AdaptiveRadixTree::LeafMatches(const Leaf *leaf, const uint8_t *key) const {
+  return memcmp(leaf->key_, key, key_size_) == 0;
+}
+
+AdaptiveRadixTree::Node **AdaptiveRadixTree::FindChild(InnerNode *node, uint8_t c) {
+  switch (node->type_) {
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->num_children_; i++) {
+        if (n->keys_[i] == c) return &n->children_[i];
+      }
+      return nullptr;
+    }
+    case NodeType::kNode16: {
+      // keys_ 有序, 二分查找
+      auto *n = static_cast<Node16 *>(node);
+      auto *end = n->keys_ + n->num_children_;
+      auto *it = std::lower_bound(n->keys_, end, c);
+      return it != end && *it == c ? &n->children_[it - n->keys_] : nullptr;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      return n->child_index_[c] != 0 ? &n->children_[n->child_index_[c] - 1] : nullptr;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      return n->children_[c] != nullptr ? &n->children_[c] : nullptr;
+    }
+    default:
+      return nullptr;
+  }
+}
+
+const AdaptiveRadixTree::Leaf *AdaptiveRadixTree::MinLeaf(const Node *node) {
+  while (node != nullptr && node->type_ != NodeType::kLeaf) {
+    switch (node->type_) {
+      case NodeType::kNode4:
+        node = static_cast<const Node4 *>(node)->children_[0];
+        break;
+      case NodeType::kNode16:
+        node = static_cast<const Node16 *>(node)->children_[0];
+        break;
+      case NodeType::kNode48: {
+        auto *n = static_cast<const Node48 *>(node);
+        int c = 0;
+        while (n->child_index_[c] == 0) c++;
+        node = n->children_[n->child_index_[c] - 1];
+        break;
+      }
+      case NodeType::kNode256: {
+        auto *n = static_cast<const Node256 *>(node);
+        int c = 0;
+        while (n->children_[c] == nullptr) c++;
+        node = n->children_[c];
+        break;
+      }
+      default:
+        return nullptr;
+    }
+  }
+  return static_cast<const Leaf *>(node);
+}
+
+int AdaptiveRadixTree::PrefixMismatch(const InnerNode *node, const uint8_t *key, int depth) const {
+  int max_cmp = std::min<int>(std::min<int>(node->prefix_len_, MAX_PREFIX_LEN), key_size_ - depth);
+  int idx = 0;
+  for (; idx < max_cmp; idx++) {
+    if (node->prefix_[idx] != key[depth + idx]) return idx;
+  }
+  // 超出 MAX_PREFIX_LEN 的部分没有存下来, 与子树中任一叶子比较
+  if (static_cast<int>(node->prefix_len_) > MAX_PREFIX_LEN) {
+    const Leaf *leaf = MinLeaf(node);
+    max_cmp = std::min<int>(node->prefix_len_, key_size_ - depth);
+    for (; idx < max_cmp; idx++) {
+      if (leaf->key_[depth + idx] != key[depth + idx]) return idx;
+    }
+  }
+  return idx;
+}
+
+void AdaptiveRadixTree::AddChild(InnerNode *node, Node **ref, uint8_t c, Node *child) {
+  switch (node->type_) {
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      if (n->num_children_ < 4) {
+        int pos = 0;
+        while (pos < n->num_children_ && n->keys_[pos] < c) pos++;
+        memmove(n->keys_ + pos + 1, n->keys_ + pos, n->num_children_ - pos);
+        memmove(n->children_ + pos + 1, n->children_ + pos, (n->num_children_ - pos) * sizeof(Node *));
+        n->keys_[pos] = c;
+        n->children_[pos] = child;
+        n->num_children_++;
+        return;
+      }
+      auto *bigger = NewNode<Node16>(n);
+      memcpy(bigger->keys_, n->keys_, sizeof(n->keys_));
+      memcpy(bigger->children_, n->children_, sizeof(n->children_));
+      *ref = bigger;
+      delete n;
+      AddChild(bigger, ref, c, child);
+      return;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<Node16 *>(node);
+      if (n->num_children_ < 16) {
+        int pos = std::lower_bound(n->keys_, n->keys_ + n->num_children_, c) - n->keys_;
+        memmove(n->keys_ + pos + 1, n->keys_ + pos, n->num_children_ - pos);
+        memmove(n->children_ + pos + 1, n->children_ + pos, (n->num_children_ - pos) * sizeof(Node *));
+        n->keys_[pos] = c;
+        n->children_[pos] = child;
+        n->num_children_++;
+        return;
+      }
+      auto *bigger = NewNode<Node48>(n);
+      for (int i = 0; i < n->num_children_; i++) {
+        bigger->children_[i] = n->children_[i];
+        bigger->child_index_[n->keys_[i]] = i + 1;
+      }
+      *ref = bigger;
+      delete n;
+      AddChild(bigger, ref, c, child);
+      return;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      if (n->num_children_ < 48) {
+        int pos = 0;
+        while (n->children_[pos] != nullptr) pos++;
+        n->children_[pos] = child;
+        n->child_index_[c] = pos + 1;
+        n->num_children_++;
+        return;
+      }
+      auto *bigger = NewNode<Node256>(n);
+      for (int i = 0; i < 256; i++) {
+        if (n->child_index_[i] != 0) bigger->children_[i] = n->children_[n->child_index_[i] - 1];
+      }
+      *ref = bigger;
+      delete n;
+      AddChild(bigger, ref, c, child);
+      return;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      n->children_[c] = child;
+      n->num_children_++;
+      return;
+    }
+    default:
+      return;
+  }
+}
+
+void AdaptiveRadixTree::RemoveChild(InnerNode *node, Node **ref, uint8_t c, Node **slot) {
+  switch (node->type_) {
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      int pos = slot - n->children_;
+      memmove(n->keys_ + pos, n->keys_ + pos + 1, n->num_children_ - pos - 1);
+      memmove(n->children_ + pos, n->children_ + pos + 1, (n->num_children_ - pos - 1) * sizeof(Node *));
+      n->num_children_--;
+      if (n->num_children_ > 1) return;
+      // 只剩一个孩子, 把本节点的前缀和分支字节并入孩子的前缀
+      Node *child = n->children_[0];
+      if (child->type_ != NodeType::kLeaf) {
+        auto *inner = static_cast<InnerNode *>(child);
+        int prefix = n->prefix_len_;
+        if (prefix < MAX_PREFIX_LEN) {
+          n->prefix_[prefix] = n->keys_[0];
+          prefix++;
+        }
+        if (prefix < MAX_PREFIX_LEN) {
+          int sub_prefix = std::min<int>(inner->prefix_len_, MAX_PREFIX_LEN - prefix);
+          memcpy(n->prefix_ + prefix, inner->prefix_, sub_prefix);
+          prefix += sub_prefix;
+        }
+        memcpy(inner->prefix_, n->prefix_, std::min(prefix, MAX_PREFIX_LEN));
+        inner->prefix_len_ += n->prefix_len_ + 1;
+      }
+      *ref = child;
+      delete n;
+      return;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<Node16 *>(node);
+      int pos = slot - n->children_;
+      memmove(n->keys_ + pos, n->keys_ + pos + 1, n->num_children_ - pos - 1);
+      memmove(n->children_ + pos, n->children_ + pos + 1, (n->num_children_ - pos - 1) * sizeof(Node *));
+      n->num_children_--;
+      if (n->num_children_ > 3) return;
+      auto *smaller = NewNode<Node4>(n);
+      memcpy(smaller->keys_, n->keys_, n->num_children_);
+      memcpy(smaller->children_, n->children_, n->num_children_ * sizeof(Node *));
+      *ref = smaller;
+      delete n;
+      return;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      n->children_[n->child_index_[c] - 1] = nullptr;
+      n->child_index_[c] = 0;
+      n->num_children_--;
+      if (n->num_children_ > 12) return;
+      auto *smaller = NewNode<Node16>(n);
+      int pos = 0;
+      for (int i = 0; i < 256; i++) {
+        if (n->child_index_[i] != 0) {
+          smaller->keys_[pos] = i;
+          smaller->children_[pos++] = n->children_[n->child_index_[i] - 1];
+        }
+      }
+      *ref = smaller;
+      delete n;
+      return;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      n->children_[c] = nullptr;
+      n->num_children_--;
+      if (n->num_children_ > 37) return;
+      auto *smaller = NewNode<Node48>(n);
+      int pos = 0;
+      for (int i = 0; i < 256; i++) {
+        if (n->children_[i] != nullptr) {
+          smaller->children_[pos] = n->children_[i];
+          smaller->child_index_[i] = ++pos;
+        }
+      }
+      *ref = smaller;
+      delete n;
+      return;
+    }
+    default:
+      return;
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool AdaptiveRadixTree::GetValue(const GenericKey *key, RowId &value) const {
+  const uint8_t *bytes = Bytes(key);
+  Node *node = root_;
+  int depth = 0;
+  while (node != nullptr) {
+    if (node->type_ == NodeType::kLeaf) {
+      auto *leaf = static_cast<Leaf *>(node);
+      if (!LeafMatches(leaf, bytes)) return false;
+      value = leaf->value_;
+      return true;
+    }
+    auto *inner = static_cast<InnerNode *>(node);
+    // 只比较存下来的前缀字节, 其余的在叶子上一并检查
+    int stored = std::min<int>(inner->prefix_len_, MAX_PREFIX_LEN);
+    if (memcmp(inner->prefix_, bytes + depth, stored) != 0) return false;
+    depth += inner->prefix_len_;
+    Node **child = FindChild(inner, bytes[depth]);
+    node = child != nullptr ? *child : nullptr;
+    depth++;
+  }
+  return false;
+}
+
+void AdaptiveRadixTree::ScanPrefix(const char *prefix, int prefix_len,
+                                   const std::function<bool(const GenericKey *, const RowId &)> &visitor) const {
+  auto *bytes = reinterpret_cast<const uint8_t *>(prefix);
+  Node *node = root_;
+  int depth = 0;
+  // 沿 prefix 往下走到覆盖整个 prefix 的子树, 跳过的前缀字节最后用子树中任一叶子检查
+  while (node != nullptr && node->type_ != NodeType::kLeaf) {
+    auto *inner = static_cast<InnerNode *>(node);
+    if (depth + static_cast<int>(inner->prefix_len_) >= prefix_len) break;
+    depth += inner->prefix_len_;
+    Node **child = FindChild(inner, bytes[depth]);
+    node = child != nullptr ? *child : nullptr;
+    depth++;
+    if (depth >= prefix_len) break;
+  }
+  if (node == nullptr) return;
+  const Leaf *leaf = MinLeaf(node);
+  if (memcmp(leaf->key_, bytes, prefix_len) != 0) return;
+  Visit(node, visitor);
+}
+
+bool AdaptiveRadixTree::Visit(const Node *node, const std::function<bool(const GenericKey *, const RowId &)> &visitor) {
+  switch (node->type_) {
+    case NodeType::kLeaf: {
+      auto *leaf = static_cast<const Leaf *>(node);
+      return visitor(reinterpret_cast<const GenericKey *>(leaf->key_), leaf->value_);
+    }
+    case NodeType::kNode4: {
+      auto *n = static_cast<const Node4 *>(node);
+      for (int i = 0; i < n->num_children_; i++) {
+        if (!Visit(n->children_[i], visitor)) return false;
+      }
+      return true;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<const Node16 *>(node);
+      for (int i = 0; i < n->num_children_; i++) {
+        if (!Visit(n->children_[i], visitor)) return false;
+      }
+      return true;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<const Node48 *>(node);
+      for (int c = 0; c < 256; c++) {
+        if (n->child_index_[c] != 0 && !Visit(n->children_[n->child_index_[c] - 1], visitor)) return false;
+      }
+      return true;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<const Node256 *>(node);
+      for (int c = 0; c < 256; c++) {
+        if (n->children_[c] != nullptr && !Visit(n->children_[c], visitor)) return false;
+      }
+      return true;
+    }
+  }
+  return true;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+bool AdaptiveRadixTree::Insert(const GenericKey *key, const RowId &value) {
+  if (!Insert(&root_, Bytes(key), 0, value)) return false;
+  size_++;
+  return true;
+}
+
+bool AdaptiveRadixTree::Insert(Node **ref, const uint8_t *key, int depth, const RowId &value) {
+  Node *node = *ref;
+  if (node == nullptr) {
+    *ref = NewLeaf(key, value);
+    return true;
+  }
+  if (node->type_ == NodeType::kLeaf) {
+    auto *leaf = static_cast<Leaf *>(node);
+    if (LeafMatches(leaf, key)) return false;
+    // 两个 key 从 depth 开始的公共部分成为新节点的前缀
+    auto *split = NewNode<Node4>();
+    int lcp = 0;
+    while (leaf->key_[depth + lcp] == key[depth + lcp]) lcp++;
+    split->prefix_len_ = lcp;
+    memcpy(split->prefix_, key + depth, std::min(lcp, MAX_PREFIX_LEN));
+    AddChild(split, ref, leaf->key_[depth + lcp], leaf);
+    AddChild(split, ref, key[depth + lcp], NewLeaf(key, value));
+    *ref = split;
+    return true;
+  }
+  auto *inner = static_cast<InnerNode *>(node);
+  if (inner->prefix_len_ != 0) {
+    int diff = PrefixMismatch(inner, key, depth);
+    if (diff < static_cast<int>(inner->prefix_len_)) {
+      // 前缀在 diff 处分叉, 在它上面插一个新节点
+      auto *split = NewNode<Node4>();
+      split->prefix_len_ = diff;
+      memcpy(split->prefix_, inner->prefix_, std::min(diff, MAX_PREFIX_LEN));
+      if (inner->prefix_len_ <= MAX_PREFIX_LEN) {
+        AddChild(split, ref, inner->prefix_[diff], inner);
+        inner->prefix_len_ -= diff + 1;
+        memmove(inner->prefix_, inner->prefix_ + diff + 1, std::min<int>(inner->prefix_len_, MAX_PREFIX_LEN));
+      } else {
+        inner->prefix_len_ -= diff + 1;
+        const Leaf *leaf = MinLeaf(inner);
+        AddChild(split, ref, leaf->key_[depth + diff], inner);
+        memcpy(inner->prefix_, leaf->key_ + depth + diff + 1, std::min<int>(inner->prefix_len_, MAX_PREFIX_LEN));
+      }
+      AddChild(split, ref, key[depth + diff], NewLeaf(key, value));
+      *ref = split;
+      return true;
+    }
+    depth += inner->prefix_len_;
+  }
+  Node **child = FindChild(inner, key[depth]);
+  if (child != nullptr) {
+    return Insert(child, key, depth + 1, value);
+  }
+  AddChild(inner, ref, key[depth], NewLeaf(key, value));
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+bool AdaptiveRadixTree::Remove(const GenericKey *key) {
+  if (!Remove(&root_, Bytes(key), 0)) return false;
+  size_--;
+  return true;
+}
+
+bool AdaptiveRadixTree::Remove(Node **ref, const uint8_t *key, int depth) {
+  Node *node = *ref;
+  if (node == nullptr) return false;
+  if (node->type_ == NodeType::kLeaf) {
+    // 只有根会是叶子
+    if (!LeafMatches(static_cast<Leaf *>(node), key)) return false;
+    FreeNode(node);
+    *ref = nullptr;
+    return true;
+  }
+  auto *inner = static_cast<InnerNode *>(node);
+  int stored = std::min<int>(inner->prefix_len_, MAX_PREFIX_LEN);
+  if (memcmp(inner->prefix_, key + depth, stored) != 0) return false;
+  depth += inner->prefix_len_;
+  Node **child = FindChild(inner, key[depth]);
+  if (child == nullptr) return false;
+  if ((*child)->type_ != NodeType::kLeaf) {
+    return Remove(child, key, depth + 1);
+  }
+  if (!LeafMatches(static_cast<Leaf *>(*child), key)) return false;
+  FreeNode(*child);
+  RemoveChild(inner, ref, key[depth], child);
+  return true;
+}
@@ -0,0 +1,72 @@
+#include "index/art_index.h"
+
+ArtIndex::ArtIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, bool unique)
+    : Index(index_id, key_schema), unique_(unique), processor_(key_schema_, key_size), container_(processor_) {}
+
+dberr_t ArtIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  if (unique_) {
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+  } else {
+    processor_.SerializeFromKey(index_key, key, row_id, key_schema_);
+  }
+  bool status = container_.Insert(index_key, row_id);
+  free(index_key);
+  if (!status) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  if (unique_) {
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+  } else {
+    processor_.SerializeFromKey(index_key, key, row_id, key_schema_);
+  }
+  container_.Remove(index_key);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, std::string compare_operator) {
+  if (compare_operator == "=" && unique_) {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+    RowId rid;
+    if (container_.GetValue(index_key, rid)) {
+      result.emplace_back(rid);
+    }
+    free(index_key);
+    return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+  }
+  std::vector<char> prefix(processor_.GetKeySize());
+  prefix.resize(processor_.SerializePrefix(key, prefix.data()));
+  if (compare_operator == "=") {
+    // 非唯一索引中同一 key 的项共享列编码前缀, 按 RowId 相邻存放
+    container_.ScanPrefix(prefix.data(), prefix.size(), [&result](const GenericKey *, const RowId &rid) {
+      result.emplace_back(rid);
+      return true;
+    });
+    return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+  }
+  container_.Scan([&](const GenericKey *entry, const RowId &rid) {
+    int cmp = processor_.CompareKeyPrefix(entry, prefix.data(), prefix.size());
+    if (compare_operator == "<" || compare_operator == "<=") {
+      // 按 key 有序遍历, 越过上界即可停止
+      if (cmp > 0 || (cmp == 0 && compare_operator == "<")) return false;
+      result.emplace_back(rid);
+    } else if ((compare_operator == ">" && cmp > 0) || (compare_operator == ">=" && cmp >= 0) ||
+               (compare_operator == "<>" && cmp != 0)) {
+      result.emplace_back(rid);
+    }
+    return true;
+  });
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+dberr_t ArtIndex::Destroy() {
+  container_.Clear();
+  return DB_SUCCESS;
+}
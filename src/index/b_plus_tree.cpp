@@ -18,14 +18,19 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {
   Page* pages = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
-  IndexRootsPage* index_roots_page = reinterpret_cast<IndexRootsPage*>(pages);
+  IndexRootsPage* index_roots_page = reinterpret_cast<IndexRootsPage*>(pages->GetData());
   index_roots_page->GetRootId(index_id, &root_page_id_);
   // LOG(ERROR)<<"index_id="<<index_id<<"new b+ tree root="<<root_page_id_;
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  // 页是否写满按字节判断, 默认不再限制 pair 数
   if (leaf_max_size == UNDEFINED_SIZE)
-    leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(RowId));
+    leaf_max_size_ = LeafPage::DATA_SIZE / (LeafPage::SLOT_SIZE + sizeof(RowId));
   if (internal_max_size == UNDEFINED_SIZE)
-    internal_max_size_ = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(page_id_t));
+    internal_max_size_ = InternalPage::DATA_SIZE / InternalPage::SLOT_SIZE;
+}
+
+BPlusTree::~BPlusTree() {
+  FlushRootPageId();
 }
 
 void BPlusTree::Destroy(page_id_t current_page_id) {
@@ -96,7 +101,7 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   Page* new_page = buffer_pool_manager_->NewPage(new_page_id);
   if (new_page == nullptr) throw ("out of memory"); // Out of memory exception.
   root_page_id_ = new_page_id;
-  UpdateRootPageId(true);//记得更新meta page里面记录的root_page_id, 因为是新根,insert=true
+  UpdateRootPageId();//记得更新meta page里面记录的root_page_id
   LeafPage *root_page = reinterpret_cast<LeafPage *>(new_page->GetData());
   root_page->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
   root_page->Insert(key, value, processor_);
@@ -120,22 +125,27 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return false; // Key already exists
   }
-  // Insert the key & value pair
-  leaf_page->Insert(key, value, processor_);
-  // Check if split is necessary
-  if (leaf_page->GetSize() > leaf_max_size_) {
-    // Split the leaf page
-    // LOG(ERROR)<<"Split";
+  // 页内放不下时先分裂再插入; 新 key 缩短了页前缀时, 分裂一次不一定够
+  GenericKey *separator = processor_.InitKey();
+  while (!leaf_page->Insert(key, value, processor_)) {
     LeafPage *new_leaf_page = Split(leaf_page, transaction);
+    new_leaf_page->SetNextPageId(leaf_page->GetNextPageId());//新叶子接上原来的后继, 否则链表会断
     leaf_page->SetNextPageId(new_leaf_page->GetPageId());//把当前叶子和新叶子连起来
-    /*把分裂后新叶子最左侧的插入到父亲   调用keyAt(0)
-    如[1,2,3,4]->  [3]
-               [1,2] [3,4]                                              
+    /*把能区分两个叶子的最短前缀插入到父亲
+    如[apple,banana,cherry,date]->      [c]
+                            [apple,banana] [cherry,date]
     */
-    InsertIntoParent(leaf_page, new_leaf_page->KeyAt(0), new_leaf_page, transaction);
-    //记得unpin new leaf page
-    buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(),true);
+    LeafSeparator(leaf_page, new_leaf_page, separator);
+    InsertIntoParent(leaf_page, separator, new_leaf_page, transaction);
+    //继续往 key 所在的那一半插入, 另一半 unpin
+    if (processor_.CompareKeys(key, separator) >= 0) {
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+      leaf_page = new_leaf_page;
+    } else {
+      buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
+    }
   }
+  free(separator);
   buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
   return true;
 }
@@ -147,7 +157,7 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
+BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, GenericKey *middle_key, Txn *transaction) {
   // New page.
   page_id_t new_page_id;
   Page* new_page = buffer_pool_manager_->NewPage(new_page_id);
@@ -156,9 +166,7 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
   // Init.
   new_internal_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
   // Split data.
-  node->MoveHalfTo(new_internal_page, buffer_pool_manager_);
-  // Unpin.
-  // buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+  node->MoveHalfTo(new_internal_page, middle_key, buffer_pool_manager_);
   //不需要unpin, 因为这个node在InsertIntoParent的时候还要用到
   return new_internal_page;
 }
@@ -173,12 +181,20 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
   new_leaf_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
   // Split data.
   node->MoveHalfTo(new_leaf_page);
-  // Unpin.
-  // buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
   //不需要unpin, 因为这个node在InsertIntoParent的时候还要用到
   return new_leaf_page;
 }
 
+void BPlusTree::LeafSeparator(LeafPage *left, LeafPage *right, GenericKey *separator) {
+  GenericKey *last_key = processor_.InitKey();
+  GenericKey *first_key = processor_.InitKey();
+  left->KeyAt(left->GetSize() - 1, last_key);
+  right->KeyAt(0, first_key);
+  processor_.FindShortestSeparator(last_key, first_key, separator);
+  free(last_key);
+  free(first_key);
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
@@ -189,6 +205,7 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
  * recursively if necessary.
  */
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction) {
+  InvalidateUpperLevels();
   // If old_node is root page, create a new root page
   if (old_node->IsRootPage()) {
     // Create a new root page
@@ -198,25 +215,32 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     InternalPage *new_root_page = reinterpret_cast<InternalPage *>(new_page->GetData());
     // Init.
     new_root_page->Init(new_page_id, INVALID_PAGE_ID, old_node->GetKeySize(), internal_max_size_);
-    new_root_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    new_root_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId(), processor_);
     old_node->SetParentPageId(new_page_id);
     new_node->SetParentPageId(new_page_id);
     root_page_id_ = new_page_id;
-    UpdateRootPageId(false);//更新meta page
+    UpdateRootPageId();//更新meta page
     buffer_pool_manager_->UnpinPage(new_page_id, true);
-  } else {
-    // Find the parent page
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData());
-    int size = parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-    // Keep iteration of split
-    if (size >= internal_max_size_) {
-      auto *new_internal_page = Split(parent_page, transaction);
-      InsertIntoParent(parent_page, new_internal_page->KeyAt(0), new_internal_page, transaction);
-      buffer_pool_manager_->UnpinPage(new_internal_page->GetPageId(),true);
+    return;
+  }
+  // Find the parent page
+  InternalPage *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData());
+  // 父节点放不下新的分隔键时先分裂父节点, 再插到 old_node 所在的那一半
+  if (!parent_page->HasRoomFor(processor_.GetKeyLength(key))) {
+    GenericKey *middle_key = processor_.InitKey();
+    auto *new_internal_page = Split(parent_page, middle_key, transaction);
+    InsertIntoParent(parent_page, middle_key, new_internal_page, transaction);
+    free(middle_key);
+    if (old_node->GetParentPageId() == new_internal_page->GetPageId()) {
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      parent_page = new_internal_page;
+    } else {
+      buffer_pool_manager_->UnpinPage(new_internal_page->GetPageId(), true);
     }
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
   }
-  return ;
+  parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId(), processor_);
+  new_node->SetParentPageId(parent_page->GetPageId());
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
 }
 
 /*****************************************************************************
@@ -233,184 +257,167 @@ void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
   if (IsEmpty()) return ; // Empty tree
   // Find the right leaf page   (isLeftMost=false, 因为要根据key去查)
   LeafPage *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_, false)->GetData());
+  page_id_t leaf_page_id = leaf_page->GetPageId();
   // Delete the key & value pair
-  int del_index=leaf_page->KeyIndex(key, processor_);
-  int new_size = leaf_page->RemoveAndDeleteRecord(key, processor_);
-  // Check if merge is necessary
-  bool flag=false;
-  if (new_size < leaf_page->GetMinSize()) {
-    // Merge the leaf page
-    flag=CoalesceOrRedistribute<LeafPage>(leaf_page, transaction);
-  } else if (!del_index) { // The deleted key is the first key, need pop up to delete.
-    GenericKey *new_key = leaf_page->KeyAt(0); // New key to replace the old one.
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(
-      buffer_pool_manager_->FetchPage(leaf_page->GetParentPageId())->GetData()//勿忘GetData()
-      );
-    page_id_t pageid = leaf_page->GetPageId();
-    // Pop up to delete
-    if(parent_page!=nullptr){
-      while (!parent_page->IsRootPage() && parent_page->ValueIndex(pageid) == 0) {
-        buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
-        pageid=parent_page->GetPageId();//应该get的是当前parent的page_id
-        parent_page = reinterpret_cast<InternalPage *>(
-          buffer_pool_manager_->FetchPage(parent_page->GetParentPageId())->GetData()
-        );
+  int size = leaf_page->GetSize();
+  if (leaf_page->RemoveAndDeleteRecord(key, processor_) == size) {
+    buffer_pool_manager_->UnpinPage(leaf_page_id, false);
+    return;
+  }
+  // 父节点里的分隔键只是上下界, 删掉叶子的第一个 key 之后依然有效, 不用往上改
+  bool deleted = leaf_page->IsUnderflow() && CoalesceOrRedistribute<LeafPage>(leaf_page, transaction);
+  buffer_pool_manager_->UnpinPage(leaf_page_id, true);
+  if (deleted) buffer_pool_manager_->DeletePage(leaf_page_id);
+}
+
+void BPlusTree::RemoveBatch(const std::vector<GenericKey *> &keys, Txn *transaction) {
+  GenericKey *last_key = processor_.InitKey();
+  size_t i = 0;
+  while (i < keys.size() && !IsEmpty()) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(keys[i], root_page_id_, false)->GetData());
+    while (true) {
+      page_id_t leaf_page_id = leaf_page->GetPageId();
+      if (leaf_page->GetSize() == 0) {
+        // 没有兄弟可合并的空叶子, 从根路由到这里的 key 不存在
+        buffer_pool_manager_->UnpinPage(leaf_page_id, false);
+        i++;
+        break;
+      }
+      // 不大于叶子最后一个 key 的 key 只可能在这个叶子里
+      leaf_page->KeyAt(leaf_page->GetSize() - 1, last_key);
+      bool dirty = false;
+      for (; i < keys.size() && processor_.CompareKeys(keys[i], last_key) <= 0; i++) {
+        int size = leaf_page->GetSize();
+        dirty = leaf_page->RemoveAndDeleteRecord(keys[i], processor_) != size || dirty;
       }
-      int tmp_index = parent_page->ValueIndex(pageid);
-      if (tmp_index != 0 && processor_.CompareKeys(parent_page->KeyAt(tmp_index), new_key) != 0) {
-        parent_page->SetKeyAt(tmp_index, new_key);
-        buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      if (dirty && leaf_page->IsBelowLowWater()) {
+        // 合并会改动父节点, 下一个 key 重新从根查找
+        bool deleted = CoalesceOrRedistribute<LeafPage>(leaf_page, transaction);
+        buffer_pool_manager_->UnpinPage(leaf_page_id, true);
+        if (deleted) buffer_pool_manager_->DeletePage(leaf_page_id);
+        break;
+      }
+      page_id_t next_page_id = leaf_page->GetNextPageId();
+      if (i == keys.size() || next_page_id == INVALID_PAGE_ID) {
+        buffer_pool_manager_->UnpinPage(leaf_page_id, dirty);
+        // 剩下的 key 都比最后一个叶子的 key 大
+        i = next_page_id == INVALID_PAGE_ID ? keys.size() : i;
+        break;
+      }
+      auto *next_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+      buffer_pool_manager_->UnpinPage(leaf_page_id, dirty);
+      leaf_page = next_page;
+      if (leaf_page->GetSize() > 0) {
+        leaf_page->KeyAt(leaf_page->GetSize() - 1, last_key);
+      }
+      if (leaf_page->GetSize() == 0 || processor_.CompareKeys(keys[i], last_key) > 0) {
+        // 下一个 key 不在下一个叶子里, 重新从根查找比沿着叶子链走更快
+        buffer_pool_manager_->UnpinPage(next_page_id, false);
+        break;
       }
     }
   }
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-  if(flag) buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
+  free(last_key);
 }
-/* todo
- * User needs to first find the sibling of input page. If sibling's size + input
- * page's size > page's max size, then redistribute. Otherwise, merge.
+
+/*
+ * User needs to first find the sibling of input page. If the pairs of both
+ * pages fit in one page, then merge. Otherwise, redistribute.
  * Using template N to represent either internal page or leaf page.
  * @return: true means target leaf page should be deleted,
- * false means no deletion happens       
+ * false means no deletion happens
  */
 template <typename N>
 bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *transaction) {
-  if (node->IsRootPage()) return AdjustRoot(node);//根节点  
+  InvalidateUpperLevels();
+  if (node->IsRootPage()) return AdjustRoot(node);//根节点
   Page* parent_page=buffer_pool_manager_->FetchPage(node->GetParentPageId());
   InternalPage* parent=reinterpret_cast<InternalPage*>(parent_page->GetData());
-  //获取兄弟节点
-  int index=parent->ValueIndex(node->GetPageId());
-  int pre_id=-1,nex_id=-1;
-  N *pre, *nex;
-  if(index>0){//对于中间的节点，必须分别检查index-1和index+1是否能merge
-    pre_id=parent->ValueAt(index-1);
-    pre=reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(pre_id)->GetData());
-    if(pre->GetSize()>pre->GetMinSize()){//有多的节点可以移动
-      Redistribute(pre,node,1);
-      BPlusTreePage* rnode_page=reinterpret_cast<BPlusTreePage*>(node);//找到右边的节点(node)
-      if(rnode_page->IsLeafPage()==false){
-        //如果是非叶子节点，要找到子树中最小值作为分割的key  而不是当前节点最小值
-        InternalPage* rnode=reinterpret_cast<InternalPage*>(rnode_page);
-        page_id_t minval = rnode->LeftMostKeyFromCurr(buffer_pool_manager_);
-        LeafPage* leaf = reinterpret_cast<LeafPage*>(buffer_pool_manager_->FetchPage(minval));
-        parent->SetKeyAt(index,leaf->KeyAt(0));
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
-      }
-      buffer_pool_manager_->UnpinPage(pre->GetPageId(),true);
-      buffer_pool_manager_->UnpinPage(parent->GetPageId(),true);
-      return false;
-    }
-  }
-  if(index<parent->GetSize()-1){
-    nex_id=parent->ValueAt(index+1);
-    nex=reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(nex_id)->GetData());
-    if(nex->GetSize()>nex->GetMinSize()){
-      Redistribute(nex,node,0);//注意node在nex左边
-      BPlusTreePage* rnode_page=reinterpret_cast<BPlusTreePage*>(nex);//找到右边的节点(nex)
-      if(rnode_page->IsLeafPage()==false){
-        //如果是非叶子节点，要找到子树中最小值作为分割的key  而不是当前节点最小值
-        InternalPage* rnode=reinterpret_cast<InternalPage*>(rnode_page);
-        page_id_t minval = rnode->LeftMostKeyFromCurr(buffer_pool_manager_);
-        LeafPage* leaf = reinterpret_cast<LeafPage*>(buffer_pool_manager_->FetchPage(minval));
-        parent->SetKeyAt(index+1,leaf->KeyAt(0));//因为nex是右边节点  所以是index+1
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
-      }
-      buffer_pool_manager_->UnpinPage(nex->GetPageId(),true);
-      buffer_pool_manager_->UnpinPage(parent->GetPageId(),true);
-      return false;
-    }
+  if(parent->GetSize()<2){//没有兄弟节点
+    buffer_pool_manager_->UnpinPage(parent->GetPageId(),false);
+    return false;
   }
   //如果node是第一个节点，就取右边的兄弟。否则取左边的
-  if (index>0) {  
-    Coalesce(pre, node, parent, index, transaction);
-    buffer_pool_manager_->UnpinPage(nex_id, false);
-    buffer_pool_manager_->UnpinPage(index, true);
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    return true;
-  } else {
-    Coalesce(node, nex, parent, index+1, transaction);
-    buffer_pool_manager_->UnpinPage(pre_id, false);
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(nex_id, true);
-    return false;
+  int index=parent->ValueIndex(node->GetPageId());
+  int key_index=index>0?index:1;//左右两个节点之间的 key
+  page_id_t sibling_id=parent->ValueAt(index>0?index-1:1);
+  N *sibling=reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(sibling_id)->GetData());
+  N *left=index>0?sibling:node;
+  N *right=index>0?node:sibling;
+  bool node_deleted=false,sibling_deleted=false,parent_deleted=false;
+  if(Coalesce(left,right,parent,key_index,transaction)){
+    //右边的节点并入左边, 由持有它的一方删除
+    node_deleted=right==node;
+    sibling_deleted=right==sibling;
+    if(parent->IsUnderflow()) parent_deleted=CoalesceOrRedistribute<InternalPage>(parent,transaction);
+  }else{
+    Redistribute(left,right,parent,key_index);
   }
-  return false;
+  page_id_t parent_id=parent->GetPageId();
+  buffer_pool_manager_->UnpinPage(parent_id,true);
+  if(parent_deleted) buffer_pool_manager_->DeletePage(parent_id);
+  buffer_pool_manager_->UnpinPage(sibling_id,true);
+  if(sibling_deleted) buffer_pool_manager_->DeletePage(sibling_id);
+  return node_deleted;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
+ * Move all the key & value pairs from one page to its left sibling page.
+ * Parent page must be adjusted to take info of deletion into account. The caller
+ * deletes the emptied page and deals with the parent recursively.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * @param   neighbor_node      left sibling of "node"
+ * @param   node               the page to merge into neighbor_node
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @param   index              index of node in parent
+ * @return  false means both pages do not fit in one page and nothing happened
  */
-bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
+bool BPlusTree::Coalesce(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index,
                          Txn *transaction) {
-  node->MoveAllTo(neighbor_node);
+  if(!node->MoveAllTo(neighbor_node)) return false;
   parent->Remove(index);
-  if(parent->GetSize()>=parent->GetMinSize())return false;
-  return CoalesceOrRedistribute<InternalPage>(parent,transaction);
+  return true;
 }
 
-bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
+bool BPlusTree::Coalesce(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
                          Txn *transaction) {
-  node->MoveAllTo(neighbor_node,parent->KeyAt(index),buffer_pool_manager_);
+  GenericKey *middle_key=processor_.InitKey();
+  parent->KeyAt(index,middle_key);
+  bool merged=node->MoveAllTo(neighbor_node,middle_key,buffer_pool_manager_);
+  free(middle_key);
+  if(!merged) return false;
   parent->Remove(index);
-  if(parent->GetSize()>=parent->GetMinSize())return false;
-  return CoalesceOrRedistribute<InternalPage>(parent,transaction);
+  return true;
 }
 
 /*
- * Redistribute key & value pairs from one page to its sibling page. If index ==
- * 0, move sibling page's first key & value pair into end of input "node",
- * otherwise move sibling page's last key & value pair into head of input
- * "node".
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * Redistribute key & value pairs between a page and its right sibling so that
+ * both hold about the same number of bytes, then update the key between them in
+ * parent. A page is left underfull when the parent has no room for the new key.
+ * @param   neighbor_node      left page
+ * @param   node               right page
+ * @param   index              index of the right page in parent
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-  page_id_t parent_id=node->GetParentPageId();
-  //根据id取出对应的page
-  Page* ptr=buffer_pool_manager_->FetchPage(parent_id);
-  InternalPage* parent=reinterpret_cast<InternalPage*>(ptr->GetData());
-   //更新后，修改parent的key,注意两种情况是不一样的
-  if(index!=0){
-    neighbor_node->MoveLastToFrontOf(node);
-    page_id_t mid_index=parent->ValueIndex(node->GetPageId());
-    parent->SetKeyAt(mid_index,node->KeyAt(0));//自己在右边，把自己的第一个节点给父母
-  }else{
-    neighbor_node->MoveFirstToEndOf(node);
-    page_id_t mid_index=parent->ValueIndex(neighbor_node->GetPageId());
-    parent->SetKeyAt(mid_index,neighbor_node->KeyAt(0));//把右边兄弟的第一个节点给父母
-    
-  }
- 
-  
+void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index) {
+  // 新的分隔键最长 key_size
+  if (parent->GetUsedBytes() - parent->GetKeyLength(index) + processor_.GetKeySize() > InternalPage::DATA_SIZE) return;
+  if (!neighbor_node->Redistribute(node)) return;
+  GenericKey *separator=processor_.InitKey();
+  LeafSeparator(neighbor_node,node,separator);
+  parent->SetKeyAt(index,separator,processor_);
+  free(separator);
 }
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-  page_id_t parent_id=node->GetParentPageId();
-  //根据id取出对应的page
-  Page* ptr=buffer_pool_manager_->FetchPage(parent_id);
-  InternalPage* parent=reinterpret_cast<InternalPage*>(ptr->GetData());
-  int id=0;
-  GenericKey * newKey=0;
-  if(index==0){
-    id=parent->ValueIndex(neighbor_node->GetPageId());
-    newKey=neighbor_node->KeyAt(1);
-    neighbor_node->MoveFirstToEndOf(node,parent->KeyAt(id),buffer_pool_manager_);
-  }else{
-    id=parent->ValueIndex(node->GetPageId());
-    newKey=neighbor_node->KeyAt(neighbor_node->GetSize()-1);
-    neighbor_node->MoveLastToFrontOf(node,parent->KeyAt(id),buffer_pool_manager_);
+
+void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index) {
+  if (parent->GetUsedBytes() - parent->GetKeyLength(index) + processor_.GetKeySize() > InternalPage::DATA_SIZE) return;
+  GenericKey *middle_key=processor_.InitKey();
+  parent->KeyAt(index,middle_key);
+  if(neighbor_node->Redistribute(node,middle_key,buffer_pool_manager_)){
+    parent->SetKeyAt(index,middle_key,processor_);
   }
-  parent->SetKeyAt(id,newKey);
-  buffer_pool_manager_->UnpinPage(parent_id,true);
+  free(middle_key);
 }
+
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -419,29 +426,24 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
  * @return : true means root page should be deleted, false means no deletion
- * happened
+ * happened. The caller unpins and deletes it.
  */
 bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
-  page_id_t old_root_id=old_root_node->GetPageId();
   if(!old_root_node->IsLeafPage() && old_root_node->GetSize()==1){
     //case 1
     InternalPage* old_root=reinterpret_cast<InternalPage*>(old_root_node);
     root_page_id_=old_root->RemoveAndReturnOnlyChild();//返回唯一的child作为新根
-    UpdateRootPageId(false);//更新Index_roots_page
+    UpdateRootPageId();//更新Index_roots_page
     //获取新根
     Page* new_root_page=buffer_pool_manager_->FetchPage(root_page_id_);
     BPlusTreePage*new_root=reinterpret_cast<BPlusTreePage*>(new_root_page->GetData());
     new_root->SetParentPageId(INVALID_PAGE_ID);
     buffer_pool_manager_->UnpinPage(root_page_id_,true);//因为新根改了parent
-    buffer_pool_manager_->UnpinPage(old_root_id,false);
-    buffer_pool_manager_->DeletePage(old_root_id);
     return true;
-  }else if(old_root_node->GetSize()==0){
+  }else if(old_root_node->IsLeafPage() && old_root_node->GetSize()==0){
     //case 2
     root_page_id_=INVALID_PAGE_ID;
-    UpdateRootPageId(false);
-    buffer_pool_manager_->UnpinPage(old_root_id,false);
-    buffer_pool_manager_->DeletePage(old_root_id);
+    UpdateRootPageId();
     return true;
   }
   return false;
@@ -492,6 +494,34 @@ IndexIterator BPlusTree::End() {
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
+BPlusTreeStats BPlusTree::GetStats() {
+  BPlusTreeStats stats;
+  if (IsEmpty()) return stats;
+  //按层遍历, 层数即树高
+  std::vector<page_id_t> level{root_page_id_};
+  while (!level.empty()) {
+    std::vector<page_id_t> next_level;
+    stats.height_++;
+    for (auto page_id : level) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      if (node->IsLeafPage()) {
+        stats.leaf_pages_++;
+        stats.entries_ += node->GetSize();
+      } else {
+        auto *internal = reinterpret_cast<InternalPage *>(node);
+        stats.internal_pages_++;
+        stats.children_ += internal->GetSize();
+        for (int i = 0; i < internal->GetSize(); i++) {
+          next_level.push_back(internal->ValueAt(i));
+        }
+      }
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    level = std::move(next_level);
+  }
+  return stats;
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
@@ -503,6 +533,17 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
   //在redistribute非叶子节点时，要从非root节点往下找最左边的
   if(IsEmpty()) return nullptr;
   if(page_id==INVALID_PAGE_ID) page_id=root_page_id_;
+  //从根开始时, 上面 cached_levels_ 层的内部页直接在内存副本里查找, 不经过 buffer pool
+  int level=page_id==root_page_id_?0:cached_levels_;
+  if(upper_levels_version_!=version_){
+    upper_levels_.clear();
+    upper_levels_version_=version_;
+  }
+  for(;level<cached_levels_;level++){
+    const InternalPage* cached=GetCachedPage(page_id);
+    if(cached==nullptr) break;//根就是叶子
+    page_id=leftMost?cached->ValueAt(0):cached->Lookup(key,processor_);
+  }
   while(1){
     Page* page=buffer_pool_manager_->FetchPage(page_id);
     BPlusTreePage* node=reinterpret_cast<BPlusTreePage*>(page->GetData());
@@ -517,28 +558,44 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
 }
 
 /*
- * Update/Insert root page id in header page(where page_id = 0, header_page is
- * defined under include/page/header_page.h)
- * Call this method everytime root page id is changed.
- * @parameter: insert_record      default value is false. When set to true,
- * insert a record <index_name, current_page_id> into header page instead of
- * updating it.
+ * Record that the root page id changed. Call this method everytime root page
+ * id is changed. The index roots page is shared by every index, so the new root
+ * is only written there at the next checkpoint, see FlushRootPageId().
+ */
+void BPlusTree::UpdateRootPageId() {
+  root_dirty_=true;
+  InvalidateUpperLevels();
+}
+
+/*
+ * Update/Insert root page id in index roots page(where page_id = 1, see
+ * include/page/index_roots_page.h) if it changed since the last checkpoint.
  */
-void BPlusTree::UpdateRootPageId(int insert_record) {
-//insert_record看起来是int,实际是bool
-//index_roots_page 记录了数据库里所有的索引(B+树)的root_page_id。 
+void BPlusTree::FlushRootPageId() {
+//index_roots_page 记录了数据库里所有的索引(B+树)的root_page_id。
 //它本身也是一个page,id为INDEX_ROOTS_PAGE_ID
-//如果当前B+树的根变了，就要修改index_roots_page
+  if(!root_dirty_) return;
   Page* page=buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
   IndexRootsPage* index_roots_page=reinterpret_cast<IndexRootsPage*>(page->GetData());
-  if(insert_record){//找到当前B+树的id,插入
-    // LOG(INFO)<<"insert root"<<index_id_<<" "<<root_page_id_;
-    index_roots_page->Insert(index_id_,root_page_id_);
-  }else{
-    // LOG(INFO)<<"update root"<<index_id_<<" "<<root_page_id_;
-    index_roots_page->Update(index_id_,root_page_id_);
-  }
+  //第一次写入时插入记录, 否则更新
+  if(!index_roots_page->Update(index_id_,root_page_id_)) index_roots_page->Insert(index_id_,root_page_id_);
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID,true);
+  root_dirty_=false;
+}
+
+const BPlusTreeInternalPage *BPlusTree::GetCachedPage(page_id_t page_id) {
+  auto it=upper_levels_.find(page_id);
+  if(it==upper_levels_.end()){
+    Page* page=buffer_pool_manager_->FetchPage(page_id);
+    std::unique_ptr<char[]> copy;
+    if(!reinterpret_cast<BPlusTreePage*>(page->GetData())->IsLeafPage()){
+      copy.reset(new char[PAGE_SIZE]);
+      memcpy(copy.get(),page->GetData(),PAGE_SIZE);
+    }
+    buffer_pool_manager_->UnpinPage(page_id,false);
+    it=upper_levels_.emplace(page_id,std::move(copy)).first;
+  }
+  return reinterpret_cast<const InternalPage*>(it->second.get());
 }
 
 /**
@@ -562,11 +619,14 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         << "max_size=" << leaf->GetMaxSize() << ",min_size=" << leaf->GetMinSize() << ",size=" << leaf->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
+    GenericKey *key = processor_.InitKey();
     for (int i = 0; i < leaf->GetSize(); i++) {
       Row ans;
-      processor_.DeserializeToKey(leaf->KeyAt(i), ans, schema);
+      leaf->KeyAt(i, key);
+      processor_.DeserializeToKey(key, ans, schema);
       out << "<TD>" << ans.GetField(0)->toString() << "</TD>\n";
     }
+    free(key);
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
@@ -596,17 +656,21 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         << "max_size=" << inner->GetMaxSize() << ",min_size=" << inner->GetMinSize() << ",size=" << inner->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
+    GenericKey *key = processor_.InitKey();
     for (int i = 0; i < inner->GetSize(); i++) {
       out << "<TD PORT=\"p" << inner->ValueAt(i) << "\">";
       if (i > 0) {
+        // 截断的分隔键按补零解码, 只用来看个大概
         Row ans;
-        processor_.DeserializeToKey(inner->KeyAt(i), ans, schema);
+        inner->KeyAt(i, key);
+        processor_.DeserializeToKey(key, ans, schema);
         out << ans.GetField(0)->toString();
       } else {
         out << " ";
       }
       out << "</TD>\n";
     }
+    free(key);
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
@@ -641,7 +705,7 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
               << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
-      std::cout << leaf->KeyAt(i) << ",";
+      std::cout << leaf->ValueAt(i).Get() << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
@@ -649,7 +713,7 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
     auto *internal = reinterpret_cast<InternalPage *>(page);
     std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
-      std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
+      std::cout << internal->GetKeyLength(i) << ": " << internal->ValueAt(i) << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
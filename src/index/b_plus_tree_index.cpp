@@ -1,17 +1,24 @@
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 #include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique)
     : Index(index_id, key_schema),
+      unique_(unique),
       processor_(key_schema_, key_size),
       container_(index_id, buffer_pool_manager, processor_) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (unique_) {
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+  } else {
+    processor_.SerializeFromKey(index_key, key, row_id, key_schema_);
+  }
 
   bool status = container_.Insert(index_key, row_id, txn);
   delete index_key;
@@ -28,61 +35,105 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
 
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (unique_) {
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+  } else {
+    processor_.SerializeFromKey(index_key, key, row_id, key_schema_);
+  }
 
   container_.Remove(index_key, txn);
   delete index_key;
   return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::RemoveEntries(const std::vector<std::pair<Row, RowId>> &entries, Txn *txn) {
+  std::vector<GenericKey *> keys;
+  keys.reserve(entries.size());
+  for (const auto &entry : entries) {
+    GenericKey *index_key = processor_.InitKey();
+    if (unique_) {
+      processor_.SerializeFromKey(index_key, entry.first, key_schema_);
+    } else {
+      processor_.SerializeFromKey(index_key, entry.first, entry.second, key_schema_);
+    }
+    keys.push_back(index_key);
+  }
+  // key 是 memcomparable 的, 排序后就是叶子的顺序
+  std::sort(keys.begin(), keys.end(),
+            [this](const GenericKey *a, const GenericKey *b) { return processor_.CompareKeys(a, b) < 0; });
+  container_.RemoveBatch(keys, txn);
+  for (auto key : keys) {
+    free(key);
+  }
+  return DB_SUCCESS;
+}
+
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
-  GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
-  auto end_iter = GetEndIterator();
-  if (compare_operator == "=") {
+  auto collect = [&result](IndexRangeScan *scan) {
+    while (scan->NextBatch(result)) {
+    }
+  };
+  if (compare_operator == "=" && !unique_) {
+    // 非唯一索引中同一 key 的项按 RowId 相邻存放
+    collect(ScanRange(&key, true, &key, true, txn).get());
+  } else if (compare_operator == "=") {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
     container_.GetValue(index_key, result, txn);
+    free(index_key);
   } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn)) ++iter;
-    result.clear();
-    for (; iter != end_iter; ++iter) {
-      result.emplace_back((*iter).second);
-    }
+    collect(ScanRange(&key, false, nullptr, false, txn).get());
   } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != end_iter; ++iter) {
-      result.emplace_back((*iter).second);
-    }
+    collect(ScanRange(&key, true, nullptr, false, txn).get());
   } else if (compare_operator == "<") {
-    auto stop_iter = GetBeginIterator(index_key);
-    for (auto iter = GetBeginIterator(); iter != stop_iter; ++iter) {
-      result.emplace_back((*iter).second);
-    }
+    collect(ScanRange(nullptr, false, &key, false, txn).get());
   } else if (compare_operator == "<=") {
-    auto stop_iter = GetBeginIterator(index_key);
-    for (auto iter = GetBeginIterator(); iter != stop_iter; ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    container_.GetValue(index_key, result, txn);
+    collect(ScanRange(nullptr, false, &key, true, txn).get());
   } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != end_iter; ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
+    collect(ScanRange(nullptr, false, &key, false, txn).get());
+    collect(ScanRange(&key, false, nullptr, false, txn).get());
   }
-  delete index_key;
   if (!result.empty())
     return DB_SUCCESS;
   else
     return DB_KEY_NOT_FOUND;
 }
 
+std::unique_ptr<IndexRangeScan> BPlusTreeIndex::ScanRange(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                          bool upper_inclusive, Txn *txn) {
+  uint32_t lower_count = lower == nullptr ? 0 : lower->GetFieldCount();
+  bool skip_null = upper != nullptr && upper->GetFieldCount() > lower_count;
+  if (lower == nullptr && !skip_null) {
+    return std::make_unique<IndexRangeScan>(container_.Begin(), upper, upper_inclusive, processor_, key_schema_);
+  }
+  // 前缀之后补零即是该前缀下最小的 key, 定位到第一个前缀 >= lower 的位置
+  Row empty;
+  GenericKey *lower_key = processor_.InitKey();
+  int lower_len = processor_.SerializePrefix(lower == nullptr ? empty : *lower, reinterpret_cast<char *>(lower_key));
+  if (skip_null) {
+    // lower 之后的一列只有上界, null 的标志字节是 0, 排在所有值之前, 从标志字节为 1 的 key 开始
+    reinterpret_cast<char *>(lower_key)[lower_len] = 1;
+  }
+  auto iter = container_.Begin(lower_key);
+  auto end_iter = container_.End();
+  // 开区间时跳过前缀等于 lower 的项
+  if (lower != nullptr && !lower_inclusive) {
+    while (iter != end_iter &&
+           processor_.CompareKeyPrefix((*iter).first, reinterpret_cast<char *>(lower_key), lower_len) == 0) {
+      ++iter;
+    }
+  }
+  free(lower_key);
+  return std::make_unique<IndexRangeScan>(std::move(iter), upper, upper_inclusive, processor_, key_schema_);
+}
+
 dberr_t BPlusTreeIndex::Destroy() {
   container_.Destroy();
   return DB_SUCCESS;
 }
 
+void BPlusTreeIndex::Checkpoint() { container_.FlushRootPageId(); }
+
 IndexIterator BPlusTreeIndex::GetBeginIterator() {
   return container_.Begin();
 }
@@ -94,4 +145,58 @@ IndexIterator BPlusTreeIndex::GetBeginIterator(GenericKey *key) {
 IndexIterator BPlusTreeIndex::GetEndIterator() { return container_.End(); }
 BPlusTree& BPlusTreeIndex::Debug() {
   return container_;
-}
\ No newline at end of file
+}
+
+IndexRangeScan::IndexRangeScan(IndexIterator &&iter, const Row *upper, bool upper_inclusive,
+                               const KeyManager &processor, IndexSchema *key_schema)
+    : iter_(std::move(iter)),
+      has_upper_(upper != nullptr),
+      upper_inclusive_(upper_inclusive),
+      processor_(processor),
+      key_schema_(key_schema) {
+  if (has_upper_) {
+    upper_.resize(processor_.GetKeySize());
+    upper_.resize(processor_.SerializePrefix(*upper, upper_.data()));
+  }
+}
+
+bool IndexRangeScan::NextBatch(std::vector<RowId> &rids) {
+  if (iter_ == end_) {
+    return false;
+  }
+  if (!has_upper_ || processor_.CompareKeyPrefix(iter_.LeafLastKey(), upper_.data(), upper_.size()) <
+                         (upper_inclusive_ ? 1 : 0)) {
+    iter_.NextLeafBatch(rids);
+    return true;
+  }
+  // 上界落在这个叶子里, 逐项比较, 之后 Next 会结束扫描
+  RowId rid;
+  bool any = false;
+  while (Next(&rid)) {
+    rids.emplace_back(rid);
+    any = true;
+  }
+  return any;
+}
+
+bool IndexRangeScan::Next(RowId *rid, Row *key) {
+  if (iter_ == end_) {
+    return false;
+  }
+  auto entry = *iter_;
+  if (has_upper_) {
+    int cmp = processor_.CompareKeyPrefix(entry.first, upper_.data(), upper_.size());
+    if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+      // 越过上界, 提前释放叶子页
+      iter_ = IndexIterator();
+      return false;
+    }
+  }
+  *rid = entry.second;
+  if (key != nullptr) {
+    *key = Row(entry.second);
+    processor_.DeserializeToKey(entry.first, *key, key_schema_);
+  }
+  ++iter_;
+  return true;
+}
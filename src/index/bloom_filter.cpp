@@ -0,0 +1,91 @@
+#include "index/bloom_filter.h"
+
+#include <algorithm>
+
+BloomFilter::BloomFilter(size_t expected_keys, int bits_per_key) {
+  AddStage(std::max<size_t>(expected_keys, 1), bits_per_key);
+}
+
+void BloomFilter::AddStage(size_t capacity, int bits_per_key) {
+  Stage stage;
+  stage.capacity_ = capacity;
+  stage.bits_per_key_ = bits_per_key;
+  stage.blocks_.resize((capacity * bits_per_key + BLOCK_BITS - 1) / BLOCK_BITS, Block{});
+  stages_.emplace_back(std::move(stage));
+}
+
+uint64_t BloomFilter::Mix(uint64_t hash) {
+  // the splitmix64 finalizer
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+uint64_t BloomFilter::Hash(const char *data, size_t len) {
+  // FNV-1a, then mixed to spread the bits
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return Mix(hash);
+}
+
+uint64_t BloomFilter::ProbeHash(uint64_t hash) {
+  // 只用低 32 位再混合一次, 与选块的高 32 位无关
+  return Mix((hash & 0xffffffffull) + 0x9e3779b97f4a7c15ull);
+}
+
+void BloomFilter::Add(const char *data, size_t len) {
+  if (stages_.back().size_ >= stages_.back().capacity_) {
+    AddStage(stages_.back().capacity_ * 2, stages_.back().bits_per_key_ + 1);
+  }
+  // 高 32 位选块, ProbeHash 每 9 位选块内的一个比特
+  Stage &stage = stages_.back();
+  uint64_t hash = Hash(data, len);
+  Block &block = stage.blocks_[(hash >> 32) % stage.blocks_.size()];
+  uint64_t probes = ProbeHash(hash);
+  for (int i = 0; i < NUM_PROBES; i++) {
+    uint32_t bit = (probes >> (i * 9)) & (BLOCK_BITS - 1);
+    block.words_[bit / 64] |= 1ull << (bit % 64);
+  }
+  stage.size_++;
+  size_++;
+}
+
+bool BloomFilter::StageMayContain(const Stage &stage, uint64_t hash) {
+  const Block &block = stage.blocks_[(hash >> 32) % stage.blocks_.size()];
+  uint64_t probes = ProbeHash(hash);
+  for (int i = 0; i < NUM_PROBES; i++) {
+    uint32_t bit = (probes >> (i * 9)) & (BLOCK_BITS - 1);
+    if ((block.words_[bit / 64] & (1ull << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BloomFilter::MayContain(const char *data, size_t len) const {
+  uint64_t hash = Hash(data, len);
+  return std::any_of(stages_.begin(), stages_.end(),
+                     [hash](const Stage &stage) { return StageMayContain(stage, hash); });
+}
+
+size_t BloomFilter::GetMemoryUsage() const {
+  size_t bytes = 0;
+  for (const auto &stage : stages_) {
+    bytes += stage.blocks_.size() * sizeof(Block);
+  }
+  return bytes;
+}
+
+void BloomFilter::Clear() {
+  size_t capacity = stages_.front().capacity_;
+  int bits_per_key = stages_.front().bits_per_key_;
+  stages_.clear();
+  size_ = 0;
+  AddStage(capacity, bits_per_key);
+}
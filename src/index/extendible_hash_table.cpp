@@ -0,0 +1,325 @@
+#include "index/extendible_hash_table.h"
+
+#include <stdexcept>
+
+#include "common/macros.h"
+#include "page/index_roots_page.h"
+
+ExtendibleHashTable::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                         const KeyManager &KM, bool unique)
+    : index_id_(index_id), buffer_pool_manager_(buffer_pool_manager), processor_(KM), unique_(unique) {
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  if (!index_roots_page->GetRootId(index_id_, &directory_page_id_)) {
+    directory_page_id_ = INVALID_PAGE_ID;
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+/*
+ * FNV-1a over the serialized key followed by the murmur3 finalizer, the
+ * directory only looks at the low bits so they have to be well mixed.
+ * The hash is persisted implicitly through the bucket layout, so it must not
+ * depend on the platform's std::hash.
+ */
+uint32_t ExtendibleHashTable::Hash(const GenericKey *key) const {
+  auto bytes = reinterpret_cast<const unsigned char *>(key);
+  uint32_t hash = 2166136261U;
+  for (int i = 0; i < processor_.GetKeySize(); i++) {
+    hash ^= bytes[i];
+    hash *= 16777619U;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bU;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+void ExtendibleHashTable::InitDirectory() {
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+  if (bucket_page == nullptr) throw std::runtime_error("out of memory");
+  reinterpret_cast<BucketPage *>(bucket_page->GetData())->Init(bucket_page_id, processor_.GetKeySize());
+  Page *directory_page = buffer_pool_manager_->NewPage(directory_page_id_);
+  if (directory_page == nullptr) throw std::runtime_error("out of memory");
+  reinterpret_cast<DirectoryPage *>(directory_page->GetData())->Init(directory_page_id_, bucket_page_id);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  // 目录页不会再变化, 只需登记一次
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  reinterpret_cast<IndexRootsPage *>(page->GetData())->Insert(index_id_, directory_page_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+HashTableDirectoryPage *ExtendibleHashTable::FetchDirectory() {
+  return reinterpret_cast<DirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+HashTableBucketPage *ExtendibleHashTable::FetchBucket(page_id_t bucket_page_id) {
+  return reinterpret_cast<BucketPage *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+bool ExtendibleHashTable::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction) {
+  if (IsEmpty()) return false;
+  DirectoryPage *directory = FetchDirectory();
+  page_id_t page_id = directory->GetBucketPageId(Hash(key) & directory->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  size_t found = result.size();
+  // 沿溢出链查找, 唯一索引找到一个就停
+  while (page_id != INVALID_PAGE_ID && (!unique_ || result.size() == found)) {
+    BucketPage *bucket = FetchBucket(page_id);
+    for (int index = bucket->KeyIndex(key); index != -1; index = bucket->KeyIndex(key, index + 1)) {
+      result.push_back(bucket->ValueAt(index));
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return result.size() > found;
+}
+
+bool ExtendibleHashTable::Insert(const GenericKey *key, const RowId &value, Txn *transaction) {
+  if (IsEmpty()) {
+    InitDirectory();
+  }
+  DirectoryPage *directory = FetchDirectory();
+  bool directory_dirty = false;
+  uint32_t hash = Hash(key);
+  while (true) {
+    uint32_t bucket_idx = hash & directory->GetGlobalDepthMask();
+    page_id_t head_page_id = directory->GetBucketPageId(bucket_idx);
+    // 先确认 key (非唯一时是这一对) 不存在, 顺便看链上是否还有空位
+    bool full = true;
+    page_id_t page_id = head_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+      BucketPage *bucket = FetchBucket(page_id);
+      if ((unique_ ? bucket->KeyIndex(key) : bucket->PairIndex(key, value)) != -1) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+        return false;
+      }
+      full = full && bucket->IsFull();
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    if (full && directory->GetLocalDepth(bucket_idx) < DirectoryPage::MAX_GLOBAL_DEPTH &&
+        CanSplit(head_page_id, hash)) {
+      SplitBucket(directory, bucket_idx);
+      directory_dirty = true;
+      continue;
+    }
+    // 有空位, 或者分裂也分不开 (目录已到最大深度, 或全是同一个 key), 只能挂溢出页
+    AppendToChain(head_page_id, key, value);
+    break;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+  return true;
+}
+
+bool ExtendibleHashTable::CanSplit(page_id_t head_page_id, uint32_t hash) {
+  const uint32_t mask = (1U << DirectoryPage::MAX_GLOBAL_DEPTH) - 1;
+  page_id_t page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *bucket = FetchBucket(page_id);
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      if ((Hash(bucket->KeyAt(i)) ^ hash) & mask) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return true;
+      }
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return false;
+}
+
+void ExtendibleHashTable::AppendToChain(page_id_t head_page_id, const GenericKey *key, const RowId &value) {
+  page_id_t page_id = head_page_id;
+  while (true) {
+    BucketPage *bucket = FetchBucket(page_id);
+    if (!bucket->IsFull()) {
+      bucket->Insert(key, value);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      return;
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      Page *overflow_page = buffer_pool_manager_->NewPage(next_page_id);
+      if (overflow_page == nullptr) throw std::runtime_error("out of memory");
+      auto *overflow = reinterpret_cast<BucketPage *>(overflow_page->GetData());
+      overflow->Init(next_page_id, processor_.GetKeySize());
+      overflow->Insert(key, value);
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+      bucket->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      return;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void ExtendibleHashTable::SplitBucket(DirectoryPage *directory, uint32_t bucket_idx) {
+  uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+  page_id_t old_page_id = directory->GetBucketPageId(bucket_idx);
+  if (local_depth == directory->GetGlobalDepth()) {
+    directory->IncrGlobalDepth();
+  }
+  page_id_t new_page_id;
+  Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+  if (new_page == nullptr) throw std::runtime_error("out of memory");
+  reinterpret_cast<BucketPage *>(new_page->GetData())->Init(new_page_id, processor_.GetKeySize());
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  // 新的一位为 1 的槽指向新 bucket
+  uint32_t split_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    if (directory->GetBucketPageId(i) == old_page_id) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if (i & split_bit) {
+        directory->SetBucketPageId(i, new_page_id);
+      }
+    }
+  }
+  // 溢出页上的 pair 和 bucket 页上要搬走的 pair 先取出来, 再按新的一位放回两条链
+  int key_size = processor_.GetKeySize();
+  std::vector<char> keys;
+  std::vector<RowId> values;
+  BucketPage *old_bucket = FetchBucket(old_page_id);
+  page_id_t page_id = old_bucket->GetNextPageId();
+  old_bucket->SetNextPageId(INVALID_PAGE_ID);
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *overflow = FetchBucket(page_id);
+    for (int i = 0; i < overflow->GetSize(); i++) {
+      auto key = reinterpret_cast<const char *>(overflow->KeyAt(i));
+      keys.insert(keys.end(), key, key + key_size);
+      values.push_back(overflow->ValueAt(i));
+    }
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  for (int i = old_bucket->GetSize() - 1; i >= 0; i--) {
+    if (Hash(old_bucket->KeyAt(i)) & split_bit) {
+      auto key = reinterpret_cast<const char *>(old_bucket->KeyAt(i));
+      keys.insert(keys.end(), key, key + key_size);
+      values.push_back(old_bucket->ValueAt(i));
+      old_bucket->RemoveAt(i);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(old_page_id, true);
+  for (size_t i = 0; i < values.size(); i++) {
+    auto key = reinterpret_cast<const GenericKey *>(&keys[i * key_size]);
+    AppendToChain((Hash(key) & split_bit) ? new_page_id : old_page_id, key, values[i]);
+  }
+}
+
+void ExtendibleHashTable::Remove(const GenericKey *key, const RowId &value, Txn *transaction) {
+  if (IsEmpty()) return;
+  DirectoryPage *directory = FetchDirectory();
+  uint32_t bucket_idx = Hash(key) & directory->GetGlobalDepthMask();
+  page_id_t head_page_id = directory->GetBucketPageId(bucket_idx);
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *bucket = FetchBucket(page_id);
+    int index = unique_ ? bucket->KeyIndex(key) : bucket->PairIndex(key, value);
+    if (index == -1) {
+      prev_page_id = page_id;
+      page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+      continue;
+    }
+    bucket->RemoveAt(index);
+    bool page_empty = bucket->GetSize() == 0;
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    if (page_empty && prev_page_id != INVALID_PAGE_ID) {
+      // 空的溢出页从链上摘掉, 只剩一个空 bucket 页时和没有溢出页一样可以合并
+      BucketPage *prev = FetchBucket(prev_page_id);
+      prev->SetNextPageId(next_page_id);
+      page_empty = prev_page_id == head_page_id && prev->GetSize() == 0;
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    if (page_empty && next_page_id == INVALID_PAGE_ID) {
+      MergeBucket(directory, bucket_idx);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      return;
+    }
+    break;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+}
+
+void ExtendibleHashTable::MergeBucket(DirectoryPage *directory, uint32_t bucket_idx) {
+  while (directory->GetLocalDepth(bucket_idx) > 0) {
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    BucketPage *bucket = FetchBucket(page_id);
+    BucketPage *image = FetchBucket(image_page_id);
+    bool bucket_empty = bucket->GetSize() == 0 && bucket->GetNextPageId() == INVALID_PAGE_ID;
+    bool image_empty = image->GetSize() == 0 && image->GetNextPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+    // 保留非空的那一页, 另一页释放
+    page_id_t keep_page_id = bucket_empty ? image_page_id : page_id;
+    page_id_t drop_page_id = bucket_empty ? page_id : image_page_id;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      page_id_t slot_page_id = directory->GetBucketPageId(i);
+      if (slot_page_id == page_id || slot_page_id == image_page_id) {
+        directory->SetBucketPageId(i, keep_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(drop_page_id);
+  }
+  while (directory->CanShrink()) {
+    directory->DecrGlobalDepth();
+  }
+}
+
+void ExtendibleHashTable::Destroy() {
+  if (IsEmpty()) return;
+  DirectoryPage *directory = FetchDirectory();
+  std::vector<page_id_t> heads;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    // 相同 bucket 的槽只在第一次出现时释放
+    if (i < (1U << directory->GetLocalDepth(i))) {
+      heads.push_back(directory->GetBucketPageId(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  for (auto page_id : heads) {
+    while (page_id != INVALID_PAGE_ID) {
+      page_id_t next_page_id = FetchBucket(page_id)->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = next_page_id;
+    }
+  }
+  buffer_pool_manager_->DeletePage(directory_page_id_);
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  reinterpret_cast<IndexRootsPage *>(page->GetData())->Delete(index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  directory_page_id_ = INVALID_PAGE_ID;
+}
+
+uint32_t ExtendibleHashTable::GetGlobalDepth() {
+  if (IsEmpty()) return 0;
+  uint32_t global_depth = FetchDirectory()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return global_depth;
+}
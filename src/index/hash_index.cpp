@@ -0,0 +1,43 @@
+#include "index/hash_index.h"
+
+HashIndex::HashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                     BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema),
+      unique_(unique),
+      processor_(key_schema_, key_size),
+      container_(index_id, buffer_pool_manager, processor_, unique) {}
+
+dberr_t HashIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  bool status = container_.Insert(index_key, row_id, txn);
+  free(index_key);
+  if (!status) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  container_.Remove(index_key, row_id, txn);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
+  if (compare_operator != "=") {
+    return DB_FAILED;
+  }
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  bool found = container_.GetValue(index_key, result, txn);
+  free(index_key);
+  return found ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t HashIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
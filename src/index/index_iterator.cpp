@@ -8,6 +8,39 @@ IndexIterator::IndexIterator() = default;
 IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
   page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+  SkipExhaustedPages();
+}
+
+// 迭代器持有叶子页的 pin, 只允许移动, 避免重复 unpin
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept
+    : current_page_id(other.current_page_id),
+      page(other.page),
+      item_index(other.item_index),
+      buffer_pool_manager(other.buffer_pool_manager),
+      key_buf_(std::move(other.key_buf_)),
+      prefetch_(std::move(other.prefetch_)),
+      leaves_until_prefetch_(other.leaves_until_prefetch_) {
+  other.current_page_id = INVALID_PAGE_ID;
+  other.page = nullptr;
+  other.item_index = 0;
+}
+
+IndexIterator &IndexIterator::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    if (current_page_id != INVALID_PAGE_ID)
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+    current_page_id = other.current_page_id;
+    page = other.page;
+    item_index = other.item_index;
+    buffer_pool_manager = other.buffer_pool_manager;
+    key_buf_ = std::move(other.key_buf_);
+    prefetch_ = std::move(other.prefetch_);
+    leaves_until_prefetch_ = other.leaves_until_prefetch_;
+    other.current_page_id = INVALID_PAGE_ID;
+    other.page = nullptr;
+    other.item_index = 0;
+  }
+  return *this;
 }
 
 IndexIterator::~IndexIterator() {
@@ -15,27 +48,97 @@ IndexIterator::~IndexIterator() {
     buffer_pool_manager->UnpinPage(current_page_id, false);
 }
 
+void IndexIterator::SkipExhaustedPages() {
+  // Begin(key) 可能落在叶子末尾 (key 大于该叶子所有 key), 空的根叶子同理
+  while (current_page_id != INVALID_PAGE_ID && item_index >= page->GetSize()) {
+    MoveToNextLeaf();
+  }
+}
+
+void IndexIterator::MoveToNextLeaf() {
+  page_id_t next_page_id = page->GetNextPageId();
+  buffer_pool_manager->UnpinPage(current_page_id, false);
+  current_page_id = next_page_id;
+  item_index = 0;
+  if (next_page_id != INVALID_PAGE_ID) {
+    page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(next_page_id)->GetData());
+  } else {
+    page = nullptr;
+  }
+}
+
+/** Load up to depth leaves starting at page_id into the buffer pool, return the leaf after the last one. */
+static page_id_t PrefetchLeaves(BufferPoolManager *bpm, page_id_t page_id, int depth) {
+  for (int i = 0; i < depth && page_id != INVALID_PAGE_ID; i++) {
+    Page *leaf = bpm->FetchPage(page_id);
+    if (leaf == nullptr) {
+      // 缓冲池已被占满, 放弃预读
+      return INVALID_PAGE_ID;
+    }
+    page_id_t next_page_id = reinterpret_cast<BPlusTreeLeafPage *>(leaf->GetData())->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return page_id;
+}
+
+void IndexIterator::Prefetch() {
+  if (current_page_id == INVALID_PAGE_ID || --leaves_until_prefetch_ > 0) {
+    return;
+  }
+  int depth = LEAF_PREFETCH_DEPTH / 2;
+  page_id_t from;
+  if (prefetch_.valid()) {
+    from = prefetch_.get();
+  } else {
+    // 第一次预读, 一次读满整个窗口
+    from = page->GetNextPageId();
+    depth = LEAF_PREFETCH_DEPTH;
+  }
+  if (from == INVALID_PAGE_ID) {
+    // 叶子链已经预读到头
+    leaves_until_prefetch_ = INT32_MAX;
+    return;
+  }
+  prefetch_ = std::async(std::launch::async, PrefetchLeaves, buffer_pool_manager, from, depth);
+  leaves_until_prefetch_ = LEAF_PREFETCH_DEPTH / 2;
+}
+
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
-  return std::make_pair(page->KeyAt(item_index), page->ValueAt(item_index));
+  key_buf_.resize(page->GetKeySize());
+  auto *key = reinterpret_cast<GenericKey *>(key_buf_.data());
+  page->KeyAt(item_index, key);
+  return std::make_pair(key, page->ValueAt(item_index));
 }
 
 IndexIterator &IndexIterator::operator++() {
   if (item_index + 1 < page->GetSize()) {
     item_index++;
   } else { // 溢出到下一页
-    int next_page_id = page->GetNextPageId();
-    if (next_page_id != INVALID_PAGE_ID) { // 是否已经到达最后一页
-      buffer_pool_manager->UnpinPage(page->GetPageId(), false);
-      page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(next_page_id)->GetData());
-    } else {
-      page = nullptr; // 置为 nullptr
-    }
-    item_index = 0;
-    current_page_id = next_page_id;
+    MoveToNextLeaf();
+    Prefetch();
   }
   return *this;
 }
 
+size_t IndexIterator::NextLeafBatch(std::vector<RowId> &values) {
+  size_t count = page->GetSize() - item_index;
+  for (int i = item_index; i < page->GetSize(); i++) {
+    values.emplace_back(page->ValueAt(i));
+  }
+  MoveToNextLeaf();
+  Prefetch();
+  SkipExhaustedPages();
+  return count;
+}
+
+GenericKey *IndexIterator::LeafLastKey() {
+  key_buf_.resize(page->GetKeySize());
+  auto *key = reinterpret_cast<GenericKey *>(key_buf_.data());
+  page->KeyAt(page->GetSize() - 1, key);
+  return key;
+}
+
 bool IndexIterator::operator==(const IndexIterator &itr) const {
   return current_page_id == itr.current_page_id && item_index == itr.item_index;
 }
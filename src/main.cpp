@@ -1,4 +1,8 @@
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
@@ -31,6 +35,39 @@ void InputCommand(char *input, const int len) {
   getchar();      // remove enter
 }
 
+/**
+ * --format=table|csv|tsv|binary picks how select results are written,
+ * --width=N gives every table column the width N instead of sizing it from the first rows.
+ */
+void ParseResultOptions(int argc, char **argv, ExecuteEngine &engine) {
+  ResultFormat format = ResultFormat::kTable;
+  int width = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg == "--format=csv") {
+      format = ResultFormat::kCsv;
+    } else if (arg == "--format=tsv") {
+      format = ResultFormat::kTsv;
+    } else if (arg == "--format=binary") {
+      format = ResultFormat::kBinary;
+    } else if (arg == "--format=table") {
+      format = ResultFormat::kTable;
+    } else if (arg.rfind("--width=", 0) == 0) {
+      const char *value = argv[i] + strlen("--width=");
+      char *end = nullptr;
+      long parsed = strtol(value, &end, 10);
+      if (*value == '\0' || *end != '\0' || parsed < 0 || parsed > INT_MAX) {
+        LOG(WARNING) << "Invalid width " << value << std::endl;
+      } else {
+        width = static_cast<int>(parsed);
+      }
+    } else {
+      LOG(WARNING) << "Unknown option " << arg << std::endl;
+    }
+  }
+  engine.SetResultFormat(format, width);
+}
+
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
   // command buffer
@@ -38,6 +75,7 @@ int main(int argc, char **argv) {
   char cmd[buf_size];
   // executor engine
   ExecuteEngine engine;
+  ParseResultOptions(argc, argv, engine);
   // for print syntax tree
   TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
   uint32_t syntax_tree_id = 0;
@@ -1,16 +1,11 @@
-
 #include "page/b_plus_tree_internal_page.h"
 
+#include <algorithm>
+
 #include "index/generic_key.h"
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(page_id_t))
-#define key_off 0
-#define val_off GetKeySize()
+static_assert(sizeof(BPlusTreeInternalPage) == PAGE_SIZE, "Internal page does not match the page size.");
 
-/**
- * TODO: Student Implement
- */
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
@@ -26,25 +21,73 @@ void InternalPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, in
   SetMaxSize(max_size);
   SetSize(0);
   SetPageType(IndexPageType::INTERNAL_PAGE);
+  heap_offset_ = DATA_SIZE;
+}
+
+uint16_t InternalPage::SlotOffset(int index) const {
+  uint16_t offset;
+  memcpy(&offset, data_ + index * SLOT_SIZE, sizeof(uint16_t));
+  return offset;
 }
+
+uint16_t InternalPage::SlotLength(int index) const {
+  uint16_t length;
+  memcpy(&length, data_ + index * SLOT_SIZE + sizeof(uint16_t), sizeof(uint16_t));
+  return length;
+}
+
+void InternalPage::SetSlot(int index, uint16_t offset, uint16_t length) {
+  memcpy(data_ + index * SLOT_SIZE, &offset, sizeof(uint16_t));
+  memcpy(data_ + index * SLOT_SIZE + sizeof(uint16_t), &length, sizeof(uint16_t));
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *InternalPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
+void InternalPage::KeyAt(int index, GenericKey *key) const {
+  char *bytes = reinterpret_cast<char *>(key);
+  memset(bytes, 0, GetKeySize());
+  memcpy(bytes, data_ + SlotOffset(index), SlotLength(index));
 }
 
-void InternalPage::SetKeyAt(int index, GenericKey *key) {
-  memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+bool InternalPage::SetKeyAt(int index, const GenericKey *key, const KeyManager &KM) {
+  int key_len = KM.GetKeyLength(key);
+  if (key_len > DATA_SIZE - GetUsedBytes() + SlotLength(index)) {
+    return false;
+  }
+  RemoveKeyBytes(index);
+  heap_offset_ -= key_len;
+  memcpy(data_ + heap_offset_, key, key_len);
+  SetSlot(index, heap_offset_, key_len);
+  return true;
+}
+
+void InternalPage::RemoveKeyBytes(int index) {
+  int offset = SlotOffset(index);
+  int length = SlotLength(index);
+  if (length == 0) {
+    return;
+  }
+  // 把 key 之前的堆内容整体后移, 保持堆紧凑
+  memmove(data_ + heap_offset_ + length, data_ + heap_offset_, offset - heap_offset_);
+  heap_offset_ += length;
+  SetSlot(index, DATA_SIZE, 0);
+  for (int i = 0; i < GetSize(); i++) {
+    if (SlotLength(i) > 0 && SlotOffset(i) < offset) {
+      SetSlot(i, SlotOffset(i) + length, SlotLength(i));
+    }
+  }
 }
 
 page_id_t InternalPage::ValueAt(int index) const {
-  return *reinterpret_cast<const page_id_t *>(pairs_off + index * pair_size + val_off);
+  page_id_t value;
+  memcpy(&value, data_ + index * SLOT_SIZE + 2 * sizeof(uint16_t), sizeof(page_id_t));
+  return value;
 }
 
 void InternalPage::SetValueAt(int index, page_id_t value) {
-  *reinterpret_cast<page_id_t *>(pairs_off + index * pair_size + val_off) = value;
+  memcpy(data_ + index * SLOT_SIZE + 2 * sizeof(uint16_t), &value, sizeof(page_id_t));
 }
 
 int InternalPage::ValueIndex(const page_id_t &value) const {
@@ -55,13 +98,6 @@ int InternalPage::ValueIndex(const page_id_t &value) const {
   return -1;
 }
 
-void *InternalPage::PairPtrAt(int index) {
-  return KeyAt(index);
-}
-
-void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
-}
 /*****************************************************************************
  * LOOKUP
  *****************************************************************************/
@@ -71,22 +107,21 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * Start the search from the second key(the first key should always be invalid)
  * 用了二分查找
  */
-page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
-  int l=1,r=GetSize()-1,mid,ans=GetSize();//l=1是因为第一个key是无效的
+page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) const {
   if(GetSize()==0) return INVALID_PAGE_ID;
-  if(GetSize()==1) return ValueAt(0);
-  if(KM.CompareKeys(key,KeyAt(1))<0) return ValueAt(0);
-  //如果key比第一个key还小，那么返回第一个value指针
-  /*按照顺序存储 m个键和m+1个指针（这些指针记录的是⼦结点的 page_id ）。由于键和指针的数量不相等，因此我们需
-要将第⼀个键设置为INVALID，也就是说，顺序查找时需要从第2个键开始查找
-         | 0  | 1 | 2  |
-    key  | /  | a | b  |
-    value| x  | y | z  |
-  */
-  //用二分，找到最后一个<=key的位置
+  const char *bytes = reinterpret_cast<const char *>(key);
+  int key_len = KM.GetKeyLength(key);
+  // 分隔键长度不一, 按字节序比较, 较短的前缀更小
+  auto compare = [&](int index) {
+    int length = SlotLength(index);
+    int cmp = memcmp(data_ + SlotOffset(index), bytes, std::min(length, key_len));
+    return cmp != 0 ? cmp : length - key_len;
+  };
+  //用二分，找到最后一个<=key的位置, 没有则是第一个孩子
+  int l=1,r=GetSize()-1,mid,ans=0;
   while(l<=r){
     mid=(l+r)/2;
-    if(KM.CompareKeys(KeyAt(mid),key)<=0){
+    if(compare(mid)<=0){
       ans=mid;
       l=mid+1;
     }else r=mid-1;
@@ -103,12 +138,13 @@ page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
  * page, you should create a new root page and populate its elements.
  * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
  */
-void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
-  SetSize(2);//size=value个数=key个数+1
-  // SetKeyAt(0,nullptr); //memcpy空指针会出错
-  SetKeyAt(1,new_key);
+void InternalPage::PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value,
+                                   const KeyManager &KM) {
+  SetSize(1);
+  heap_offset_ = DATA_SIZE;
+  SetSlot(0, DATA_SIZE, 0);
   SetValueAt(0, old_value);
-  SetValueAt(1,new_value);
+  InsertNodeAfter(old_value, new_key, new_value, KM);
 }
 
 /* CP
@@ -116,52 +152,21 @@ void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_k
  * old_value
  * @return:  new size after insertion
  */
-int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
-  int index=ValueIndex(old_value);
-  //先右移，后插入到index+1位置
-  PairCopy(PairPtrAt(index+2),PairPtrAt(index+1),GetSize()-index-1);
-  SetKeyAt(index+1, new_key);
-  SetValueAt(index+1, new_value);
+int InternalPage::InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value,
+                                  const KeyManager &KM) {
+  int key_len = KM.GetKeyLength(new_key);
+  ASSERT(HasRoomFor(key_len), "Insert into a full internal page.");
+  int index=ValueIndex(old_value)+1;
+  //先右移，后插入到index位置
+  memmove(data_ + (index + 1) * SLOT_SIZE, data_ + index * SLOT_SIZE, (GetSize() - index) * SLOT_SIZE);
+  heap_offset_ -= key_len;
+  memcpy(data_ + heap_offset_, new_key, key_len);
+  SetSlot(index, heap_offset_, key_len);
+  SetValueAt(index, new_value);
   IncreaseSize(1);
   return GetSize();
 }
 
-/*****************************************************************************
- * SPLIT
- *****************************************************************************/
-/*
- * Remove half of key & value pairs from this page to "recipient" page
- * buffer_pool_manager 是干嘛的？传给CopyNFrom()用于Fetch数据页
- */
-void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager) {
-  int size=GetSize();//把后size/2个元素移动到recipient
-  recipient->CopyNFrom(PairPtrAt(size-size/2),size/2,buffer_pool_manager);
-  IncreaseSize(-size/2);
-}
-
-/* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
- *
- */
-void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager) {
-  int pos=GetSize();//从当前size的位置开始插入
-  PairCopy(PairPtrAt(pos),src,size);
-  IncreaseSize(size);
-  //对于复制过来的子节点，要把他门的父节点更新成当前Page
-  for(int i=0;i<size;i++){
-    page_id_t page_id=ValueAt(pos+i);//id
-    Page *page=buffer_pool_manager->FetchPage(page_id);//fetch->修改->unPin
-    if(page==nullptr){
-      LOG(INFO)<<"CopyNFrom fetch page failed";
-      return;
-    }
-    InternalPage *internal_page=reinterpret_cast<InternalPage *>(page->GetData());
-    internal_page->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(page_id,true);
-  }
-}
-
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -171,7 +176,8 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
  * NOTE: store key&value pair continuously after deletion
  */
 void InternalPage::Remove(int index) {
-  PairCopy(PairPtrAt(index),PairPtrAt(index+1),GetSize()-index-1);
+  RemoveKeyBytes(index);
+  memmove(data_ + index * SLOT_SIZE, data_ + (index + 1) * SLOT_SIZE, (GetSize() - index - 1) * SLOT_SIZE);
   IncreaseSize(-1);
 }
 
@@ -190,98 +196,126 @@ page_id_t InternalPage::RemoveAndReturnOnlyChild() {
 }
 
 /*****************************************************************************
- * MERGE
+ * SPLIT / MERGE / REDISTRIBUTE
  *****************************************************************************/
-/*
- * Remove all of key & value pairs from this page to "recipient" page.
- * The middle_key is the separation key you should get from the parent. You need
- * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
- */
-void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyLastFrom(middle_key,ValueAt(0),buffer_pool_manager);
-  recipient->CopyNFrom(PairPtrAt(1),GetSize()-1,buffer_pool_manager);
-  buffer_pool_manager->DeletePage(GetPageId());
+void InternalPage::AppendEntries(std::vector<Entry> &entries) const {
+  for (int i = 0; i < GetSize(); i++) {
+    entries.emplace_back(std::string(data_ + SlotOffset(i), SlotLength(i)), ValueAt(i));
+  }
 }
 
-/*****************************************************************************
- * REDISTRIBUTE
- *****************************************************************************/
-/*
- * Remove the first key & value pair from this page to tail of "recipient" page.
- *
- * The middle_key is the separation key you should get from the parent. You need
- * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
- */
-void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key,
-                                    BufferPoolManager *buffer_pool_manager) {
-    recipient->CopyLastFrom(middle_key,ValueAt(0),buffer_pool_manager);//插到末尾
-    Remove(0);//自己删除value(0)
-                      
+int InternalPage::GetRebuildSize(const std::vector<Entry> &entries, int begin, int end) {
+  int size = 0;
+  for (int i = begin; i < end; i++) {
+    size += SLOT_SIZE + (i == begin ? 0 : entries[i].first.size());
+  }
+  return size;
 }
 
-/* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
+void InternalPage::Rebuild(const std::vector<Entry> &entries, int begin, int end) {
+  heap_offset_ = DATA_SIZE;
+  for (int i = begin; i < end; i++) {
+    int key_len = i == begin ? 0 : entries[i].first.size();
+    heap_offset_ -= key_len;
+    memcpy(data_ + heap_offset_, entries[i].first.data(), key_len);
+    SetSlot(i - begin, key_len == 0 ? DATA_SIZE : heap_offset_, key_len);
+    SetValueAt(i - begin, entries[i].second);
+  }
+  SetSize(end - begin);
+}
+
+/* For all entries (pages) moved into this page, their parents page now changes to me.
+ * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
-void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager) {
-  int pos=GetSize();
-  SetKeyAt(pos,key);
-  SetValueAt(pos,value);
-  IncreaseSize(1);
-  Page *page=buffer_pool_manager->FetchPage(value);
-  if(page==nullptr){
-    LOG(INFO)<<"CopyLastFrom fetch page failed";
-    return;
+void InternalPage::Adopt(const std::vector<Entry> &entries, int begin, int end,
+                         BufferPoolManager *buffer_pool_manager) {
+  for (int i = begin; i < end; i++) {
+    Page *page = buffer_pool_manager->FetchPage(entries[i].second);
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+    buffer_pool_manager->UnpinPage(entries[i].second, true);
   }
-  InternalPage *internal_page=reinterpret_cast<InternalPage *>(page->GetData());
-  internal_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value,true);
+}
+
+int InternalPage::GetBalancedSplit(const std::vector<Entry> &entries, int max_size) {
+  int n = static_cast<int>(entries.size());
+  ASSERT(n >= 2, "Too few children to split.");
+  int total = 0;
+  for (auto &entry : entries) {
+    total += SLOT_SIZE + entry.first.size();
+  }
+  int acc = 0, split = 1;
+  for (int i = 0; i < n - 1; i++) {
+    acc += SLOT_SIZE + entries[i].first.size();
+    split = i + 1;
+    if (acc * 2 >= total) break;
+  }
+  // 两边的孩子数都不能超过 max_size
+  return std::min(std::max(split, n - max_size), max_size);
 }
 
 /*
- * Remove the last key & value pair from this page to head of "recipient" page.
- * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
- * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
+ * Remove half of key & value pairs from this page to "recipient" page
+ * 分界处的 key 不留在任何一边, 交给父节点
  */
-void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
-                                     BufferPoolManager *buffer_pool_manager) {
-    recipient->CopyFirstFrom(ValueAt(GetSize()-1),buffer_pool_manager);//插到开头作为key,不需要value
-    Remove(GetSize()-1);//删除最后一个value
-    recipient->SetKeyAt(1,middle_key);//更新middle_key
-    
+void InternalPage::MoveHalfTo(InternalPage *recipient, GenericKey *middle_key,
+                              BufferPoolManager *buffer_pool_manager) {
+  std::vector<Entry> entries;
+  AppendEntries(entries);
+  int split = GetBalancedSplit(entries, GetMaxSize());
+  memset(middle_key, 0, GetKeySize());
+  memcpy(middle_key, entries[split].first.data(), entries[split].first.size());
+  recipient->Rebuild(entries, split, entries.size());
+  recipient->Adopt(entries, split, entries.size(), buffer_pool_manager);
+  Rebuild(entries, 0, split);
 }
 
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
+/*
+ * Remove all of key & value pairs from this page to "recipient" page.
+ * The middle_key is the separation key you should get from the parent. You need
+ * to make sure the middle key is added to the recipient to maintain the invariant.
+ * You also need to use BufferPoolManager to persist changes to the parent page id for those
+ * pages that are moved to the recipient
  */
-void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffer_pool_manager) {
-  InsertNodeAfter(INVALID_PAGE_ID, KeyAt(0), value);//????? 我不理解
-  Page *page=buffer_pool_manager->FetchPage(value);
-  if(page==nullptr){
-    LOG(INFO)<<"CopyLastFrom fetch page failed";
-    return;
+bool InternalPage::MoveAllTo(InternalPage *recipient, const GenericKey *middle_key,
+                             BufferPoolManager *buffer_pool_manager) {
+  std::vector<Entry> entries;
+  recipient->AppendEntries(entries);
+  int left_size = entries.size();
+  AppendEntries(entries);
+  // 原来无效的第一个 key 换成父节点里的分隔键
+  entries[left_size].first.assign(reinterpret_cast<const char *>(middle_key),
+                                  KeyManager::GetKeyLength(middle_key, GetKeySize()));
+  if (static_cast<int>(entries.size()) > recipient->GetMaxSize() ||
+      GetRebuildSize(entries, 0, entries.size()) > DATA_SIZE) {
+    return false;
   }
-  InternalPage *internal_page=reinterpret_cast<InternalPage *>(page->GetData());
-  internal_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value,true);
+  recipient->Rebuild(entries, 0, entries.size());
+  recipient->Adopt(entries, left_size, entries.size(), buffer_pool_manager);
+  SetSize(0);
+  return true;
 }
-page_id_t InternalPage::LeftMostKeyFromCurr(BufferPoolManager *buffer_pool_manager) {
-  Page *currPage = buffer_pool_manager->FetchPage(this->GetPageId());
-  auto *curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
-  InternalPage *internalPage;
-  while (!curr->IsLeafPage()) {//由于curr是由this转换过来的，所以至少可以进入一次
-    buffer_pool_manager->UnpinPage(curr->GetPageId(), false);           // 每找一层关闭上一层的内节点page
-    internalPage = reinterpret_cast<::InternalPage *>(currPage);  // 打开上一层内节点page
-    currPage = buffer_pool_manager->FetchPage(internalPage->ValueAt(0));  // 改变当前页的指针
-    curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
+
+bool InternalPage::Redistribute(InternalPage *right, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
+  std::vector<Entry> entries;
+  AppendEntries(entries);
+  int left_size = entries.size();
+  right->AppendEntries(entries);
+  entries[left_size].first.assign(reinterpret_cast<const char *>(middle_key),
+                                  KeyManager::GetKeyLength(middle_key, GetKeySize()));
+  int n = static_cast<int>(entries.size());
+  int split = GetBalancedSplit(entries, GetMaxSize());
+  if (split == left_size || split > GetMaxSize() || n - split > GetMaxSize() ||
+      GetRebuildSize(entries, 0, split) > DATA_SIZE || GetRebuildSize(entries, split, n) > DATA_SIZE) {
+    return false;
   }
-  buffer_pool_manager->UnpinPage(curr->GetPageId(),false);
-  return internalPage->ValueAt(0);
-}
\ No newline at end of file
+  memset(middle_key, 0, GetKeySize());
+  memcpy(middle_key, entries[split].first.data(), entries[split].first.size());
+  Rebuild(entries, 0, split);
+  right->Rebuild(entries, split, n);
+  if (split < left_size) {
+    right->Adopt(entries, split, left_size, buffer_pool_manager);
+  } else {
+    Adopt(entries, left_size, split, buffer_pool_manager);
+  }
+  return true;
+}
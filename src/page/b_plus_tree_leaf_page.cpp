@@ -4,17 +4,22 @@
 
 #include "index/generic_key.h"
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(RowId))
-#define key_off 0
-#define val_off GetKeySize()
+static_assert(sizeof(BPlusTreeLeafPage) == PAGE_SIZE, "Leaf page does not match the page size.");
+
+/** Length of the common prefix of two byte strings */
+static int CommonPrefixLength(const std::string &lhs, const std::string &rhs) {
+  int len = 0;
+  int max_len = static_cast<int>(std::min(lhs.size(), rhs.size()));
+  while (len < max_len && lhs[len] == rhs[len]) {
+    len++;
+  }
+  return len;
+}
+
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
 
-/**
- * TODO: Student Implement
- */
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
@@ -29,6 +34,8 @@ void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int ma
   SetNextPageId(INVALID_PAGE_ID);// 未初始化next_page_id
   SetSize(0);// 初始化size为0，因为是新建的叶子节点
   SetPageType(IndexPageType::LEAF_PAGE);// 设置为叶子节点
+  prefix_size_ = 0;
+  heap_offset_ = DATA_SIZE;
 }
 
 /**
@@ -45,19 +52,48 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
   }
 }
 
-/**
- * TODO: Student Implement
- */
+uint16_t LeafPage::SlotOffset(int index) const {
+  uint16_t offset;
+  memcpy(&offset, data_ + prefix_size_ + index * SLOT_SIZE, sizeof(uint16_t));
+  return offset;
+}
+
+uint16_t LeafPage::SlotLength(int index) const {
+  uint16_t length;
+  memcpy(&length, data_ + prefix_size_ + index * SLOT_SIZE + sizeof(uint16_t), sizeof(uint16_t));
+  return length;
+}
+
+void LeafPage::SetSlot(int index, uint16_t offset, uint16_t length) {
+  memcpy(data_ + prefix_size_ + index * SLOT_SIZE, &offset, sizeof(uint16_t));
+  memcpy(data_ + prefix_size_ + index * SLOT_SIZE + sizeof(uint16_t), &length, sizeof(uint16_t));
+}
+
+int LeafPage::CompareSuffix(int index, const char *suffix, int suffix_len) const {
+  int length = SlotLength(index);
+  int cmp = memcmp(data_ + SlotOffset(index), suffix, std::min(length, suffix_len));
+  return cmp != 0 ? cmp : length - suffix_len;
+}
+
 /**
  * Helper method to find the first index i so that pairs_[i].first >= key
  * NOTE: This method is only used when generating index iterator
  * 二分查找
  */
-int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
+int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) const {
+  const char *bytes = reinterpret_cast<const char *>(key);
+  int key_len = KM.GetKeyLength(key);
+  // 先和页前缀比较, 前缀不同时 key 落在整页的一侧
+  int cmp = memcmp(data_, bytes, std::min(prefix_size_, key_len));
+  if (cmp == 0 && key_len < prefix_size_) {
+    cmp = 1;
+  }
+  if (cmp > 0) return 0;
+  if (cmp < 0) return GetSize();
   int l=0,r=GetSize()-1,ans=r+1,mid;
   while(l<=r){
     mid=(l+r)/2;
-    if(KM.CompareKeys(KeyAt(mid),key)>=0){
+    if(CompareSuffix(mid,bytes+prefix_size_,key_len-prefix_size_)>=0){
       ans=mid;//pairs[mid].first>=key
       r=mid-1;
     }else{
@@ -71,55 +107,110 @@ int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *LeafPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
+void LeafPage::KeyAt(int index, GenericKey *key) const {
+  char *bytes = reinterpret_cast<char *>(key);
+  memset(bytes, 0, GetKeySize());
+  memcpy(bytes, data_, prefix_size_);
+  memcpy(bytes + prefix_size_, data_ + SlotOffset(index), SlotLength(index));
 }
 
-void LeafPage::SetKeyAt(int index, GenericKey *key) {
-  memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+RowId LeafPage::ValueAt(int index) const {
+  RowId value;
+  memcpy(&value, data_ + SlotOffset(index) + SlotLength(index), sizeof(RowId));
+  return value;
 }
 
-RowId LeafPage::ValueAt(int index) const {
-  return *reinterpret_cast<const RowId *>(pairs_off + index * pair_size + val_off);
+void LeafPage::AppendEntries(std::vector<Entry> &entries) const {
+  for (int i = 0; i < GetSize(); i++) {
+    std::string key(data_, prefix_size_);
+    key.append(data_ + SlotOffset(i), SlotLength(i));
+    entries.emplace_back(std::move(key), ValueAt(i));
+  }
 }
 
-void LeafPage::SetValueAt(int index, RowId value) {
-  *reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off) = value;
+int LeafPage::GetRebuildSize(const std::vector<Entry> &entries, int begin, int end) {
+  if (begin >= end) {
+    return 0;
+  }
+  // 有序的一组 key 的公共前缀就是首尾两个 key 的公共前缀
+  int prefix_size = CommonPrefixLength(entries[begin].first, entries[end - 1].first);
+  int size = prefix_size;
+  for (int i = begin; i < end; i++) {
+    size += SLOT_SIZE + static_cast<int>(entries[i].first.size()) - prefix_size + sizeof(RowId);
+  }
+  return size;
 }
 
-void *LeafPage::PairPtrAt(int index) {
-  return KeyAt(index);
+void LeafPage::Rebuild(const std::vector<Entry> &entries, int begin, int end) {
+  prefix_size_ = begin < end ? CommonPrefixLength(entries[begin].first, entries[end - 1].first) : 0;
+  if (prefix_size_ > 0) {
+    memcpy(data_, entries[begin].first.data(), prefix_size_);
+  }
+  heap_offset_ = DATA_SIZE;
+  for (int i = begin; i < end; i++) {
+    int suffix_len = static_cast<int>(entries[i].first.size()) - prefix_size_;
+    heap_offset_ -= suffix_len + sizeof(RowId);
+    memcpy(data_ + heap_offset_, entries[i].first.data() + prefix_size_, suffix_len);
+    memcpy(data_ + heap_offset_ + suffix_len, &entries[i].second, sizeof(RowId));
+    SetSlot(i - begin, heap_offset_, suffix_len);
+  }
+  SetSize(end - begin);
 }
-//把src的pair_num个元素复制到dest    可利用PairPtrAt()来获取第index个元素的指针
-void LeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+
+int LeafPage::GetBalancedSplit(const std::vector<Entry> &entries, int max_size) {
+  int n = static_cast<int>(entries.size());
+  ASSERT(n >= 2, "Too few pairs to split.");
+  int total = 0;
+  for (auto &entry : entries) {
+    total += SLOT_SIZE + entry.first.size() + sizeof(RowId);
+  }
+  int acc = 0, split = 1;
+  for (int i = 0; i < n - 1; i++) {
+    acc += SLOT_SIZE + entries[i].first.size() + sizeof(RowId);
+    split = i + 1;
+    if (acc * 2 >= total) break;
+  }
+  // 两边的 pair 数都不能超过 max_size
+  return std::min(std::max(split, n - max_size), max_size);
 }
-/*
- * Helper method to find and return the key & value pair associated with input
- * "index"(a.k.a. array offset)
- */
-std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) { return {KeyAt(index), ValueAt(index)}; }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
- * @return page size after insertion
+ * @return false if there is no room for the pair
  */
-int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
-  if(GetSize()==0){//结点为空
-    SetKeyAt(0,key);
-    SetValueAt(0,value);
-    IncreaseSize(1);
-    return 1;
+bool LeafPage::Insert(const GenericKey *key, const RowId &value, const KeyManager &KM) {
+  if (GetSize() >= GetMaxSize()) {
+    return false;
   }
+  const char *bytes = reinterpret_cast<const char *>(key);
+  int key_len = KM.GetKeyLength(key);
   int index = KeyIndex(key, KM);
-  PairCopy(PairPtrAt(index+1),PairPtrAt(index),GetSize()-index);// 将index及之后的元素后移
-  SetKeyAt(index, key);
-  SetValueAt(index, value);
+  if (key_len < prefix_size_ || memcmp(data_, bytes, prefix_size_) != 0) {
+    // key 不以页前缀开头, 用更短的前缀重建整页
+    std::vector<Entry> entries;
+    AppendEntries(entries);
+    entries.insert(entries.begin() + index, Entry(std::string(bytes, key_len), value));
+    if (GetRebuildSize(entries, 0, entries.size()) > DATA_SIZE) {
+      return false;
+    }
+    Rebuild(entries, 0, entries.size());
+    return true;
+  }
+  int suffix_len = key_len - prefix_size_;
+  if (SLOT_SIZE + suffix_len + static_cast<int>(sizeof(RowId)) > DATA_SIZE - GetUsedBytes()) {
+    return false;
+  }
+  char *slots = data_ + prefix_size_;
+  memmove(slots + (index + 1) * SLOT_SIZE, slots + index * SLOT_SIZE, (GetSize() - index) * SLOT_SIZE);
+  heap_offset_ -= suffix_len + sizeof(RowId);
+  memcpy(data_ + heap_offset_, bytes + prefix_size_, suffix_len);
+  memcpy(data_ + heap_offset_ + suffix_len, &value, sizeof(RowId));
+  SetSlot(index, heap_offset_, suffix_len);
   IncreaseSize(1);
-  return GetSize();
+  return true;
 }
 
 /*****************************************************************************
@@ -127,20 +218,14 @@ int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM)
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * 按字节数而不是 pair 数对半分, 两边各自重新计算前缀
  */
 void LeafPage::MoveHalfTo(LeafPage *recipient) {
-  int size=GetSize();//把后size/2个元素移动到recipient
-  recipient->CopyNFrom(PairPtrAt(size-size/2),size/2);
-  IncreaseSize(-(size/2));
-}
-
-/*
- * Copy starting from items, and copy {size} number of elements into me.
- */
-void LeafPage::CopyNFrom(void *src, int size) {
-  int pos=GetSize();//从当前size的位置开始插入
-  PairCopy(PairPtrAt(pos),src,size);
-  IncreaseSize(size);
+  std::vector<Entry> entries;
+  AppendEntries(entries);
+  int split = GetBalancedSplit(entries, GetMaxSize());
+  recipient->Rebuild(entries, split, entries.size());
+  Rebuild(entries, 0, split);
 }
 
 /*****************************************************************************
@@ -151,10 +236,12 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * does, then store its corresponding value in input "value" and return true.
  * If the key does not exist, then return false
  */
-bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
+bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) const {
   int index=KeyIndex(key,KM);
   if(index>=GetSize()) return false;
-  if(KM.CompareKeys(KeyAt(index),key)==0){
+  int key_len = KM.GetKeyLength(key);
+  if (key_len < prefix_size_ || memcmp(data_, key, prefix_size_) != 0) return false;
+  if(CompareSuffix(index,reinterpret_cast<const char *>(key)+prefix_size_,key_len-prefix_size_)==0){
     value=ValueAt(index);
     return true;
   }
@@ -171,10 +258,22 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
  * @return  page size after deletion
  */
 int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
-  int index=KeyIndex(key,KM);
-  if(index==GetSize()||KM.CompareKeys(KeyAt(index),key)!=0) return GetSize();//不存在
-  PairCopy(PairPtrAt(index),PairPtrAt(index+1),GetSize()-index-1);//删除index位置的元素
+  RowId value;
+  if (!Lookup(key, value, KM)) return GetSize();//不存在
+  int index = KeyIndex(key, KM);
+  // 把 entry 之前的堆内容整体后移, 保持堆紧凑
+  int offset = SlotOffset(index);
+  int length = SlotLength(index) + sizeof(RowId);
+  memmove(data_ + heap_offset_ + length, data_ + heap_offset_, offset - heap_offset_);
+  heap_offset_ += length;
+  char *slots = data_ + prefix_size_;
+  memmove(slots + index * SLOT_SIZE, slots + (index + 1) * SLOT_SIZE, (GetSize() - index - 1) * SLOT_SIZE);
   IncreaseSize(-1);
+  for (int i = 0; i < GetSize(); i++) {
+    if (SlotOffset(i) < offset) {
+      SetSlot(i, SlotOffset(i) + length, SlotLength(i));
+    }
+  }
   return GetSize();
 }
 
@@ -185,51 +284,37 @@ int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
  * Remove all key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
  */
-void LeafPage::MoveAllTo(LeafPage *recipient) {
-    recipient->CopyNFrom(PairPtrAt(0),GetSize());//先把当前page的所有元素移动到recipient
-    recipient->SetNextPageId(GetNextPageId());
-    SetSize(0);//清空当前page
+bool LeafPage::MoveAllTo(LeafPage *recipient) {
+  std::vector<Entry> entries;
+  recipient->AppendEntries(entries);
+  AppendEntries(entries);
+  if (static_cast<int>(entries.size()) > recipient->GetMaxSize() ||
+      GetRebuildSize(entries, 0, entries.size()) > DATA_SIZE) {
+    return false;
+  }
+  recipient->Rebuild(entries, 0, entries.size());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);//清空当前page
+  return true;
 }
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
-/*
- * Remove the first key & value pair from this page to "recipient" page.
- *
- */
-void LeafPage::MoveFirstToEndOf(LeafPage *recipient) {
-  recipient->CopyLastFrom(KeyAt(0),ValueAt(0));//把first元素移动到recipient
-  PairCopy(PairPtrAt(0),PairPtrAt(1),GetSize()-1);//当前page的元素前移
-  IncreaseSize(-1);
-}
-
-/*
- * Copy the item into the end of my item list. (Append item to my array)
- */
-void LeafPage::CopyLastFrom(GenericKey *key, const RowId value) {
-  int pos=GetSize();//因为是直接插到末尾，不需要移动
-  SetKeyAt(pos,key);
-  SetValueAt(pos,value);
-  IncreaseSize(1);
-}
-
-/*
- * Remove the last key & value pair from this page to "recipient" page.
- */
-void LeafPage::MoveLastToFrontOf(LeafPage *recipient) {
-  //把last元素移动到recipient
-  recipient->CopyFirstFrom(KeyAt(GetSize()-1),ValueAt(GetSize()-1));
-  IncreaseSize(-1);
+bool LeafPage::Redistribute(LeafPage *right) {
+  std::vector<Entry> entries;
+  AppendEntries(entries);
+  right->AppendEntries(entries);
+  int n = static_cast<int>(entries.size());
+  if (n < 2) {
+    return false;
+  }
+  int split = GetBalancedSplit(entries, GetMaxSize());
+  if (split == GetSize() || split > GetMaxSize() || n - split > GetMaxSize() ||
+      GetRebuildSize(entries, 0, split) > DATA_SIZE || GetRebuildSize(entries, split, n) > DATA_SIZE) {
+    return false;
+  }
+  Rebuild(entries, 0, split);
+  right->Rebuild(entries, split, n);
+  return true;
 }
-
-/*
- * Insert item at the front of my items. Move items accordingly.
- *
- */
-void LeafPage::CopyFirstFrom(GenericKey *key, const RowId value) {
-  PairCopy(PairPtrAt(1),PairPtrAt(0),GetSize());//需要所有元素后移1
-  SetKeyAt(0,key);
-  SetValueAt(0,value);
-  IncreaseSize(1);
-}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "page/hash_table_bucket_page.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+void HashTableBucketPage::Init(page_id_t page_id, int key_size) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  key_size_ = key_size;
+  size_ = 0;
+  max_size_ = (PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE) / (key_size + sizeof(RowId));
+}
+
+GenericKey *HashTableBucketPage::KeyAt(int index) { return reinterpret_cast<GenericKey *>(PairPtrAt(index)); }
+
+RowId HashTableBucketPage::ValueAt(int index) const {
+  return *reinterpret_cast<const RowId *>(PairPtrAt(index) + key_size_);
+}
+
+int HashTableBucketPage::KeyIndex(const GenericKey *key, int start) const {
+  // key 序列化前已清零, 相等的 key 字节完全相同
+  for (int i = start; i < size_; i++) {
+    if (memcmp(PairPtrAt(i), key, key_size_) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int HashTableBucketPage::PairIndex(const GenericKey *key, const RowId &value) const {
+  for (int i = KeyIndex(key); i != -1; i = KeyIndex(key, i + 1)) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void HashTableBucketPage::Insert(const GenericKey *key, const RowId &value) {
+  ASSERT(!IsFull(), "Insert into a full bucket.");
+  char *pair = PairPtrAt(size_);
+  memcpy(pair, key, key_size_);
+  memcpy(pair + key_size_, &value, sizeof(RowId));
+  size_++;
+}
+
+void HashTableBucketPage::RemoveAt(int index) {
+  ASSERT(index >= 0 && index < size_, "Bucket slot out of range.");
+  if (index != size_ - 1) {
+    memcpy(PairPtrAt(index), PairPtrAt(size_ - 1), key_size_ + sizeof(RowId));
+  }
+  size_--;
+}
@@ -0,0 +1,65 @@
+#include "page/hash_table_directory_page.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+  page_id_ = page_id;
+  global_depth_ = 0;
+  memset(local_depths_, 0, sizeof(local_depths_));
+  bucket_page_ids_[0] = bucket_page_id;
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  return bucket_page_ids_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  return local_depths_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  ASSERT(local_depth <= global_depth_, "Local depth exceeds global depth.");
+  local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  uint32_t local_depth = GetLocalDepth(bucket_idx);
+  ASSERT(local_depth > 0, "A bucket of depth 0 has no split image.");
+  return bucket_idx ^ (1U << (local_depth - 1));
+}
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  ASSERT(CanGrow(), "Directory is already at its maximum size.");
+  uint32_t size = Size();
+  // 新增的一半与原来的一半一一对应, 指向同一个 bucket
+  memcpy(local_depths_ + size, local_depths_, size * sizeof(uint8_t));
+  memcpy(bucket_page_ids_ + size, bucket_page_ids_, size * sizeof(page_id_t));
+  global_depth_++;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] == global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  ASSERT(CanShrink(), "Directory cannot shrink.");
+  global_depth_--;
+}
@@ -1,5 +1,7 @@
 #include "page/table_page.h"
 
+#include "planner/expressions/compiled_predicate.h"
+
 // TODO: Update interface implementation if apply recovery
 
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Txn *txn) {
@@ -85,6 +87,11 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Tx
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  // Same size: overwrite in place, no other tuple has to move.
+  if (serialized_size == tuple_size) {
+    new_row.SerializeTo(GetData() + tuple_offset, schema);
+    return true;
+  }
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
   memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
@@ -97,7 +104,7 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Tx
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - serialized_size);
     }
   }
   return true;
@@ -164,6 +171,23 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_m
   return true;
 }
 
+void TablePage::ScanTuples(const CompiledPredicate *predicate, Schema *schema, std::vector<Row> &rows) {
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size)) {
+      continue;
+    }
+    char *tuple = GetData() + GetTupleOffsetAtSlot(i);
+    if (predicate != nullptr && !predicate->EvaluateTuple(tuple, schema)) {
+      continue;
+    }
+    rows.emplace_back(RowId(GetTablePageId(), i));
+    uint32_t __attribute__((unused)) read_bytes = rows.back().DeserializeFrom(tuple, schema);
+    ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  }
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
+/* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -36,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -43,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.3"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -55,192 +57,264 @@
 /* Pure parsers.  */
 #define YYPURE 0
 
-/* Using locations.  */
-#define YYLSP_NEEDED 0
-
-
-
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     CREATE = 258,
-     DROP = 259,
-     SELECT = 260,
-     INSERT = 261,
-     DELETE = 262,
-     UPDATE = 263,
-     TRXBEGIN = 264,
-     TRXCOMMIT = 265,
-     TRXROLLBACK = 266,
-     QUIT = 267,
-     EXECFILE = 268,
-     SHOW = 269,
-     USE = 270,
-     USING = 271,
-     DATABASE = 272,
-     DATABASES = 273,
-     TABLE = 274,
-     TABLES = 275,
-     INDEX = 276,
-     INDEXES = 277,
-     ON = 278,
-     FROM = 279,
-     WHERE = 280,
-     INTO = 281,
-     SET = 282,
-     VALUES = 283,
-     PRIMARY = 284,
-     KEY = 285,
-     UNIQUE = 286,
-     CHAR = 287,
-     INT = 288,
-     FLOAT = 289,
-     AND = 290,
-     OR = 291,
-     NOT = 292,
-     IS = 293,
-     FLAGNULL = 294,
-     IDENTIFIER = 295,
-     STRING = 296,
-     NUMBER = 297,
-     EQ = 298,
-     NE = 299,
-     LE = 300,
-     GE = 301
-   };
-#endif
-/* Tokens.  */
-#define CREATE 258
-#define DROP 259
-#define SELECT 260
-#define INSERT 261
-#define DELETE 262
-#define UPDATE 263
-#define TRXBEGIN 264
-#define TRXCOMMIT 265
-#define TRXROLLBACK 266
-#define QUIT 267
-#define EXECFILE 268
-#define SHOW 269
-#define USE 270
-#define USING 271
-#define DATABASE 272
-#define DATABASES 273
-#define TABLE 274
-#define TABLES 275
-#define INDEX 276
-#define INDEXES 277
-#define ON 278
-#define FROM 279
-#define WHERE 280
-#define INTO 281
-#define SET 282
-#define VALUES 283
-#define PRIMARY 284
-#define KEY 285
-#define UNIQUE 286
-#define CHAR 287
-#define INT 288
-#define FLOAT 289
-#define AND 290
-#define OR 291
-#define NOT 292
-#define IS 293
-#define FLAGNULL 294
-#define IDENTIFIER 295
-#define STRING 296
-#define NUMBER 297
-#define EQ 298
-#define NE 299
-#define LE 300
-#define GE 301
-
-
-
-
-/* Copy the first part of user declarations.  */
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
 #line 1 "minisql.y"
 
   #include <stdio.h>
+  #include <string.h>
   #include "parser/parser.h"
 
   extern char *yytext;
   extern int yylex(void);
   int yyerror(char* error);
 
+  /* keywords added after minisql.l, see MinisqlLex */
+  static int MinisqlLex(void);
+  #define yylex MinisqlLex
 
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
+#line 85 "./minisql_yacc.c"
 
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 10 "minisql.y"
+#include "parser/minisql_yacc.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-	pSyntaxNode syntax_node;
-}
-/* Line 193 of yacc.c.  */
-#line 201 "./minisql_yacc.c"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-# define YYSTYPE_IS_TRIVIAL 1
-#endif
-
-
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CREATE = 3,                     /* CREATE  */
+  YYSYMBOL_DROP = 4,                       /* DROP  */
+  YYSYMBOL_SELECT = 5,                     /* SELECT  */
+  YYSYMBOL_INSERT = 6,                     /* INSERT  */
+  YYSYMBOL_DELETE = 7,                     /* DELETE  */
+  YYSYMBOL_UPDATE = 8,                     /* UPDATE  */
+  YYSYMBOL_TRXBEGIN = 9,                   /* TRXBEGIN  */
+  YYSYMBOL_TRXCOMMIT = 10,                 /* TRXCOMMIT  */
+  YYSYMBOL_TRXROLLBACK = 11,               /* TRXROLLBACK  */
+  YYSYMBOL_QUIT = 12,                      /* QUIT  */
+  YYSYMBOL_EXECFILE = 13,                  /* EXECFILE  */
+  YYSYMBOL_SHOW = 14,                      /* SHOW  */
+  YYSYMBOL_USE = 15,                       /* USE  */
+  YYSYMBOL_USING = 16,                     /* USING  */
+  YYSYMBOL_DATABASE = 17,                  /* DATABASE  */
+  YYSYMBOL_DATABASES = 18,                 /* DATABASES  */
+  YYSYMBOL_TABLE = 19,                     /* TABLE  */
+  YYSYMBOL_TABLES = 20,                    /* TABLES  */
+  YYSYMBOL_INDEX = 21,                     /* INDEX  */
+  YYSYMBOL_INDEXES = 22,                   /* INDEXES  */
+  YYSYMBOL_ON = 23,                        /* ON  */
+  YYSYMBOL_FROM = 24,                      /* FROM  */
+  YYSYMBOL_WHERE = 25,                     /* WHERE  */
+  YYSYMBOL_INTO = 26,                      /* INTO  */
+  YYSYMBOL_SET = 27,                       /* SET  */
+  YYSYMBOL_VALUES = 28,                    /* VALUES  */
+  YYSYMBOL_PRIMARY = 29,                   /* PRIMARY  */
+  YYSYMBOL_KEY = 30,                       /* KEY  */
+  YYSYMBOL_UNIQUE = 31,                    /* UNIQUE  */
+  YYSYMBOL_CHAR = 32,                      /* CHAR  */
+  YYSYMBOL_INT = 33,                       /* INT  */
+  YYSYMBOL_FLOAT = 34,                     /* FLOAT  */
+  YYSYMBOL_AND = 35,                       /* AND  */
+  YYSYMBOL_OR = 36,                        /* OR  */
+  YYSYMBOL_NOT = 37,                       /* NOT  */
+  YYSYMBOL_IS = 38,                        /* IS  */
+  YYSYMBOL_FLAGNULL = 39,                  /* FLAGNULL  */
+  YYSYMBOL_IDENTIFIER = 40,                /* IDENTIFIER  */
+  YYSYMBOL_STRING = 41,                    /* STRING  */
+  YYSYMBOL_NUMBER = 42,                    /* NUMBER  */
+  YYSYMBOL_EQ = 43,                        /* EQ  */
+  YYSYMBOL_NE = 44,                        /* NE  */
+  YYSYMBOL_LE = 45,                        /* LE  */
+  YYSYMBOL_GE = 46,                        /* GE  */
+  YYSYMBOL_ANALYZE = 47,                   /* ANALYZE  */
+  YYSYMBOL_GROUP = 48,                     /* GROUP  */
+  YYSYMBOL_BY = 49,                        /* BY  */
+  YYSYMBOL_COUNT = 50,                     /* COUNT  */
+  YYSYMBOL_SUM = 51,                       /* SUM  */
+  YYSYMBOL_MIN = 52,                       /* MIN  */
+  YYSYMBOL_MAX = 53,                       /* MAX  */
+  YYSYMBOL_AVG = 54,                       /* AVG  */
+  YYSYMBOL_ORDER = 55,                     /* ORDER  */
+  YYSYMBOL_ASC = 56,                       /* ASC  */
+  YYSYMBOL_DESC = 57,                      /* DESC  */
+  YYSYMBOL_LIMIT = 58,                     /* LIMIT  */
+  YYSYMBOL_DISTINCT = 59,                  /* DISTINCT  */
+  YYSYMBOL_60_ = 60,                       /* ';'  */
+  YYSYMBOL_61_ = 61,                       /* '('  */
+  YYSYMBOL_62_ = 62,                       /* ')'  */
+  YYSYMBOL_63_ = 63,                       /* ','  */
+  YYSYMBOL_64_ = 64,                       /* '*'  */
+  YYSYMBOL_65_ = 65,                       /* '<'  */
+  YYSYMBOL_66_ = 66,                       /* '>'  */
+  YYSYMBOL_YYACCEPT = 67,                  /* $accept  */
+  YYSYMBOL_start = 68,                     /* start  */
+  YYSYMBOL_sql = 69,                       /* sql  */
+  YYSYMBOL_sql_create_database = 70,       /* sql_create_database  */
+  YYSYMBOL_sql_drop_database = 71,         /* sql_drop_database  */
+  YYSYMBOL_sql_show_databases = 72,        /* sql_show_databases  */
+  YYSYMBOL_sql_use_database = 73,          /* sql_use_database  */
+  YYSYMBOL_sql_show_tables = 74,           /* sql_show_tables  */
+  YYSYMBOL_sql_create_table = 75,          /* sql_create_table  */
+  YYSYMBOL_column_list = 76,               /* column_list  */
+  YYSYMBOL_column_definition_list = 77,    /* column_definition_list  */
+  YYSYMBOL_column_definition = 78,         /* column_definition  */
+  YYSYMBOL_column_type = 79,               /* column_type  */
+  YYSYMBOL_sql_drop_table = 80,            /* sql_drop_table  */
+  YYSYMBOL_sql_create_index = 81,          /* sql_create_index  */
+  YYSYMBOL_sql_drop_index = 82,            /* sql_drop_index  */
+  YYSYMBOL_sql_show_indexes = 83,          /* sql_show_indexes  */
+  YYSYMBOL_sql_select = 84,                /* sql_select  */
+  YYSYMBOL_distinct_option = 85,           /* distinct_option  */
+  YYSYMBOL_where_clause = 86,              /* where_clause  */
+  YYSYMBOL_group_by_clause = 87,           /* group_by_clause  */
+  YYSYMBOL_order_by_clause = 88,           /* order_by_clause  */
+  YYSYMBOL_limit_clause = 89,              /* limit_clause  */
+  YYSYMBOL_order_list = 90,                /* order_list  */
+  YYSYMBOL_order_item = 91,                /* order_item  */
+  YYSYMBOL_order_direction = 92,           /* order_direction  */
+  YYSYMBOL_table_list = 93,                /* table_list  */
+  YYSYMBOL_select_columns = 94,            /* select_columns  */
+  YYSYMBOL_select_list = 95,               /* select_list  */
+  YYSYMBOL_select_item = 96,               /* select_item  */
+  YYSYMBOL_aggregate = 97,                 /* aggregate  */
+  YYSYMBOL_where_conditions = 98,          /* where_conditions  */
+  YYSYMBOL_connector = 99,                 /* connector  */
+  YYSYMBOL_where_condition = 100,          /* where_condition  */
+  YYSYMBOL_column_value = 101,             /* column_value  */
+  YYSYMBOL_operator = 102,                 /* operator  */
+  YYSYMBOL_sql_insert = 103,               /* sql_insert  */
+  YYSYMBOL_column_values = 104,            /* column_values  */
+  YYSYMBOL_sql_delete = 105,               /* sql_delete  */
+  YYSYMBOL_sql_update = 106,               /* sql_update  */
+  YYSYMBOL_update_values = 107,            /* update_values  */
+  YYSYMBOL_update_value = 108,             /* update_value  */
+  YYSYMBOL_sql_trx_begin = 109,            /* sql_trx_begin  */
+  YYSYMBOL_sql_trx_commit = 110,           /* sql_trx_commit  */
+  YYSYMBOL_sql_trx_rollback = 111,         /* sql_trx_rollback  */
+  YYSYMBOL_sql_quit = 112,                 /* sql_quit  */
+  YYSYMBOL_sql_exec_file = 113,            /* sql_exec_file  */
+  YYSYMBOL_sql_analyze = 114               /* sql_analyze  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Copy the second part of user declarations.  */
 
 
-/* Line 216 of yacc.c.  */
-#line 214 "./minisql_yacc.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -248,55 +322,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int i)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (i)
-    int i;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return i;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -313,11 +438,11 @@ YYID (i)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
 #     endif
 #    endif
 #   endif
@@ -325,8 +450,8 @@ YYID (i)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -340,119 +465,125 @@ YYID (i)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss;
-  YYSTYPE yyvs;
-  };
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack)					\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack, Stack, yysize);				\
-	Stack = &yyptr->Stack;						\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  53
+#define YYFINAL  54
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   106
+#define YYLAST   152
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  54
+#define YYNTOKENS  67
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  35
+#define YYNNTS  48
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  77
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  134
+#define YYNRULES  107
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  177
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   314
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   301
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      48,    49,    51,     2,    50,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    47,
-      52,     2,    53,     2,     2,     2,     2,     2,     2,     2,
+      61,    62,    64,     2,    63,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    60,
+      65,     2,    66,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -476,336 +607,283 @@ static const yytype_uint8 yytranslate[] =
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
       35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
-      45,    46
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     6,     8,    10,    12,    14,    16,    18,
-      20,    22,    24,    26,    28,    30,    32,    34,    36,    38,
-      40,    42,    44,    48,    52,    55,    58,    61,    68,    72,
-      74,    78,    80,    86,    90,    93,    95,    97,   102,   106,
-     115,   126,   130,   133,   138,   145,   147,   149,   153,   155,
-     157,   159,   163,   165,   167,   169,   171,   173,   175,   177,
-     179,   181,   183,   185,   193,   197,   199,   203,   209,   214,
-     221,   225,   227,   231,   233,   235,   237,   239
+       0,    47,    47,    54,    55,    56,    57,    58,    59,    60,
+      61,    62,    63,    64,    65,    66,    67,    68,    69,    70,
+      71,    72,    73,    77,    84,    91,    97,   104,   110,   120,
+     124,   130,   134,   137,   144,   149,   157,   160,   163,   170,
+     177,   185,   199,   206,   212,   235,   238,   244,   247,   254,
+     257,   264,   267,   274,   277,   284,   288,   294,   301,   304,
+     307,   313,   317,   323,   326,   333,   337,   343,   346,   350,
+     357,   360,   363,   366,   369,   375,   380,   386,   389,   395,
+     400,   408,   411,   414,   420,   423,   426,   429,   432,   435,
+     438,   441,   447,   457,   461,   467,   471,   481,   488,   503,
+     507,   513,   521,   527,   533,   539,   545,   552
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      55,     0,    -1,    56,    47,    -1,    57,    -1,    58,    -1,
-      59,    -1,    60,    -1,    61,    -1,    62,    -1,    67,    -1,
-      68,    -1,    69,    -1,    70,    -1,    71,    -1,    78,    -1,
-      80,    -1,    81,    -1,    84,    -1,    85,    -1,    86,    -1,
-      87,    -1,    88,    -1,     3,    17,    40,    -1,     4,    17,
-      40,    -1,    14,    18,    -1,    15,    40,    -1,    14,    20,
-      -1,     3,    19,    40,    48,    64,    49,    -1,    40,    50,
-      63,    -1,    40,    -1,    65,    50,    64,    -1,    65,    -1,
-      29,    30,    48,    63,    49,    -1,    40,    66,    31,    -1,
-      40,    66,    -1,    33,    -1,    34,    -1,    32,    48,    42,
-      49,    -1,     4,    19,    40,    -1,     3,    21,    40,    23,
-      40,    48,    63,    49,    -1,     3,    21,    40,    23,    40,
-      48,    63,    49,    16,    40,    -1,     4,    21,    40,    -1,
-      14,    22,    -1,     5,    72,    24,    40,    -1,     5,    72,
-      24,    40,    25,    73,    -1,    51,    -1,    63,    -1,    73,
-      74,    75,    -1,    75,    -1,    35,    -1,    36,    -1,    40,
-      77,    76,    -1,    41,    -1,    42,    -1,    39,    -1,    43,
-      -1,    44,    -1,    45,    -1,    46,    -1,    52,    -1,    53,
-      -1,    38,    -1,    37,    -1,     6,    26,    40,    28,    48,
-      79,    49,    -1,    76,    50,    79,    -1,    76,    -1,     7,
-      24,    40,    -1,     7,    24,    40,    25,    73,    -1,     8,
-      40,    27,    82,    -1,     8,    40,    27,    82,    25,    73,
-      -1,    83,    50,    82,    -1,    83,    -1,    40,    43,    76,
-      -1,     9,    -1,    10,    -1,    11,    -1,    12,    -1,    13,
-      41,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,    35,    35,    42,    43,    44,    45,    46,    47,    48,
-      49,    50,    51,    52,    53,    54,    55,    56,    57,    58,
-      59,    60,    64,    71,    78,    84,    91,    97,   107,   111,
-     117,   121,   124,   131,   136,   144,   147,   150,   157,   164,
-     172,   186,   193,   199,   204,   215,   218,   225,   230,   236,
-     239,   245,   253,   256,   259,   265,   268,   271,   274,   277,
-     280,   283,   286,   292,   302,   306,   312,   316,   326,   333,
-     348,   352,   358,   366,   372,   378,   384,   390
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "CREATE", "DROP", "SELECT", "INSERT",
-  "DELETE", "UPDATE", "TRXBEGIN", "TRXCOMMIT", "TRXROLLBACK", "QUIT",
-  "EXECFILE", "SHOW", "USE", "USING", "DATABASE", "DATABASES", "TABLE",
-  "TABLES", "INDEX", "INDEXES", "ON", "FROM", "WHERE", "INTO", "SET",
-  "VALUES", "PRIMARY", "KEY", "UNIQUE", "CHAR", "INT", "FLOAT", "AND",
-  "OR", "NOT", "IS", "FLAGNULL", "IDENTIFIER", "STRING", "NUMBER", "EQ",
-  "NE", "LE", "GE", "';'", "'('", "')'", "','", "'*'", "'<'", "'>'",
-  "$accept", "start", "sql", "sql_create_database", "sql_drop_database",
+  "\"end of file\"", "error", "\"invalid token\"", "CREATE", "DROP",
+  "SELECT", "INSERT", "DELETE", "UPDATE", "TRXBEGIN", "TRXCOMMIT",
+  "TRXROLLBACK", "QUIT", "EXECFILE", "SHOW", "USE", "USING", "DATABASE",
+  "DATABASES", "TABLE", "TABLES", "INDEX", "INDEXES", "ON", "FROM",
+  "WHERE", "INTO", "SET", "VALUES", "PRIMARY", "KEY", "UNIQUE", "CHAR",
+  "INT", "FLOAT", "AND", "OR", "NOT", "IS", "FLAGNULL", "IDENTIFIER",
+  "STRING", "NUMBER", "EQ", "NE", "LE", "GE", "ANALYZE", "GROUP", "BY",
+  "COUNT", "SUM", "MIN", "MAX", "AVG", "ORDER", "ASC", "DESC", "LIMIT",
+  "DISTINCT", "';'", "'('", "')'", "','", "'*'", "'<'", "'>'", "$accept",
+  "start", "sql", "sql_create_database", "sql_drop_database",
   "sql_show_databases", "sql_use_database", "sql_show_tables",
   "sql_create_table", "column_list", "column_definition_list",
   "column_definition", "column_type", "sql_drop_table", "sql_create_index",
-  "sql_drop_index", "sql_show_indexes", "sql_select", "select_columns",
+  "sql_drop_index", "sql_show_indexes", "sql_select", "distinct_option",
+  "where_clause", "group_by_clause", "order_by_clause", "limit_clause",
+  "order_list", "order_item", "order_direction", "table_list",
+  "select_columns", "select_list", "select_item", "aggregate",
   "where_conditions", "connector", "where_condition", "column_value",
   "operator", "sql_insert", "column_values", "sql_delete", "sql_update",
   "update_values", "update_value", "sql_trx_begin", "sql_trx_commit",
-  "sql_trx_rollback", "sql_quit", "sql_exec_file", 0
+  "sql_trx_rollback", "sql_quit", "sql_exec_file", "sql_analyze", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,    59,    40,    41,
-      44,    42,    60,    62
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-120)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
 {
-       0,    54,    55,    56,    56,    56,    56,    56,    56,    56,
-      56,    56,    56,    56,    56,    56,    56,    56,    56,    56,
-      56,    56,    57,    58,    59,    60,    61,    62,    63,    63,
-      64,    64,    64,    65,    65,    66,    66,    66,    67,    68,
-      68,    69,    70,    71,    71,    72,    72,    73,    73,    74,
-      74,    75,    76,    76,    76,    77,    77,    77,    77,    77,
-      77,    77,    77,    78,    79,    79,    80,    80,    81,    81,
-      82,    82,    83,    84,    85,    86,    87,    88
+      -3,    36,    39,   -41,     7,    13,     0,  -120,  -120,  -120,
+    -120,    21,    41,    35,    43,    69,    16,  -120,  -120,  -120,
+    -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,
+    -120,  -120,  -120,  -120,  -120,  -120,  -120,    44,    45,    46,
+      47,    48,    49,  -120,   -25,    50,    51,    52,  -120,  -120,
+    -120,  -120,  -120,  -120,  -120,  -120,  -120,    19,    58,  -120,
+    -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,    68,
+    -120,    30,    33,    54,    70,    56,    -5,    57,    59,    -2,
+     -17,    37,    60,    61,    76,    53,    72,    40,    55,    62,
+      63,    64,    78,  -120,    66,    67,    29,   -24,    42,  -120,
+      29,    60,    56,    65,    71,  -120,  -120,    74,  -120,    -5,
+      73,    59,    60,    75,  -120,  -120,  -120,  -120,  -120,    77,
+      79,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,    25,
+    -120,  -120,    60,  -120,    42,  -120,    73,    80,  -120,  -120,
+      81,    83,  -120,    42,    82,    84,    29,  -120,  -120,  -120,
+    -120,    85,    86,    73,    90,    73,    87,    88,  -120,  -120,
+    -120,  -120,    93,  -120,    -2,    92,  -120,  -120,  -120,    89,
+     -26,  -120,    -2,  -120,  -120,  -120,  -120
 };
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     3,     3,     2,     2,     2,     6,     3,     1,
-       3,     1,     5,     3,     2,     1,     1,     4,     3,     8,
-      10,     3,     2,     4,     6,     1,     1,     3,     1,     1,
-       1,     3,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     7,     3,     1,     3,     5,     4,     6,
-       3,     1,     3,     1,     1,     1,     1,     2
+       0,     0,     0,    45,     0,     0,     0,   102,   103,   104,
+     105,     0,     0,     0,     0,     0,     0,     3,     4,     5,
+       6,     7,     8,     9,    10,    11,    12,    13,    14,    15,
+      16,    17,    18,    19,    20,    21,    22,     0,     0,     0,
+       0,     0,     0,    46,     0,     0,     0,     0,   106,    25,
+      27,    43,    26,   107,     1,     2,    23,     0,     0,    24,
+      39,    42,    67,    70,    71,    72,    73,    74,    63,     0,
+      64,    66,     0,     0,    95,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    97,   100,     0,     0,     0,    32,
+       0,    62,    47,    65,     0,     0,     0,     0,    96,    76,
+       0,     0,     0,     0,     0,    36,    37,    35,    28,     0,
+       0,     0,     0,    49,    68,    69,    83,    81,    82,    94,
+       0,    91,    90,    84,    85,    86,    87,    88,    89,     0,
+      77,    78,     0,   101,    98,    99,     0,     0,    34,    31,
+      30,     0,    61,    48,     0,    51,     0,    92,    80,    79,
+      75,     0,     0,     0,    40,     0,     0,    53,    93,    33,
+      38,    29,     0,    50,     0,     0,    44,    41,    52,    56,
+      58,    54,     0,    59,    60,    57,    55
 };
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
 {
-       0,     0,     0,     0,     0,     0,     0,    73,    74,    75,
-      76,     0,     0,     0,     0,     0,     3,     4,     5,     6,
-       7,     8,     9,    10,    11,    12,    13,    14,    15,    16,
-      17,    18,    19,    20,    21,     0,     0,     0,     0,     0,
-       0,    29,    45,    46,     0,     0,     0,     0,    77,    24,
-      26,    42,    25,     1,     2,    22,     0,     0,    23,    38,
-      41,     0,     0,     0,    66,     0,     0,     0,    28,    43,
-       0,     0,     0,    68,    71,     0,     0,     0,    31,     0,
-       0,     0,     0,    67,    48,     0,     0,     0,     0,     0,
-      35,    36,    34,    27,     0,     0,    44,    54,    52,    53,
-      65,     0,    62,    61,    55,    56,    57,    58,    59,    60,
-       0,    49,    50,     0,    72,    69,    70,     0,     0,    33,
-      30,     0,     0,    63,    51,    47,     0,     0,    39,    64,
-      32,    37,     0,    40
+    -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -119,
+      -1,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,  -120,
+    -120,  -120,  -120,   -65,  -120,  -120,     1,  -120,    31,  -118,
+    -120,   -69,  -120,   -23,   -84,  -120,  -120,   -35,  -120,  -120,
+      12,  -120,  -120,  -120,  -120,  -120,  -120,  -120
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,    14,    15,    16,    17,    18,    19,    20,    21,    43,
-      77,    78,    92,    22,    23,    24,    25,    26,    44,    83,
-     113,    84,   100,   110,    27,   101,    28,    29,    73,    74,
-      30,    31,    32,    33,    34
+       0,    15,    16,    17,    18,    19,    20,    21,    22,   141,
+      88,    89,   107,    23,    24,    25,    26,    27,    44,   113,
+     145,   157,   166,   168,   169,   175,    92,    69,    70,    71,
+      72,    98,   132,    99,   119,   129,    28,   120,    29,    30,
+      84,    85,    31,    32,    33,    34,    35,    36
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -85
-static const yytype_int8 yypact[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_uint8 yytable[] =
 {
-      32,     2,     3,   -36,   -19,     8,    -7,   -85,   -85,   -85,
-     -85,    10,     7,    12,    53,    11,   -85,   -85,   -85,   -85,
-     -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,
-     -85,   -85,   -85,   -85,   -85,    14,    15,    17,    19,    20,
-      21,    13,   -85,   -85,    38,    24,    25,    39,   -85,   -85,
-     -85,   -85,   -85,   -85,   -85,   -85,    22,    44,   -85,   -85,
-     -85,    28,    29,    43,    47,    33,   -24,    34,   -85,    50,
-      30,    36,    37,    52,    31,    49,    16,    35,    40,    41,
-      36,   -11,   -35,   -22,   -85,   -11,    36,    33,    45,    46,
-     -85,   -85,    51,   -85,   -24,    28,   -22,   -85,   -85,   -85,
-      42,    48,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,
-     -11,   -85,   -85,    36,   -85,   -22,   -85,    28,    54,   -85,
-     -85,    55,   -11,   -85,   -85,   -85,    56,    57,    67,   -85,
-     -85,   -85,    58,   -85
+       1,     2,     3,     4,     5,     6,     7,     8,     9,    10,
+      11,    12,    13,   121,   122,    62,   133,   151,    43,   123,
+     124,   125,   126,    94,    86,    63,    64,    65,    66,    67,
+     173,   174,   134,    45,   161,    87,   163,    46,    62,    68,
+      47,   127,   128,   143,    14,   149,   170,    95,    63,    64,
+      65,    66,    67,    37,   170,    38,    40,    39,    41,    49,
+      42,    50,    48,    51,   116,   148,   117,   118,   116,    54,
+     117,   118,   104,   105,   106,    52,    55,   130,   131,    75,
+      76,    77,    81,    53,    56,    57,    58,    59,    60,    61,
+      73,    74,    78,    79,    80,    82,    83,    90,    96,    91,
+      97,   101,   103,   112,   100,   138,   162,   176,   139,   150,
+      93,   158,   142,   140,   135,     0,   102,   108,     0,     0,
+       0,     0,   152,   144,   110,   109,   136,   111,   114,   115,
+       0,   155,   137,   167,   171,     0,   164,     0,     0,   156,
+     146,   147,     0,     0,   153,   154,   165,   159,   160,     0,
+       0,     0,   172
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+static const yytype_int16 yycheck[] =
 {
-     -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -61,
-      -9,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -85,   -74,
-     -85,   -27,   -84,   -85,   -85,   -34,   -85,   -85,     0,   -85,
-     -85,   -85,   -85,   -85,   -85
+       3,     4,     5,     6,     7,     8,     9,    10,    11,    12,
+      13,    14,    15,    37,    38,    40,   100,   136,    59,    43,
+      44,    45,    46,    40,    29,    50,    51,    52,    53,    54,
+      56,    57,   101,    26,   153,    40,   155,    24,    40,    64,
+      40,    65,    66,   112,    47,   129,   164,    64,    50,    51,
+      52,    53,    54,    17,   172,    19,    17,    21,    19,    18,
+      21,    20,    41,    22,    39,    40,    41,    42,    39,     0,
+      41,    42,    32,    33,    34,    40,    60,    35,    36,    27,
+      61,    23,    28,    40,    40,    40,    40,    40,    40,    40,
+      40,    40,    24,    63,    61,    25,    40,    40,    61,    40,
+      40,    25,    30,    25,    43,    31,    16,   172,   109,   132,
+      79,   146,   111,    40,   102,    -1,    63,    62,    -1,    -1,
+      -1,    -1,    42,    48,    61,    63,    61,    63,    62,    62,
+      -1,    49,    61,    40,    42,    -1,    49,    -1,    -1,    55,
+      63,    62,    -1,    -1,    63,    62,    58,    62,    62,    -1,
+      -1,    -1,    63
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
-static const yytype_uint8 yytable[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-      68,   114,   102,   103,    41,    75,    96,    45,   104,   105,
-     106,   107,   115,   111,   112,    42,    76,   108,   109,    35,
-      38,    36,    39,    37,    40,    49,   124,    50,    97,    51,
-      98,    99,    46,    47,   121,     1,     2,     3,     4,     5,
-       6,     7,     8,     9,    10,    11,    12,    13,    89,    90,
-      91,    48,    52,    53,    55,    56,   126,    57,    54,    58,
-      59,    60,    62,    61,    63,    64,    65,    67,    41,    69,
-      66,    70,    71,    72,    79,    80,    82,    86,    81,    88,
-      85,    87,   119,   132,    93,   120,   125,   116,   129,    95,
-      94,     0,   122,   117,   118,     0,   127,   123,   133,     0,
-       0,     0,     0,     0,   128,   130,   131
+       0,     3,     4,     5,     6,     7,     8,     9,    10,    11,
+      12,    13,    14,    15,    47,    68,    69,    70,    71,    72,
+      73,    74,    75,    80,    81,    82,    83,    84,   103,   105,
+     106,   109,   110,   111,   112,   113,   114,    17,    19,    21,
+      17,    19,    21,    59,    85,    26,    24,    40,    41,    18,
+      20,    22,    40,    40,     0,    60,    40,    40,    40,    40,
+      40,    40,    40,    50,    51,    52,    53,    54,    64,    94,
+      95,    96,    97,    40,    40,    27,    61,    23,    24,    63,
+      61,    28,    25,    40,   107,   108,    29,    40,    77,    78,
+      40,    40,    93,    95,    40,    64,    61,    40,    98,   100,
+      43,    25,    63,    30,    32,    33,    34,    79,    62,    63,
+      61,    63,    25,    86,    62,    62,    39,    41,    42,   101,
+     104,    37,    38,    43,    44,    45,    46,    65,    66,   102,
+      35,    36,    99,   101,    98,   107,    61,    61,    31,    77,
+      40,    76,    93,    98,    48,    87,    63,    62,    40,   101,
+     100,    76,    42,    63,    62,    49,    55,    88,   104,    62,
+      62,    76,    16,    76,    49,    58,    89,    40,    90,    91,
+      96,    42,    63,    56,    57,    92,    90
 };
 
-static const yytype_int8 yycheck[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-      61,    85,    37,    38,    40,    29,    80,    26,    43,    44,
-      45,    46,    86,    35,    36,    51,    40,    52,    53,    17,
-      17,    19,    19,    21,    21,    18,   110,    20,    39,    22,
-      41,    42,    24,    40,    95,     3,     4,     5,     6,     7,
-       8,     9,    10,    11,    12,    13,    14,    15,    32,    33,
-      34,    41,    40,     0,    40,    40,   117,    40,    47,    40,
-      40,    40,    24,    50,    40,    40,    27,    23,    40,    40,
-      48,    28,    25,    40,    40,    25,    40,    25,    48,    30,
-      43,    50,    31,    16,    49,    94,   113,    87,   122,    48,
-      50,    -1,    50,    48,    48,    -1,    42,    49,    40,    -1,
-      -1,    -1,    -1,    -1,    49,    49,    49
+       0,    67,    68,    69,    69,    69,    69,    69,    69,    69,
+      69,    69,    69,    69,    69,    69,    69,    69,    69,    69,
+      69,    69,    69,    70,    71,    72,    73,    74,    75,    76,
+      76,    77,    77,    77,    78,    78,    79,    79,    79,    80,
+      81,    81,    82,    83,    84,    85,    85,    86,    86,    87,
+      87,    88,    88,    89,    89,    90,    90,    91,    92,    92,
+      92,    93,    93,    94,    94,    95,    95,    96,    96,    96,
+      97,    97,    97,    97,    97,    98,    98,    99,    99,   100,
+     100,   101,   101,   101,   102,   102,   102,   102,   102,   102,
+     102,   102,   103,   104,   104,   105,   105,   106,   106,   107,
+     107,   108,   109,   110,   111,   112,   113,   114
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     3,     4,     5,     6,     7,     8,     9,    10,    11,
-      12,    13,    14,    15,    55,    56,    57,    58,    59,    60,
-      61,    62,    67,    68,    69,    70,    71,    78,    80,    81,
-      84,    85,    86,    87,    88,    17,    19,    21,    17,    19,
-      21,    40,    51,    63,    72,    26,    24,    40,    41,    18,
-      20,    22,    40,     0,    47,    40,    40,    40,    40,    40,
-      40,    50,    24,    40,    40,    27,    48,    23,    63,    40,
-      28,    25,    40,    82,    83,    29,    40,    64,    65,    40,
-      25,    48,    40,    73,    75,    43,    25,    50,    30,    32,
-      33,    34,    66,    49,    50,    48,    73,    39,    41,    42,
-      76,    79,    37,    38,    43,    44,    45,    46,    52,    53,
-      77,    35,    36,    74,    76,    73,    82,    48,    48,    31,
-      64,    63,    50,    49,    76,    75,    63,    42,    49,    79,
-      49,    49,    16,    40
+       0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     3,     3,     2,     2,     2,     6,     3,
+       1,     3,     1,     5,     3,     2,     1,     1,     4,     3,
+       8,    10,     3,     2,     9,     0,     1,     0,     2,     0,
+       3,     0,     3,     0,     2,     3,     1,     2,     0,     1,
+       1,     3,     1,     1,     1,     3,     1,     1,     4,     4,
+       1,     1,     1,     1,     1,     3,     1,     1,     1,     3,
+       3,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     7,     3,     1,     3,     5,     4,     6,     3,
+       1,     3,     1,     1,     1,     1,     2,     2
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
 
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#define YYFAIL		goto yyerrlab
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
-
-
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
-
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -815,80 +893,58 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
-static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -896,80 +952,68 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_stack_print (yytype_int16 *bottom, yytype_int16 *top)
-#else
-static void
-yy_stack_print (bottom, top)
-    yytype_int16 *bottom;
-    yytype_int16 *top;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
-  for (; bottom <= top; ++bottom)
-    YYFPRINTF (stderr, " %d", *bottom);
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
-      fprintf (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
-      fprintf (stderr, "\n");
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -984,478 +1028,219 @@ int yydebug;
 # define YYMAXDEPTH 10000
 #endif
 
-
-
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
 
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
-
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
-
-
-/* Prevent warnings from -Wmissing-prototypes.  */
-
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
-
 
 
-/* The look-ahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
-/* The semantic value of the look-ahead symbol.  */
+/* The semantic value of the lookahead symbol.  */
 YYSTYPE yylval;
-
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
 
+
 /*----------.
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-  
-  int yystate;
-  int yyn;
-  int yyresult;
-  /* Number of tokens to shift before error messages enabled.  */
-  int yyerrstatus;
-  /* Look-ahead token as an internal (translated) token number.  */
-  int yytoken = 0;
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
-
-  /* Three stacks and their tools:
-     `yyss': related to states,
-     `yyvs': related to semantic values,
-     `yyls': related to locations.
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
 
-     Refer to the stacks thru separate pointers, to allow yyoverflow
-     to reallocate them elsewhere.  */
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
-  /* The state stack.  */
-  yytype_int16 yyssa[YYINITDEPTH];
-  yytype_int16 *yyss = yyssa;
-  yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-  /* The semantic value stack.  */
-  YYSTYPE yyvsa[YYINITDEPTH];
-  YYSTYPE *yyvs = yyvsa;
-  YYSTYPE *yyvsp;
-
-
-
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-  YYSIZE_T yystacksize = YYINITDEPTH;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
 
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
-  yychar = YYEMPTY;		/* Cause a token to be read.  */
-
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-
-  yyssp = yyss;
-  yyvsp = yyvs;
+  yychar = YYEMPTY; /* Cause a token to be read.  */
 
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss);
-	YYSTACK_RELOCATE (yyvs);
-
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
-     look-ahead token if we need one and don't already have one.  */
+     lookahead token if we need one and don't already have one.  */
 
-  /* First try to decide what to do without reference to look-ahead token.  */
+  /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
-  /* Not known => get a look-ahead token if don't already have one.  */
+  /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid look-ahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1470,30 +1255,26 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
   /* Count tokens shifted since error; after three, turn off error
      status.  */
   if (yyerrstatus)
     yyerrstatus--;
 
-  /* Shift the look-ahead token.  */
+  /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token unless it is eof.  */
-  if (yychar != YYEOF)
-    yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1508,14 +1289,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1528,666 +1309,978 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 35 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (2)].syntax_node);
+  case 2: /* start: sql ';'  */
+#line 47 "minisql.y"
+          {
+    (yyval.syntax_node) = (yyvsp[-1].syntax_node);
     MinisqlParserSetRoot((yyval.syntax_node));
   }
+#line 1319 "./minisql_yacc.c"
     break;
 
-  case 3:
-#line 42 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 3: /* sql: sql_create_database  */
+#line 54 "minisql.y"
+                      { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1325 "./minisql_yacc.c"
     break;
 
-  case 4:
-#line 43 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 4: /* sql: sql_drop_database  */
+#line 55 "minisql.y"
+                      { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1331 "./minisql_yacc.c"
     break;
 
-  case 5:
-#line 44 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 5: /* sql: sql_show_databases  */
+#line 56 "minisql.y"
+                       { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1337 "./minisql_yacc.c"
     break;
 
-  case 6:
-#line 45 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 6: /* sql: sql_use_database  */
+#line 57 "minisql.y"
+                     { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1343 "./minisql_yacc.c"
     break;
 
-  case 7:
-#line 46 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 7: /* sql: sql_show_tables  */
+#line 58 "minisql.y"
+                    { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1349 "./minisql_yacc.c"
     break;
 
-  case 8:
-#line 47 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 8: /* sql: sql_create_table  */
+#line 59 "minisql.y"
+                     { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1355 "./minisql_yacc.c"
     break;
 
-  case 9:
-#line 48 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 9: /* sql: sql_drop_table  */
+#line 60 "minisql.y"
+                   { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1361 "./minisql_yacc.c"
     break;
 
-  case 10:
-#line 49 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 10: /* sql: sql_create_index  */
+#line 61 "minisql.y"
+                     { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1367 "./minisql_yacc.c"
     break;
 
-  case 11:
-#line 50 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 11: /* sql: sql_drop_index  */
+#line 62 "minisql.y"
+                   { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1373 "./minisql_yacc.c"
     break;
 
-  case 12:
-#line 51 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 12: /* sql: sql_show_indexes  */
+#line 63 "minisql.y"
+                     { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1379 "./minisql_yacc.c"
     break;
 
-  case 13:
-#line 52 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 13: /* sql: sql_select  */
+#line 64 "minisql.y"
+               { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1385 "./minisql_yacc.c"
     break;
 
-  case 14:
-#line 53 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 14: /* sql: sql_insert  */
+#line 65 "minisql.y"
+               { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1391 "./minisql_yacc.c"
     break;
 
-  case 15:
-#line 54 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 15: /* sql: sql_delete  */
+#line 66 "minisql.y"
+               { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1397 "./minisql_yacc.c"
     break;
 
-  case 16:
-#line 55 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 16: /* sql: sql_update  */
+#line 67 "minisql.y"
+               { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1403 "./minisql_yacc.c"
     break;
 
-  case 17:
-#line 56 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 17: /* sql: sql_trx_begin  */
+#line 68 "minisql.y"
+                  { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1409 "./minisql_yacc.c"
     break;
 
-  case 18:
-#line 57 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 18: /* sql: sql_trx_commit  */
+#line 69 "minisql.y"
+                   { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1415 "./minisql_yacc.c"
     break;
 
-  case 19:
-#line 58 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 19: /* sql: sql_trx_rollback  */
+#line 70 "minisql.y"
+                     { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1421 "./minisql_yacc.c"
     break;
 
-  case 20:
-#line 59 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 20: /* sql: sql_quit  */
+#line 71 "minisql.y"
+             { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1427 "./minisql_yacc.c"
     break;
 
-  case 21:
-#line 60 "minisql.y"
-    { (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node); }
+  case 21: /* sql: sql_exec_file  */
+#line 72 "minisql.y"
+                  { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1433 "./minisql_yacc.c"
     break;
 
-  case 22:
-#line 64 "minisql.y"
-    {
+  case 22: /* sql: sql_analyze  */
+#line 73 "minisql.y"
+                { (yyval.syntax_node) = (yyvsp[0].syntax_node); }
+#line 1439 "./minisql_yacc.c"
+    break;
+
+  case 23: /* sql_create_database: CREATE DATABASE IDENTIFIER  */
+#line 77 "minisql.y"
+                             {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCreateDB, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1448 "./minisql_yacc.c"
     break;
 
-  case 23:
-#line 71 "minisql.y"
-    {
+  case 24: /* sql_drop_database: DROP DATABASE IDENTIFIER  */
+#line 84 "minisql.y"
+                           {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeDropDB, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1457 "./minisql_yacc.c"
     break;
 
-  case 24:
-#line 78 "minisql.y"
-    {
+  case 25: /* sql_show_databases: SHOW DATABASES  */
+#line 91 "minisql.y"
+                 {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeShowDB, NULL);
   }
+#line 1465 "./minisql_yacc.c"
     break;
 
-  case 25:
-#line 84 "minisql.y"
-    {
+  case 26: /* sql_use_database: USE IDENTIFIER  */
+#line 97 "minisql.y"
+                 {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeUseDB, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (2)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1474 "./minisql_yacc.c"
     break;
 
-  case 26:
-#line 91 "minisql.y"
-    {
+  case 27: /* sql_show_tables: SHOW TABLES  */
+#line 104 "minisql.y"
+              {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeShowTables, NULL);
   }
+#line 1482 "./minisql_yacc.c"
     break;
 
-  case 27:
-#line 97 "minisql.y"
-    {
+  case 28: /* sql_create_table: CREATE TABLE IDENTIFIER '(' column_definition_list ')'  */
+#line 110 "minisql.y"
+                                                         {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCreateTable, NULL);
     pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
-    SyntaxNodeAddChildren(list_node, (yyvsp[(5) - (6)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (6)].syntax_node));
+    SyntaxNodeAddChildren(list_node, (yyvsp[-1].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-3].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), list_node);
   }
+#line 1494 "./minisql_yacc.c"
     break;
 
-  case 28:
-#line 107 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (3)].syntax_node);
-    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+  case 29: /* column_list: IDENTIFIER ',' column_list  */
+#line 120 "minisql.y"
+                             {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1503 "./minisql_yacc.c"
     break;
 
-  case 29:
-#line 111 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 30: /* column_list: IDENTIFIER  */
+#line 124 "minisql.y"
+               {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
   }
+#line 1511 "./minisql_yacc.c"
     break;
 
-  case 30:
-#line 117 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (3)].syntax_node);
-    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+  case 31: /* column_definition_list: column_definition ',' column_definition_list  */
+#line 130 "minisql.y"
+                                               {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1520 "./minisql_yacc.c"
     break;
 
-  case 31:
-#line 121 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 32: /* column_definition_list: column_definition  */
+#line 134 "minisql.y"
+                      {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
   }
+#line 1528 "./minisql_yacc.c"
     break;
 
-  case 32:
-#line 124 "minisql.y"
-    {
+  case 33: /* column_definition_list: PRIMARY KEY '(' column_list ')'  */
+#line 137 "minisql.y"
+                                    {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnList, "primary keys");
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(4) - (5)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
   }
+#line 1537 "./minisql_yacc.c"
     break;
 
-  case 33:
-#line 131 "minisql.y"
-    {
+  case 34: /* column_definition: IDENTIFIER column_type UNIQUE  */
+#line 144 "minisql.y"
+                                {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnDefinition, "unique");
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(1) - (3)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
   }
+#line 1547 "./minisql_yacc.c"
     break;
 
-  case 34:
-#line 136 "minisql.y"
-    {
+  case 35: /* column_definition: IDENTIFIER column_type  */
+#line 149 "minisql.y"
+                           {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnDefinition, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(1) - (2)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (2)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1557 "./minisql_yacc.c"
     break;
 
-  case 35:
-#line 144 "minisql.y"
-    {
+  case 36: /* column_type: INT  */
+#line 157 "minisql.y"
+      {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnType, "int");
   }
+#line 1565 "./minisql_yacc.c"
     break;
 
-  case 36:
-#line 147 "minisql.y"
-    {
+  case 37: /* column_type: FLOAT  */
+#line 160 "minisql.y"
+          {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnType, "float");
   }
+#line 1573 "./minisql_yacc.c"
     break;
 
-  case 37:
-#line 150 "minisql.y"
-    {
+  case 38: /* column_type: CHAR '(' NUMBER ')'  */
+#line 163 "minisql.y"
+                        {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnType, "char");
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (4)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
   }
+#line 1582 "./minisql_yacc.c"
     break;
 
-  case 38:
-#line 157 "minisql.y"
-    {
+  case 39: /* sql_drop_table: DROP TABLE IDENTIFIER  */
+#line 170 "minisql.y"
+                        {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeDropTable, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1591 "./minisql_yacc.c"
     break;
 
-  case 39:
-#line 164 "minisql.y"
-    {
+  case 40: /* sql_create_index: CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')'  */
+#line 177 "minisql.y"
+                                                            {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCreateIndex, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (8)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(5) - (8)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-5].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-3].syntax_node));
     pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
-    SyntaxNodeAddChildren(index_keys_node, (yyvsp[(7) - (8)].syntax_node));
+    SyntaxNodeAddChildren(index_keys_node, (yyvsp[-1].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), index_keys_node);
   }
+#line 1604 "./minisql_yacc.c"
     break;
 
-  case 40:
-#line 172 "minisql.y"
-    {
+  case 41: /* sql_create_index: CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' USING IDENTIFIER  */
+#line 185 "minisql.y"
+                                                                               {
       (yyval.syntax_node) = CreateSyntaxNode(kNodeCreateIndex, NULL);
-      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (10)].syntax_node));
-      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(5) - (10)].syntax_node));
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-7].syntax_node));
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-5].syntax_node));
       pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
-      SyntaxNodeAddChildren(index_keys_node, (yyvsp[(7) - (10)].syntax_node));
+      SyntaxNodeAddChildren(index_keys_node, (yyvsp[-3].syntax_node));
       SyntaxNodeAddChildren((yyval.syntax_node), index_keys_node);
       pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
-      SyntaxNodeAddChildren(index_type_node, (yyvsp[(10) - (10)].syntax_node));
+      SyntaxNodeAddChildren(index_type_node, (yyvsp[0].syntax_node));
       SyntaxNodeAddChildren((yyval.syntax_node), index_type_node);
   }
+#line 1620 "./minisql_yacc.c"
     break;
 
-  case 41:
-#line 186 "minisql.y"
-    {
+  case 42: /* sql_drop_index: DROP INDEX IDENTIFIER  */
+#line 199 "minisql.y"
+                        {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeDropIndex, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1629 "./minisql_yacc.c"
     break;
 
-  case 42:
-#line 193 "minisql.y"
-    {
+  case 43: /* sql_show_indexes: SHOW INDEXES  */
+#line 206 "minisql.y"
+               {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeShowIndexes, NULL);
   }
+#line 1637 "./minisql_yacc.c"
     break;
 
-  case 43:
-#line 199 "minisql.y"
-    {
+  case 44: /* sql_select: SELECT distinct_option select_columns FROM table_list where_clause group_by_clause order_by_clause limit_clause  */
+#line 212 "minisql.y"
+                                                                                                                  {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeSelect, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (4)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(4) - (4)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-6].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-4].syntax_node));
+    if ((yyvsp[-3].syntax_node) != NULL) {
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-3].syntax_node));
+    }
+    if ((yyvsp[-2].syntax_node) != NULL) {
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
+    }
+    if ((yyvsp[-1].syntax_node) != NULL) {
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
+    }
+    if ((yyvsp[0].syntax_node) != NULL) {
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+    }
+    if ((yyvsp[-7].syntax_node) != NULL) {
+      SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-7].syntax_node));
+    }
   }
+#line 1662 "./minisql_yacc.c"
     break;
 
-  case 44:
-#line 204 "minisql.y"
-    {
-    (yyval.syntax_node) = CreateSyntaxNode(kNodeSelect, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (6)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(4) - (6)].syntax_node));
-    pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, (yyvsp[(6) - (6)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), condition_node);
+  case 45: /* distinct_option: %empty  */
+#line 235 "minisql.y"
+              {
+    (yyval.syntax_node) = NULL;
   }
+#line 1670 "./minisql_yacc.c"
     break;
 
-  case 45:
-#line 215 "minisql.y"
-    {
+  case 46: /* distinct_option: DISTINCT  */
+#line 238 "minisql.y"
+             {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeDistinct, NULL);
+  }
+#line 1678 "./minisql_yacc.c"
+    break;
+
+  case 47: /* where_clause: %empty  */
+#line 244 "minisql.y"
+              {
+    (yyval.syntax_node) = NULL;
+  }
+#line 1686 "./minisql_yacc.c"
+    break;
+
+  case 48: /* where_clause: WHERE where_conditions  */
+#line 247 "minisql.y"
+                           {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeConditions, NULL);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1695 "./minisql_yacc.c"
+    break;
+
+  case 49: /* group_by_clause: %empty  */
+#line 254 "minisql.y"
+              {
+    (yyval.syntax_node) = NULL;
+  }
+#line 1703 "./minisql_yacc.c"
+    break;
+
+  case 50: /* group_by_clause: GROUP BY column_list  */
+#line 257 "minisql.y"
+                         {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeGroupBy, NULL);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1712 "./minisql_yacc.c"
+    break;
+
+  case 51: /* order_by_clause: %empty  */
+#line 264 "minisql.y"
+              {
+    (yyval.syntax_node) = NULL;
+  }
+#line 1720 "./minisql_yacc.c"
+    break;
+
+  case 52: /* order_by_clause: ORDER BY order_list  */
+#line 267 "minisql.y"
+                        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeOrderBy, NULL);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1729 "./minisql_yacc.c"
+    break;
+
+  case 53: /* limit_clause: %empty  */
+#line 274 "minisql.y"
+              {
+    (yyval.syntax_node) = NULL;
+  }
+#line 1737 "./minisql_yacc.c"
+    break;
+
+  case 54: /* limit_clause: LIMIT NUMBER  */
+#line 277 "minisql.y"
+                 {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeLimit, NULL);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1746 "./minisql_yacc.c"
+    break;
+
+  case 55: /* order_list: order_item ',' order_list  */
+#line 284 "minisql.y"
+                            {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1755 "./minisql_yacc.c"
+    break;
+
+  case 56: /* order_list: order_item  */
+#line 288 "minisql.y"
+               {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
+  }
+#line 1763 "./minisql_yacc.c"
+    break;
+
+  case 57: /* order_item: select_item order_direction  */
+#line 294 "minisql.y"
+                              {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
+  }
+#line 1772 "./minisql_yacc.c"
+    break;
+
+  case 58: /* order_direction: %empty  */
+#line 301 "minisql.y"
+              {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeOrderItem, "asc");
+  }
+#line 1780 "./minisql_yacc.c"
+    break;
+
+  case 59: /* order_direction: ASC  */
+#line 304 "minisql.y"
+        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeOrderItem, "asc");
+  }
+#line 1788 "./minisql_yacc.c"
+    break;
+
+  case 60: /* order_direction: DESC  */
+#line 307 "minisql.y"
+         {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeOrderItem, "desc");
+  }
+#line 1796 "./minisql_yacc.c"
+    break;
+
+  case 61: /* table_list: IDENTIFIER ',' table_list  */
+#line 313 "minisql.y"
+                            {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1805 "./minisql_yacc.c"
+    break;
+
+  case 62: /* table_list: IDENTIFIER  */
+#line 317 "minisql.y"
+               {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
+  }
+#line 1813 "./minisql_yacc.c"
+    break;
+
+  case 63: /* select_columns: '*'  */
+#line 323 "minisql.y"
+      {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeAllColumns, NULL);
   }
+#line 1821 "./minisql_yacc.c"
     break;
 
-  case 46:
-#line 218 "minisql.y"
-    {
+  case 64: /* select_columns: select_list  */
+#line 326 "minisql.y"
+                {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeColumnList, "select columns");
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(1) - (1)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1830 "./minisql_yacc.c"
     break;
 
-  case 47:
-#line 225 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(2) - (3)].syntax_node);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(1) - (3)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+  case 65: /* select_list: select_item ',' select_list  */
+#line 333 "minisql.y"
+                              {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1839 "./minisql_yacc.c"
     break;
 
-  case 48:
-#line 230 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 66: /* select_list: select_item  */
+#line 337 "minisql.y"
+                {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
   }
+#line 1847 "./minisql_yacc.c"
     break;
 
-  case 49:
-#line 236 "minisql.y"
-    {
+  case 67: /* select_item: IDENTIFIER  */
+#line 343 "minisql.y"
+             {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
+  }
+#line 1855 "./minisql_yacc.c"
+    break;
+
+  case 68: /* select_item: aggregate '(' IDENTIFIER ')'  */
+#line 346 "minisql.y"
+                                 {
+    (yyval.syntax_node) = (yyvsp[-3].syntax_node);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-1].syntax_node));
+  }
+#line 1864 "./minisql_yacc.c"
+    break;
+
+  case 69: /* select_item: aggregate '(' '*' ')'  */
+#line 350 "minisql.y"
+                          {
+    (yyval.syntax_node) = (yyvsp[-3].syntax_node);
+    SyntaxNodeAddChildren((yyval.syntax_node), CreateSyntaxNode(kNodeAllColumns, NULL));
+  }
+#line 1873 "./minisql_yacc.c"
+    break;
+
+  case 70: /* aggregate: COUNT  */
+#line 357 "minisql.y"
+        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeAggregate, "count");
+  }
+#line 1881 "./minisql_yacc.c"
+    break;
+
+  case 71: /* aggregate: SUM  */
+#line 360 "minisql.y"
+        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeAggregate, "sum");
+  }
+#line 1889 "./minisql_yacc.c"
+    break;
+
+  case 72: /* aggregate: MIN  */
+#line 363 "minisql.y"
+        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeAggregate, "min");
+  }
+#line 1897 "./minisql_yacc.c"
+    break;
+
+  case 73: /* aggregate: MAX  */
+#line 366 "minisql.y"
+        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeAggregate, "max");
+  }
+#line 1905 "./minisql_yacc.c"
+    break;
+
+  case 74: /* aggregate: AVG  */
+#line 369 "minisql.y"
+        {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeAggregate, "avg");
+  }
+#line 1913 "./minisql_yacc.c"
+    break;
+
+  case 75: /* where_conditions: where_conditions connector where_condition  */
+#line 375 "minisql.y"
+                                              {
+    (yyval.syntax_node) = (yyvsp[-1].syntax_node);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 1923 "./minisql_yacc.c"
+    break;
+
+  case 76: /* where_conditions: where_condition  */
+#line 380 "minisql.y"
+                    {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
+  }
+#line 1931 "./minisql_yacc.c"
+    break;
+
+  case 77: /* connector: AND  */
+#line 386 "minisql.y"
+      {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeConnector, "and");
   }
+#line 1939 "./minisql_yacc.c"
     break;
 
-  case 50:
-#line 239 "minisql.y"
-    {
+  case 78: /* connector: OR  */
+#line 389 "minisql.y"
+       {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeConnector, "or");
   }
+#line 1947 "./minisql_yacc.c"
     break;
 
-  case 51:
-#line 245 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(2) - (3)].syntax_node);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(1) - (3)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+  case 79: /* where_condition: IDENTIFIER operator column_value  */
+#line 395 "minisql.y"
+                                   {
+    (yyval.syntax_node) = (yyvsp[-1].syntax_node);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1957 "./minisql_yacc.c"
     break;
 
-  case 52:
-#line 253 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 80: /* where_condition: IDENTIFIER operator IDENTIFIER  */
+#line 400 "minisql.y"
+                                   {
+    (yyval.syntax_node) = (yyvsp[-1].syntax_node);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 1967 "./minisql_yacc.c"
     break;
 
-  case 53:
-#line 256 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 81: /* column_value: STRING  */
+#line 408 "minisql.y"
+         {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
   }
+#line 1975 "./minisql_yacc.c"
     break;
 
-  case 54:
-#line 259 "minisql.y"
-    {
+  case 82: /* column_value: NUMBER  */
+#line 411 "minisql.y"
+           {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
+  }
+#line 1983 "./minisql_yacc.c"
+    break;
+
+  case 83: /* column_value: FLAGNULL  */
+#line 414 "minisql.y"
+             {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeNull, NULL);
   }
+#line 1991 "./minisql_yacc.c"
     break;
 
-  case 55:
-#line 265 "minisql.y"
-    {
+  case 84: /* operator: EQ  */
+#line 420 "minisql.y"
+     {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, "=");
   }
+#line 1999 "./minisql_yacc.c"
     break;
 
-  case 56:
-#line 268 "minisql.y"
-    {
+  case 85: /* operator: NE  */
+#line 423 "minisql.y"
+       {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, "<>");
   }
+#line 2007 "./minisql_yacc.c"
     break;
 
-  case 57:
-#line 271 "minisql.y"
-    {
+  case 86: /* operator: LE  */
+#line 426 "minisql.y"
+       {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, "<=");
   }
+#line 2015 "./minisql_yacc.c"
     break;
 
-  case 58:
-#line 274 "minisql.y"
-    {
+  case 87: /* operator: GE  */
+#line 429 "minisql.y"
+       {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, ">=");
   }
+#line 2023 "./minisql_yacc.c"
     break;
 
-  case 59:
-#line 277 "minisql.y"
-    {
+  case 88: /* operator: '<'  */
+#line 432 "minisql.y"
+        {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, "<");
   }
+#line 2031 "./minisql_yacc.c"
     break;
 
-  case 60:
-#line 280 "minisql.y"
-    {
+  case 89: /* operator: '>'  */
+#line 435 "minisql.y"
+        {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, ">");
   }
+#line 2039 "./minisql_yacc.c"
     break;
 
-  case 61:
-#line 283 "minisql.y"
-    {
+  case 90: /* operator: IS  */
+#line 438 "minisql.y"
+       {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, "is");
   }
+#line 2047 "./minisql_yacc.c"
     break;
 
-  case 62:
-#line 286 "minisql.y"
-    {
+  case 91: /* operator: NOT  */
+#line 441 "minisql.y"
+        {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeCompareOperator, "not");
   }
+#line 2055 "./minisql_yacc.c"
     break;
 
-  case 63:
-#line 292 "minisql.y"
-    {
+  case 92: /* sql_insert: INSERT INTO IDENTIFIER VALUES '(' column_values ')'  */
+#line 447 "minisql.y"
+                                                      {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeInsert, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (7)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-4].syntax_node));
     pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, (yyvsp[(6) - (7)].syntax_node));
+    SyntaxNodeAddChildren(col_val_node, (yyvsp[-1].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), col_val_node);
   }
+#line 2067 "./minisql_yacc.c"
     break;
 
-  case 64:
-#line 302 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (3)].syntax_node);
-    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+  case 93: /* column_values: column_value ',' column_values  */
+#line 457 "minisql.y"
+                                 {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 2076 "./minisql_yacc.c"
     break;
 
-  case 65:
-#line 306 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 94: /* column_values: column_value  */
+#line 461 "minisql.y"
+                 {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
   }
+#line 2084 "./minisql_yacc.c"
     break;
 
-  case 66:
-#line 312 "minisql.y"
-    {
+  case 95: /* sql_delete: DELETE FROM IDENTIFIER  */
+#line 467 "minisql.y"
+                         {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeDelete, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 2093 "./minisql_yacc.c"
     break;
 
-  case 67:
-#line 316 "minisql.y"
-    {
+  case 96: /* sql_delete: DELETE FROM IDENTIFIER WHERE where_conditions  */
+#line 471 "minisql.y"
+                                                  {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeDelete, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (5)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
     pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, (yyvsp[(5) - (5)].syntax_node));
+    SyntaxNodeAddChildren(condition_node, (yyvsp[0].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), condition_node);
   }
+#line 2105 "./minisql_yacc.c"
     break;
 
-  case 68:
-#line 326 "minisql.y"
-    {
+  case 97: /* sql_update: UPDATE IDENTIFIER SET update_values  */
+#line 481 "minisql.y"
+                                      {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeUpdate, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (4)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
     pSyntaxNode upd_values_node = CreateSyntaxNode(kNodeUpdateValues, NULL);
-    SyntaxNodeAddChildren(upd_values_node, (yyvsp[(4) - (4)].syntax_node));
+    SyntaxNodeAddChildren(upd_values_node, (yyvsp[0].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), upd_values_node);
   }
+#line 2117 "./minisql_yacc.c"
     break;
 
-  case 69:
-#line 333 "minisql.y"
-    {
+  case 98: /* sql_update: UPDATE IDENTIFIER SET update_values WHERE where_conditions  */
+#line 488 "minisql.y"
+                                                               {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeUpdate, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (6)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-4].syntax_node));
     // update values
     pSyntaxNode upd_values_node = CreateSyntaxNode(kNodeUpdateValues, NULL);
-    SyntaxNodeAddChildren(upd_values_node, (yyvsp[(4) - (6)].syntax_node));
+    SyntaxNodeAddChildren(upd_values_node, (yyvsp[-2].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), upd_values_node);
     // where conditions
     pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, (yyvsp[(6) - (6)].syntax_node));
+    SyntaxNodeAddChildren(condition_node, (yyvsp[0].syntax_node));
     SyntaxNodeAddChildren((yyval.syntax_node), condition_node);
   }
+#line 2134 "./minisql_yacc.c"
     break;
 
-  case 70:
-#line 348 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (3)].syntax_node);
-    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+  case 99: /* update_values: update_value ',' update_values  */
+#line 503 "minisql.y"
+                                 {
+    (yyval.syntax_node) = (yyvsp[-2].syntax_node);
+    SyntaxNodeAddSibling((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 2143 "./minisql_yacc.c"
     break;
 
-  case 71:
-#line 352 "minisql.y"
-    {
-    (yyval.syntax_node) = (yyvsp[(1) - (1)].syntax_node);
+  case 100: /* update_values: update_value  */
+#line 507 "minisql.y"
+                 {
+    (yyval.syntax_node) = (yyvsp[0].syntax_node);
   }
+#line 2151 "./minisql_yacc.c"
     break;
 
-  case 72:
-#line 358 "minisql.y"
-    {
+  case 101: /* update_value: IDENTIFIER EQ column_value  */
+#line 513 "minisql.y"
+                             {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeUpdateValue, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(1) - (3)].syntax_node));
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(3) - (3)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[-2].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 2161 "./minisql_yacc.c"
     break;
 
-  case 73:
-#line 366 "minisql.y"
-    {
+  case 102: /* sql_trx_begin: TRXBEGIN  */
+#line 521 "minisql.y"
+           {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeTrxBegin, NULL);
   }
+#line 2169 "./minisql_yacc.c"
     break;
 
-  case 74:
-#line 372 "minisql.y"
-    {
+  case 103: /* sql_trx_commit: TRXCOMMIT  */
+#line 527 "minisql.y"
+            {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeTrxCommit, NULL);
   }
+#line 2177 "./minisql_yacc.c"
     break;
 
-  case 75:
-#line 378 "minisql.y"
-    {
+  case 104: /* sql_trx_rollback: TRXROLLBACK  */
+#line 533 "minisql.y"
+              {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeTrxRollback, NULL);
   }
+#line 2185 "./minisql_yacc.c"
     break;
 
-  case 76:
-#line 384 "minisql.y"
-    {
+  case 105: /* sql_quit: QUIT  */
+#line 539 "minisql.y"
+       {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeQuit, NULL);
   }
+#line 2193 "./minisql_yacc.c"
     break;
 
-  case 77:
-#line 390 "minisql.y"
-    {
+  case 106: /* sql_exec_file: EXECFILE STRING  */
+#line 545 "minisql.y"
+                  {
     (yyval.syntax_node) = CreateSyntaxNode(kNodeExecFile, NULL);
-    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[(2) - (2)].syntax_node));
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
   }
+#line 2202 "./minisql_yacc.c"
     break;
 
+  case 107: /* sql_analyze: ANALYZE IDENTIFIER  */
+#line 552 "minisql.y"
+                     {
+    (yyval.syntax_node) = CreateSyntaxNode(kNodeAnalyze, NULL);
+    SyntaxNodeAddChildren((yyval.syntax_node), (yyvsp[0].syntax_node));
+  }
+#line 2211 "./minisql_yacc.c"
+    break;
+
+
+#line 2215 "./minisql_yacc.c"
 
-/* Line 1267 of yacc.c.  */
-#line 2098 "./minisql_yacc.c"
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
-      /* If just tried and failed to reuse look-ahead token after an
-	 error, discard it.  */
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
 
-  /* Else will try to reuse look-ahead token after shifting the error
+  /* Else will try to reuse lookahead token after shifting the error
      token.  */
   goto yyerrlab1;
 
@@ -2196,14 +2289,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2216,42 +2308,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2262,53 +2354,93 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#ifndef yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
-  if (yychar != YYEOF && yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval);
-  /* Do not reclaim the symbols of the rule which action triggered
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
 
+  return yyresult;
+}
 
-#line 396 "minisql.y"
+#line 558 "minisql.y"
+
+#undef yylex
+
+/**
+ * The keywords below are not in minisql.l, they are scanned as identifiers and
+ * turned into keyword tokens here.
+ */
+static int MinisqlLex(void) {
+  static const struct {
+    const char *word;
+    int token;
+  } keywords[] = {
+      {"analyze", ANALYZE},
+      {"group", GROUP},
+      {"by", BY},
+      {"count", COUNT},
+      {"sum", SUM},
+      {"min", MIN},
+      {"max", MAX},
+      {"avg", AVG},
+      {"order", ORDER},
+      {"asc", ASC},
+      {"desc", DESC},
+      {"limit", LIMIT},
+      {"distinct", DISTINCT},
+  };
+  int token = yylex();
+  if (token == IDENTIFIER) {
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+      if (strcmp(yytext, keywords[i].word) == 0) {
+        return keywords[i].token;
+      }
+    }
+  }
+  return token;
+}
 
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
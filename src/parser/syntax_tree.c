@@ -170,6 +170,20 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeAnalyze:
+      return "kNodeAnalyze";
+    case kNodeAggregate:
+      return "kNodeAggregate";
+    case kNodeGroupBy:
+      return "kNodeGroupBy";
+    case kNodeOrderBy:
+      return "kNodeOrderBy";
+    case kNodeOrderItem:
+      return "kNodeOrderItem";
+    case kNodeLimit:
+      return "kNodeLimit";
+    case kNodeDistinct:
+      return "kNodeDistinct";
     default:
       return "error type";
   }
@@ -0,0 +1,501 @@
+#include "planner/expressions/compiled_predicate.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+
+namespace {
+
+using CompareOp = CompiledPredicate::CompareOp;
+
+bool ToCompareOp(const std::string &comp_type, CompareOp *op) {
+  static const std::pair<const char *, CompareOp> ops[] = {
+      {"=", CompareOp::Equal}, {"<>", CompareOp::NotEqual},    {"<", CompareOp::Less},
+      {"<=", CompareOp::LessEqual}, {">", CompareOp::Greater}, {">=", CompareOp::GreaterEqual}};
+  for (const auto &item : ops) {
+    if (comp_type == item.first) {
+      *op = item.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+inline bool Compare(CompareOp op, const T &lhs, const T &rhs) {
+  switch (op) {
+    case CompareOp::Equal:
+      return lhs == rhs;
+    case CompareOp::NotEqual:
+      return lhs != rhs;
+    case CompareOp::Less:
+      return lhs < rhs;
+    case CompareOp::LessEqual:
+      return lhs <= rhs;
+    case CompareOp::Greater:
+      return lhs > rhs;
+    default:
+      return lhs >= rhs;
+  }
+}
+
+/** Same order as TypeChar and as std::string::compare, the batch columns are strings. */
+inline int CompareChars(const char *lhs, size_t lhs_len, const char *rhs, size_t rhs_len) {
+  int ret = memcmp(lhs, rhs, std::min(lhs_len, rhs_len));
+  if (ret == 0 && lhs_len != rhs_len) {
+    ret = lhs_len < rhs_len ? -1 : 1;
+  }
+  return ret;
+}
+
+inline CmpBool And(uint8_t lhs, uint8_t rhs) {
+  if (lhs == CmpBool::kFalse || rhs == CmpBool::kFalse) {
+    return CmpBool::kFalse;
+  }
+  return lhs == CmpBool::kTrue && rhs == CmpBool::kTrue ? CmpBool::kTrue : CmpBool::kNull;
+}
+
+inline CmpBool Or(uint8_t lhs, uint8_t rhs) {
+  if (lhs == CmpBool::kTrue || rhs == CmpBool::kTrue) {
+    return CmpBool::kTrue;
+  }
+  return lhs == CmpBool::kFalse && rhs == CmpBool::kFalse ? CmpBool::kFalse : CmpBool::kNull;
+}
+
+/** A stride of 0 reads the same value for every row, that is how constants and constant vectors are passed. */
+template <typename T, typename Op>
+void CompareLoop(const T *lhs, size_t lhs_stride, const T *rhs, size_t rhs_stride,
+                 const std::vector<uint32_t> &selection, uint8_t *out, Op op) {
+  for (auto i : selection) {
+    out[i] = op(lhs[i * lhs_stride], rhs[i * rhs_stride]) ? CmpBool::kTrue : CmpBool::kFalse;
+  }
+}
+
+template <typename T>
+void CompareTyped(CompareOp cmp, const T *lhs, size_t lhs_stride, const T *rhs, size_t rhs_stride,
+                  const std::vector<uint32_t> &selection, uint8_t *out) {
+  switch (cmp) {
+    case CompareOp::Equal:
+      return CompareLoop(lhs, lhs_stride, rhs, rhs_stride, selection, out, std::equal_to<T>());
+    case CompareOp::NotEqual:
+      return CompareLoop(lhs, lhs_stride, rhs, rhs_stride, selection, out, std::not_equal_to<T>());
+    case CompareOp::Less:
+      return CompareLoop(lhs, lhs_stride, rhs, rhs_stride, selection, out, std::less<T>());
+    case CompareOp::LessEqual:
+      return CompareLoop(lhs, lhs_stride, rhs, rhs_stride, selection, out, std::less_equal<T>());
+    case CompareOp::Greater:
+      return CompareLoop(lhs, lhs_stride, rhs, rhs_stride, selection, out, std::greater<T>());
+    default:
+      return CompareLoop(lhs, lhs_stride, rhs, rhs_stride, selection, out, std::greater_equal<T>());
+  }
+}
+
+template <typename T, typename Op>
+size_t FilterLoop(const ColumnVector &column, const T *values, size_t stride, const T &constant,
+                  std::vector<uint32_t> *selection, Op op) {
+  size_t n = 0;
+  for (auto i : *selection) {
+    (*selection)[n] = i;
+    n += !column.IsNull(i) && op(values[i * stride], constant);
+  }
+  return n;
+}
+
+template <typename T>
+size_t FilterTyped(CompareOp cmp, const ColumnVector &column, const T *values, const T &constant,
+                   std::vector<uint32_t> *selection) {
+  size_t stride = column.IsConstant() ? 0 : 1;
+  switch (cmp) {
+    case CompareOp::Equal:
+      return FilterLoop(column, values, stride, constant, selection, std::equal_to<T>());
+    case CompareOp::NotEqual:
+      return FilterLoop(column, values, stride, constant, selection, std::not_equal_to<T>());
+    case CompareOp::Less:
+      return FilterLoop(column, values, stride, constant, selection, std::less<T>());
+    case CompareOp::LessEqual:
+      return FilterLoop(column, values, stride, constant, selection, std::less_equal<T>());
+    case CompareOp::Greater:
+      return FilterLoop(column, values, stride, constant, selection, std::greater<T>());
+    default:
+      return FilterLoop(column, values, stride, constant, selection, std::greater_equal<T>());
+  }
+}
+
+}  // namespace
+
+CompiledPredicate::CompiledPredicate(const AbstractExpressionRef &predicate) {
+  CompileConjuncts(predicate);
+  size_t begin = 0;
+  for (auto end : conjunct_ends_) {
+    size_t depth = 0;
+    for (size_t i = begin; i < end; i++) {
+      const auto &ins = program_[i];
+      depth = ins.op_ == OpCode::And || ins.op_ == OpCode::Or ? depth - 1 : depth + 1;
+      max_depth_ = std::max(max_depth_, depth);
+      if (ins.op_ == OpCode::Expression) {
+        has_expression_ = true;
+      } else if (ins.op_ != OpCode::And && ins.op_ != OpCode::Or) {
+        max_column_ = std::max({max_column_, ins.column_, ins.rhs_column_});
+      }
+    }
+    begin = end;
+  }
+}
+
+void CompiledPredicate::CompileConjuncts(const AbstractExpressionRef &expr) {
+  if (expr->GetType() == ExpressionType::LogicExpression &&
+      std::static_pointer_cast<LogicExpression>(expr)->logic_type_ == LogicType::And) {
+    CompileConjuncts(expr->GetChildAt(0));
+    CompileConjuncts(expr->GetChildAt(1));
+    return;
+  }
+  Compile(expr);
+  conjunct_ends_.push_back(program_.size());
+}
+
+void CompiledPredicate::Compile(const AbstractExpressionRef &expr) {
+  Instruction ins;
+  ins.op_ = OpCode::Expression;
+  ins.expr_ = expr;
+  if (expr->GetType() == ExpressionType::LogicExpression) {
+    Compile(expr->GetChildAt(0));
+    Compile(expr->GetChildAt(1));
+    ins.op_ = std::static_pointer_cast<LogicExpression>(expr)->logic_type_ == LogicType::And ? OpCode::And : OpCode::Or;
+    ins.expr_ = nullptr;
+    program_.push_back(std::move(ins));
+    return;
+  }
+  if (expr->GetType() != ExpressionType::ComparisonExpression ||
+      expr->GetChildAt(0)->GetType() != ExpressionType::ColumnExpression) {
+    program_.push_back(std::move(ins));
+    return;
+  }
+  auto comp_type = std::static_pointer_cast<ComparisonExpression>(expr)->GetComparisonType();
+  auto lhs = std::static_pointer_cast<ColumnValueExpression>(expr->GetChildAt(0));
+  const auto &rhs = expr->GetChildAt(1);
+  ins.column_ = lhs->GetColIdx();
+  ins.type_ = lhs->GetReturnType();
+  if (comp_type == "is" || comp_type == "not") {
+    ins.op_ = comp_type == "is" ? OpCode::IsNull : OpCode::IsNotNull;
+    ins.expr_ = nullptr;
+  } else if (ToCompareOp(comp_type, &ins.cmp_) && rhs->GetReturnType() == ins.type_) {
+    if (rhs->GetType() == ExpressionType::ColumnExpression) {
+      ins.op_ = OpCode::CompareColumn;
+      ins.rhs_column_ = std::static_pointer_cast<ColumnValueExpression>(rhs)->GetColIdx();
+      ins.expr_ = nullptr;
+    } else if (rhs->GetType() == ExpressionType::ConstantExpression) {
+      // 常量在规划时已经按列的类型解析过, 这里直接取出原始值
+      const Field &val = std::static_pointer_cast<ConstantValueExpression>(rhs)->val_;
+      ins.op_ = OpCode::CompareConstant;
+      ins.is_null_ = val.IsNull();
+      if (!ins.is_null_) {
+        switch (ins.type_) {
+          case TypeId::kTypeInt:
+            ins.int_ = val.value_.integer_;
+            break;
+          case TypeId::kTypeFloat:
+            ins.float_ = val.value_.float_;
+            break;
+          case TypeId::kTypeChar:
+            ins.chars_.assign(val.value_.chars_, val.len_);
+            break;
+          default:
+            throw std::logic_error("Unsupported comparison type");
+        }
+      }
+      ins.expr_ = nullptr;
+    }
+  }
+  if (ins.expr_ != nullptr) {
+    ins.op_ = OpCode::Expression;
+  }
+  program_.push_back(std::move(ins));
+}
+
+bool CompiledPredicate::Evaluate(const Row &row) const {
+  auto get = [&row](uint32_t column) { return GetValue(row, column); };
+  size_t begin = 0;
+  for (auto end : conjunct_ends_) {
+    if (Run(begin, end, get, &row) != CmpBool::kTrue) {
+      return false;
+    }
+    begin = end;
+  }
+  return true;
+}
+
+bool CompiledPredicate::EvaluateTuple(const char *data, Schema *schema) const {
+  if (has_expression_) {
+    Row row;
+    row.DeserializeFrom(const_cast<char *>(data), schema);
+    return Evaluate(row);
+  }
+  // 按 Row::SerializeTo 的格式: 列数, null bitmap (高位在前), 然后是非 null 的列
+  uint32_t field_count = MACH_READ_UINT32(data);
+  const auto *bitmap = reinterpret_cast<const uint8_t *>(data + sizeof(uint32_t));
+  const char *pos = data + sizeof(uint32_t) + (field_count + 7) / 8;
+  uint32_t column_count = std::min(max_column_ + 1, field_count);
+  Value local[16];
+  std::vector<Value> heap;
+  Value *values = local;
+  if (column_count > sizeof(local) / sizeof(Value)) {
+    heap.resize(column_count);
+    values = heap.data();
+  }
+  for (uint32_t i = 0; i < column_count; i++) {
+    Value &value = values[i];
+    value.is_null_ = !(bitmap[i / 8] & (1 << (7 - i % 8)));
+    if (value.is_null_) {
+      continue;
+    }
+    switch (schema->GetColumn(i)->GetType()) {
+      case TypeId::kTypeInt:
+        value.int_ = MACH_READ_INT32(pos);
+        pos += sizeof(int32_t);
+        break;
+      case TypeId::kTypeFloat:
+        value.float_ = MACH_READ_FROM(float, pos);
+        pos += sizeof(float);
+        break;
+      default:
+        value.len_ = MACH_READ_UINT32(pos);
+        value.chars_ = pos + sizeof(uint32_t);
+        pos += sizeof(uint32_t) + value.len_;
+        break;
+    }
+  }
+  auto get = [values](uint32_t column) -> const Value & { return values[column]; };
+  size_t begin = 0;
+  for (auto end : conjunct_ends_) {
+    if (Run(begin, end, get, nullptr) != CmpBool::kTrue) {
+      return false;
+    }
+    begin = end;
+  }
+  return true;
+}
+
+CompiledPredicate::Value CompiledPredicate::GetValue(const Row &row, uint32_t column) {
+  const Field *field = row.GetField(column);
+  Value value;
+  value.is_null_ = field->IsNull();
+  if (!value.is_null_) {
+    switch (field->GetTypeId()) {
+      case TypeId::kTypeInt:
+        value.int_ = field->value_.integer_;
+        break;
+      case TypeId::kTypeFloat:
+        value.float_ = field->value_.float_;
+        break;
+      default:
+        value.chars_ = field->value_.chars_;
+        value.len_ = field->len_;
+        break;
+    }
+  }
+  return value;
+}
+
+template <typename Getter>
+CmpBool CompiledPredicate::Run(size_t begin, size_t end, const Getter &get, const Row *row) const {
+  if (end - begin == 1) {
+    return EvaluateValue(program_[begin], get, row);
+  }
+  uint8_t local[16];
+  std::vector<uint8_t> heap;
+  uint8_t *stack = local;
+  if (max_depth_ > sizeof(local)) {
+    heap.resize(max_depth_);
+    stack = heap.data();
+  }
+  size_t top = 0;
+  for (size_t i = begin; i < end; i++) {
+    const auto &ins = program_[i];
+    if (ins.op_ == OpCode::And || ins.op_ == OpCode::Or) {
+      top--;
+      stack[top - 1] = ins.op_ == OpCode::And ? And(stack[top - 1], stack[top]) : Or(stack[top - 1], stack[top]);
+    } else {
+      stack[top++] = EvaluateValue(ins, get, row);
+    }
+  }
+  return static_cast<CmpBool>(stack[0]);
+}
+
+template <typename Getter>
+CmpBool CompiledPredicate::EvaluateValue(const Instruction &ins, const Getter &get, const Row *row) const {
+  if (ins.op_ == OpCode::Expression) {
+    return ins.expr_->Evaluate(row).CompareEquals(Field(kTypeInt, 1));
+  }
+  const Value &lhs = get(ins.column_);
+  if (ins.op_ == OpCode::IsNull || ins.op_ == OpCode::IsNotNull) {
+    return GetCmpBool(lhs.is_null_ == (ins.op_ == OpCode::IsNull));
+  }
+  if (ins.op_ == OpCode::CompareConstant) {
+    if (lhs.is_null_ || ins.is_null_) {
+      return CmpBool::kNull;
+    }
+    switch (ins.type_) {
+      case TypeId::kTypeInt:
+        return GetCmpBool(Compare(ins.cmp_, lhs.int_, ins.int_));
+      case TypeId::kTypeFloat:
+        return GetCmpBool(Compare(ins.cmp_, lhs.float_, ins.float_));
+      case TypeId::kTypeChar:
+        return GetCmpBool(
+            Compare(ins.cmp_, CompareChars(lhs.chars_, lhs.len_, ins.chars_.data(), ins.chars_.size()), 0));
+      default:
+        throw std::logic_error("Unsupported comparison type");
+    }
+  }
+  const Value &rhs = get(ins.rhs_column_);
+  if (lhs.is_null_ || rhs.is_null_) {
+    return CmpBool::kNull;
+  }
+  switch (ins.type_) {
+    case TypeId::kTypeInt:
+      return GetCmpBool(Compare(ins.cmp_, lhs.int_, rhs.int_));
+    case TypeId::kTypeFloat:
+      return GetCmpBool(Compare(ins.cmp_, lhs.float_, rhs.float_));
+    case TypeId::kTypeChar:
+      return GetCmpBool(Compare(ins.cmp_, CompareChars(lhs.chars_, lhs.len_, rhs.chars_, rhs.len_), 0));
+    default:
+      throw std::logic_error("Unsupported comparison type");
+  }
+}
+
+void CompiledPredicate::FilterBatch(RowBatch *batch) const {
+  auto &selection = batch->GetSelection();
+  std::vector<uint8_t> result;
+  size_t begin = 0;
+  for (auto end : conjunct_ends_) {
+    if (selection.empty()) {
+      return;
+    }
+    const auto &first = program_[begin];
+    if (end - begin == 1 && first.op_ == OpCode::CompareConstant) {
+      FilterConstant(first, batch);
+    } else {
+      RunBatch(begin, end, *batch, &result);
+      size_t n = 0;
+      for (auto i : selection) {
+        selection[n] = i;
+        n += result[i] == CmpBool::kTrue;
+      }
+      selection.resize(n);
+    }
+    begin = end;
+  }
+}
+
+void CompiledPredicate::FilterConstant(const Instruction &ins, RowBatch *batch) const {
+  auto &selection = batch->GetSelection();
+  if (ins.is_null_) {
+    selection.clear();
+    return;
+  }
+  const ColumnVector &column = batch->GetColumn(ins.column_);
+  if (column.GetType() != ins.type_) {
+    throw std::logic_error("the column type does not match the compiled predicate");
+  }
+  size_t n;
+  switch (ins.type_) {
+    case TypeId::kTypeInt:
+      n = FilterTyped(ins.cmp_, column, column.Ints(), ins.int_, &selection);
+      break;
+    case TypeId::kTypeFloat:
+      n = FilterTyped(ins.cmp_, column, column.Floats(), ins.float_, &selection);
+      break;
+    case TypeId::kTypeChar:
+      n = FilterTyped(ins.cmp_, column, column.Chars(), ins.chars_, &selection);
+      break;
+    default:
+      throw std::logic_error("Unsupported comparison type");
+  }
+  selection.resize(n);
+}
+
+void CompiledPredicate::RunBatch(size_t begin, size_t end, const RowBatch &batch, std::vector<uint8_t> *out) const {
+  if (end - begin == 1) {
+    EvaluateBatch(program_[begin], batch, out);
+    return;
+  }
+  std::vector<std::vector<uint8_t>> stack(max_depth_);
+  size_t top = 0;
+  const auto &selection = batch.GetSelection();
+  for (size_t i = begin; i < end; i++) {
+    const auto &ins = program_[i];
+    if (ins.op_ == OpCode::And || ins.op_ == OpCode::Or) {
+      top--;
+      auto &lhs = stack[top - 1];
+      const auto &rhs = stack[top];
+      for (auto k : selection) {
+        lhs[k] = ins.op_ == OpCode::And ? And(lhs[k], rhs[k]) : Or(lhs[k], rhs[k]);
+      }
+    } else {
+      EvaluateBatch(ins, batch, &stack[top++]);
+    }
+  }
+  out->swap(stack[0]);
+}
+
+void CompiledPredicate::EvaluateBatch(const Instruction &ins, const RowBatch &batch, std::vector<uint8_t> *out) const {
+  out->resize(batch.Size());
+  uint8_t *result = out->data();
+  const auto &selection = batch.GetSelection();
+  if (ins.op_ == OpCode::Expression) {
+    ColumnVector values;
+    ins.expr_->EvaluateBatch(batch, &values);
+    for (auto i : selection) {
+      if (values.IsNull(i)) {
+        result[i] = CmpBool::kNull;
+      } else {
+        result[i] = values.Ints()[values.IsConstant() ? 0 : i] == 1 ? CmpBool::kTrue : CmpBool::kFalse;
+      }
+    }
+    return;
+  }
+  const ColumnVector &lhs = batch.GetColumn(ins.column_);
+  if (ins.op_ == OpCode::IsNull || ins.op_ == OpCode::IsNotNull) {
+    for (auto i : selection) {
+      result[i] = GetCmpBool(lhs.IsNull(i) == (ins.op_ == OpCode::IsNull));
+    }
+    return;
+  }
+  if (ins.op_ == OpCode::CompareConstant && ins.is_null_) {
+    for (auto i : selection) {
+      result[i] = CmpBool::kNull;
+    }
+    return;
+  }
+  const ColumnVector *rhs = ins.op_ == OpCode::CompareColumn ? &batch.GetColumn(ins.rhs_column_) : nullptr;
+  if (lhs.GetType() != ins.type_ || (rhs != nullptr && rhs->GetType() != ins.type_)) {
+    throw std::logic_error("the column type does not match the compiled predicate");
+  }
+  size_t lhs_stride = lhs.IsConstant() ? 0 : 1;
+  size_t rhs_stride = rhs == nullptr || rhs->IsConstant() ? 0 : 1;
+  switch (ins.type_) {
+    case TypeId::kTypeInt:
+      CompareTyped(ins.cmp_, lhs.Ints(), lhs_stride, rhs != nullptr ? rhs->Ints() : &ins.int_, rhs_stride, selection,
+                   result);
+      break;
+    case TypeId::kTypeFloat:
+      CompareTyped(ins.cmp_, lhs.Floats(), lhs_stride, rhs != nullptr ? rhs->Floats() : &ins.float_, rhs_stride,
+                   selection, result);
+      break;
+    case TypeId::kTypeChar:
+      CompareTyped(ins.cmp_, lhs.Chars(), lhs_stride, rhs != nullptr ? rhs->Chars() : &ins.chars_, rhs_stride,
+                   selection, result);
+      break;
+    default:
+      throw std::logic_error("Unsupported comparison type");
+  }
+  for (auto i : selection) {
+    if (lhs.IsNull(i) || (rhs != nullptr && rhs->IsNull(i))) {
+      result[i] = CmpBool::kNull;
+    }
+  }
+}
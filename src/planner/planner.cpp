@@ -3,6 +3,12 @@
 //
 #include "planner/planner.h"
 
+#include <cmath>
+#include <functional>
+#include <set>
+
+#include "executor/executors/index_scan_executor.h"
+
 void Planner::PlanQuery(pSyntaxNode ast) {
   switch (ast->type_) {
     case kNodeSelect: {
@@ -34,25 +40,94 @@ void Planner::PlanQuery(pSyntaxNode ast) {
   }
 }
 AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> statement) {
-  auto out_schema = MakeOutputSchema(statement->column_list_);
-  vector<IndexInfo *> indexes;
-  vector<IndexInfo *> available_index;
-  context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
-  for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
+  AbstractPlanNodeRef plan;
+  if (!statement->aggregates_.empty() || !statement->group_by_.empty()) {
+    plan = PlanAggregation(statement);
+    if (!statement->order_by_.empty()) {
+      // 排序键在聚合的输出行中按 SELECT 列表的位置取列
+      std::vector<Column *> columns;
+      for (auto column : plan->OutputSchema()->GetColumns()) {
+        columns.push_back(new Column(column));
+        columns.back()->SetTableInd(columns.size() - 1);
+      }
+      plan = std::make_shared<SortPlanNode>(new Schema(columns), plan, statement->order_by_);
+    }
+  } else {
+    auto out_schema = MakeOutputSchema(statement->column_list_);
+    if (!statement->order_by_.empty()) {
+      // 排序键不一定在输出的列中, 先按所有表的所有列排序, 输出时再取 out_schema 的列
+      plan = std::make_shared<SortPlanNode>(out_schema, PlanTables(statement), statement->order_by_);
+    } else if (statement->table_names_.size() > 1) {
+      plan = PlanJoin(statement, out_schema);
+    } else {
+      plan = PlanScan(out_schema, statement->table_name_, statement->where_);
+    }
+  }
+  if (statement->distinct_) {
+    plan = std::make_shared<DistinctPlanNode>(plan->OutputSchema(), plan, IsGroupedByOutput(plan));
+  }
+  return statement->has_limit_ ? PlanLimit(plan, statement->limit_) : plan;
+}
+
+bool Planner::IsGroupedByOutput(const AbstractPlanNodeRef &plan) {
+  // order: 输出按哪些列 (table_ind) 有序; constant: 该列在结果中只有一个值
+  std::vector<uint32_t> order;
+  std::vector<bool> constant;
+  switch (plan->GetType()) {
+    case PlanType::Sort: {
+      for (const auto &order_by : dynamic_cast<const SortPlanNode *>(plan.get())->GetOrderBy()) {
+        auto column = dynamic_pointer_cast<ColumnValueExpression>(order_by.second);
+        if (column == nullptr) {
+          break;
+        }
+        order.push_back(column->GetColIdx());
+        constant.push_back(false);
+      }
+      break;
+    }
+    case PlanType::IndexScan:
+    case PlanType::IndexOnlyScan: {
+      // 位图扫描按 RowId 的顺序读表, 只有单个 b+ 树范围的扫描按键有序
+      auto scan = dynamic_cast<const IndexScanPlanNode *>(plan.get());
+      const auto &range = scan->key_range_;
+      if (scan->bitmap_heap_scan_ || scan->bitmap_condition_ != nullptr || range.index_->GetIndexType() != "bptree") {
+        return false;
       }
+      auto key_schema = range.index_->GetIndexKeySchema();
+      for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+        order.push_back(key_schema->GetColumn(i)->GetTableInd());
+        constant.push_back(i < range.lower_.size() && i < range.upper_.size() &&
+                           range.lower_[i].CompareEquals(range.upper_[i]) == CmpBool::kTrue);
+      }
+      break;
     }
+    default:
+      return false;
+  }
+  std::set<uint32_t> output, covered;
+  for (auto column : plan->OutputSchema()->GetColumns()) {
+    output.insert(column->GetTableInd());
   }
-  if (available_index.empty() || statement->has_or) {
-    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
+  // 输出的列都出现在第一个不在输出中的有序列之前 (常量列除外), 相等的行才相邻
+  for (size_t i = 0; i < order.size(); i++) {
+    if (output.count(order[i]) == 0) {
+      if (!constant[i]) {
+        break;
+      }
+      continue;
+    }
+    covered.insert(order[i]);
+  }
+  return covered == output;
+}
+
+AbstractPlanNodeRef Planner::PlanLimit(const AbstractPlanNodeRef &plan, size_t limit) {
+  if (plan->GetType() == PlanType::Sort && limit <= static_cast<size_t>(TOP_N_MAX_ROWS)) {
+    auto sort_plan = dynamic_cast<const SortPlanNode *>(plan.get());
+    return std::make_shared<TopNPlanNode>(sort_plan->OutputSchema(), sort_plan->GetChildPlan(),
+                                          sort_plan->GetOrderBy(), limit);
   }
-  return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
-                                        available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
+  return std::make_shared<LimitPlanNode>(plan->OutputSchema(), plan, limit);
 }
 
 AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> statement) {
@@ -63,56 +138,700 @@ AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> stateme
 AbstractPlanNodeRef Planner::PlanDelete(std::shared_ptr<DeleteStatement> statement) {
   TableInfo *info = nullptr;
   context_->GetCatalog()->GetTable(statement->table_name_, info);
+  auto scan_plan = PlanScan(info->GetSchema(), statement->table_name_, statement->where_, true);
+  return std::make_shared<DeletePlanNode>(info->GetSchema(), scan_plan, statement->table_name_);
+}
+
+AbstractPlanNodeRef Planner::PlanUpdate(std::shared_ptr<UpdateStatement> statement) {
+  TableInfo *info = nullptr;
+  context_->GetCatalog()->GetTable(statement->table_name_, info);
+  auto scan_plan = PlanScan(info->GetSchema(), statement->table_name_, statement->where_, true);
+  return std::make_shared<UpdatePlanNode>(info->GetSchema(), scan_plan, statement->table_name_,
+                                          statement->update_attrs);
+}
+
+/** Split the predicate into the terms that are AND-ed at the top level. */
+static void CollectConjuncts(const AbstractExpressionRef &predicate, std::vector<AbstractExpressionRef> &conjuncts) {
+  if (predicate->GetType() == ExpressionType::LogicExpression &&
+      dynamic_pointer_cast<LogicExpression>(predicate)->logic_type_ == LogicType::And) {
+    CollectConjuncts(predicate->GetChildAt(0), conjuncts);
+    CollectConjuncts(predicate->GetChildAt(1), conjuncts);
+  } else {
+    conjuncts.push_back(predicate);
+  }
+}
+
+/** Collect the table columns an expression reads. */
+static void CollectColumns(const AbstractExpressionRef &expr, std::vector<uint32_t> &columns) {
+  if (expr->GetType() == ExpressionType::ColumnExpression) {
+    columns.push_back(dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx());
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
+
+/** Whether every referenced column is part of the index key. Only a b+ tree index can be scanned for its keys. */
+static bool IsCovering(IndexInfo *index, const std::vector<uint32_t> &columns) {
+  if (index->GetIndexType() != "bptree") {
+    return false;
+  }
+  auto key_columns = index->GetIndexKeySchema()->GetColumns();
+  for (auto col_id : columns) {
+    if (std::none_of(key_columns.begin(), key_columns.end(),
+                     [col_id](const Column *column) { return column->GetTableInd() == col_id; })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Narrow the range with `col op val`; return false if the operator cannot bound a key range. */
+static bool TightenRange(IndexKeyRange &range, const std::string &op, const Field &val) {
+  bool lower = (op == "=" || op == ">" || op == ">=");
+  bool upper = (op == "=" || op == "<" || op == "<=");
+  bool inclusive = (op == "=" || op == ">=" || op == "<=");
+  if (!lower && !upper) {
+    return false;
+  }
+  if (lower) {
+    if (range.lower_.empty() || val.CompareGreaterThan(range.lower_[0]) == CmpBool::kTrue) {
+      range.lower_.clear();
+      range.lower_.emplace_back(val);
+      range.lower_inclusive_ = inclusive;
+    } else if (val.CompareEquals(range.lower_[0]) == CmpBool::kTrue) {
+      range.lower_inclusive_ = range.lower_inclusive_ && inclusive;
+    }
+  }
+  if (upper) {
+    if (range.upper_.empty() || val.CompareLessThan(range.upper_[0]) == CmpBool::kTrue) {
+      range.upper_.clear();
+      range.upper_.emplace_back(val);
+      range.upper_inclusive_ = inclusive;
+    } else if (val.CompareEquals(range.upper_[0]) == CmpBool::kTrue) {
+      range.upper_inclusive_ = range.upper_inclusive_ && inclusive;
+    }
+  }
+  return true;
+}
+
+/**
+ * Build the key range an index can answer from the conjuncts: equalities on a leading prefix of the key
+ * columns plus the comparisons on the next column.
+ * @param[out] used marks the conjuncts folded into the range
+ * @return a score that prefers longer equality prefixes, then two-sided ranges; 0 if the index is unusable
+ */
+static int BuildKeyRange(IndexInfo *index, const std::vector<AbstractExpressionRef> &conjuncts, IndexKeyRange &range,
+                         std::vector<bool> &used) {
+  auto key_schema = index->GetIndexKeySchema();
+  range = IndexKeyRange();
+  range.index_ = index;
+  used.assign(conjuncts.size(), false);
+  uint32_t eq_columns = 0;
+  bool any_used = false;
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    auto col_id = key_schema->GetColumn(i)->GetTableInd();
+    IndexKeyRange column_range;
+    bool column_used = false;
+    for (size_t k = 0; k < conjuncts.size(); k++) {
+      const auto &conjunct = conjuncts[k];
+      if (conjunct->GetType() != ExpressionType::ComparisonExpression) {
+        continue;
+      }
+      auto col_expr = dynamic_pointer_cast<ColumnValueExpression>(conjunct->GetChildAt(0));
+      auto const_expr = dynamic_pointer_cast<ConstantValueExpression>(conjunct->GetChildAt(1));
+      if (col_expr == nullptr || const_expr == nullptr || col_expr->GetColIdx() != col_id ||
+          const_expr->val_.IsNull()) {
+        continue;
+      }
+      if (TightenRange(column_range, dynamic_pointer_cast<ComparisonExpression>(conjunct)->GetComparisonType(),
+                       const_expr->val_)) {
+        used[k] = true;
+        column_used = true;
+      }
+    }
+    if (!column_used) {
+      break;
+    }
+    any_used = true;
+    bool is_point = !column_range.lower_.empty() && !column_range.upper_.empty() && column_range.lower_inclusive_ &&
+                    column_range.upper_inclusive_ &&
+                    column_range.lower_[0].CompareEquals(column_range.upper_[0]) == CmpBool::kTrue;
+    if (is_point) {
+      range.lower_.emplace_back(column_range.lower_[0]);
+      range.upper_.emplace_back(column_range.upper_[0]);
+      eq_columns++;
+      continue;
+    }
+    // 范围列之后的列无法再缩小扫描区间
+    if (!column_range.lower_.empty()) {
+      range.lower_.emplace_back(column_range.lower_[0]);
+      range.lower_inclusive_ = column_range.lower_inclusive_;
+    }
+    if (!column_range.upper_.empty()) {
+      range.upper_.emplace_back(column_range.upper_[0]);
+      range.upper_inclusive_ = column_range.upper_inclusive_;
+    }
+    break;
+  }
+  if (!any_used) {
+    return 0;
+  }
+  if (index->GetIndexType() != "bptree") {
+    // hash/art 索引只能回答完整 key 上的等值查找, 此时比同样的 b+ 树查找更便宜
+    if (eq_columns != key_schema->GetColumnCount()) {
+      used.assign(conjuncts.size(), false);
+      return 0;
+    }
+    return 4 * eq_columns + 1;
+  }
+  // 等值前缀越长越好, 其次是双边范围 > 单边范围
+  return 4 * eq_columns + (range.lower_.size() > eq_columns) + (range.upper_.size() > eq_columns);
+}
+
+/**
+ * Build the RowId bitmap condition of an expression: OR unions its sides, AND intersects the ranges of as
+ * many indexes as needed to cover its comparisons.
+ * @return nullptr if some OR branch cannot be answered by an index
+ */
+static std::shared_ptr<IndexBitmapCondition> BuildBitmapCondition(const AbstractExpressionRef &expr,
+                                                                  const std::vector<IndexInfo *> &indexes) {
+  if (expr->GetType() == ExpressionType::LogicExpression &&
+      dynamic_pointer_cast<LogicExpression>(expr)->logic_type_ == LogicType::Or) {
+    auto node = std::make_shared<IndexBitmapCondition>();
+    node->is_leaf_ = false;
+    node->logic_type_ = LogicType::Or;
+    for (const auto &child : expr->GetChildren()) {
+      auto sub = BuildBitmapCondition(child, indexes);
+      if (sub == nullptr) {
+        return nullptr;
+      }
+      if (!sub->is_leaf_ && sub->logic_type_ == LogicType::Or) {
+        for (const auto &grandchild : sub->children_) {
+          node->children_.push_back(grandchild);
+        }
+      } else {
+        node->children_.push_back(*sub);
+      }
+    }
+    return node;
+  }
+  std::vector<AbstractExpressionRef> conjuncts;
+  CollectConjuncts(expr, conjuncts);
+  auto node = std::make_shared<IndexBitmapCondition>();
+  node->is_leaf_ = false;
+  node->logic_type_ = LogicType::And;
+  // 贪心地选择索引, 每个新索引至少要覆盖一个还没被覆盖的比较条件
+  std::vector<bool> absorbed(conjuncts.size(), false);
+  while (true) {
+    int best_score = 0;
+    IndexKeyRange best_range;
+    std::vector<bool> best_used;
+    for (auto index : indexes) {
+      IndexKeyRange range;
+      std::vector<bool> used;
+      int score = BuildKeyRange(index, conjuncts, range, used);
+      bool adds_new = false;
+      for (size_t k = 0; k < used.size(); k++) {
+        adds_new = adds_new || (used[k] && !absorbed[k]);
+      }
+      if (adds_new && score > best_score) {
+        best_score = score;
+        best_range = std::move(range);
+        best_used = std::move(used);
+      }
+    }
+    if (best_score == 0) {
+      break;
+    }
+    for (size_t k = 0; k < best_used.size(); k++) {
+      absorbed[k] = absorbed[k] || best_used[k];
+    }
+    IndexBitmapCondition leaf;
+    leaf.key_range_ = std::move(best_range);
+    node->children_.push_back(std::move(leaf));
+  }
+  for (const auto &conjunct : conjuncts) {
+    if (conjunct->GetType() == ExpressionType::LogicExpression) {
+      auto sub = BuildBitmapCondition(conjunct, indexes);
+      if (sub != nullptr) {
+        node->children_.push_back(*sub);
+      }
+    }
+  }
+  if (node->children_.empty()) {
+    return nullptr;
+  }
+  if (node->children_.size() == 1) {
+    return std::make_shared<IndexBitmapCondition>(node->children_[0]);
+  }
+  return node;
+}
+
+/**
+ * Estimate the fraction of rows inside a key range from the column statistics, assuming the key columns
+ * are independent.
+ */
+static double RangeSelectivity(const TableStatistics *stats, const IndexKeyRange &range) {
+  auto key_schema = range.index_->GetIndexKeySchema();
+  size_t bounded = std::min(range.lower_.size(), range.upper_.size());
+  double selectivity = 1;
+  size_t eq_columns = 0;
+  for (; eq_columns < bounded; eq_columns++) {
+    // 两端都停在这一列且不是闭区间时, 这一列是范围列
+    bool range_column = eq_columns + 1 == range.lower_.size() && eq_columns + 1 == range.upper_.size() &&
+                        !(range.lower_inclusive_ && range.upper_inclusive_);
+    if (range_column || range.lower_[eq_columns].CompareEquals(range.upper_[eq_columns]) != CmpBool::kTrue) {
+      break;
+    }
+    const auto &column = stats->GetColumn(key_schema->GetColumn(eq_columns)->GetTableInd());
+    selectivity *= column.EqualSelectivity(range.lower_[eq_columns]);
+  }
+  bool has_lower = range.lower_.size() > eq_columns;
+  bool has_upper = range.upper_.size() > eq_columns;
+  if (has_lower || has_upper) {
+    const auto &column = stats->GetColumn(key_schema->GetColumn(eq_columns)->GetTableInd());
+    double low = 0, high = 1 - column.GetNullFraction();
+    if (has_lower) {
+      const Field &val = range.lower_[eq_columns];
+      low = column.LessSelectivity(val) + (range.lower_inclusive_ ? 0 : column.EqualSelectivity(val));
+    }
+    if (has_upper) {
+      const Field &val = range.upper_[eq_columns];
+      high = column.LessSelectivity(val) + (range.upper_inclusive_ ? column.EqualSelectivity(val) : 0);
+    }
+    selectivity *= std::max(0.0, high - low);
+  }
+  return std::min(1.0, std::max(0.0, selectivity));
+}
+
+/** Estimate the fraction of rows in the RowId set of a bitmap condition. */
+static double ConditionSelectivity(const TableStatistics *stats, const IndexBitmapCondition &condition) {
+  if (condition.is_leaf_) {
+    return RangeSelectivity(stats, condition.key_range_);
+  }
+  double selectivity = 1;
+  for (const auto &child : condition.children_) {
+    if (condition.logic_type_ == LogicType::And) {
+      selectivity *= ConditionSelectivity(stats, child);
+    } else {
+      selectivity *= 1 - ConditionSelectivity(stats, child);
+    }
+  }
+  return condition.logic_type_ == LogicType::And ? selectivity : 1 - selectivity;
+}
+
+static double SeqScanCost(const TableStatistics *stats) {
+  return stats->GetPageCount() * Planner::SEQ_PAGE_COST + stats->GetRowCount() * Planner::CPU_TUPLE_COST;
+}
+
+/**
+ * Cost of fetching the given fraction of rows through an index. A plain index scan reads a random page per
+ * row. A bitmap heap scan reads each page once, the expected number of distinct pages among the rows
+ * follows Cardenas' formula, and the pages get cheaper towards sequential reads as more of them are read.
+ */
+static double IndexScanCost(const TableStatistics *stats, double selectivity, bool bitmap_heap_scan) {
+  double rows = selectivity * stats->GetRowCount();
+  double cpu = rows * (Planner::CPU_INDEX_TUPLE_COST + Planner::CPU_TUPLE_COST);
+  if (!bitmap_heap_scan) {
+    return rows * Planner::RANDOM_PAGE_COST + cpu;
+  }
+  double pages = stats->GetPageCount();
+  double fetched = pages * (1 - std::pow(1 - 1 / pages, rows));
+  double page_cost = Planner::RANDOM_PAGE_COST -
+                     (Planner::RANDOM_PAGE_COST - Planner::SEQ_PAGE_COST) * std::sqrt(fetched / pages);
+  return fetched * page_cost + cpu;
+}
+
+AbstractPlanNodeRef Planner::PlanScan(const Schema *out_schema, const std::string &table_name,
+                                      const AbstractExpressionRef &predicate, bool snapshot_rids) {
+  std::vector<AbstractExpressionRef> conjuncts;
+  if (predicate != nullptr) {
+    CollectConjuncts(predicate, conjuncts);
+  }
   vector<IndexInfo *> indexes;
-  vector<IndexInfo *> available_index;
-  context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
+  context_->GetCatalog()->GetTableIndexes(table_name, indexes);
+  IndexKeyRange best_range;
+  int best_score = 0;
+  bool best_exact = false;
   for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
+    IndexKeyRange range;
+    std::vector<bool> used;
+    int score = BuildKeyRange(index, conjuncts, range, used);
+    if (score > best_score) {
+      best_score = score;
+      best_exact = std::all_of(used.begin(), used.end(), [](bool u) { return u; });
+      best_range = std::move(range);
+    }
+  }
+  // 查询引用的列都在索引 key 中时不必回表; DELETE/UPDATE 需要完整的行
+  std::vector<uint32_t> referenced;
+  for (auto column : out_schema->GetColumns()) {
+    referenced.push_back(column->GetTableInd());
+  }
+  if (predicate != nullptr) {
+    CollectColumns(predicate, referenced);
+  }
+  if (!snapshot_rids && best_score > 0 && IsCovering(best_range.index_, referenced)) {
+    return make_shared<IndexOnlyScanPlanNode>(out_schema, table_name, std::move(best_range), !best_exact,
+                                              predicate);
+  }
+  bool large_range = best_score > 0 && IsLargeRange(best_range);
+  // ANALYZE 过的表按代价比较, 选出的行太多时顺序扫描更便宜
+  TableInfo *table_info = nullptr;
+  context_->GetCatalog()->GetTable(table_name, table_info);
+  const TableStatistics *stats = table_info->GetStatistics();
+  if (stats != nullptr && best_score > 0 &&
+      SeqScanCost(stats) < IndexScanCost(stats, RangeSelectivity(stats, best_range), large_range)) {
+    best_score = 0;
+  }
+  // OR 只能靠多个索引的并集; AND 在单个范围较大时再与其他索引求交
+  if (predicate != nullptr && (best_score == 0 || large_range)) {
+    auto condition = BuildBitmapCondition(predicate, indexes);
+    if (condition != nullptr && !condition->is_leaf_ &&
+        (stats == nullptr ||
+         IndexScanCost(stats, ConditionSelectivity(stats, *condition), true) <= SeqScanCost(stats))) {
+      auto plan = make_shared<IndexScanPlanNode>(out_schema, table_name, IndexKeyRange(), true, predicate);
+      plan->snapshot_rids_ = snapshot_rids;
+      plan->bitmap_heap_scan_ = true;
+      plan->bitmap_condition_ = condition;
+      return plan;
+    }
+  }
+  if (best_score == 0) {
+    // 没有可用的范围条件, 但覆盖索引比整张表更小, 仍然全量扫描索引
+    for (auto index : indexes) {
+      if (!snapshot_rids && IsCovering(index, referenced)) {
+        IndexKeyRange full_range;
+        full_range.index_ = index;
+        return make_shared<IndexOnlyScanPlanNode>(out_schema, table_name, std::move(full_range),
+                                                  predicate != nullptr, predicate);
       }
     }
+    return make_shared<SeqScanPlanNode>(out_schema, table_name, predicate);
   }
-  if(available_index.empty()){
-    auto scan_plan = make_shared<SeqScanPlanNode>(info->GetSchema(), statement->table_name_, statement->where_);
-    return std::make_shared<DeletePlanNode>(info->GetSchema(), scan_plan, statement->table_name_);
-  }else{
-    auto scan_plan=make_shared<IndexScanPlanNode>(info->GetSchema(), statement->table_name_, available_index,
-                                        available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
-    return std::make_shared<DeletePlanNode>(info->GetSchema(), scan_plan, statement->table_name_);
+  auto plan = make_shared<IndexScanPlanNode>(out_schema, table_name, std::move(best_range), !best_exact, predicate);
+  plan->snapshot_rids_ = snapshot_rids;
+  plan->bitmap_heap_scan_ = large_range;
+  return plan;
+}
+
+/** Rebuild an expression with every column moved to the (row_idx, col_idx) that bind gives for its index. */
+static AbstractExpressionRef RebindColumns(const AbstractExpressionRef &expr,
+                                          const std::function<std::pair<uint32_t, uint32_t>(uint32_t)> &bind) {
+  switch (expr->GetType()) {
+    case ExpressionType::ColumnExpression: {
+      auto binding = bind(dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx());
+      return std::make_shared<ColumnValueExpression>(binding.first, binding.second, expr->GetReturnType());
+    }
+    case ExpressionType::ComparisonExpression:
+      return std::make_shared<ComparisonExpression>(RebindColumns(expr->GetChildAt(0), bind),
+                                                    RebindColumns(expr->GetChildAt(1), bind),
+                                                    dynamic_pointer_cast<ComparisonExpression>(expr)->GetComparisonType());
+    case ExpressionType::LogicExpression:
+      return std::make_shared<LogicExpression>(RebindColumns(expr->GetChildAt(0), bind),
+                                               RebindColumns(expr->GetChildAt(1), bind),
+                                               dynamic_pointer_cast<LogicExpression>(expr)->logic_type_);
+    default:
+      return expr;
   }
 }
 
-AbstractPlanNodeRef Planner::PlanUpdate(std::shared_ptr<UpdateStatement> statement) {
-  TableInfo *info = nullptr;
-  context_->GetCatalog()->GetTable(statement->table_name_, info);
-    vector<IndexInfo *> indexes;
-  vector<IndexInfo *> available_index;
-  context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
+/** AND the conditions together, nullptr if there are none. */
+static AbstractExpressionRef MakeConjunction(const std::vector<AbstractExpressionRef> &conjuncts) {
+  AbstractExpressionRef predicate = nullptr;
+  for (const auto &conjunct : conjuncts) {
+    predicate = predicate == nullptr ? conjunct : std::make_shared<LogicExpression>(predicate, conjunct, LogicType::And);
+  }
+  return predicate;
+}
+
+/**
+ * Estimate the fraction of rows on which a predicate holds. Comparisons of a column with a constant use
+ * the column statistics when there are any, everything else is assumed to keep a third of the rows.
+ */
+static double PredicateSelectivity(const TableStatistics *stats, const AbstractExpressionRef &expr) {
+  if (expr->GetType() == ExpressionType::LogicExpression) {
+    double lhs = PredicateSelectivity(stats, expr->GetChildAt(0));
+    double rhs = PredicateSelectivity(stats, expr->GetChildAt(1));
+    return dynamic_pointer_cast<LogicExpression>(expr)->logic_type_ == LogicType::And ? lhs * rhs
+                                                                                      : lhs + rhs - lhs * rhs;
+  }
+  auto col_expr = dynamic_pointer_cast<ColumnValueExpression>(expr->GetChildAt(0));
+  auto const_expr = dynamic_pointer_cast<ConstantValueExpression>(expr->GetChildAt(1));
+  if (stats == nullptr || expr->GetType() != ExpressionType::ComparisonExpression || col_expr == nullptr ||
+      const_expr == nullptr) {
+    return 1.0 / 3;
+  }
+  const auto &column = stats->GetColumn(col_expr->GetColIdx());
+  const Field &val = const_expr->val_;
+  double non_null = 1 - column.GetNullFraction();
+  auto op = dynamic_pointer_cast<ComparisonExpression>(expr)->GetComparisonType();
+  double selectivity = 1.0 / 3;
+  if (op == "=") {
+    selectivity = column.EqualSelectivity(val);
+  } else if (op == "<>") {
+    selectivity = non_null - column.EqualSelectivity(val);
+  } else if (op == "<") {
+    selectivity = column.LessSelectivity(val);
+  } else if (op == "<=") {
+    selectivity = column.LessSelectivity(val) + column.EqualSelectivity(val);
+  } else if (op == ">") {
+    selectivity = non_null - column.LessSelectivity(val) - column.EqualSelectivity(val);
+  } else if (op == ">=") {
+    selectivity = non_null - column.LessSelectivity(val);
+  } else if (op == "is") {
+    selectivity = column.GetNullFraction();
+  } else if (op == "not") {
+    selectivity = non_null;
+  }
+  return std::min(1.0, std::max(0.0, selectivity));
+}
+
+/** Estimate the rows of a table that pass a predicate, unanalyzed tables count as DEFAULT_TABLE_ROWS rows. */
+static double EstimateRows(TableInfo *table_info, const AbstractExpressionRef &predicate) {
+  const TableStatistics *stats = table_info->GetStatistics();
+  double rows = stats != nullptr ? stats->GetRowCount() : Planner::DEFAULT_TABLE_ROWS;
+  return predicate == nullptr ? rows : rows * PredicateSelectivity(stats, predicate);
+}
+
+/** Cost of reading a whole table in order, guessed for a table that has not been analyzed. */
+static double TableScanCost(TableInfo *table_info) {
+  const TableStatistics *stats = table_info->GetStatistics();
+  if (stats != nullptr) {
+    return SeqScanCost(stats);
+  }
+  return Planner::DEFAULT_TABLE_PAGES * Planner::SEQ_PAGE_COST + Planner::DEFAULT_TABLE_ROWS * Planner::CPU_TUPLE_COST;
+}
+
+/** Estimate the rows of a table that share one key of an index. */
+static double IndexMatches(TableInfo *table_info, IndexInfo *index) {
+  if (index->IsUnique()) {
+    return 1;
+  }
+  const TableStatistics *stats = table_info->GetStatistics();
+  if (stats == nullptr) {
+    return Planner::DEFAULT_INDEX_MATCHES;
+  }
+  // 多列 key 只按第一列估计, 结果偏大, 不会误选索引连接
+  const auto &column = stats->GetColumn(index->GetIndexKeySchema()->GetColumn(0)->GetTableInd());
+  return stats->GetRowCount() * (1 - column.GetNullFraction()) / std::max(1.0, column.GetDistinctCount());
+}
+
+IndexInfo *Planner::FindJoinIndex(const std::string &table_name, const std::vector<AbstractExpressionRef> &inner_keys,
+                                  std::vector<size_t> &key_positions) {
+  vector<IndexInfo *> indexes;
+  context_->GetCatalog()->GetTableIndexes(table_name, indexes);
+  IndexInfo *best = nullptr;
   for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
+    if (index->GetIndexType() != "bptree") {
+      continue;
+    }
+    std::vector<size_t> positions;
+    for (auto column : index->GetIndexKeySchema()->GetColumns()) {
+      auto it = std::find_if(inner_keys.begin(), inner_keys.end(), [column](const AbstractExpressionRef &key) {
+        return dynamic_pointer_cast<ColumnValueExpression>(key)->GetColIdx() == column->GetTableInd();
+      });
+      if (it == inner_keys.end()) {
+        break;
       }
+      positions.push_back(it - inner_keys.begin());
+    }
+    if (positions.size() == index->GetIndexKeySchema()->GetColumnCount() &&
+        (best == nullptr || positions.size() > key_positions.size())) {
+      best = index;
+      key_positions = std::move(positions);
     }
   }
-  if(available_index.empty()){
-    auto scan_plan = make_shared<SeqScanPlanNode>(info->GetSchema(), statement->table_name_, statement->where_);
-    return std::make_shared<UpdatePlanNode>(info->GetSchema(), scan_plan, statement->table_name_,
-                                          statement->update_attrs);
-  }else{
-    auto scan_plan=make_shared<IndexScanPlanNode>(info->GetSchema(), statement->table_name_, available_index,
-                                        available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
-    return std::make_shared<UpdatePlanNode>(info->GetSchema(), scan_plan, statement->table_name_,
-                                          statement->update_attrs);                                    
-  }
-  
+  return best;
+}
+
+AbstractPlanNodeRef Planner::PlanJoin(std::shared_ptr<SelectStatement> statement, const Schema *out_schema) {
+  const auto &tables = statement->table_names_;
+  size_t table_count = tables.size();
+  std::vector<TableInfo *> infos(table_count);
+  // offsets[t]: 第 t 张表的第一列在所有表的列拼成的行中的位置
+  std::vector<uint32_t> offsets{0};
+  for (size_t t = 0; t < table_count; t++) {
+    context_->GetCatalog()->GetTable(tables[t], infos[t]);
+    offsets.push_back(offsets.back() + infos[t]->GetSchema()->GetColumnCount());
+  }
+  // 每个条件在它引用的最后一张表连接进来时求值, 只引用一张表的条件下推到这张表的扫描
+  std::vector<std::vector<AbstractExpressionRef>> scan_conjuncts(table_count);
+  std::vector<std::vector<AbstractExpressionRef>> join_conjuncts(table_count);
+  std::vector<AbstractExpressionRef> conjuncts;
+  if (statement->where_ != nullptr) {
+    CollectConjuncts(statement->where_, conjuncts);
+  }
+  for (const auto &conjunct : conjuncts) {
+    std::vector<uint32_t> columns;
+    CollectColumns(conjunct, columns);
+    size_t first = columns.empty() ? 0 : table_count;
+    size_t last = 0;
+    for (auto column : columns) {
+      size_t t = std::upper_bound(offsets.begin(), offsets.end(), column) - offsets.begin() - 1;
+      first = std::min(first, t);
+      last = std::max(last, t);
+    }
+    uint32_t offset = offsets[last];
+    if (first == last) {
+      scan_conjuncts[last].push_back(
+          RebindColumns(conjunct, [offset](uint32_t column) { return std::make_pair(0u, column - offset); }));
+    } else {
+      join_conjuncts[last].push_back(RebindColumns(conjunct, [offset](uint32_t column) {
+        return column < offset ? std::make_pair(0u, column) : std::make_pair(1u, column - offset);
+      }));
+    }
+  }
+  // 按 FROM 的顺序建左深树, 中间结果带上已连接的表的所有列
+  auto scan_predicate = MakeConjunction(scan_conjuncts[0]);
+  AbstractPlanNodeRef plan = PlanScan(infos[0]->GetSchema(), tables[0], scan_predicate);
+  double rows = EstimateRows(infos[0], scan_predicate);
+  for (size_t k = 1; k < table_count; k++) {
+    scan_predicate = MakeConjunction(scan_conjuncts[k]);
+    double right_rows = EstimateRows(infos[k], scan_predicate);
+    const Schema *schema = k + 1 < table_count ? MakeJoinedSchema(infos, offsets, k + 1) : out_schema;
+    // 两侧各一列的等值条件作为哈希键, 其余条件在匹配的行对上求值
+    std::vector<AbstractExpressionRef> left_keys, right_keys, key_conjuncts, residual;
+    for (const auto &conjunct : join_conjuncts[k]) {
+      auto lhs = dynamic_pointer_cast<ColumnValueExpression>(conjunct->GetChildAt(0));
+      auto rhs = conjunct->GetType() == ExpressionType::ComparisonExpression
+                     ? dynamic_pointer_cast<ColumnValueExpression>(conjunct->GetChildAt(1))
+                     : nullptr;
+      if (lhs == nullptr || rhs == nullptr || lhs->GetRowIdx() == rhs->GetRowIdx() ||
+          dynamic_pointer_cast<ComparisonExpression>(conjunct)->GetComparisonType() != "=") {
+        residual.push_back(conjunct);
+        continue;
+      }
+      left_keys.push_back(lhs->GetRowIdx() == 0 ? lhs : rhs);
+      right_keys.push_back(lhs->GetRowIdx() == 0 ? rhs : lhs);
+      key_conjuncts.push_back(conjunct);
+    }
+    // 外侧估计的行数少且内表的连接列上有 b+ 树索引时, 逐行查索引比读整张内表便宜
+    std::vector<size_t> key_positions;
+    IndexInfo *join_index = FindJoinIndex(tables[k], right_keys, key_positions);
+    if (join_index != nullptr) {
+      double matches = IndexMatches(infos[k], join_index);
+      double index_cost =
+          rows * (RANDOM_PAGE_COST + matches * (RANDOM_PAGE_COST + CPU_INDEX_TUPLE_COST + CPU_TUPLE_COST));
+      if (index_cost < TableScanCost(infos[k])) {
+        std::vector<AbstractExpressionRef> outer_keys;
+        for (auto j : key_positions) {
+          outer_keys.push_back(left_keys[j]);
+        }
+        for (size_t j = 0; j < key_conjuncts.size(); j++) {
+          if (std::find(key_positions.begin(), key_positions.end(), j) == key_positions.end()) {
+            residual.push_back(key_conjuncts[j]);
+          }
+        }
+        plan = std::make_shared<IndexNestedLoopJoinPlanNode>(schema, plan, tables[k], join_index, std::move(outer_keys),
+                                                             scan_predicate, MakeConjunction(residual));
+        rows *= matches * right_rows / std::max(1.0, EstimateRows(infos[k], nullptr));
+        continue;
+      }
+    }
+    auto right_plan = PlanScan(infos[k]->GetSchema(), tables[k], scan_predicate);
+    if (left_keys.empty()) {
+      auto predicate = MakeConjunction(residual);
+      plan = std::make_shared<NestedLoopJoinPlanNode>(schema, plan, right_plan, predicate);
+      rows *= right_rows * (predicate == nullptr ? 1 : PredicateSelectivity(nullptr, predicate));
+    } else {
+      // 哈希表建在估计较小的一侧
+      plan = std::make_shared<HashJoinPlanNode>(schema, plan, right_plan, std::move(left_keys), std::move(right_keys),
+                                                MakeConjunction(residual), rows < right_rows);
+      rows = std::max(rows, right_rows);
+    }
+  }
+  return plan;
+}
+
+AbstractPlanNodeRef Planner::PlanTables(std::shared_ptr<SelectStatement> statement) {
+  const auto &tables = statement->table_names_;
+  if (tables.size() == 1) {
+    TableInfo *info = nullptr;
+    context_->GetCatalog()->GetTable(statement->table_name_, info);
+    return PlanScan(info->GetSchema(), statement->table_name_, statement->where_);
+  }
+  std::vector<TableInfo *> infos(tables.size());
+  std::vector<uint32_t> offsets{0};
+  for (size_t t = 0; t < tables.size(); t++) {
+    context_->GetCatalog()->GetTable(tables[t], infos[t]);
+    offsets.push_back(offsets.back() + infos[t]->GetSchema()->GetColumnCount());
+  }
+  return PlanJoin(statement, MakeJoinedSchema(infos, offsets, tables.size()));
+}
+
+AbstractPlanNodeRef Planner::PlanAggregation(std::shared_ptr<SelectStatement> statement) {
+  auto child = PlanTables(statement);
+  // 聚合的输出行是分组的列后接各个聚合值, 输出模式按 table_ind 从中取列
+  std::vector<AbstractExpressionRef> aggregates;
+  std::vector<AggregationType> agg_types;
+  for (const auto &aggregate : statement->aggregates_) {
+    aggregates.push_back(statement->column_list_[aggregate.first].second);
+    agg_types.push_back(aggregate.second);
+  }
+  const auto &group_by = statement->group_by_;
+  std::vector<Column *> columns;
+  for (size_t i = 0, j = 0; i < statement->column_list_.size(); i++) {
+    const auto &column = statement->column_list_[i];
+    TypeId type = statement->GetColumnType(i);
+    uint32_t index;
+    if (j < agg_types.size() && statement->aggregates_[j].first == i) {
+      index = group_by.size() + j++;
+    } else {
+      index = statement->GetGroupByPosition(column.second);
+    }
+    if (type != TypeId::kTypeChar) {
+      columns.push_back(new Column(column.first, type, index, true, false));
+    } else {
+      columns.push_back(new Column(column.first, type, MAX_VARCHAR_SIZE, index, true, false));
+    }
+  }
+  return std::make_shared<AggregationPlanNode>(new Schema(columns), child, group_by, std::move(aggregates),
+                                               std::move(agg_types));
+}
+
+Schema *Planner::MakeJoinedSchema(const std::vector<TableInfo *> &infos, const std::vector<uint32_t> &offsets,
+                                  size_t count) {
+  std::vector<Column *> columns;
+  for (size_t t = 0; t < count; t++) {
+    for (auto column : infos[t]->GetSchema()->GetColumns()) {
+      columns.push_back(new Column(column));
+      columns.back()->SetTableInd(offsets[t] + column->GetTableInd());
+    }
+  }
+  return new Schema(columns);
+}
+
+bool Planner::IsLargeRange(const IndexKeyRange &range) {
+  // 唯一索引完整 key 上的等值查找至多一行
+  auto key_columns = range.index_->GetIndexKeySchema()->GetColumnCount();
+  if (range.index_->IsUnique() && range.lower_.size() == key_columns && range.upper_.size() == key_columns && range.lower_inclusive_ &&
+      range.upper_inclusive_) {
+    bool is_point = true;
+    for (uint32_t i = 0; i < key_columns; i++) {
+      is_point = is_point && range.lower_[i].CompareEquals(range.upper_[i]) == CmpBool::kTrue;
+    }
+    if (is_point) {
+      return false;
+    }
+  }
+  if (range.index_->GetIndexType() != "bptree") {
+    // hash/art 索引不能按范围扫描, 直接取出这个 key 的所有行
+    std::vector<Field> key_fields(range.lower_);
+    std::vector<RowId> rids;
+    range.index_->GetIndex()->ScanKey(Row(key_fields), rids, context_->GetTransaction(), "=");
+    return rids.size() >= BITMAP_HEAP_SCAN_MIN_ROWS;
+  }
+  // 只数到阈值为止, 通常只会读一两个叶子
+  auto scan = IndexScanExecutor::OpenKeyRange(range, context_->GetTransaction());
+  RowId rid;
+  uint32_t count = 0;
+  while (count < BITMAP_HEAP_SCAN_MIN_ROWS && scan->Next(&rid)) {
+    count++;
+  }
+  return count >= BITMAP_HEAP_SCAN_MIN_ROWS;
 }
 
 Schema *Planner::MakeOutputSchema(const vector<std::pair<std::string, AbstractExpressionRef>> &exprs) {
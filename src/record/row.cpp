@@ -92,6 +92,9 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
         offset += len_;
         f = new Field(type, data_, len_, true);
       }
+    } else {
+      // null 列也要有一个 Field, 否则 GetField 会返回空指针
+      f = new Field(type);
     }
     fields_.push_back(f);
   }
@@ -0,0 +1,127 @@
+#include "record/row_batch.h"
+
+void ColumnVector::Reset(TypeId type) {
+  type_ = type;
+  is_constant_ = false;
+  nulls_.clear();
+  ints_.clear();
+  floats_.clear();
+  chars_.clear();
+}
+
+void ColumnVector::Resize(size_t n, bool is_null) {
+  nulls_.resize(n, is_null);
+  switch (type_) {
+    case TypeId::kTypeInt:
+      ints_.resize(n);
+      break;
+    case TypeId::kTypeFloat:
+      floats_.resize(n);
+      break;
+    case TypeId::kTypeChar:
+      chars_.resize(n);
+      break;
+    default:
+      break;
+  }
+}
+
+void ColumnVector::SetConstant(const Field &val) {
+  Reset(val.GetTypeId());
+  Append(val);
+  is_constant_ = true;
+}
+
+void ColumnVector::Append(const Field &field) {
+  Resize(Size() + 1);
+  Set(Size() - 1, field);
+}
+
+void ColumnVector::Set(size_t i, const Field &field) {
+  ASSERT(field.GetTypeId() == type_, "Field type does not match the column vector.");
+  nulls_[i] = field.IsNull();
+  if (field.IsNull()) {
+    return;
+  }
+  switch (type_) {
+    case TypeId::kTypeInt:
+    case TypeId::kTypeFloat: {
+      char buf[sizeof(int32_t)];
+      field.SerializeTo(buf);
+      if (type_ == TypeId::kTypeInt) {
+        ints_[i] = MACH_READ_INT32(buf);
+      } else {
+        floats_[i] = MACH_READ_FROM(float, buf);
+      }
+      break;
+    }
+    case TypeId::kTypeChar:
+      chars_[i].assign(field.GetData(), field.GetLength());
+      break;
+    default:
+      break;
+  }
+}
+
+Field ColumnVector::GetField(size_t i) const {
+  if (is_constant_) {
+    i = 0;
+  }
+  if (nulls_[i]) {
+    return Field(type_);
+  }
+  switch (type_) {
+    case TypeId::kTypeInt:
+      return Field(type_, ints_[i]);
+    case TypeId::kTypeFloat:
+      return Field(type_, floats_[i]);
+    default:
+      return Field(type_, const_cast<char *>(chars_[i].data()), chars_[i].size(), true);
+  }
+}
+
+void RowBatch::Reset(const Schema *schema) {
+  columns_.clear();
+  rids_.clear();
+  selection_.clear();
+  has_schema_ = schema != nullptr;
+  if (has_schema_) {
+    for (auto column : schema->GetColumns()) {
+      columns_.emplace_back(column->GetType());
+    }
+  }
+}
+
+void RowBatch::Append(const Row &row, RowId rid) {
+  if (!has_schema_ && rids_.empty()) {
+    columns_.clear();
+    for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+      columns_.emplace_back(row.GetField(i)->GetTypeId());
+    }
+  }
+  selection_.push_back(rids_.size());
+  rids_.push_back(rid);
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].Append(*row.GetField(i));
+  }
+}
+
+void RowBatch::GetRow(size_t i, Row *row) const {
+  std::vector<Field> fields;
+  fields.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    fields.emplace_back(column.GetField(i));
+  }
+  *row = Row(fields);
+  row->SetRowId(rids_[i]);
+}
+
+void RowBatch::Project(const Schema *output_schema, RowBatch *out) const {
+  out->has_schema_ = true;
+  out->columns_.clear();
+  for (auto column : output_schema->GetColumns()) {
+    out->columns_.push_back(columns_[column->GetTableInd()]);
+  }
+  out->rids_ = rids_;
+  out->selection_ = selection_;
+}
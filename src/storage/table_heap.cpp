@@ -140,6 +140,43 @@ bool TableHeap::GetTuple(Row *row, Txn *txn) {
   return false; 
 }
 
+void TableHeap::GetTuples(const std::vector<RowId> &rids, std::vector<Row> &rows, Txn *txn) {
+  size_t i = 0;
+  while (i < rids.size()) {
+    page_id_t current_page_id = rids[i].GetPageId();
+    TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(current_page_id));
+    if (page == nullptr) {
+      LOG(ERROR) << "GetTuples: page is nullptr";
+      return;
+    }
+    page->RLatch();
+    // 同一页上连续的 rid 只 fetch 一次
+    for (; i < rids.size() && rids[i].GetPageId() == current_page_id; i++) {
+      Row row(rids[i]);
+      if (page->GetTuple(&row, schema_, txn, lock_manager_)) {
+        rows.emplace_back(row);
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(current_page_id, false);
+  }
+}
+
+page_id_t TableHeap::ScanPage(page_id_t page_id, const CompiledPredicate *predicate, std::vector<Row> &rows,
+                              Txn * /*txn*/) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    LOG(ERROR) << "ScanPage: page is nullptr";
+    return INVALID_PAGE_ID;
+  }
+  page->RLatch();
+  page->ScanTuples(predicate, schema_, rows);
+  page_id_t next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return next_page_id;
+}
+
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
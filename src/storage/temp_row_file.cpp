@@ -0,0 +1,71 @@
+#include "storage/temp_row_file.h"
+
+#include <stdexcept>
+
+TempRowFile::TempRowFile(BufferPoolManager *buffer_pool_manager, const Schema *schema)
+    : buffer_pool_manager_(buffer_pool_manager), schema_(const_cast<Schema *>(schema)) {}
+
+TempRowFile::~TempRowFile() {
+  ReleasePage();
+  for (auto page_id : pages_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+void TempRowFile::ReleasePage() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), writing_);
+    page_ = nullptr;
+  }
+}
+
+void TempRowFile::Append(const Row &row) {
+  ASSERT(writing_, "Cannot append to a temporary file being read.");
+  uint32_t size = row.GetSerializedSize(schema_);
+  ASSERT(HEADER_SIZE + ENTRY_HEADER_SIZE + size <= PAGE_SIZE, "Row does not fit in a temporary page.");
+  if (page_ == nullptr || offset_ + ENTRY_HEADER_SIZE + size > PAGE_SIZE) {
+    ReleasePage();
+    page_id_t page_id;
+    page_ = buffer_pool_manager_->NewPage(page_id);
+    if (page_ == nullptr) {
+      throw std::logic_error("no free page in the buffer pool for a temporary file");
+    }
+    pages_.push_back(page_id);
+    MACH_WRITE_UINT32(page_->GetData(), 0);
+    offset_ = HEADER_SIZE;
+  }
+  char *buf = page_->GetData();
+  MACH_WRITE_TO(int64_t, buf + offset_, row.GetRowId().Get());
+  MACH_WRITE_UINT32(buf + offset_ + sizeof(int64_t), size);
+  offset_ += ENTRY_HEADER_SIZE;
+  offset_ += row.SerializeTo(buf + offset_, schema_);
+  MACH_WRITE_UINT32(buf, MACH_READ_UINT32(buf) + 1);
+  row_count_++;
+}
+
+void TempRowFile::Rewind() {
+  ReleasePage();
+  writing_ = false;
+  next_page_ = 0;
+  rows_left_ = 0;
+}
+
+bool TempRowFile::Next(Row *row) {
+  ASSERT(!writing_, "Rewind the temporary file before reading it.");
+  while (rows_left_ == 0) {
+    ReleasePage();
+    if (next_page_ == pages_.size()) {
+      return false;
+    }
+    page_ = buffer_pool_manager_->FetchPage(pages_[next_page_++]);
+    rows_left_ = MACH_READ_UINT32(page_->GetData());
+    offset_ = HEADER_SIZE;
+  }
+  char *buf = page_->GetData();
+  RowId rid(MACH_READ_FROM(int64_t, buf + offset_));
+  offset_ += ENTRY_HEADER_SIZE;
+  *row = Row(rid);
+  offset_ += row->DeserializeFrom(buf + offset_, schema_);
+  rows_left_--;
+  return true;
+}
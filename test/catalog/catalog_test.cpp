@@ -66,6 +66,26 @@ TEST(CatalogTest, CatalogTableTest) {
   ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_02->GetTable("table-2", table_info_03));
   ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info_03));
   delete db_02;
+  // Table metadata of the layout without the statistics page id is still read
+  std::unique_ptr<TableMetadata> meta(TableMetadata::Create(3, "table-3", 5, Schema::DeepCopySchema(schema.get())));
+  meta->SetStatsPageId(9);
+  char buf[PAGE_SIZE];
+  uint32_t size = meta->SerializeTo(buf);
+  TableMetadata *other = nullptr;
+  ASSERT_EQ(size, TableMetadata::DeserializeFrom(buf, other));
+  ASSERT_EQ(9, other->GetStatsPageId());
+  delete other;
+  other = nullptr;
+  MACH_WRITE_UINT32(buf, 344528);
+  ASSERT_EQ(size - 4, TableMetadata::DeserializeFrom(buf, other));
+  ASSERT_EQ("table-3", other->GetTableName());
+  ASSERT_EQ(INVALID_PAGE_ID, other->GetStatsPageId());
+  delete other;
+  // An unknown layout is rejected
+  other = nullptr;
+  MACH_WRITE_UINT32(buf, 12345);
+  ASSERT_EQ(0, TableMetadata::DeserializeFrom(buf, other));
+  ASSERT_EQ(nullptr, other);
 }
 
 TEST(CatalogTest, CatalogIndexTest) {
@@ -108,6 +128,14 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(row, ret, &txn));
     ASSERT_EQ(rid.Get(), ret[i].Get());
   }
+  // Hash index
+  IndexInfo *hash_index_info = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("table-1", "index-2", {"id"}, &txn, hash_index_info, "unknown"));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-2", {"id"}, &txn, hash_index_info, "hash"));
+  for (int i = 0; i < 10; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, hash_index_info->GetIndex()->InsertEntry(Row(fields), RowId(1000, i), nullptr));
+  }
   delete db_01;
   /** Stage 2: Testing catalog loading */
   auto db_02 = new DBStorageEngine(db_file_name, false);
@@ -125,5 +153,117 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(row, ret_02, &txn));
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
+  // The index type survives reloading
+  ASSERT_EQ("bptree", index_info_02->GetIndexType());
+  IndexInfo *hash_index_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-2", hash_index_info_02));
+  ASSERT_EQ("hash", hash_index_info_02->GetIndexType());
+  for (int i = 0; i < 10; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    std::vector<RowId> hash_ret;
+    ASSERT_EQ(DB_SUCCESS, hash_index_info_02->GetIndex()->ScanKey(Row(fields), hash_ret, &txn));
+    ASSERT_EQ(RowId(1000, i).Get(), hash_ret[0].Get());
+  }
   delete db_02;
-}
\ No newline at end of file
+  // Index metadata of the layout without index type and unique flag is rejected instead of misread
+  std::unique_ptr<IndexMetadata> meta(IndexMetadata::Create(7, "index-3", 0, {0, 1}, "hash", true));
+  char buf[PAGE_SIZE];
+  meta->SerializeTo(buf);
+  IndexMetadata *other = nullptr;
+  ASSERT_EQ(meta->GetSerializedSize(), IndexMetadata::DeserializeFrom(buf, other));
+  ASSERT_EQ("hash", other->GetIndexType());
+  ASSERT_TRUE(other->IsUnique());
+  delete other;
+  other = nullptr;
+  MACH_WRITE_UINT32(buf, 344528);
+  ASSERT_EQ(0, IndexMetadata::DeserializeFrom(buf, other));
+  ASSERT_EQ(nullptr, other);
+}
+TEST(CatalogTest, CatalogArtIndexTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  std::vector<RowId> rids;
+  for (int i = 0; i < 100; i++) {
+    std::string name = "name-" + std::to_string(i % 10);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    rids.push_back(row.GetRowId());
+  }
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-art", {"name"}, &txn, index_info, "art"));
+  ASSERT_FALSE(index_info->IsUnique());
+  for (auto iter = table_info->GetTableHeap()->Begin(&txn); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(table_info->GetSchema(), index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), &txn));
+  }
+  delete db_01;
+  // Nothing of an art index is on disk, it is rebuilt from the table heap
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  IndexInfo *index_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-art", index_info_02));
+  ASSERT_EQ("art", index_info_02->GetIndexType());
+  for (int k = 0; k < 10; k++) {
+    std::string name = "name-" + std::to_string(k);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(Row(fields), ret, &txn));
+    ASSERT_EQ(10, ret.size());
+    for (int i = 0; i < 10; i++) {
+      ASSERT_EQ(rids[i * 10 + k].Get(), ret[i].Get());
+    }
+  }
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogStatisticsTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  ASSERT_EQ(nullptr, table_info->GetStatistics());
+  for (int i = 0; i < 1000; i++) {
+    std::string name = "name-" + std::to_string(i % 10);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              i % 4 == 0 ? Field(TypeId::kTypeChar, nullptr, 0, false)
+                                         : Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  ASSERT_EQ(DB_SUCCESS, catalog_01->UpdateTableStatistics(
+                            "table-1", TableStatistics::Collect(table_info, std::vector<IndexInfo *>(), &txn)));
+  delete db_01;
+  // The statistics are reloaded with the table
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  TableInfo *table_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info_02));
+  auto stats = table_info_02->GetStatistics();
+  ASSERT_NE(nullptr, stats);
+  ASSERT_EQ(1000, stats->GetRowCount());
+  ASSERT_GT(stats->GetPageCount(), 1);
+  // every row is in the sample, so the counts are exact
+  ASSERT_EQ(1000, stats->GetColumn(0).GetDistinctCount());
+  ASSERT_EQ(10, stats->GetColumn(1).GetDistinctCount());
+  ASSERT_DOUBLE_EQ(0.25, stats->GetColumn(1).GetNullFraction());
+  ASSERT_NEAR(0.1, stats->GetColumn(0).LessSelectivity(Field(TypeId::kTypeInt, 100)), 0.01);
+  ASSERT_NEAR(0.001, stats->GetColumn(0).EqualSelectivity(Field(TypeId::kTypeInt, 100)), 1e-6);
+  ASSERT_EQ(0, stats->GetColumn(0).EqualSelectivity(Field(TypeId::kTypeInt, 5000)));
+  std::string name = "name-1";
+  ASSERT_NEAR(0.1, stats->GetColumn(1).EqualSelectivity(
+                       Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false)), 0.03);
+  delete db_02;
+}
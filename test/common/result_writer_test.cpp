@@ -0,0 +1,119 @@
+#include "common/result_writer.h"
+
+#include <sstream>
+
+#include "common/macros.h"
+#include "gtest/gtest.h"
+#include "record/row.h"
+
+class ResultSinkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("name", TypeId::kTypeChar, 16, 1, true, false)};
+    schema_.reset(new Schema(columns));
+  }
+
+  void AddRow(int32_t id, const char *name) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id)};
+    if (name == nullptr) {
+      fields.emplace_back(TypeId::kTypeChar);
+    } else {
+      fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true);
+    }
+    if (batch_.Size() == 0) {
+      batch_.Reset(schema_.get());
+    }
+    batch_.Append(Row(fields), RowId(0, id));
+  }
+
+  std::unique_ptr<Schema> schema_;
+  RowBatch batch_;
+};
+
+TEST_F(ResultSinkTest, TableTest) {
+  std::stringstream ss;
+  ResultSink sink(ss, schema_.get(), ResultFormat::kTable);
+  // 没有行时什么都不输出
+  sink.Finish();
+  ASSERT_EQ("", ss.str());
+
+  AddRow(1, "alice");
+  AddRow(22, nullptr);
+  ResultSink sampled(ss, schema_.get(), ResultFormat::kTable);
+  sampled.Write(batch_);
+  // 取样的行还没写出
+  ASSERT_EQ("", ss.str());
+  sampled.Finish();
+  ASSERT_EQ(2, sampled.GetRowCount());
+  ASSERT_EQ(
+      "+----+-------+\n"
+      "| id | name  |\n"
+      "+----+-------+\n"
+      "| 1  | alice |\n"
+      "| 22 | NULL  |\n"
+      "+----+-------+\n",
+      ss.str());
+
+  // 固定宽度时第一批就输出, 超宽的值原样写出
+  std::stringstream fixed_ss;
+  ResultSink fixed(fixed_ss, schema_.get(), ResultFormat::kTable, 3);
+  fixed.Write(batch_);
+  ASSERT_EQ(
+      "+-----+-----+\n"
+      "| id  | name |\n"
+      "+-----+-----+\n"
+      "| 1   | alice |\n"
+      "| 22  | NULL |\n",
+      fixed_ss.str());
+}
+
+TEST_F(ResultSinkTest, DelimitedTest) {
+  AddRow(1, "a,\"b\"");
+  AddRow(2, "c\td\\");
+  AddRow(3, nullptr);
+  std::stringstream csv;
+  ResultSink csv_sink(csv, schema_.get(), ResultFormat::kCsv);
+  csv_sink.Write(batch_);
+  csv_sink.Finish();
+  ASSERT_EQ("id,name\n1,\"a,\"\"b\"\"\"\n2,c\td\\\n3,\n", csv.str());
+
+  std::stringstream tsv;
+  ResultSink tsv_sink(tsv, schema_.get(), ResultFormat::kTsv);
+  tsv_sink.Write(batch_);
+  tsv_sink.Finish();
+  ASSERT_EQ("id\tname\n1\ta,\"b\"\n2\tc\\td\\\\\n3\t\\N\n", tsv.str());
+}
+
+TEST_F(ResultSinkTest, BinaryTest) {
+  AddRow(7, "bob");
+  AddRow(8, nullptr);
+  std::stringstream ss;
+  ResultSink sink(ss, schema_.get(), ResultFormat::kBinary);
+  sink.Write(batch_);
+  sink.Finish();
+
+  std::string data = ss.str();
+  char *buf = &data[0];
+  Schema *schema = nullptr;
+  uint32_t offset = Schema::DeserializeFrom(buf, schema);
+  std::unique_ptr<Schema> schema_guard(schema);
+  ASSERT_EQ(2, schema->GetColumnCount());
+  ASSERT_EQ("name", schema->GetColumn(1)->GetName());
+  std::vector<Row> rows;
+  while (true) {
+    uint32_t size = MACH_READ_UINT32(buf + offset);
+    offset += sizeof(uint32_t);
+    if (size == 0) {
+      break;
+    }
+    rows.emplace_back();
+    ASSERT_EQ(size, rows.back().DeserializeFrom(buf + offset, schema));
+    offset += size;
+  }
+  ASSERT_EQ(data.size(), offset);
+  ASSERT_EQ(2, rows.size());
+  ASSERT_EQ("7", rows[0].GetField(0)->toString());
+  ASSERT_EQ("bob", rows[0].GetField(1)->toString());
+  ASSERT_TRUE(rows[1].GetField(1)->IsNull());
+}
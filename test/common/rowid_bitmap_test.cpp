@@ -0,0 +1,70 @@
+#include "common/rowid_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static std::set<int64_t> ToSet(const RowIdBitmap &bitmap) {
+  std::set<int64_t> result;
+  for (auto rid : bitmap.ToVector()) {
+    result.insert(rid.Get());
+  }
+  return result;
+}
+
+TEST(RowIdBitmapTest, SimpleTest) {
+  RowIdBitmap bitmap;
+  ASSERT_TRUE(bitmap.Empty());
+  bitmap.Add(RowId(3, 7));
+  bitmap.Add(RowId(1, 2));
+  bitmap.Add(RowId(3, 1));
+  bitmap.Add(RowId(3, 7));
+  ASSERT_EQ(3, bitmap.Cardinality());
+  ASSERT_TRUE(bitmap.Contains(RowId(3, 1)));
+  ASSERT_FALSE(bitmap.Contains(RowId(2, 1)));
+  // (page, slot) order
+  auto rids = bitmap.ToVector();
+  ASSERT_EQ(RowId(1, 2), rids[0]);
+  ASSERT_EQ(RowId(3, 1), rids[1]);
+  ASSERT_EQ(RowId(3, 7), rids[2]);
+  // a dense page switches to a bitset and keeps its contents
+  for (uint32_t slot = 0; slot < 200; slot++) {
+    bitmap.Add(RowId(5, slot));
+  }
+  ASSERT_EQ(203, bitmap.Cardinality());
+  for (uint32_t slot = 0; slot < 200; slot++) {
+    ASSERT_TRUE(bitmap.Contains(RowId(5, slot)));
+  }
+  ASSERT_FALSE(bitmap.Contains(RowId(5, 200)));
+}
+
+TEST(RowIdBitmapTest, AndOrTest) {
+  std::set<int64_t> lhs_set, rhs_set;
+  RowIdBitmap lhs, rhs;
+  // mix sparse and dense pages on both sides
+  for (int i = 0; i < 5000; i++) {
+    RowId l(RandomUtils::RandomInt(0, 20), RandomUtils::RandomInt(0, i % 2 ? 300 : 40));
+    RowId r(RandomUtils::RandomInt(0, 20), RandomUtils::RandomInt(0, i % 3 ? 20 : 300));
+    lhs.Add(l);
+    lhs_set.insert(l.Get());
+    rhs.Add(r);
+    rhs_set.insert(r.Get());
+  }
+  ASSERT_EQ(lhs_set.size(), lhs.Cardinality());
+  std::set<int64_t> expected_and, expected_or;
+  std::set_intersection(lhs_set.begin(), lhs_set.end(), rhs_set.begin(), rhs_set.end(),
+                        std::inserter(expected_and, expected_and.begin()));
+  std::set_union(lhs_set.begin(), lhs_set.end(), rhs_set.begin(), rhs_set.end(),
+                 std::inserter(expected_or, expected_or.begin()));
+  RowIdBitmap and_bitmap = lhs;
+  and_bitmap.IntersectWith(rhs);
+  ASSERT_EQ(expected_and, ToSet(and_bitmap));
+  ASSERT_EQ(expected_and.size(), and_bitmap.Cardinality());
+  RowIdBitmap or_bitmap = lhs;
+  or_bitmap.UnionWith(rhs);
+  ASSERT_EQ(expected_or, ToSet(or_bitmap));
+  ASSERT_EQ(expected_or.size(), or_bitmap.Cardinality());
+}
@@ -0,0 +1,243 @@
+#include "planner/expressions/compiled_predicate.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+
+class CompiledPredicateTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, true, false),
+                                     new Column("b", TypeId::kTypeFloat, 1, true, false),
+                                     new Column("c", TypeId::kTypeChar, 8, 2, true, false),
+                                     new Column("d", TypeId::kTypeInt, 3, true, false)};
+    schema_.reset(new Schema(columns));
+  }
+
+  /** Rows over a small domain so that every comparison hits equal values, about one value in ten is null. */
+  void MakeRows(size_t n) {
+    std::mt19937 rng(2024);
+    const char *names[] = {"", "a", "ab", "abc", "b", "ba", "zz"};
+    rows_.clear();
+    for (size_t i = 0; i < n; i++) {
+      std::vector<Field> fields;
+      auto is_null = [&]() { return rng() % 10 == 0; };
+      fields.push_back(is_null() ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, static_cast<int32_t>(rng() % 20)));
+      fields.push_back(is_null() ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, (rng() % 20) / 2.0f));
+      if (is_null()) {
+        fields.emplace_back(TypeId::kTypeChar);
+      } else {
+        const char *name = names[rng() % 7];
+        fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true);
+      }
+      fields.push_back(is_null() ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, static_cast<int32_t>(rng() % 20)));
+      rows_.emplace_back(fields);
+      rows_.back().SetRowId(RowId(0, i));
+    }
+  }
+
+  void MakeBatches() {
+    batches_.clear();
+    for (size_t i = 0; i < rows_.size(); i++) {
+      if (i % ROW_BATCH_SIZE == 0) {
+        batches_.emplace_back();
+        batches_.back().Reset(schema_.get());
+      }
+      batches_.back().Append(rows_[i], rows_[i].GetRowId());
+    }
+  }
+
+  static AbstractExpressionRef ColumnRef(uint32_t idx, TypeId type) {
+    return std::make_shared<ColumnValueExpression>(0, idx, type);
+  }
+
+  static AbstractExpressionRef Compare(AbstractExpressionRef lhs, AbstractExpressionRef rhs, const char *op) {
+    return std::make_shared<ComparisonExpression>(std::move(lhs), std::move(rhs), op);
+  }
+
+  static AbstractExpressionRef Logic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, LogicType type) {
+    return std::make_shared<LogicExpression>(std::move(lhs), std::move(rhs), type);
+  }
+
+  static AbstractExpressionRef Int(int32_t val) {
+    return std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, val));
+  }
+
+  static AbstractExpressionRef Float(float val) {
+    return std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeFloat, val));
+  }
+
+  static AbstractExpressionRef Char(const char *val) {
+    return std::make_shared<ConstantValueExpression>(
+        Field(TypeId::kTypeChar, const_cast<char *>(val), strlen(val), true));
+  }
+
+  /** The rows the interpreter lets through, by their slot. */
+  std::vector<uint32_t> Interpret(const AbstractExpressionRef &predicate) {
+    std::vector<uint32_t> result;
+    for (const auto &row : rows_) {
+      if (predicate->Evaluate(&row).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+        result.push_back(row.GetRowId().GetSlotNum());
+      }
+    }
+    return result;
+  }
+
+  std::unique_ptr<Schema> schema_;
+  std::vector<Row> rows_;
+  std::vector<RowBatch> batches_;
+};
+
+TEST_F(CompiledPredicateTest, SameAsInterpreterTest) {
+  MakeRows(3000);
+  MakeBatches();
+  auto a = ColumnRef(0, TypeId::kTypeInt);
+  auto b = ColumnRef(1, TypeId::kTypeFloat);
+  auto c = ColumnRef(2, TypeId::kTypeChar);
+  auto d = ColumnRef(3, TypeId::kTypeInt);
+  std::vector<AbstractExpressionRef> predicates;
+  for (const char *op : {"=", "<>", "<", "<=", ">", ">="}) {
+    predicates.push_back(Compare(a, Int(7), op));
+    predicates.push_back(Compare(b, Float(4.5f), op));
+    predicates.push_back(Compare(c, Char("ab"), op));
+    predicates.push_back(Compare(a, d, op));
+  }
+  predicates.push_back(Compare(a, std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt)), "="));
+  predicates.push_back(Compare(c, Char(""), "is"));
+  predicates.push_back(Compare(c, Char(""), "not"));
+  predicates.push_back(Logic(Compare(a, Int(10), "<"), Compare(c, Char("b"), ">="), LogicType::And));
+  predicates.push_back(Logic(Compare(a, Int(3), "<"), Compare(b, Float(8), ">"), LogicType::Or));
+  // 三值逻辑: null OR true 为 true, null AND false 为 false
+  predicates.push_back(Logic(Logic(Compare(a, Int(5), "="), Compare(d, Int(5), "<>"), LogicType::Or),
+                             Logic(Compare(c, Char("a"), "<="), Compare(b, Float(2), ">="), LogicType::And),
+                             LogicType::And));
+  predicates.push_back(Logic(Compare(a, d, "<"), Logic(Compare(a, Int(0), "is"), Compare(c, Char("zz"), "="),
+                                                       LogicType::Or),
+                             LogicType::Or));
+
+  for (size_t k = 0; k < predicates.size(); k++) {
+    auto expected = Interpret(predicates[k]);
+    CompiledPredicate compiled(predicates[k]);
+    std::vector<uint32_t> by_row;
+    for (const auto &row : rows_) {
+      if (compiled.Evaluate(row)) {
+        by_row.push_back(row.GetRowId().GetSlotNum());
+      }
+    }
+    ASSERT_EQ(expected, by_row) << "predicate " << k;
+    std::vector<uint32_t> by_batch;
+    for (auto batch : batches_) {
+      compiled.FilterBatch(&batch);
+      for (auto i : batch.GetSelection()) {
+        by_batch.push_back(batch.GetRowId(i).GetSlotNum());
+      }
+    }
+    ASSERT_EQ(expected, by_batch) << "predicate " << k;
+    // 直接在序列化的元组上求值
+    std::vector<uint32_t> by_tuple;
+    std::vector<char> buf(PAGE_SIZE);
+    for (const auto &row : rows_) {
+      row.SerializeTo(buf.data(), schema_.get());
+      if (compiled.EvaluateTuple(buf.data(), schema_.get())) {
+        by_tuple.push_back(row.GetRowId().GetSlotNum());
+      }
+    }
+    ASSERT_EQ(expected, by_tuple) << "predicate " << k;
+  }
+
+  // 顶层的 AND (包括右边嵌套的 AND) 拆成各自的合取项, 比较都编译成了指令
+  CompiledPredicate compiled(predicates[predicates.size() - 2]);
+  ASSERT_EQ(3, compiled.GetConjunctCount());
+  for (const auto &ins : compiled.GetProgram()) {
+    ASSERT_NE(CompiledPredicate::OpCode::Expression, ins.op_);
+  }
+}
+
+/**
+ * Filter throughput of the interpreted and the compiled predicate, row at a time and batch at a time. Disabled by
+ * default, run it with --gtest_also_run_disabled_tests --gtest_filter='*FilterThroughputBenchmark'.
+ */
+TEST_F(CompiledPredicateTest, DISABLED_FilterThroughputBenchmark) {
+  const size_t row_count = 200000;
+  const int rounds = 5;
+  MakeRows(row_count);
+  MakeBatches();
+  auto predicate = Logic(Compare(ColumnRef(0, TypeId::kTypeInt), Int(10), "<"),
+                         Compare(ColumnRef(2, TypeId::kTypeChar), Char("b"), ">="), LogicType::And);
+  CompiledPredicate compiled(predicate);
+
+  auto measure = [&](const char *name, const std::function<size_t()> &run) {
+    size_t passed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+      passed = run();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[ BENCH    ] " << name << ": " << static_cast<size_t>(row_count * rounds / seconds)
+              << " rows/s" << std::endl;
+    return passed;
+  };
+  size_t interpreted_row = measure("interpreted row", [&]() {
+    size_t n = 0;
+    for (const auto &row : rows_) {
+      n += predicate->Evaluate(&row).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+    }
+    return n;
+  });
+  size_t compiled_row = measure("compiled row", [&]() {
+    size_t n = 0;
+    for (const auto &row : rows_) {
+      n += compiled.Evaluate(row);
+    }
+    return n;
+  });
+  size_t interpreted_batch = measure("interpreted batch", [&]() {
+    size_t n = 0;
+    for (auto batch : batches_) {
+      predicate->FilterBatch(&batch);
+      n += batch.GetSelection().size();
+    }
+    return n;
+  });
+  size_t compiled_batch = measure("compiled batch", [&]() {
+    size_t n = 0;
+    for (auto batch : batches_) {
+      compiled.FilterBatch(&batch);
+      n += batch.GetSelection().size();
+    }
+    return n;
+  });
+  // 序列化的元组: 先反序列化再求值, 与在原地求值
+  std::vector<std::vector<char>> tuples;
+  for (const auto &row : rows_) {
+    tuples.emplace_back(row.GetSerializedSize(schema_.get()));
+    row.SerializeTo(tuples.back().data(), schema_.get());
+  }
+  size_t deserialized_tuple = measure("deserialize + compiled row", [&]() {
+    size_t n = 0;
+    for (auto &tuple : tuples) {
+      Row row;
+      row.DeserializeFrom(tuple.data(), schema_.get());
+      n += compiled.Evaluate(row);
+    }
+    return n;
+  });
+  size_t compiled_tuple = measure("compiled tuple", [&]() {
+    size_t n = 0;
+    for (const auto &tuple : tuples) {
+      n += compiled.EvaluateTuple(tuple.data(), schema_.get());
+    }
+    return n;
+  });
+  ASSERT_EQ(interpreted_row, compiled_row);
+  ASSERT_EQ(interpreted_row, interpreted_batch);
+  ASSERT_EQ(interpreted_row, compiled_batch);
+  ASSERT_EQ(interpreted_row, deserialized_tuple);
+  ASSERT_EQ(interpreted_row, compiled_tuple);
+}
@@ -1,12 +1,51 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include <map>
+#include <set>
+
+#include "executor/executors/aggregation_executor.h"
+#include "executor/executors/hash_distinct_executor.h"
+#include "executor/executors/hash_join_executor.h"
+#include "executor/executors/index_nested_loop_join_executor.h"
+#include "executor/executors/seq_scan_executor.h"
+#include "executor/executors/sort_executor.h"
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
+#include "planner/planner.h"
+
+extern "C" {
+int yyparse(void);
+#include "parser/minisql_lex.h"
+#include "parser/parser.h"
+}
+
+/** Parse a single SELECT statement and plan it. */
+static AbstractPlanNodeRef PlanSql(ExecuteContext *context, const char *sql) {
+  YY_BUFFER_STATE bp = yy_scan_string(sql);
+  yy_switch_to_buffer(bp);
+  MinisqlParserInit();
+  yyparse();
+  EXPECT_FALSE(MinisqlParserGetError());
+  Planner planner(context);
+  auto cleanup = [bp]() {
+    MinisqlParserFinish();
+    yy_delete_buffer(bp);
+    yylex_destroy();
+  };
+  try {
+    planner.PlanQuery(MinisqlGetParserRootNode());
+  } catch (...) {
+    cleanup();
+    throw;
+  }
+  cleanup();
+  return planner.plan_;
+}
 
 // SELECT id FROM table-1 WHERE id < 500
 TEST_F(ExecutorTest, SimpleSeqScanTest) {
@@ -155,3 +194,1345 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// SELECT id, account FROM table-1 WHERE id > 100 AND id <= 200 AND id >= 50
+TEST_F(ExecutorTest, IndexRangeScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                       index_info, "bptree"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+  auto range = MakeLogicExpression(
+      MakeLogicExpression(MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 100)), ">"),
+                          MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 200)), "<="),
+                          LogicType::And),
+      MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 50)), ">="), LogicType::And);
+  auto out_schema = MakeOutputSchema({{"id", col_id}, {"account", col_account}});
+  Planner planner(GetExecutorContext());
+  auto plan = planner.PlanScan(out_schema, "table-1", range);
+
+  // All three conjuncts collapse into the single range (100, 200]
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  auto index_plan = dynamic_pointer_cast<const IndexScanPlanNode>(plan);
+  ASSERT_FALSE(index_plan->need_filter_);
+  ASSERT_FALSE(index_plan->key_range_.lower_inclusive_);
+  ASSERT_TRUE(index_plan->key_range_.lower_[0].CompareEquals(Field(kTypeInt, 100)));
+  ASSERT_TRUE(index_plan->key_range_.upper_inclusive_);
+  ASSERT_TRUE(index_plan->key_range_.upper_[0].CompareEquals(Field(kTypeInt, 200)));
+  // 100 rows is a large range, read page by page
+  ASSERT_TRUE(index_plan->bitmap_heap_scan_);
+
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(100, result_set.size());
+  // the bitmap heap scan returns rows in heap order, not in key order
+  std::set<std::string> ids;
+  for (const auto &row : result_set) {
+    ids.insert(row.GetField(0)->toString());
+  }
+  for (int i = 101; i <= 200; i++) {
+    ASSERT_EQ(1, ids.count(std::to_string(i)));
+  }
+
+  // A conjunct on an unindexed column is evaluated on the fetched rows
+  auto filtered = MakeLogicExpression(
+      range, MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat, 0.f)), ">"),
+      LogicType::And);
+  plan = planner.PlanScan(out_schema, "table-1", filtered);
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  ASSERT_TRUE(dynamic_pointer_cast<const IndexScanPlanNode>(plan)->need_filter_);
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  std::vector<Row> expected;
+  GetExecutionEngine()->ExecutePlan(make_shared<SeqScanPlanNode>(out_schema, "table-1", filtered), &expected, GetTxn(),
+                                    GetExecutorContext());
+  ASSERT_EQ(expected.size(), result_set.size());
+
+  // A short range keeps the streaming index-order fetch
+  auto short_range = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 990)), ">");
+  plan = planner.PlanScan(out_schema, "table-1", short_range);
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  ASSERT_FALSE(dynamic_pointer_cast<const IndexScanPlanNode>(plan)->bitmap_heap_scan_);
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(9, result_set.size());
+}
+
+// SELECT id, name FROM table-1 WHERE id = 500 AND account > -1000 with an index on (id, account)
+TEST_F(ExecutorTest, CompositeIndexPrefixScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id", "account"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-2", index_keys, GetTxn(),
+                                                                       index_info, "bptree"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+  auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+  auto id_eq = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 500)), "=");
+  auto account_gt =
+      MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat, -1000.f)), ">");
+  Planner planner(GetExecutorContext());
+
+  // Equality on the leading column alone scans the (500) prefix
+  auto plan = planner.PlanScan(out_schema, "table-1", id_eq);
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  auto index_plan = dynamic_pointer_cast<const IndexScanPlanNode>(plan);
+  ASSERT_EQ(1, index_plan->key_range_.lower_.size());
+  ASSERT_EQ(1, index_plan->key_range_.upper_.size());
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+  ASSERT_TRUE(result_set[0].GetField(0)->CompareEquals(Field(kTypeInt, 500)));
+
+  // Equality prefix plus a range on the next column
+  plan = planner.PlanScan(out_schema, "table-1", MakeLogicExpression(account_gt, id_eq, LogicType::And));
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  index_plan = dynamic_pointer_cast<const IndexScanPlanNode>(plan);
+  ASSERT_FALSE(index_plan->need_filter_);
+  ASSERT_EQ(2, index_plan->key_range_.lower_.size());
+  ASSERT_FALSE(index_plan->key_range_.lower_inclusive_);
+  ASSERT_EQ(1, index_plan->key_range_.upper_.size());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+
+  // A range on the second column alone cannot use the index
+  plan = planner.PlanScan(out_schema, "table-1", account_gt);
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+}
+
+// SELECT id, name FROM table-1 WHERE id = 500 with a hash index on id
+TEST_F(ExecutorTest, HashIndexScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-hash", index_keys, GetTxn(),
+                                                                       index_info, "hash"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+  auto compare = [&](const std::string &op, int v) {
+    return MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, v)), op);
+  };
+  Planner planner(GetExecutorContext());
+
+  // Equality is a single probe
+  auto plan = planner.PlanScan(out_schema, "table-1", compare("=", 500));
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  auto index_plan = dynamic_pointer_cast<const IndexScanPlanNode>(plan);
+  ASSERT_EQ(index_info, index_plan->key_range_.index_);
+  ASSERT_FALSE(index_plan->bitmap_heap_scan_);
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+  ASSERT_TRUE(result_set[0].GetField(0)->CompareEquals(Field(kTypeInt, 500)));
+
+  // Even the covering query goes back to the table, the hash index has no ordered keys to read
+  plan = planner.PlanScan(MakeOutputSchema({{"id", col_id}}), "table-1", compare("=", 7));
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+
+  // OR of equalities is a union of probes
+  plan = planner.PlanScan(out_schema, "table-1", MakeLogicExpression(compare("=", 7), compare("=", 500), LogicType::Or));
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  ASSERT_TRUE(dynamic_pointer_cast<const IndexScanPlanNode>(plan)->bitmap_condition_ != nullptr);
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(2, result_set.size());
+
+  // Ranges cannot use a hash index
+  plan = planner.PlanScan(out_schema, "table-1", compare(">", 990));
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+}
+
+// SELECT id, name FROM table-1 WHERE id = 500 with an in-memory art index on id
+TEST_F(ExecutorTest, ArtIndexScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-art", index_keys, GetTxn(),
+                                                                       index_info, "art"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+  auto compare = [&](const std::string &op, int v) {
+    return MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, v)), op);
+  };
+  Planner planner(GetExecutorContext());
+
+  // Equality probes the tree, a non-unique index is counted without a key range scan
+  auto plan = planner.PlanScan(out_schema, "table-1", compare("=", 500));
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  auto index_plan = dynamic_pointer_cast<const IndexScanPlanNode>(plan);
+  ASSERT_EQ(index_info, index_plan->key_range_.index_);
+  ASSERT_FALSE(index_plan->bitmap_heap_scan_);
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+  ASSERT_TRUE(result_set[0].GetField(0)->CompareEquals(Field(kTypeInt, 500)));
+
+  // Ranges are left to the table scan
+  plan = planner.PlanScan(out_schema, "table-1", compare(">", 990));
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+}
+
+// SELECT account FROM table-1 WHERE id >= 10 AND id < 20 with an index on (id, account)
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id", "account"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-3", index_keys, GetTxn(),
+                                                                       index_info, "bptree"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+  auto predicate = MakeLogicExpression(
+      MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 10)), ">="),
+      MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 20)), "<"), LogicType::And);
+  auto out_schema = MakeOutputSchema({{"account", col_account}});
+  Planner planner(GetExecutorContext());
+  auto plan = planner.PlanScan(out_schema, "table-1", predicate);
+  ASSERT_EQ(PlanType::IndexOnlyScan, plan->GetType());
+
+  std::vector<Row> result_set;
+  std::vector<Row> expected;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  GetExecutionEngine()->ExecutePlan(make_shared<SeqScanPlanNode>(out_schema, "table-1", predicate), &expected,
+                                    GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(1, result_set[i].GetFieldCount());
+    ASSERT_TRUE(result_set[i].GetField(0)->CompareEquals(*expected[i].GetField(0)));
+  }
+
+  // No usable range, the covering index is still read in full and filtered on the keys
+  auto not_equal = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 10)), "<>");
+  plan = planner.PlanScan(MakeOutputSchema({{"id", col_id}}), "table-1", not_equal);
+  ASSERT_EQ(PlanType::IndexOnlyScan, plan->GetType());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(999, result_set.size());
+
+  // Reading a column outside the key needs the heap
+  plan = planner.PlanScan(MakeOutputSchema({{"name", col_name}}), "table-1", predicate);
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+}
+
+// SELECT * FROM table-2 WHERE a < 10 OR b < 5 OR a = 500, and a >= 100 AND b >= 100, indexes on a and b
+TEST_F(ExecutorTest, BitmapIndexOrAndTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false),
+                                   new Column("b", TypeId::kTypeInt, 1, false, false)};
+  auto table_schema = std::make_shared<Schema>(columns);
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("table-2", table_schema.get(), GetTxn(), table_info));
+  IndexInfo *index_a = nullptr, *index_b = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("table-2", "index-a", {"a"}, GetTxn(), index_a, "bptree"));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("table-2", "index-b", {"b"}, GetTxn(), index_b, "bptree"));
+  // b = 999 - a
+  for (int i = 0; i < 1000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeInt, 999 - i)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, GetTxn()));
+    for (auto index : {index_a, index_b}) {
+      Row key_row;
+      row.GetKeyFromRow(table_info->GetSchema(), index->GetIndexKeySchema(), key_row);
+      ASSERT_EQ(DB_SUCCESS, index->GetIndex()->InsertEntry(key_row, row.GetRowId(), GetTxn()));
+    }
+  }
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "a");
+  auto col_b = MakeColumnValueExpression(*schema, 0, "b");
+  auto out_schema = MakeOutputSchema({{"a", col_a}, {"b", col_b}});
+  auto compare = [&](const AbstractExpressionRef &col, const std::string &op, int v) {
+    return MakeComparisonExpression(col, MakeConstantValueExpression(Field(kTypeInt, v)), op);
+  };
+  Planner planner(GetExecutorContext());
+  auto check = [&](const AbstractExpressionRef &predicate, LogicType logic_type, size_t expected_size) {
+    auto plan = planner.PlanScan(out_schema, "table-2", predicate);
+    ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+    auto index_plan = dynamic_pointer_cast<const IndexScanPlanNode>(plan);
+    ASSERT_TRUE(index_plan->bitmap_condition_ != nullptr);
+    ASSERT_EQ(logic_type, index_plan->bitmap_condition_->logic_type_);
+    std::vector<Row> result_set, expected;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+    GetExecutionEngine()->ExecutePlan(make_shared<SeqScanPlanNode>(out_schema, "table-2", predicate), &expected,
+                                      GetTxn(), GetExecutorContext());
+    ASSERT_EQ(expected_size, expected.size());
+    ASSERT_EQ(expected.size(), result_set.size());
+    // the bitmap scan returns rows in heap page order, compare them as sets
+    std::set<std::string> expected_a, result_a;
+    for (size_t i = 0; i < result_set.size(); i++) {
+      expected_a.insert(expected[i].GetField(0)->toString());
+      result_a.insert(result_set[i].GetField(0)->toString());
+    }
+    ASSERT_EQ(expected_a, result_a);
+  };
+  // union over two indexes, a = 500 sits in the middle of the heap
+  auto or_predicate = MakeLogicExpression(
+      MakeLogicExpression(compare(col_a, "<", 10), compare(col_b, "<", 5), LogicType::Or), compare(col_a, "=", 500),
+      LogicType::Or);
+  check(or_predicate, LogicType::Or, 16);
+  ASSERT_EQ(3, dynamic_pointer_cast<const IndexScanPlanNode>(planner.PlanScan(out_schema, "table-2", or_predicate))
+                   ->bitmap_condition_->children_.size());
+  // both ranges are large, so they are intersected
+  check(MakeLogicExpression(compare(col_a, ">=", 100), compare(col_b, ">=", 100), LogicType::And), LogicType::And,
+        800);
+  // one OR branch without an index forces a sequential scan
+  auto no_index = MakeLogicExpression(compare(col_a, "<", 10),
+                                      MakeComparisonExpression(col_a, MakeConstantValueExpression(Field(kTypeInt, 3)),
+                                                               "<>"),
+                                      LogicType::Or);
+  ASSERT_EQ(PlanType::SeqScan, planner.PlanScan(out_schema, "table-2", no_index)->GetType());
+}
+
+/** Create table_name(id, name) with rows ids, name is NULL for every third id and one of n0..n3 otherwise. */
+static void CreateNullableNameTable(ExecuteContext *context, const std::string &table_name, int rows) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("name", TypeId::kTypeChar, 8, 1, true, false)};
+  Schema schema(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, context->GetCatalog()->CreateTable(table_name, &schema, context->GetTransaction(), table_info));
+  for (int i = 0; i < rows; i++) {
+    std::string name = "n" + std::to_string(i % 4);
+    std::vector<Field> fields{Field(kTypeInt, i), i % 3 == 0 ? Field(kTypeChar)
+                                                             : Field(kTypeChar, const_cast<char *>(name.c_str()),
+                                                                     static_cast<uint32_t>(name.size()), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, context->GetTransaction()));
+  }
+}
+
+// SELECT a FROM table-3 WHERE a < 50 / a <= 50 / a <> 50 with an index on a, every tenth a is null
+TEST_F(ExecutorTest, IndexRangeNullKeyTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, true, false),
+                                   new Column("b", TypeId::kTypeInt, 1, false, false)};
+  auto table_schema = std::make_shared<Schema>(columns);
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("table-3", table_schema.get(), GetTxn(), table_info));
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("table-3", "index-a", {"a"}, GetTxn(), index_info, "bptree"));
+  for (int i = 0; i < 200; i++) {
+    std::vector<Field> fields{i % 10 == 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, GetTxn()));
+    Row key_row;
+    row.GetKeyFromRow(table_info->GetSchema(), index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, row.GetRowId(), GetTxn()));
+  }
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "a");
+  auto col_b = MakeColumnValueExpression(*schema, 0, "b");
+  auto compare = [&](const std::string &op, int v) {
+    return MakeComparisonExpression(col_a, MakeConstantValueExpression(Field(kTypeInt, v)), op);
+  };
+  Planner planner(GetExecutorContext());
+  auto check = [&](const Schema *out_schema, const AbstractExpressionRef &predicate, PlanType type, size_t size) {
+    auto plan = planner.PlanScan(out_schema, "table-3", predicate);
+    ASSERT_EQ(type, plan->GetType());
+    std::vector<Row> result_set, expected;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+    GetExecutionEngine()->ExecutePlan(make_shared<SeqScanPlanNode>(out_schema, "table-3", predicate), &expected,
+                                      GetTxn(), GetExecutorContext());
+    ASSERT_EQ(size, expected.size());
+    ASSERT_EQ(size, result_set.size());
+    for (const auto &row : result_set) {
+      ASSERT_FALSE(row.GetField(0)->IsNull());
+    }
+  };
+  // 索引范围是精确的, 没有再过滤一遍, null 的 key 必须由扫描本身排除
+  auto out_all = MakeOutputSchema({{"a", col_a}, {"b", col_b}});
+  auto out_a = MakeOutputSchema({{"a", col_a}});
+  check(out_all, compare("<", 50), PlanType::IndexScan, 45);
+  check(out_all, compare("<=", 50), PlanType::IndexScan, 45);
+  check(out_a, compare("<", 50), PlanType::IndexOnlyScan, 45);
+  check(out_a, compare("<=", 51), PlanType::IndexOnlyScan, 46);
+  // 并集的每个分支都从 bitmap 读取
+  check(out_all, MakeLogicExpression(compare("<", 5), compare(">", 195), LogicType::Or), PlanType::IndexScan, 8);
+  auto index = index_info->GetIndex();
+  std::vector<Field> key_fields{Field(kTypeInt, 50)};
+  for (const auto &op : {std::string("<"), std::string("<="), std::string("<>")}) {
+    std::vector<RowId> rids;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(key_fields), rids, GetTxn(), op));
+    ASSERT_EQ(op == "<>" ? 180 : 45, rids.size()) << op;
+  }
+}
+
+// INSERT duplicate ids with a non-unique index on id, then a unique index on id
+TEST_F(ExecutorTest, NonUniqueIndexTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-dup", index_keys, GetTxn(),
+                                                                       index_info, "bptree"));
+  ASSERT_FALSE(index_info->IsUnique());
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+  auto insert = [&](int id) {
+    auto const1 = MakeConstantValueExpression(Field(kTypeInt, id));
+    auto const2 = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("dup"), 3, false));
+    auto const3 = MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(1.5)));
+    std::vector<std::vector<AbstractExpressionRef>> raw_values{{const1, const2, const3}};
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+  };
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto out_schema = MakeOutputSchema({{"id", col_id}});
+  Planner planner(GetExecutorContext());
+  auto count = [&](int id) {
+    auto plan = planner.PlanScan(
+        out_schema, "table-1", MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, id)), "="));
+    EXPECT_EQ(PlanType::IndexOnlyScan, plan->GetType());
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set.size();
+  };
+
+  // A non-unique index takes the duplicate and finds both rows
+  insert(500);
+  insert(500);
+  ASSERT_EQ(3, count(500));
+  std::vector<Field> key_fields{Field(kTypeInt, 500)};
+  std::vector<RowId> rids;
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(Row(key_fields), rids, GetTxn()));
+  ASSERT_EQ(3, rids.size());
+
+  // A unique index rejects rows whose key is already there
+  IndexInfo *unique_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-unique", {"name"}, GetTxn(),
+                                                                       unique_info, "bptree", true));
+  ASSERT_TRUE(unique_info->IsUnique());
+  insert(2000);
+  insert(2001);
+  ASSERT_EQ(1, count(2000));
+  ASSERT_EQ(0, count(2001));
+}
+
+// INSERT fresh ids and then an existing id with a unique index on id
+TEST_F(ExecutorTest, UniqueKeyFilterTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-id", {"id"}, GetTxn(),
+                                                                       index_info, "bptree", true));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+  auto insert = [&](int id) {
+    auto const1 = MakeConstantValueExpression(Field(kTypeInt, id));
+    auto const2 = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("new"), 3, false));
+    auto const3 = MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(1.5)));
+    std::vector<std::vector<AbstractExpressionRef>> raw_values{{const1, const2, const3}};
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+  };
+  auto count = [&](int id) {
+    std::vector<Field> key_fields{Field(kTypeInt, id)};
+    std::vector<RowId> rids;
+    index_info->GetIndex()->ScanKey(Row(key_fields), rids, GetTxn());
+    return rids.size();
+  };
+
+  // The filter was built from the rows already in the table, fresh ids rarely reach the index
+  for (int id = 1000; id < 1200; id++) {
+    insert(id);
+    ASSERT_EQ(1, count(id));
+  }
+  const auto &stats = index_info->GetKeyFilterStats();
+  ASSERT_EQ(200, stats.probes_);
+  ASSERT_EQ(200, stats.skipped_ + stats.false_positives_);
+  ASSERT_LT(stats.FalsePositiveRate(), 0.1);
+
+  // An existing id passes the filter and is found in the index
+  uint64_t skipped = stats.skipped_;
+  insert(5);
+  insert(1100);
+  ASSERT_EQ(1, count(5));
+  ASSERT_EQ(1, count(1100));
+  ASSERT_EQ(202, stats.probes_);
+  ASSERT_EQ(skipped, stats.skipped_);
+}
+
+// SELECT id, name FROM table-1 WHERE id > 0 / id = 500 after ANALYZE table-1
+TEST_F(ExecutorTest, AnalyzeCostBasedScanTest) {
+  TableInfo *table_info;
+  auto catalog = GetExecutorContext()->GetCatalog();
+  catalog->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("table-1", "index-id", {"id"}, GetTxn(), index_info, "bptree"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+  auto almost_all = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 0)), ">");
+  auto point = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 500)), "=");
+  Planner planner(GetExecutorContext());
+  // Without statistics any usable index range is taken
+  ASSERT_EQ(PlanType::IndexScan, planner.PlanScan(out_schema, "table-1", almost_all)->GetType());
+
+  std::vector<IndexInfo *> indexes;
+  catalog->GetTableIndexes("table-1", indexes);
+  ASSERT_EQ(DB_SUCCESS,
+            catalog->UpdateTableStatistics("table-1", TableStatistics::Collect(table_info, indexes, GetTxn())));
+  ASSERT_EQ(1000, table_info->GetStatistics()->GetColumn(0).GetDistinctCount());
+
+  // Nearly every row matches, reading the table in order is cheaper
+  auto plan = planner.PlanScan(out_schema, "table-1", almost_all);
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(999, result_set.size());
+
+  // A single row is still fetched through the index
+  plan = planner.PlanScan(out_schema, "table-1", point);
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+}
+
+// UPDATE table-1 SET account = 2.5 WHERE id < 100 / UPDATE table-1 SET id = 20000 WHERE id = 5
+TEST_F(ExecutorTest, UpdateSkipsUntouchedIndexTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-id", {"id"}, GetTxn(),
+                                                                       index_info, "bptree", true));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto predicate = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 100)), "<");
+  auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+  std::vector<Row> before;
+  GetExecutionEngine()->ExecutePlan(scan_plan, &before, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(100, before.size());
+
+  // account is not a key column: the index is left alone and every row is rewritten in place
+  std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs{};
+  update_attrs.emplace(2, MakeConstantValueExpression(Field(kTypeFloat, 2.5f)));
+  auto update_plan = std::make_shared<UpdatePlanNode>(schema, scan_plan, "table-1", update_attrs);
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(update_plan, &result_set, GetTxn(), GetExecutorContext());
+  std::vector<Row> after;
+  GetExecutionEngine()->ExecutePlan(scan_plan, &after, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(before.size(), after.size());
+  for (size_t i = 0; i < after.size(); i++) {
+    ASSERT_EQ(before[i].GetRowId().Get(), after[i].GetRowId().Get());
+    ASSERT_TRUE(after[i].GetField(0)->CompareEquals(*before[i].GetField(0)));
+    ASSERT_TRUE(after[i].GetField(1)->CompareEquals(*before[i].GetField(1)));
+    ASSERT_TRUE(after[i].GetField(2)->CompareEquals(Field(kTypeFloat, 2.5f)));
+  }
+
+  // id is the key column: the index follows the new value
+  update_attrs.clear();
+  update_attrs.emplace(0, MakeConstantValueExpression(Field(kTypeInt, 20000)));
+  auto one_row = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 5)), "=");
+  auto one_row_scan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), one_row);
+  update_plan = std::make_shared<UpdatePlanNode>(schema, one_row_scan, "table-1", update_attrs);
+  GetExecutionEngine()->ExecutePlan(update_plan, &result_set, GetTxn(), GetExecutorContext());
+  std::vector<RowId> rids;
+  std::vector<Field> old_key{Field(kTypeInt, 5)};
+  std::vector<Field> new_key{Field(kTypeInt, 20000)};
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index_info->GetIndex()->ScanKey(Row(old_key), rids, GetTxn()));
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(Row(new_key), rids, GetTxn()));
+  ASSERT_EQ(1, rids.size());
+  ASSERT_EQ(before[5].GetRowId().Get(), rids[0].Get());
+}
+
+// The batch path of a seq scan yields the same rows as the row-at-a-time path
+TEST_F(ExecutorTest, BatchScanMatchesRowScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  // 几行 name 与 account 为 null 的数据
+  for (int i = 1000; i < 1010; i++) {
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeChar, nullptr, 0, false), Field(kTypeFloat)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, GetTxn()));
+  }
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+  auto int_const = [&](int v) { return MakeConstantValueExpression(Field(kTypeInt, v)); };
+  auto float_const = [&](float v) { return MakeConstantValueExpression(Field(kTypeFloat, v)); };
+  auto name_const = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("m"), 1, false));
+  std::vector<AbstractExpressionRef> predicates{
+      nullptr,
+      MakeComparisonExpression(col_id, int_const(500), "<"),
+      MakeComparisonExpression(int_const(500), col_id, ">"),
+      MakeLogicExpression(MakeComparisonExpression(col_account, float_const(0), ">="),
+                          MakeComparisonExpression(col_name, name_const, "<"), LogicType::And),
+      MakeLogicExpression(MakeLogicExpression(MakeComparisonExpression(col_id, int_const(100), "<"),
+                                              MakeComparisonExpression(col_account, float_const(-500), "<"),
+                                              LogicType::Or),
+                          MakeComparisonExpression(col_id, int_const(50), "<>"), LogicType::And),
+      MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat)), "is"),
+      MakeComparisonExpression(col_id, int_const(5000), ">")};
+  auto output_schema = MakeOutputSchema({{"name", col_name}, {"id", col_id}});
+  size_t total = 0;
+  for (const auto &predicate : predicates) {
+    for (const Schema *out : {schema, static_cast<const Schema *>(output_schema)}) {
+      SeqScanPlanNode plan(out, table_info->GetTableName(), predicate);
+      SeqScanExecutor row_executor(GetExecutorContext(), &plan);
+      row_executor.Init();
+      std::vector<std::pair<Row, RowId>> expected;
+      Row row;
+      RowId rid;
+      while (row_executor.Next(&row, &rid)) {
+        expected.emplace_back(row, rid);
+      }
+      SeqScanExecutor batch_executor(GetExecutorContext(), &plan);
+      batch_executor.Init();
+      RowBatch batch;
+      size_t k = 0;
+      while (batch_executor.NextBatch(&batch)) {
+        ASSERT_FALSE(batch.GetSelection().empty());
+        ASSERT_LE(batch.Size(), static_cast<size_t>(ROW_BATCH_SIZE));
+        ASSERT_EQ(out->GetColumnCount(), batch.GetColumnCount());
+        for (auto i : batch.GetSelection()) {
+          ASSERT_LT(k, expected.size());
+          batch.GetRow(i, &row);
+          ASSERT_EQ(expected[k].second.Get(), row.GetRowId().Get());
+          for (uint32_t c = 0; c < out->GetColumnCount(); c++) {
+            Field *lhs = expected[k].first.GetField(c);
+            Field *rhs = row.GetField(c);
+            ASSERT_EQ(lhs->IsNull(), rhs->IsNull());
+            ASSERT_TRUE(lhs->IsNull() || lhs->CompareEquals(*rhs) == CmpBool::kTrue);
+          }
+          k++;
+        }
+      }
+      ASSERT_EQ(expected.size(), k);
+      total += k;
+    }
+  }
+  ASSERT_GT(total, 2 * (1010 + 500 + 500 + 10));
+  delete output_schema;
+}
+
+// SELECT ... FROM users, orders [, regions] WHERE ... with equi and non-equi join conditions
+TEST_F(ExecutorTest, JoinTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  std::vector<Column *> user_columns = {new Column("uid", TypeId::kTypeInt, 0, false, true),
+                                        new Column("uname", TypeId::kTypeChar, 16, 1, false, false),
+                                        new Column("region", TypeId::kTypeInt, 2, true, false)};
+  std::vector<Column *> order_columns = {new Column("oid", TypeId::kTypeInt, 0, false, true),
+                                         new Column("owner", TypeId::kTypeInt, 1, true, false),
+                                         new Column("amount", TypeId::kTypeInt, 2, false, false)};
+  std::vector<Column *> region_columns = {new Column("rid", TypeId::kTypeInt, 0, false, true),
+                                          new Column("rname", TypeId::kTypeChar, 16, 1, false, false)};
+  Schema user_schema(user_columns), order_schema(order_columns), region_schema(region_columns);
+  TableInfo *users, *orders, *regions;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("users", &user_schema, GetTxn(), users));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("orders", &order_schema, GetTxn(), orders));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("regions", &region_schema, GetTxn(), regions));
+  std::map<int, std::string> user_names;
+  std::map<int, int> user_regions;
+  for (int i = 0; i < 300; i++) {
+    std::string name = "user" + std::to_string(i);
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                              Field(kTypeInt, i % 7)};
+    Row row(fields);
+    ASSERT_TRUE(users->GetTableHeap()->InsertTuple(row, GetTxn()));
+    user_names[i] = name;
+    user_regions[i] = i % 7;
+  }
+  std::map<int, std::pair<int, int>> order_rows;
+  for (int i = 0; i < 2000; i++) {
+    // 部分订单没有对应的用户, 部分订单的 owner 为 null
+    bool has_owner = i % 50 != 0;
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeInt, (i * 7) % 400), Field(kTypeInt, i % 20)};
+    Field null_owner(kTypeInt);
+    if (!has_owner) {
+      fields[1] = null_owner;
+    }
+    Row row(fields);
+    ASSERT_TRUE(orders->GetTableHeap()->InsertTuple(row, GetTxn()));
+    if (has_owner) {
+      order_rows[i] = {(i * 7) % 400, i % 20};
+    }
+  }
+  for (int i = 0; i < 5; i++) {
+    std::string name = "region" + std::to_string(i);
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(regions->GetTableHeap()->InsertTuple(row, GetTxn()));
+  }
+  std::multiset<std::pair<std::string, int>> expected;
+  for (const auto &order : order_rows) {
+    if (user_names.count(order.second.first) && order.second.second > 10) {
+      expected.emplace(user_names[order.second.first], order.first);
+    }
+  }
+  auto collect = [](const std::vector<Row> &rows) {
+    std::multiset<std::pair<std::string, int>> result;
+    for (const auto &row : rows) {
+      result.emplace(row.GetField(0)->toString(), std::stoi(row.GetField(1)->toString()));
+    }
+    return result;
+  };
+
+  auto plan = PlanSql(GetExecutorContext(), "select uname, oid from users, orders where uid = owner and amount > 10;");
+  ASSERT_EQ(PlanType::HashJoin, plan->GetType());
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // A tiny memory budget sends both sides to partitions on temporary pages
+  auto spill_plan = std::make_shared<HashJoinPlanNode>(*dynamic_cast<const HashJoinPlanNode *>(plan.get()));
+  spill_plan->memory_budget_ = PAGE_SIZE;
+  auto left_plan = dynamic_cast<const SeqScanPlanNode *>(spill_plan->GetLeftPlan().get());
+  auto right_plan = dynamic_cast<const SeqScanPlanNode *>(spill_plan->GetRightPlan().get());
+  ASSERT_NE(nullptr, left_plan);
+  ASSERT_NE(nullptr, right_plan);
+  uint32_t allocated_pages = GetAllocatedPages();
+  auto spill_executor = std::make_unique<HashJoinExecutor>(
+      GetExecutorContext(), spill_plan.get(), std::make_unique<SeqScanExecutor>(GetExecutorContext(), left_plan),
+      std::make_unique<SeqScanExecutor>(GetExecutorContext(), right_plan));
+  spill_executor->Init();
+  ASSERT_TRUE(spill_executor->IsSpilled());
+  result_set.clear();
+  Row row;
+  RowId rid;
+  while (spill_executor->Next(&row, &rid)) {
+    result_set.push_back(row);
+  }
+  ASSERT_EQ(expected, collect(result_set));
+  // 临时页随执行器一起释放, 数据库文件里不留下分配过的页
+  spill_executor.reset();
+  ASSERT_EQ(allocated_pages, GetAllocatedPages());
+
+  // Three tables: the region key joins the first two with the third
+  expected.clear();
+  for (const auto &order : order_rows) {
+    int owner = order.second.first;
+    if (user_names.count(owner) && user_regions[owner] < 5 && order.second.second > 10) {
+      expected.emplace("region" + std::to_string(user_regions[owner]), order.first);
+    }
+  }
+  plan = PlanSql(GetExecutorContext(),
+                 "select rname, oid from users, orders, regions where uid = owner and region = rid and amount > 10;");
+  ASSERT_EQ(PlanType::HashJoin, plan->GetType());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // Without an equality the tables are joined with nested loops
+  expected.clear();
+  for (const auto &user : user_names) {
+    for (const auto &order : order_rows) {
+      if (user.first > 295 && order.first < 100 && user.first < order.second.first) {
+        expected.emplace(user.second, order.first);
+      }
+    }
+  }
+  plan = PlanSql(GetExecutorContext(),
+                 "select uname, oid from users, orders where uid > 295 and oid < 100 and uid < owner;");
+  ASSERT_EQ(PlanType::NestedLoopJoin, plan->GetType());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+}
+
+// SELECT cname, pid FROM purchases, customers WHERE pid < 6 AND buyer = cid, with an index on cid
+TEST_F(ExecutorTest, IndexNestedLoopJoinTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  std::vector<Column *> customer_columns = {new Column("cid", TypeId::kTypeInt, 0, false, true),
+                                            new Column("cname", TypeId::kTypeChar, 16, 1, false, false)};
+  std::vector<Column *> purchase_columns = {new Column("pid", TypeId::kTypeInt, 0, false, true),
+                                            new Column("buyer", TypeId::kTypeInt, 1, true, false)};
+  Schema customer_schema(customer_columns), purchase_schema(purchase_columns);
+  TableInfo *customers, *purchases;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("customers", &customer_schema, GetTxn(), customers));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("purchases", &purchase_schema, GetTxn(), purchases));
+  for (int i = 0; i < 5000; i++) {
+    std::string name = "customer" + std::to_string(i);
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(customers->GetTableHeap()->InsertTuple(row, GetTxn()));
+  }
+  // 前 6 个订单的买家为 0, 1, 2, 0, 1, null
+  for (int i = 0; i < 3000; i++) {
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeInt, i < 5 ? i % 3 : i)};
+    Field null_buyer(kTypeInt);
+    if (i == 5) {
+      fields[1] = null_buyer;
+    }
+    Row row(fields);
+    ASSERT_TRUE(purchases->GetTableHeap()->InsertTuple(row, GetTxn()));
+  }
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("customers", "index-cid", {"cid"}, GetTxn(), index_info, "bptree", true));
+  for (auto iter = customers->GetTableHeap()->Begin(GetTxn()); iter != customers->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(customers->GetSchema(), index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+  auto sql = "select cname, pid from purchases, customers where pid < 6 and buyer = cid;";
+  // Without statistics the outer side is assumed to be large
+  ASSERT_EQ(PlanType::HashJoin, PlanSql(GetExecutorContext(), sql)->GetType());
+
+  for (auto table : {customers, purchases}) {
+    std::vector<IndexInfo *> indexes;
+    catalog->GetTableIndexes(table->GetTableName(), indexes);
+    ASSERT_EQ(DB_SUCCESS, catalog->UpdateTableStatistics(table->GetTableName(),
+                                                         TableStatistics::Collect(table, indexes, GetTxn())));
+  }
+  auto plan = PlanSql(GetExecutorContext(), sql);
+  ASSERT_EQ(PlanType::IndexNestedLoopJoin, plan->GetType());
+  std::multiset<std::pair<std::string, int>> expected;
+  for (int i = 0; i < 5; i++) {
+    expected.emplace("customer" + std::to_string(i % 3), i);
+  }
+  auto collect = [](const std::vector<Row> &rows) {
+    std::multiset<std::pair<std::string, int>> result;
+    for (const auto &row : rows) {
+      result.emplace(row.GetField(0)->toString(), std::stoi(row.GetField(1)->toString()));
+    }
+    return result;
+  };
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // The outer keys are probed in order and equal keys share a lookup
+  auto join_plan = dynamic_cast<const IndexNestedLoopJoinPlanNode *>(plan.get());
+  auto outer_plan = dynamic_cast<const SeqScanPlanNode *>(join_plan->GetOuterPlan().get());
+  ASSERT_NE(nullptr, outer_plan);
+  IndexNestedLoopJoinExecutor executor(GetExecutorContext(), join_plan,
+                                       std::make_unique<SeqScanExecutor>(GetExecutorContext(), outer_plan));
+  executor.Init();
+  result_set.clear();
+  Row row;
+  RowId rid;
+  while (executor.Next(&row, &rid)) {
+    result_set.push_back(row);
+  }
+  ASSERT_EQ(expected, collect(result_set));
+  ASSERT_EQ(3, executor.GetProbeCount());
+}
+
+TEST_F(ExecutorTest, AggregationTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  std::vector<Column *> sale_columns = {new Column("sid", TypeId::kTypeInt, 0, false, true),
+                                        new Column("region", TypeId::kTypeInt, 1, true, false),
+                                        new Column("amount", TypeId::kTypeInt, 2, true, false),
+                                        new Column("price", TypeId::kTypeFloat, 3, false, false)};
+  std::vector<Column *> region_columns = {new Column("rid", TypeId::kTypeInt, 0, false, true),
+                                          new Column("rname", TypeId::kTypeChar, 16, 1, false, false)};
+  Schema sale_schema(sale_columns), region_schema(region_columns);
+  TableInfo *sales, *regions;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("sales", &sale_schema, GetTxn(), sales));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("regions", &region_schema, GetTxn(), regions));
+  // region 每 100 行有一个 null, amount 每 33 行有一个 null
+  struct Expected {
+    int count_star = 0, count = 0, sum = 0, min = 0, max = 0;
+    double price = 0;
+  };
+  std::map<std::string, Expected> groups;
+  std::map<std::string, int> region_counts;
+  for (int i = 0; i < 3000; i++) {
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeInt, i % 37), Field(kTypeInt, i % 50 - 10),
+                              Field(kTypeFloat, (i % 8) * 0.25f)};
+    Field null_field(kTypeInt);
+    if (i % 100 == 0) {
+      fields[1] = null_field;
+    }
+    Field null_amount(kTypeInt);
+    if (i % 33 == 0) {
+      fields[2] = null_amount;
+    }
+    Row row(fields);
+    ASSERT_TRUE(sales->GetTableHeap()->InsertTuple(row, GetTxn()));
+    if (i % 100 != 0) {
+      region_counts["region" + std::to_string(i % 37)]++;
+    }
+    if (i >= 2500) {
+      continue;
+    }
+    auto &group = groups[i % 100 == 0 ? "NULL" : std::to_string(i % 37)];
+    group.count_star++;
+    group.price += (i % 8) * 0.25f;
+    if (i % 33 != 0) {
+      int amount = i % 50 - 10;
+      group.min = group.count == 0 ? amount : std::min(group.min, amount);
+      group.max = group.count == 0 ? amount : std::max(group.max, amount);
+      group.count++;
+      group.sum += amount;
+    }
+  }
+  for (int i = 0; i < 37; i++) {
+    std::string name = "region" + std::to_string(i);
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(regions->GetTableHeap()->InsertTuple(row, GetTxn()));
+  }
+  std::multiset<std::vector<std::string>> expected;
+  for (const auto &group : groups) {
+    const auto &g = group.second;
+    expected.insert({std::to_string(g.count_star), group.first, std::to_string(g.count), std::to_string(g.sum),
+                     std::to_string(g.min), std::to_string(g.max),
+                     std::to_string(static_cast<float>(g.price / g.count_star))});
+  }
+  auto collect = [](const std::vector<Row> &rows) {
+    std::multiset<std::vector<std::string>> result;
+    for (const auto &row : rows) {
+      std::vector<std::string> values;
+      for (auto field : const_cast<Row &>(row).GetFields()) {
+        values.push_back(field->toString());
+      }
+      result.insert(values);
+    }
+    return result;
+  };
+
+  // Output columns may come in any order around the group column
+  auto plan = PlanSql(GetExecutorContext(),
+                      "select count(*), region, count(amount), sum(amount), min(amount), max(amount), avg(price) "
+                      "from sales where sid < 2500 group by region;");
+  ASSERT_EQ(PlanType::Aggregation, plan->GetType());
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // With a tiny memory budget only the first group stays in memory, the others go through the partitions
+  auto spill_plan = std::make_shared<AggregationPlanNode>(*dynamic_cast<const AggregationPlanNode *>(plan.get()));
+  spill_plan->memory_budget_ = 1;
+  auto child_plan = dynamic_cast<const SeqScanPlanNode *>(spill_plan->GetChildPlan().get());
+  ASSERT_NE(nullptr, child_plan);
+  uint32_t allocated_pages = GetAllocatedPages();
+  auto spill_executor = std::make_unique<AggregationExecutor>(
+      GetExecutorContext(), spill_plan.get(), std::make_unique<SeqScanExecutor>(GetExecutorContext(), child_plan));
+  spill_executor->Init();
+  ASSERT_TRUE(spill_executor->IsSpilled());
+  result_set.clear();
+  Row row;
+  RowId rid;
+  while (spill_executor->Next(&row, &rid)) {
+    result_set.push_back(row);
+  }
+  ASSERT_EQ(expected, collect(result_set));
+  spill_executor.reset();
+  ASSERT_EQ(allocated_pages, GetAllocatedPages());
+
+  // Without GROUP BY an empty input is still one group
+  plan = PlanSql(GetExecutorContext(), "select count(*), sum(amount), max(price) from sales where sid < 0;");
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  expected = {{"0", "NULL", "NULL"}};
+  ASSERT_EQ(expected, collect(result_set));
+
+  // Grouping the rows of a join by a char column
+  plan = PlanSql(GetExecutorContext(), "select rname, count(*) from sales, regions where region = rid group by rname;");
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  expected.clear();
+  for (const auto &count : region_counts) {
+    expected.insert({count.first, std::to_string(count.second)});
+  }
+  ASSERT_EQ(expected, collect(result_set));
+
+  // A NULL char key is a group of its own
+  CreateNullableNameTable(GetExecutorContext(), "pets", 30);
+  plan = PlanSql(GetExecutorContext(), "select name, count(*) from pets group by name;");
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  expected = {{"NULL", "10"}, {"n0", "5"}, {"n1", "6"}, {"n2", "5"}, {"n3", "4"}};
+  ASSERT_EQ(expected, collect(result_set));
+
+  ASSERT_THROW(PlanSql(GetExecutorContext(), "select region, amount, count(*) from sales group by region;"),
+               std::logic_error);
+  ASSERT_THROW(PlanSql(GetExecutorContext(), "select sum(*) from sales;"), std::logic_error);
+}
+
+TEST_F(ExecutorTest, SortTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, false, false),
+                                   new Column("score", TypeId::kTypeFloat, 2, true, false),
+                                   new Column("grp", TypeId::kTypeInt, 3, false, false)};
+  Schema schema(columns);
+  TableInfo *table_info;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("scores", &schema, GetTxn(), table_info));
+  struct Record {
+    int id;
+    std::string name;
+    bool has_score;
+    float score;
+    int grp;
+  };
+  std::vector<Record> records;
+  for (int i = 0; i < 5000; i++) {
+    // "n1" 是 "n10" 的前缀, 检查降序时短串排在后面
+    Record record{i, "n" + std::to_string((i * 31) % 97), i % 17 != 0, static_cast<float>((i * 7919) % 301) - 150.5f,
+                  (i * 13) % 10};
+    std::vector<Field> fields{
+        Field(kTypeInt, i),
+        Field(kTypeChar, const_cast<char *>(record.name.c_str()), static_cast<uint32_t>(record.name.size()), true),
+        Field(kTypeFloat, record.score), Field(kTypeInt, record.grp)};
+    Field null_score(kTypeFloat);
+    if (!record.has_score) {
+      fields[2] = null_score;
+    }
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, GetTxn()));
+    records.push_back(record);
+  }
+  auto collect = [](const std::vector<Row> &rows) {
+    std::vector<std::vector<std::string>> result;
+    for (const auto &row : rows) {
+      std::vector<std::string> values;
+      for (auto field : const_cast<Row &>(row).GetFields()) {
+        values.push_back(field->toString());
+      }
+      result.push_back(values);
+    }
+    return result;
+  };
+
+  // The first key is not in the SELECT list, NULL comes first in ascending order
+  std::vector<Record> sorted;
+  std::copy_if(records.begin(), records.end(), std::back_inserter(sorted), [](const Record &r) { return r.id < 4000; });
+  std::sort(sorted.begin(), sorted.end(), [](const Record &a, const Record &b) {
+    if (a.grp != b.grp) {
+      return a.grp > b.grp;
+    }
+    if (a.has_score != b.has_score || (a.has_score && a.score != b.score)) {
+      return !a.has_score || (b.has_score && a.score < b.score);
+    }
+    return a.id < b.id;
+  });
+  std::vector<std::vector<std::string>> expected;
+  for (const auto &r : sorted) {
+    Field score(kTypeFloat, r.score);
+    expected.push_back({std::to_string(r.id), r.has_score ? score.toString() : "NULL"});
+  }
+  auto plan =
+      PlanSql(GetExecutorContext(), "select id, score from scores where id < 4000 order by grp desc, score, id asc;");
+  ASSERT_EQ(PlanType::Sort, plan->GetType());
+  std::vector<Row> result_set;
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // A small memory budget writes many runs, and a small fan-in merges them in several passes
+  auto spill_plan = std::make_shared<SortPlanNode>(*dynamic_cast<const SortPlanNode *>(plan.get()));
+  spill_plan->memory_budget_ = 4 * PAGE_SIZE;
+  spill_plan->merge_fan_in_ = 4;
+  auto child_plan = dynamic_cast<const SeqScanPlanNode *>(spill_plan->GetChildPlan().get());
+  ASSERT_NE(nullptr, child_plan);
+  uint32_t allocated_pages = GetAllocatedPages();
+  auto spill_executor = std::make_unique<SortExecutor>(
+      GetExecutorContext(), spill_plan.get(), std::make_unique<SeqScanExecutor>(GetExecutorContext(), child_plan));
+  spill_executor->Init();
+  ASSERT_GT(spill_executor->GetRunCount(), 16);
+  result_set.clear();
+  Row row;
+  RowId rid;
+  while (spill_executor->Next(&row, &rid)) {
+    result_set.push_back(row);
+  }
+  ASSERT_EQ(expected, collect(result_set));
+  spill_executor.reset();
+  ASSERT_EQ(allocated_pages, GetAllocatedPages());
+
+  // Descending order of char keys, equal keys keep the order of the table
+  sorted = records;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Record &a, const Record &b) { return a.name > b.name; });
+  expected.clear();
+  for (const auto &r : sorted) {
+    expected.push_back({r.name, std::to_string(r.id)});
+  }
+  plan = PlanSql(GetExecutorContext(), "select name, id from scores order by name desc;");
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // Ordering the groups of an aggregation by an aggregate
+  std::map<int, int> counts;
+  for (const auto &r : records) {
+    counts[r.grp]++;
+  }
+  std::vector<std::pair<int, int>> groups;
+  for (const auto &count : counts) {
+    groups.emplace_back(-count.second, count.first);
+  }
+  std::sort(groups.begin(), groups.end());
+  expected.clear();
+  for (const auto &group : groups) {
+    expected.push_back({std::to_string(group.second), std::to_string(-group.first)});
+  }
+  plan = PlanSql(GetExecutorContext(), "select grp, count(*) from scores group by grp order by count(*) desc, grp;");
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  // NULL char keys come first in ascending order
+  CreateNullableNameTable(GetExecutorContext(), "pets", 30);
+  expected.clear();
+  for (int id = 0; id < 30; id += 3) {
+    expected.push_back({std::to_string(id), "NULL"});
+  }
+  for (int n = 0; n < 4; n++) {
+    for (int id = n; id < 30; id += 4) {
+      if (id % 3 != 0) {
+        expected.push_back({std::to_string(id), "n" + std::to_string(n)});
+      }
+    }
+  }
+  plan = PlanSql(GetExecutorContext(), "select id, name from pets order by name, id;");
+  ASSERT_EQ(PlanType::Sort, plan->GetType());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected, collect(result_set));
+
+  ASSERT_THROW(PlanSql(GetExecutorContext(), "select grp, count(*) from scores group by grp order by id;"),
+               std::logic_error);
+}
+
+TEST_F(ExecutorTest, LimitTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("val", TypeId::kTypeInt, 1, false, false)};
+  Schema schema(columns);
+  TableInfo *table_info;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("items", &schema, GetTxn(), table_info));
+  std::vector<std::pair<int, int>> records;
+  for (int i = 0; i < 3000; i++) {
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeInt, (i * 37) % 101)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, GetTxn()));
+    records.emplace_back((i * 37) % 101, i);
+  }
+  auto run = [this](const char *sql, PlanType type) {
+    auto plan = PlanSql(GetExecutorContext(), sql);
+    EXPECT_EQ(type, plan->GetType());
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<int> ids;
+    for (const auto &row : result_set) {
+      ids.push_back(std::stoi(row.GetField(0)->toString()));
+    }
+    return ids;
+  };
+
+  // The first qualifying rows of the scan
+  std::vector<int> expected;
+  for (const auto &record : records) {
+    if (record.first < 10 && expected.size() < 7) {
+      expected.push_back(record.second);
+    }
+  }
+  ASSERT_EQ(expected, run("select id from items where val < 10 limit 7;", PlanType::Limit));
+  ASSERT_EQ(3000, run("select id from items limit 5000;", PlanType::Limit).size());
+  ASSERT_EQ(2000, run("select id from items limit 2000;", PlanType::Limit).size());
+  ASSERT_TRUE(run("select id from items limit 0;", PlanType::Limit).empty());
+
+  // ORDER BY ... LIMIT keeps a heap of n rows, equal keys keep the order of the table
+  auto sorted = records;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first > b.first; });
+  for (size_t n : {1, 25, 3000}) {
+    expected.clear();
+    for (size_t i = 0; i < n; i++) {
+      expected.push_back(sorted[i].second);
+    }
+    auto sql = "select id from items order by val desc limit " + std::to_string(n) + ";";
+    ASSERT_EQ(expected, run(sql.c_str(), PlanType::TopN));
+  }
+
+  // NULL char keys sort first and fill the heap
+  CreateNullableNameTable(GetExecutorContext(), "pets", 30);
+  ASSERT_EQ((std::vector<int>{0, 3, 6, 9, 12}), run("select id from pets order by name, id limit 5;", PlanType::TopN));
+  ASSERT_EQ((std::vector<int>{0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 4, 8, 16}),
+            run("select id from pets order by name, id limit 13;", PlanType::TopN));
+
+  // Past TOP_N_MAX_ROWS the sort stays and the limit goes on top of it
+  auto plan = PlanSql(GetExecutorContext(), "select id from items order by val limit 1000000;");
+  ASSERT_EQ(PlanType::Limit, plan->GetType());
+  ASSERT_EQ(PlanType::Sort, dynamic_cast<const LimitPlanNode *>(plan.get())->GetChildPlan()->GetType());
+
+  ASSERT_THROW(PlanSql(GetExecutorContext(), "select id from items limit 1.5;"), std::logic_error);
+}
+
+TEST_F(ExecutorTest, DistinctTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("a", TypeId::kTypeInt, 1, false, false),
+                                   new Column("b", TypeId::kTypeChar, 8, 2, false, false),
+                                   new Column("c", TypeId::kTypeInt, 3, false, false)};
+  Schema schema(columns);
+  TableInfo *table_info;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("colors", &schema, GetTxn(), table_info));
+  std::vector<std::vector<std::string>> first_ab;
+  std::set<std::vector<std::string>> seen_ab;
+  for (int i = 0; i < 4000; i++) {
+    std::string b = "b" + std::to_string(i % 5);
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeInt, i % 13),
+                              Field(kTypeChar, const_cast<char *>(b.c_str()), b.size(), true), Field(kTypeInt, i % 7)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, GetTxn()));
+    std::vector<std::string> ab{std::to_string(i % 13), b};
+    if (seen_ab.insert(ab).second) {
+      first_ab.push_back(ab);
+    }
+  }
+  auto collect = [](const std::vector<Row> &rows) {
+    std::vector<std::vector<std::string>> result;
+    for (const auto &row : rows) {
+      std::vector<std::string> values;
+      for (auto field : const_cast<Row &>(row).GetFields()) {
+        values.push_back(field->toString());
+      }
+      result.push_back(values);
+    }
+    return result;
+  };
+  auto run = [&](const char *sql, bool input_ordered) {
+    auto plan = PlanSql(GetExecutorContext(), sql);
+    EXPECT_EQ(PlanType::Distinct, plan->GetType());
+    EXPECT_EQ(input_ordered, dynamic_cast<const DistinctPlanNode *>(plan.get())->IsInputOrdered());
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+    return collect(result_set);
+  };
+
+  // A hash distinct yields every row the first time its key is seen
+  ASSERT_EQ(first_ab, run("select distinct a, b from colors;", false));
+
+  // With a tiny memory budget most keys go through the partitions
+  auto plan = PlanSql(GetExecutorContext(), "select distinct a, b from colors;");
+  auto spill_plan = std::make_shared<DistinctPlanNode>(*dynamic_cast<const DistinctPlanNode *>(plan.get()));
+  spill_plan->memory_budget_ = 64;
+  auto child_plan = dynamic_cast<const SeqScanPlanNode *>(spill_plan->GetChildPlan().get());
+  ASSERT_NE(nullptr, child_plan);
+  uint32_t allocated_pages = GetAllocatedPages();
+  auto spill_executor = std::make_unique<HashDistinctExecutor>(
+      GetExecutorContext(), spill_plan.get(), std::make_unique<SeqScanExecutor>(GetExecutorContext(), child_plan));
+  spill_executor->Init();
+  std::vector<Row> result_set;
+  Row row;
+  RowId rid;
+  while (spill_executor->Next(&row, &rid)) {
+    result_set.push_back(row);
+  }
+  ASSERT_TRUE(spill_executor->IsSpilled());
+  auto result = collect(result_set);
+  ASSERT_EQ(seen_ab, std::set<std::vector<std::string>>(result.begin(), result.end()));
+  ASSERT_EQ(seen_ab.size(), result.size());
+  spill_executor.reset();
+  ASSERT_EQ(allocated_pages, GetAllocatedPages());
+
+  // A scan of an index on (a, c) yields equal a next to each other, and equal c once a is fixed
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("colors", "index-ac", {"a", "c"}, GetTxn(), index_info, "bptree"));
+  for (auto iter = table_info->GetTableHeap()->Begin(GetTxn()); iter != table_info->GetTableHeap()->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(table_info->GetSchema(), index_info->GetIndexKeySchema(), key_row);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key_row, iter->GetRowId(), GetTxn()));
+  }
+  std::vector<std::vector<std::string>> expected;
+  for (int a = 0; a < 13; a++) {
+    expected.push_back({std::to_string(a)});
+  }
+  ASSERT_EQ(expected, run("select distinct a from colors;", true));
+  std::set<int> cs;
+  for (int i = 3; i < 4000; i += 13) {
+    cs.insert(i % 7);
+  }
+  expected.clear();
+  for (auto c : cs) {
+    expected.push_back({std::to_string(c)});
+  }
+  ASSERT_EQ(expected, run("select distinct c from colors where a = 3;", true));
+  ASSERT_EQ(7, run("select distinct c from colors;", false).size());
+
+  // ORDER BY is extended with the other selected columns, so the sorted rows can be deduplicated in order
+  expected.clear();
+  for (int b = 4; b >= 0; b--) {
+    for (int a = 0; a < 13; a++) {
+      if (seen_ab.count({std::to_string(a), "b" + std::to_string(b)}) != 0) {
+        expected.push_back({"b" + std::to_string(b), std::to_string(a)});
+      }
+    }
+  }
+  ASSERT_EQ(expected, run("select distinct b, a from colors order by b desc;", true));
+
+  plan = PlanSql(GetExecutorContext(), "select distinct b from colors limit 3;");
+  ASSERT_EQ(PlanType::Limit, plan->GetType());
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(3, result_set.size());
+  ASSERT_THROW(PlanSql(GetExecutorContext(), "select distinct a from colors order by c;"), std::logic_error);
+
+  // NULL char keys are one distinct value, in both the hash and the sorted distinct
+  CreateNullableNameTable(GetExecutorContext(), "pets", 30);
+  ASSERT_EQ((std::vector<std::vector<std::string>>{{"NULL"}, {"n1"}, {"n2"}, {"n0"}, {"n3"}}),
+            run("select distinct name from pets;", false));
+  ASSERT_EQ((std::vector<std::vector<std::string>>{{"NULL"}, {"n0"}, {"n1"}, {"n2"}, {"n3"}}),
+            run("select distinct name from pets order by name;", true));
+}
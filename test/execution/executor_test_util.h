@@ -18,9 +18,11 @@
 #include "executor/execute_engine.h"
 #include "executor/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
+#include "page/disk_file_meta_page.h"
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 #include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
 #include "utils/utils.h"
 
 /**
@@ -73,6 +75,11 @@ class ExecutorTest : public ::testing::Test {
   /** @return The execution engine for our test instance. */
   ExecuteEngine *GetExecutionEngine() { return execution_engine_.get(); }
 
+  /** @return Number of pages allocated in the database file, temporary pages included. */
+  uint32_t GetAllocatedPages() {
+    return reinterpret_cast<DiskFileMetaPage *>(db_test_->disk_mgr_->GetMetaData())->GetAllocatedPages();
+  }
+
   /** @return Get the recovery for our test instance. */
   Txn *GetTxn() { return txn_; }
 
@@ -149,6 +156,19 @@ class ExecutorTest : public ::testing::Test {
                                                      string comp_type) {
     return std::make_shared<ComparisonExpression>(lhs, rhs, comp_type);
   }
+  /**
+   * Make a logic expression.
+   * @param lhs The abstract expression for the left-hand side of the logic computation
+   * @param rhs The abstract expression for the right-hand side of the logic computation
+   * @param logic_type The type of the logic computation operation
+   * @return A non-owning pointer to the LogicExpression
+   */
+  AbstractExpressionRef MakeLogicExpression(AbstractExpressionRef lhs, AbstractExpressionRef rhs,
+                                            LogicType logic_type) {
+    allocated_exprs_.emplace_back(std::make_shared<LogicExpression>(lhs, rhs, logic_type));
+    return allocated_exprs_.back();
+  }
+
   /**
    * Make an output schema.
    * @param exprs The expressions that define the columns of the output schema
@@ -0,0 +1,160 @@
+#include "index/art_index.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+
+TEST(ArtIndexTests, SimpleTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  // negative keys too, the sign bit of the encoding decides the first byte
+  const int n = 20000;
+  std::vector<int> keys;
+  for (int i = -n / 2; i < n / 2; i++) {
+    keys.push_back(i * 7);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  ArtIndex index(0, index_schema, 16);
+  for (int k : keys) {
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(make_key(k), RowId(1000, k), nullptr));
+  }
+  // duplicate keys are rejected
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(make_key(42), RowId(1000, 0), nullptr));
+  ASSERT_EQ(n, index.GetContainer().GetSize());
+  std::vector<RowId> ret;
+  for (int k : keys) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(k), ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(1000, k).Get(), ret[0].Get());
+    ret.clear();
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(make_key(k + 1), ret, nullptr));
+  }
+  // the leaves come out in key order
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(0), ret, nullptr, "<"));
+  ASSERT_EQ(n / 2, ret.size());
+  for (size_t i = 0; i < ret.size(); i++) {
+    ASSERT_EQ(RowId(1000, (static_cast<int>(i) - n / 2) * 7).Get(), ret[i].Get());
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(0), ret, nullptr, ">="));
+  ASSERT_EQ(n / 2, ret.size());
+  // remove two thirds of the keys in random order, nodes shrink on the way
+  std::set<int> removed;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i % 3 != 0) {
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(make_key(keys[i]), RowId(1000, keys[i]), nullptr));
+      removed.insert(keys[i]);
+    }
+  }
+  for (int k : keys) {
+    ret.clear();
+    ASSERT_EQ(removed.count(k) ? DB_KEY_NOT_FOUND : DB_SUCCESS, index.ScanKey(make_key(k), ret, nullptr));
+  }
+  ret.clear();
+  index.ScanKey(make_key(1), ret, nullptr, "<>");
+  ASSERT_EQ(n - removed.size(), ret.size());
+  for (size_t i = 0; i < keys.size(); i += 3) {
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(make_key(keys[i]), RowId(1000, keys[i]), nullptr));
+  }
+  ASSERT_TRUE(index.GetContainer().IsEmpty());
+}
+
+TEST(ArtIndexTests, LongPrefixTest) {
+  // keys share more bytes than an inner node stores as its prefix
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 64, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto make_name = [](int v) {
+    std::string name = "customer_account_" + std::to_string(v % 10) + "_record_";
+    return name + std::to_string(v);
+  };
+  auto make_key = [](const std::string &name) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    return Row(fields);
+  };
+  const int n = 5000;
+  std::vector<int> ids(n);
+  for (int i = 0; i < n; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(1));
+  ArtIndex index(0, index_schema, 80);
+  for (int i : ids) {
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(make_key(make_name(i)), RowId(1, i), nullptr));
+  }
+  std::vector<RowId> ret;
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(make_name(i)), ret, nullptr));
+    ASSERT_EQ(RowId(1, i).Get(), ret[0].Get());
+    ret.clear();
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(make_key(make_name(i) + "x"), ret, nullptr));
+  }
+  // a scan visits the names in string order
+  std::vector<std::string> names;
+  for (int i = 0; i < n; i++) {
+    names.push_back(make_name(i));
+  }
+  std::sort(names.begin(), names.end());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(""), ret, nullptr, ">="));
+  ASSERT_EQ(n, ret.size());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(names[i], make_name(ret[i].GetSlotNum()));
+  }
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(make_key(make_name(i)), RowId(1, i), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index.ScanKey(make_key(make_name(i)), ret, nullptr));
+  }
+  index.Destroy();
+  ASSERT_TRUE(index.GetContainer().IsEmpty());
+}
+
+TEST(ArtIndexTests, NonUniqueTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  const int n = 3000;
+  ArtIndex index(0, index_schema, 16 + KeyManager::ROW_ID_KEY_SIZE, false);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(make_key(i % 100), RowId(i / 100, i), nullptr));
+  }
+  std::vector<RowId> ret;
+  for (int k = 0; k < 100; k++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(k), ret, nullptr));
+    ASSERT_EQ(n / 100, ret.size());
+    // the entries of one key come in RowId order
+    for (size_t i = 0; i < ret.size(); i++) {
+      ASSERT_EQ(RowId(i, i * 100 + k).Get(), ret[i].Get());
+    }
+  }
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(make_key(i % 100), RowId(i / 100, i), nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(make_key(0), ret, nullptr));
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key(1), ret, nullptr));
+  ASSERT_EQ(n / 100, ret.size());
+}
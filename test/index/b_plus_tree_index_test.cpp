@@ -78,4 +78,330 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     i++;
   }
   delete index;
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  static const std::string range_db_name = "bp_tree_index_range_test.db";
+  remove(range_db_name.c_str());
+  auto disk_mgr_ = new DiskManager(range_db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, bpm_);
+  // keys: 0, 2, 4, ..., 1998
+  for (int i = 0; i < 1000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 2 * i)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(1000, 2 * i), nullptr));
+  }
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  auto collect = [](IndexRangeScan *scan) {
+    std::vector<uint32_t> slots;
+    RowId rid;
+    while (scan->Next(&rid)) {
+      slots.push_back(rid.GetSlotNum());
+    }
+    return slots;
+  };
+  Row k100 = make_key(100), k200 = make_key(200), k101 = make_key(101), k199 = make_key(199);
+  // 100 < id <= 200
+  auto slots = collect(index->ScanRange(&k100, false, &k200, true).get());
+  ASSERT_EQ(50, slots.size());
+  ASSERT_EQ(102, slots.front());
+  ASSERT_EQ(200, slots.back());
+  // 101 <= id < 199, bounds that are not in the index
+  slots = collect(index->ScanRange(&k101, true, &k199, false).get());
+  ASSERT_EQ(49, slots.size());
+  ASSERT_EQ(102, slots.front());
+  ASSERT_EQ(198, slots.back());
+  // open ranges on either side, and a lower bound past the last key
+  Row k1990 = make_key(1990), k5000 = make_key(5000);
+  ASSERT_EQ(5, collect(index->ScanRange(&k1990, true, nullptr, false).get()).size());
+  ASSERT_EQ(1000, collect(index->ScanRange(nullptr, false, &k5000, false).get()).size());
+  ASSERT_TRUE(collect(index->ScanRange(&k5000, true, nullptr, false).get()).empty());
+  // an empty range
+  ASSERT_TRUE(collect(index->ScanRange(&k200, false, &k100, false).get()).empty());
+  // ScanKey operators are built on top of the range scan
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(10), ret, nullptr, "<"));
+  ASSERT_EQ(5, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(10), ret, nullptr, "<>"));
+  ASSERT_EQ(999, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(make_key(1998), ret, nullptr, ">"));
+  // every leaf must be unpinned once the scans are gone
+  ASSERT_TRUE(index->Debug().Check());
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexPrefixRangeScanTest) {
+  static const std::string prefix_db_name = "bp_tree_index_prefix_test.db";
+  remove(prefix_db_name.c_str());
+  auto disk_mgr_ = new DiskManager(prefix_db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  std::vector<Column *> columns = {new Column("tenant", TypeId::kTypeInt, 0, false, false),
+                                   new Column("id", TypeId::kTypeInt, 1, false, false)};
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 32, bpm_);
+  // (tenant, id) for tenant in [0, 10), id in [0, 100)
+  for (int t = 0; t < 10; t++) {
+    for (int i = 0; i < 100; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, t), Field(TypeId::kTypeInt, i)};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(t, i), nullptr));
+    }
+  }
+  auto collect = [](IndexRangeScan *scan) {
+    std::vector<RowId> rids;
+    RowId rid;
+    while (scan->Next(&rid)) {
+      rids.push_back(rid);
+    }
+    return rids;
+  };
+  std::vector<Field> tenant3{Field(TypeId::kTypeInt, 3)};
+  std::vector<Field> tenant3_id10{Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 10)};
+  Row prefix(tenant3), bound(tenant3_id10);
+  // tenant = 3
+  auto rids = collect(index->ScanRange(&prefix, true, &prefix, true).get());
+  ASSERT_EQ(100, rids.size());
+  ASSERT_EQ(RowId(3, 0), rids.front());
+  ASSERT_EQ(RowId(3, 99), rids.back());
+  // tenant = 3 AND id > 10
+  rids = collect(index->ScanRange(&bound, false, &prefix, true).get());
+  ASSERT_EQ(89, rids.size());
+  ASSERT_EQ(RowId(3, 11), rids.front());
+  // tenant = 3 AND id < 10
+  rids = collect(index->ScanRange(&prefix, true, &bound, false).get());
+  ASSERT_EQ(10, rids.size());
+  ASSERT_EQ(RowId(3, 9), rids.back());
+  // tenant > 3
+  rids = collect(index->ScanRange(&prefix, false, nullptr, false).get());
+  ASSERT_EQ(600, rids.size());
+  ASSERT_EQ(RowId(4, 0), rids.front());
+  ASSERT_TRUE(index->Debug().Check());
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexNonUniqueTest) {
+  static const std::string dup_db_name = "bp_tree_index_dup_test.db";
+  remove(dup_db_name.c_str());
+  auto disk_mgr_ = new DiskManager(dup_db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeChar, 16, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(
+      0, index_schema, KeyManager::GetMaxKeySize(index_schema) + KeyManager::ROW_ID_KEY_SIZE, bpm_, false);
+  // 5 distinct values over 10000 rows
+  const std::vector<std::string> status{"active", "closed", "new", "pending", "suspended"};
+  auto make_key = [&status](int v) {
+    std::vector<Field> fields{
+        Field(TypeId::kTypeChar, const_cast<char *>(status[v].c_str()), status[v].size(), true)};
+    return Row(fields);
+  };
+  const int n = 10000;
+  std::vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(i % 5), RowId(i / 100, i % 100), nullptr));
+  }
+  // the same (key, row id) pair cannot be inserted twice
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(make_key(0), RowId(0, 0), nullptr));
+  // an equality lookup returns every row of the key, in row id order
+  std::vector<RowId> ret;
+  for (int v = 0; v < 5; v++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(v), ret, nullptr, "="));
+    ASSERT_EQ(n / 5, ret.size());
+    for (size_t k = 0; k < ret.size(); k++) {
+      int row = v + 5 * static_cast<int>(k);
+      ASSERT_EQ(RowId(row / 100, row % 100), ret[k]);
+    }
+  }
+  // ranges still step over whole groups of equal keys
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(2), ret, nullptr, ">"));
+  ASSERT_EQ(2 * n / 5, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(2), ret, nullptr, "<="));
+  ASSERT_EQ(3 * n / 5, ret.size());
+  // removing one row keeps the other rows of the same key
+  for (int i = 0; i < n; i += 10) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(i % 5), RowId(i / 100, i % 100), nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(0), ret, nullptr, "="));
+  ASSERT_EQ(n / 10, ret.size());
+  for (auto &rid : ret) {
+    ASSERT_EQ(5, (rid.GetPageId() * 100 + rid.GetSlotNum()) % 10);
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(1), ret, nullptr, "="));
+  ASSERT_EQ(n / 5, ret.size());
+  ASSERT_TRUE(index->Debug().Check());
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBatchScanTest) {
+  static const std::string batch_db_name = "bp_tree_index_batch_test.db";
+  remove(batch_db_name.c_str());
+  auto disk_mgr_ = new DiskManager(batch_db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, bpm_);
+  // enough keys for a few hundred leaves, so the scans read ahead
+  const int n = 50000;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i / 100, i % 100), nullptr));
+  }
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  auto collect_batches = [](IndexRangeScan *scan) {
+    std::vector<RowId> rids;
+    while (scan->NextBatch(rids)) {
+    }
+    return rids;
+  };
+  auto check = [&](int from, std::vector<RowId> rids, size_t expected) {
+    ASSERT_EQ(expected, rids.size());
+    for (size_t i = 0; i < rids.size(); i++) {
+      ASSERT_EQ(RowId((from + i) / 100, (from + i) % 100).Get(), rids[i].Get());
+    }
+  };
+  Row k123 = make_key(123), k40000 = make_key(40000), k41000 = make_key(41000);
+  check(0, collect_batches(index->ScanRange(nullptr, false, nullptr, false).get()), n);
+  check(124, collect_batches(index->ScanRange(&k123, false, &k40000, true).get()), 40000 - 123);
+  check(123, collect_batches(index->ScanRange(&k123, true, &k40000, false).get()), 40000 - 123);
+  check(41000, collect_batches(index->ScanRange(&k41000, true, nullptr, false).get()), n - 41000);
+  // batches and single steps can be mixed on one scan
+  auto scan = index->ScanRange(&k123, true, nullptr, false);
+  RowId rid;
+  std::vector<RowId> rids;
+  ASSERT_TRUE(scan->Next(&rid));
+  ASSERT_EQ(RowId(1, 23).Get(), rid.Get());
+  ASSERT_TRUE(scan->NextBatch(rids));
+  ASSERT_EQ(RowId(1, 24).Get(), rids.front().Get());
+  ASSERT_TRUE(scan->Next(&rid));
+  ASSERT_EQ(rids.back().GetPageId() * 100 + rids.back().GetSlotNum() + 1, rid.GetPageId() * 100 + rid.GetSlotNum());
+  // a scan dropped in the middle waits for its read ahead, then every leaf is unpinned
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(scan->Next(&rid));
+  }
+  scan.reset();
+  ASSERT_TRUE(index->Debug().Check());
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBatchRemoveTest) {
+  static const std::string remove_db_name = "bp_tree_index_remove_test.db";
+  remove(remove_db_name.c_str());
+  auto disk_mgr_ = new DiskManager(remove_db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  bpm_->UnpinPage(id, true);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, bpm_);
+  const int n = 20000;
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(i), RowId(i / 100, i % 100), nullptr));
+  }
+  auto remaining = [&]() {
+    std::vector<int> keys;
+    auto scan = index->ScanRange(nullptr, false, nullptr, false);
+    RowId rid;
+    while (scan->Next(&rid)) {
+      keys.push_back(rid.GetPageId() * 100 + rid.GetSlotNum());
+    }
+    return keys;
+  };
+  // 偶数 key 乱序传入, 再混入几个不存在的 key
+  std::vector<std::pair<Row, RowId>> entries;
+  for (int i = n - 2; i >= 0; i -= 2) {
+    entries.emplace_back(make_key(i), RowId(i / 100, i % 100));
+  }
+  entries.emplace_back(make_key(-5), RowId());
+  entries.emplace_back(make_key(n + 7), RowId());
+  index->RemoveEntries(entries, nullptr);
+  ASSERT_TRUE(index->Debug().Check());
+  std::vector<int> keys = remaining();
+  ASSERT_EQ(n / 2, keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(2 * i + 1, keys[i]);
+  }
+  // 删掉一大段连续的 key, 叶子需要合并
+  entries.clear();
+  for (int i = 1; i < n - 1000; i += 2) {
+    entries.emplace_back(make_key(i), RowId(i / 100, i % 100));
+  }
+  index->RemoveEntries(entries, nullptr);
+  ASSERT_TRUE(index->Debug().Check());
+  keys = remaining();
+  ASSERT_EQ(500, keys.size());
+  ASSERT_EQ(n - 999, keys.front());
+  ASSERT_EQ(n - 1, keys.back());
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(make_key(n - 1000), result, nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(n - 999), result, nullptr));
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
@@ -3,6 +3,7 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "page/index_roots_page.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -87,4 +88,178 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, StringKeyTest) {
+  // Init engine
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("name", TypeId::kTypeChar, 64, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, KeyManager::GetMaxKeySize(table_schema));
+  BPlusTree tree(0, engine.bpm_, KP);
+  // Prepare data, keys share a long common prefix
+  const int n = 20000;
+  vector<std::string> names;
+  char buf[64];
+  for (int i = 0; i < n; i++) {
+    snprintf(buf, sizeof(buf), "customer_account_%06d@example.com", i);
+    names.emplace_back(buf);
+  }
+  vector<std::string> sorted_names(names);
+  std::sort(sorted_names.begin(), sorted_names.end());
+  ShuffleArray(names);
+  auto make_key = [&](const std::string &name) -> GenericKey * {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    return key;
+  };
+  map<std::string, RowId> kv_map;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = make_key(names[i]);
+    kv_map[names[i]] = RowId(i);
+    ASSERT_TRUE(tree.Insert(key, RowId(i)));
+    free(key);
+  }
+  ASSERT_TRUE(tree.Check());
+  // Search keys
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = make_key(names[i]);
+    ans.clear();
+    ASSERT_TRUE(tree.GetValue(key, ans));
+    ASSERT_EQ(kv_map[names[i]], ans[0]);
+    free(key);
+  }
+  // Iterate in key order
+  int pos = 0;
+  for (auto it = tree.Begin(); it != tree.End(); ++it, ++pos) {
+    Row row;
+    KP.DeserializeToKey((*it).first, row, table_schema);
+    ASSERT_EQ(sorted_names[pos], row.GetField(0)->toString());
+    ASSERT_EQ(kv_map[sorted_names[pos]], (*it).second);
+  }
+  ASSERT_EQ(n, pos);
+  ASSERT_TRUE(tree.Check());
+  // Fan-out and height against the former fixed 128-byte key slots (char(64) rounded up), with full pages
+  const int old_leaf_fanout = (PAGE_SIZE - 32) / (128 + sizeof(RowId));
+  const int old_internal_fanout = (PAGE_SIZE - 28) / (128 + sizeof(page_id_t));
+  uint32_t old_height = 1;
+  for (int pages = (n + old_leaf_fanout - 1) / old_leaf_fanout; pages > 1; old_height++) {
+    pages = (pages + old_internal_fanout - 1) / old_internal_fanout;
+  }
+  BPlusTreeStats stats = tree.GetStats();
+  LOG(INFO) << "fixed slots: leaf fan-out " << old_leaf_fanout << ", internal fan-out " << old_internal_fanout
+            << ", height " << old_height;
+  LOG(INFO) << "prefix compressed: leaf fan-out " << stats.GetLeafFanout() << ", internal fan-out "
+            << stats.GetInternalFanout() << ", height " << stats.height_;
+  ASSERT_EQ(static_cast<uint32_t>(n), stats.entries_);
+  ASSERT_GT(stats.GetLeafFanout(), old_leaf_fanout);
+  ASSERT_LE(stats.height_, old_height);
+  // Keys outside the common prefix shrink the prefix of the first and last leaves
+  vector<std::string> outliers{"", "a", "customer", "customer_account_", "zzzzzzzz", std::string(64, 'z')};
+  for (size_t i = 0; i < outliers.size(); i++) {
+    GenericKey *key = make_key(outliers[i]);
+    ASSERT_TRUE(tree.Insert(key, RowId(n + i)));
+    free(key);
+    kv_map[outliers[i]] = RowId(n + i);
+  }
+  ASSERT_TRUE(tree.Check());
+  // Delete every key and check the rest after each round
+  vector<std::string> delete_seq;
+  for (auto &kv : kv_map) {
+    delete_seq.push_back(kv.first);
+  }
+  ShuffleArray(delete_seq);
+  for (size_t i = 0; i < delete_seq.size(); i++) {
+    GenericKey *key = make_key(delete_seq[i]);
+    tree.Remove(key);
+    ans.clear();
+    ASSERT_FALSE(tree.GetValue(key, ans));
+    free(key);
+    if (i % 5000 == 0 || i + 1 == delete_seq.size()) {
+      for (size_t j = i + 1; j < delete_seq.size(); j++) {
+        key = make_key(delete_seq[j]);
+        ans.clear();
+        ASSERT_TRUE(tree.GetValue(key, ans));
+        ASSERT_EQ(kv_map[delete_seq[j]], ans[0]);
+        free(key);
+      }
+    }
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  // The tree starts over after being emptied
+  GenericKey *key = make_key(names[0]);
+  ASSERT_TRUE(tree.Insert(key, RowId(0)));
+  ans.clear();
+  ASSERT_TRUE(tree.GetValue(key, ans));
+  free(key);
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, LazyRootTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, KeyManager::GetMaxKeySize(table_schema));
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  ShuffleArray(keys);
+  auto roots_page_has = [&](index_id_t index_id) {
+    auto *roots = reinterpret_cast<IndexRootsPage *>(engine.bpm_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    page_id_t root_id;
+    bool found = roots->GetRootId(index_id, &root_id);
+    engine.bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+    return found;
+  };
+  {
+    BPlusTree tree(7, engine.bpm_, KP, 32, 32);
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    }
+    ASSERT_GE(tree.GetStats().height_, 3);
+    // the root changed several times, but nothing was written yet
+    ASSERT_FALSE(roots_page_has(7));
+    // lookups route through the cached upper levels, removals keep them in sync
+    vector<RowId> ans;
+    for (int i = 0; i < n; i += 2) {
+      tree.Remove(keys[i]);
+    }
+    for (int i = 0; i < n; i++) {
+      ans.clear();
+      ASSERT_EQ(i % 2 == 1, tree.GetValue(keys[i], ans));
+      if (i % 2 == 1) {
+        ASSERT_EQ(RowId(i), ans[0]);
+      }
+    }
+    ASSERT_TRUE(tree.Check());
+    tree.FlushRootPageId();
+    ASSERT_TRUE(roots_page_has(7));
+    for (int i = 0; i < n; i += 2) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    }
+  }
+  // the root written when the first tree went away opens the same tree, without the upper level cache
+  BPlusTree reopened(7, engine.bpm_, KP);
+  reopened.SetCachedLevels(0);
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_TRUE(reopened.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans[0]);
+  }
+  ASSERT_TRUE(reopened.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
@@ -0,0 +1,50 @@
+#include "index/bloom_filter.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+TEST(BloomFilterTests, SimpleTest) {
+  // start small so that the filter has to add stages
+  BloomFilter filter(1000);
+  const int n = 100000;
+  for (int i = 0; i < n; i++) {
+    std::string key = "key-" + std::to_string(i);
+    filter.Add(key.data(), key.size());
+  }
+  ASSERT_EQ(n, filter.GetSize());
+  // no false negatives
+  for (int i = 0; i < n; i++) {
+    std::string key = "key-" + std::to_string(i);
+    ASSERT_TRUE(filter.MayContain(key.data(), key.size()));
+  }
+  // about 1% false positives per stage, a handful of stages
+  int false_positives = 0;
+  for (int i = n; i < 2 * n; i++) {
+    std::string key = "key-" + std::to_string(i);
+    false_positives += filter.MayContain(key.data(), key.size());
+  }
+  ASSERT_LT(false_positives, n / 20);
+  // about 10 bits per key
+  ASSERT_LT(filter.GetMemoryUsage(), 3 * n * BLOOM_FILTER_BITS_PER_KEY / 8);
+  filter.Clear();
+  ASSERT_EQ(0, filter.GetSize());
+  std::string key = "key-0";
+  ASSERT_FALSE(filter.MayContain(key.data(), key.size()));
+}
+
+TEST(BloomFilterTests, FalsePositiveRateTest) {
+  // a single stage sized for every key, the rate should stay near the sizing target of BLOOM_FILTER_BITS_PER_KEY
+  const int n = 200000;
+  BloomFilter filter(n);
+  for (int i = 0; i < n; i++) {
+    std::string key = "key-" + std::to_string(i);
+    filter.Add(key.data(), key.size());
+  }
+  int false_positives = 0;
+  for (int i = n; i < 2 * n; i++) {
+    std::string key = "key-" + std::to_string(i);
+    false_positives += filter.MayContain(key.data(), key.size());
+  }
+  ASSERT_LT(false_positives, n / 50);
+}
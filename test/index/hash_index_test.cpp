@@ -0,0 +1,201 @@
+#include "index/hash_index.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+static void InitHeaderPages(BufferPoolManager *bpm) {
+  page_id_t id;
+  ASSERT_TRUE(bpm->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  bpm->UnpinPage(id, true);
+  ASSERT_TRUE(bpm->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  bpm->UnpinPage(id, true);
+}
+
+TEST(HashIndexTests, SimpleTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  InitHeaderPages(bpm_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  const int n = 20000;
+  auto *index = new HashIndex(0, index_schema, 16, bpm_);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(i), RowId(1000, i), nullptr));
+  }
+  // duplicate keys are rejected
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(make_key(42), RowId(1000, 0), nullptr));
+  ASSERT_GT(index->GetContainer().GetGlobalDepth(), 0);
+  std::vector<RowId> ret;
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(1000, i).Get(), ret[0].Get());
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(make_key(n), ret, nullptr));
+  // only equality is supported
+  ASSERT_EQ(DB_FAILED, index->ScanKey(make_key(0), ret, nullptr, "<"));
+  // remove the even keys
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(i), RowId(1000, i), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+  }
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete index;
+  // the directory is found again through the index roots page
+  index = new HashIndex(0, index_schema, 16, bpm_);
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(1), ret, nullptr));
+  // empty buckets merge and the directory shrinks back
+  for (int i = 1; i < n; i += 2) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(i), RowId(1000, i), nullptr));
+  }
+  ASSERT_EQ(0, index->GetContainer().GetGlobalDepth());
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
+
+TEST(HashIndexTests, OverflowTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  InitHeaderPages(bpm_);
+  // wide keys leave room for only a few pairs per bucket, so the directory hits its maximum depth
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, false, false)};
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v),
+                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+    return Row(fields);
+  };
+  const int n = 10000;
+  auto *index = new HashIndex(0, index_schema, 256, bpm_);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(i), RowId(1000, i), nullptr));
+  }
+  ASSERT_EQ(HashTableDirectoryPage::MAX_GLOBAL_DEPTH, index->GetContainer().GetGlobalDepth());
+  std::vector<RowId> ret;
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+    ASSERT_EQ(RowId(1000, i).Get(), ret[0].Get());
+  }
+  for (int i = 0; i < n; i += 3) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(i), RowId(1000, i), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 3 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+  }
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
+
+TEST(HashIndexTests, DuplicateKeyTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  InitHeaderPages(bpm_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto make_key = [](int v) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, v)};
+    return Row(fields);
+  };
+  auto sorted = [](std::vector<RowId> rids) {
+    std::vector<int64_t> values;
+    for (auto rid : rids) {
+      values.push_back(rid.Get());
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+  };
+  auto *index = new HashIndex(0, index_schema, 16, bpm_, false);
+  // one key over many pages goes to overflow pages, splitting could never separate its pairs
+  const int dup = 2000;
+  for (int i = 0; i < dup; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(7), RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  ASSERT_EQ(0, index->GetContainer().GetGlobalDepth());
+  // only the very same pair is rejected
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(make_key(7), RowId(1000, 0), nullptr));
+  // other keys still split the bucket, the duplicates move along with their overflow pages
+  const int n = 5000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(i), RowId(2000, i), nullptr));
+  }
+  ASSERT_GT(index->GetContainer().GetGlobalDepth(), 0);
+  std::vector<RowId> ret;
+  std::vector<RowId> expected;
+  for (int i = 0; i < dup; i++) {
+    expected.emplace_back(1000 + i / 100, i % 100);
+  }
+  expected.emplace_back(2000, 7);
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(7), ret, nullptr));
+  ASSERT_EQ(sorted(expected), sorted(ret));
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+    ASSERT_EQ(i == 7 ? dup + 1 : 1, ret.size());
+  }
+  // a remove takes out only the pair of its row
+  expected.clear();
+  for (int i = 0; i < dup; i++) {
+    if (i % 2 == 0) {
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(7), RowId(1000 + i / 100, i % 100), nullptr));
+    } else {
+      expected.emplace_back(1000 + i / 100, i % 100);
+    }
+  }
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(7), RowId(2000, 7), nullptr));
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(7), ret, nullptr));
+  ASSERT_EQ(sorted(expected), sorted(ret));
+  for (auto rid : expected) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(7), rid, nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(make_key(7), ret, nullptr));
+  for (int i = 0; i < n; i++) {
+    if (i != 7) {
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(i), RowId(2000, i), nullptr));
+    }
+  }
+  ASSERT_EQ(0, index->GetContainer().GetGlobalDepth());
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+}
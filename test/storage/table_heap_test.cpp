@@ -1,10 +1,16 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/compiled_predicate.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
 #include "record/field.h"
 #include "record/schema.h"
 #include "utils/utils.h"
@@ -47,6 +53,19 @@ TEST(TableHeapTest, TableHeapSampleTest) {
 
   ASSERT_EQ(row_nums, row_values.size());
   ASSERT_EQ(row_nums, size);
+  // batch read, each page fetched once
+  std::vector<RowId> rids;
+  for (auto row_kv : row_values) {
+    rids.emplace_back(row_kv.first);
+  }
+  std::sort(rids.begin(), rids.end(), [](const RowId &a, const RowId &b) { return a.Get() < b.Get(); });
+  std::vector<Row> rows;
+  table_heap->GetTuples(rids, rows, nullptr);
+  ASSERT_EQ(row_nums, rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    ASSERT_EQ(rids[i], rows[i].GetRowId());
+    ASSERT_EQ(CmpBool::kTrue, rows[i].GetField(0)->CompareEquals(row_values[rids[i].Get()]->at(0)));
+  }
   for (auto row_kv : row_values) {
     size--;
     Row row(RowId(row_kv.first));
@@ -60,3 +79,79 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+TEST(TableHeapTest, ScanPageTest) {
+  const string scan_db_file_name = "table_heap_scan_test.db";
+  remove(scan_db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(scan_db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 5000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  for (int i = 0; i < row_nums; i++) {
+    int32_t len = RandomUtils::RandomInt(0, 64);
+    char *characters = new char[len];
+    RandomUtils::RandomString(characters, len);
+    // 每 7 行一个 null name, 让后面的列在元组中的位置随之移动
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  i % 7 == 0 ? Field(TypeId::kTypeChar) : Field(TypeId::kTypeChar, characters, len, true),
+                  Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    if (i % 5 == 0) {
+      table_heap->ApplyDelete(row.GetRowId(), nullptr);
+    }
+    delete[] characters;
+  }
+  auto id = std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt);
+  auto name = std::make_shared<ColumnValueExpression>(0, 1, TypeId::kTypeChar);
+  auto account = std::make_shared<ColumnValueExpression>(0, 2, TypeId::kTypeFloat);
+  char bound[] = "m";
+  auto predicate = std::make_shared<LogicExpression>(
+      std::make_shared<ComparisonExpression>(id, std::make_shared<ConstantValueExpression>(Field(kTypeInt, 3000)),
+                                             "<"),
+      std::make_shared<LogicExpression>(
+          std::make_shared<ComparisonExpression>(
+              name, std::make_shared<ConstantValueExpression>(Field(kTypeChar, bound, 1, true)), ">="),
+          std::make_shared<ComparisonExpression>(
+              account, std::make_shared<ConstantValueExpression>(Field(kTypeFloat, 0.f)), ">"),
+          LogicType::Or),
+      LogicType::And);
+  CompiledPredicate compiled(predicate);
+
+  std::vector<Row> expected;
+  std::vector<Row> all;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    all.push_back(*it);
+    if (predicate->Evaluate(&*it).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+      expected.push_back(*it);
+    }
+  }
+  ASSERT_EQ(row_nums - row_nums / 5, all.size());
+  ASSERT_FALSE(expected.empty());
+  for (const CompiledPredicate *filter : std::vector<const CompiledPredicate *>{nullptr, &compiled}) {
+    std::vector<Row> rows;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+      page_id = table_heap->ScanPage(page_id, filter, rows, nullptr);
+    }
+    const auto &want = filter == nullptr ? all : expected;
+    ASSERT_EQ(want.size(), rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+      ASSERT_EQ(want[i].GetRowId(), rows[i].GetRowId());
+      for (uint32_t j = 0; j < schema->GetColumnCount(); j++) {
+        ASSERT_EQ(want[i].GetField(j)->IsNull(), rows[i].GetField(j)->IsNull());
+        if (!want[i].GetField(j)->IsNull()) {
+          ASSERT_EQ(CmpBool::kTrue, rows[i].GetField(j)->CompareEquals(*want[i].GetField(j)));
+        }
+      }
+    }
+  }
+  delete table_heap;
+  delete bpm_;
+  disk_mgr_->Close();
+  delete disk_mgr_;
+  remove(scan_db_file_name.c_str());
+}